@@ -0,0 +1,256 @@
+//! Prepared plugin instances chained in series.
+
+use beamer_core::{
+    AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, BusLayout, FullAudioSetup, HasParameters, MemoryPolicy, NoConfig,
+    ParameterId, ParameterStore, Parameters, Plugin, PrepareScope, ProcessContext, ProcessorConfig, Transport, MAX_CHANNELS,
+};
+
+// =============================================================================
+// Config Building
+// =============================================================================
+
+mod sealed {
+    pub trait Sealed {}
+    impl Sealed for beamer_core::NoConfig {}
+    impl Sealed for beamer_core::AudioSetup {}
+    impl Sealed for beamer_core::FullAudioSetup {}
+}
+
+/// Builds a plugin's config the same way the VST3 wrapper does.
+///
+/// Sealed: implemented for [`NoConfig`], [`AudioSetup`] and [`FullAudioSetup`].
+pub trait RenderConfig: ProcessorConfig + sealed::Sealed {
+    /// Build the config for a sample rate, maximum block size and bus layout.
+    fn build(sample_rate: f64, max_buffer_size: usize, layout: &BusLayout) -> Self;
+}
+
+impl RenderConfig for NoConfig {
+    fn build(_sample_rate: f64, _max_buffer_size: usize, _layout: &BusLayout) -> Self {
+        NoConfig
+    }
+}
+
+impl RenderConfig for AudioSetup {
+    fn build(sample_rate: f64, max_buffer_size: usize, _layout: &BusLayout) -> Self {
+        AudioSetup {
+            sample_rate,
+            max_buffer_size,
+        }
+    }
+}
+
+impl RenderConfig for FullAudioSetup {
+    fn build(sample_rate: f64, max_buffer_size: usize, layout: &BusLayout) -> Self {
+        FullAudioSetup {
+            sample_rate,
+            max_buffer_size,
+            layout: layout.clone(),
+        }
+    }
+}
+
+// =============================================================================
+// Stage
+// =============================================================================
+
+/// One prepared plugin instance of a chain, type-erased.
+pub(crate) trait Stage: Send {
+    /// Main output channels.
+    fn output_channels(&self) -> usize;
+
+    /// Start a new file: reset DSP state and restore default parameter values.
+    fn reset(&mut self);
+
+    /// Set one parameter (normalized). Returns false if the ID is unknown.
+    fn set_parameter(&mut self, id: ParameterId, normalized: f64) -> bool;
+
+    /// Jump smoothers to the current parameter values.
+    fn settle_parameters(&mut self);
+
+    /// Render `frames` frames (at most the block size) from `inputs` into `outputs`.
+    fn process(&mut self, inputs: &[Vec<f32>], outputs: &mut [Vec<f32>], frames: usize, position: i64);
+}
+
+/// Creates a prepared stage for a sample rate and maximum block size.
+pub(crate) type StageFactory = Box<dyn Fn(f64, usize) -> Box<dyn Stage> + Send + Sync>;
+
+/// A prepared plugin with the main-bus channel counts of its layout.
+struct PluginStage<P: Plugin> {
+    processor: P::Processor,
+    sample_rate: f64,
+    input_channels: usize,
+    output_channels: usize,
+    /// `(id, default)` of every parameter, restored between files
+    defaults: Vec<(ParameterId, f64)>,
+}
+
+impl<P: Plugin> PluginStage<P>
+where
+    P::Config: RenderConfig,
+{
+    fn prepare(plugin: P, sample_rate: f64, max_block_size: usize) -> Self {
+        let layout = BusLayout::from_plugin(&plugin);
+        let defaults = {
+            let parameters = plugin.parameters();
+            (0..ParameterStore::count(parameters))
+                .filter_map(|i| ParameterStore::info(parameters, i))
+                .map(|info| (info.id, info.default_normalized))
+                .collect()
+        };
+        // Prepare the way the format wrappers do (this also builds the shared lookup tables)
+        let scope = PrepareScope::begin(MemoryPolicy::Default);
+        let mut processor = plugin.prepare(P::Config::build(sample_rate, max_block_size, &layout));
+        scope.finish();
+        processor.parameters_mut().set_sample_rate(sample_rate);
+        processor.set_active(true);
+        Self {
+            processor,
+            sample_rate,
+            input_channels: (layout.main_input_channels as usize).min(MAX_CHANNELS),
+            output_channels: (layout.main_output_channels as usize).min(MAX_CHANNELS),
+            defaults,
+        }
+    }
+}
+
+impl<P: Plugin> Stage for PluginStage<P>
+where
+    P::Config: RenderConfig,
+{
+    fn output_channels(&self) -> usize {
+        self.output_channels
+    }
+
+    fn reset(&mut self) {
+        // Hosts request a full state reset this way
+        self.processor.set_active(false);
+        self.processor.set_active(true);
+        for &(id, default) in &self.defaults {
+            ParameterStore::set_normalized(self.processor.parameters(), id, default);
+        }
+    }
+
+    fn set_parameter(&mut self, id: ParameterId, normalized: f64) -> bool {
+        let known = self.defaults.iter().any(|&(other, _)| other == id);
+        if known {
+            ParameterStore::set_normalized(self.processor.parameters(), id, normalized);
+        }
+        known
+    }
+
+    fn settle_parameters(&mut self) {
+        Parameters::reset_smoothing(self.processor.parameters_mut());
+    }
+
+    fn process(&mut self, inputs: &[Vec<f32>], outputs: &mut [Vec<f32>], frames: usize, position: i64) {
+        let transport = Transport {
+            project_time_samples: Some(position),
+            ..Default::default()
+        };
+        let context = ProcessContext::new(self.sample_rate, frames, transport);
+        let mut buffer = Buffer::new(
+            inputs.iter().take(self.input_channels).map(|c| &c[..frames]),
+            outputs.iter_mut().take(self.output_channels).map(|c| &mut c[..frames]),
+            frames,
+        );
+        let mut aux = AuxiliaryBuffers::empty();
+        self.processor.process(&mut buffer, &mut aux, &context);
+    }
+}
+
+/// Factory for a stage of plugin `P` created by `make`.
+pub(crate) fn stage_factory<P, F>(make: F) -> StageFactory
+where
+    P: Plugin,
+    P::Config: RenderConfig,
+    F: Fn() -> P + Send + Sync + 'static,
+{
+    Box::new(move |sample_rate, max_block_size| {
+        Box::new(PluginStage::<P>::prepare(make(), sample_rate, max_block_size))
+    })
+}
+
+// =============================================================================
+// Chain
+// =============================================================================
+
+/// Prepared stages in series with their ping-pong buffers.
+///
+/// Each worker keeps one chain per sample rate and reuses it for every file
+/// at that rate.
+pub(crate) struct Chain {
+    stages: Vec<Box<dyn Stage>>,
+    /// Output of the previous stage / output of the current stage
+    scratch: [Vec<Vec<f32>>; 2],
+    block_size: usize,
+}
+
+impl Chain {
+    pub(crate) fn new(factories: &[StageFactory], sample_rate: f64, block_size: usize) -> Self {
+        Self {
+            stages: factories.iter().map(|make| make(sample_rate, block_size)).collect(),
+            scratch: std::array::from_fn(|_| vec![vec![0.0; block_size]; MAX_CHANNELS]),
+            block_size,
+        }
+    }
+
+    /// Main output channels of the last stage.
+    pub(crate) fn output_channels(&self) -> usize {
+        self.stages.last().map_or(0, |stage| stage.output_channels())
+    }
+
+    /// Reset every stage and apply `(stage, id, normalized)` overrides.
+    ///
+    /// Returns the number of overrides whose stage or parameter doesn't exist.
+    pub(crate) fn start_file(&mut self, parameters: &[(usize, ParameterId, f64)]) -> usize {
+        for stage in &mut self.stages {
+            stage.reset();
+        }
+        let unknown = parameters
+            .iter()
+            .filter(|&&(index, id, value)| !self.stages.get_mut(index).is_some_and(|s| s.set_parameter(id, value)))
+            .count();
+        for stage in &mut self.stages {
+            stage.settle_parameters();
+        }
+        unknown
+    }
+
+    /// Render `frames` frames of `channels` in place, block by block.
+    ///
+    /// `channels` holds at least `input_channels` and
+    /// [`output_channels()`](Self::output_channels) buffers of `frames`
+    /// samples; the first `input_channels` carry the input, and on return
+    /// the first `output_channels()` carry the output.
+    pub(crate) fn process(&mut self, channels: &mut [Vec<f32>], input_channels: usize, frames: usize, position: i64) {
+        let output_channels = self.output_channels();
+        let [a, b] = &mut self.scratch;
+        let mut done = 0;
+        while done < frames {
+            let n = (frames - done).min(self.block_size);
+
+            // Mono files feed both channels of a stereo chain
+            for (channel, buffer) in a.iter_mut().enumerate() {
+                match channel {
+                    c if c < input_channels => buffer[..n].copy_from_slice(&channels[c][done..done + n]),
+                    1 if input_channels == 1 => buffer[..n].copy_from_slice(&channels[0][done..done + n]),
+                    _ => buffer[..n].fill(0.0),
+                }
+            }
+
+            let (mut input, mut output) = (&mut *a, &mut *b);
+            for stage in &mut self.stages {
+                for buffer in output.iter_mut() {
+                    buffer[..n].fill(0.0);
+                }
+                stage.process(input, output, n, position + done as i64);
+                std::mem::swap(&mut input, &mut output);
+            }
+
+            for (channel, buffer) in channels.iter_mut().zip(input.iter()).take(output_channels) {
+                channel[done..done + n].copy_from_slice(&buffer[..n]);
+            }
+            done += n;
+        }
+    }
+}
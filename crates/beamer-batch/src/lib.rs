@@ -0,0 +1,46 @@
+//! # beamer-batch
+//!
+//! Offline batch rendering of WAV files through Beamer plugin chains.
+//!
+//! Drives any chain of [`Plugin`](beamer_core::Plugin)s through `prepare()`
+//! and `process()` on every core, with no DAW or plugin host involved:
+//!
+//! - [`BatchRenderer`] - the plugin chain and the worker pool that renders [`Job`]s
+//! - [`BatchOptions`] - worker count, block size, chunk size, read-ahead and write-behind
+//! - [`BatchReport`] - per-file results and aggregate throughput
+//! - [`wav`] - the streaming WAV reader and writer used for file I/O
+//!
+//! Each worker thread keeps one prepared chain per sample rate and resets it
+//! between files, so plugins are prepared once per worker rather than once
+//! per file. Files are dealt largest first; a worker that runs out steals
+//! from the back of the others' queues. A reader thread per worker reads
+//! ahead (into the next file, too), and a writer thread writes behind, through
+//! a fixed set of recycled buffers.
+//!
+//! ## Example
+//!
+//! ```ignore
+//! use beamer_batch::{BatchOptions, BatchRenderer, Job};
+//!
+//! let jobs: Vec<Job> = stems
+//!     .iter()
+//!     .map(|stem| Job::new(stem, out_dir.join(stem.file_name().unwrap())))
+//!     .collect();
+//!
+//! let report = BatchRenderer::new(BatchOptions::default().with_output_format(SampleFormat::Int24))
+//!     .stage::<CompressorPlugin>()
+//!     .stage::<LimiterPlugin>()
+//!     .render(&jobs);
+//!
+//! println!("{report}");
+//! ```
+
+mod chain;
+mod pipeline;
+mod queue;
+pub mod renderer;
+pub mod wav;
+
+pub use chain::RenderConfig;
+pub use renderer::{BatchFailure, BatchOptions, BatchRenderer, BatchReport, FileReport, Job};
+pub use wav::{SampleFormat, WavReader, WavSpec, WavWriter};
@@ -0,0 +1,282 @@
+//! Read-ahead and write-behind threads of one worker.
+//!
+//! Each worker owns a reader and a writer thread and a fixed set of
+//! [`Chunk`]s that circulate reader → worker → writer → reader. The reader
+//! runs ahead (into the next file, too) until every free chunk is filled;
+//! the writer drains rendered chunks while the worker renders the next.
+//! Chunks hold only as many channels as the widest file or chain they have
+//! carried; once every chunk has seen the widest, nothing is allocated.
+
+use std::io;
+use std::path::PathBuf;
+use std::sync::mpsc::{channel, Receiver, Sender};
+use std::thread::{self, JoinHandle};
+
+use crate::wav::{WavReader, WavSpec, WavWriter};
+
+/// Planar audio of one read, rendered in place.
+pub(crate) struct Chunk {
+    /// One buffer of `capacity` frames per channel used so far
+    pub(crate) channels: Vec<Vec<f32>>,
+    /// Frames per channel buffer
+    capacity: usize,
+    /// Valid frames
+    pub(crate) frames: usize,
+}
+
+impl Chunk {
+    fn new(capacity: usize) -> Self {
+        Self {
+            channels: Vec::new(),
+            capacity,
+            frames: 0,
+        }
+    }
+
+    /// Make room for at least `channels` channels.
+    ///
+    /// Allocates only the first time this chunk carries that many.
+    pub(crate) fn ensure_channels(&mut self, channels: usize) {
+        let capacity = self.capacity;
+        if self.channels.len() < channels {
+            self.channels.resize_with(channels, || vec![0.0; capacity]);
+        }
+    }
+}
+
+// =============================================================================
+// Reader
+// =============================================================================
+
+/// Message from the reader, in file order.
+pub(crate) enum ReadEvent {
+    /// The next requested file is open.
+    Open(WavSpec),
+    /// Audio of the current file.
+    Data(Chunk),
+    /// The current file is fully read.
+    End,
+    /// The current file can't be (further) read; no more events for it.
+    Failed(io::Error),
+}
+
+fn spawn_reader(
+    name: String,
+    requests: Receiver<PathBuf>,
+    free: Receiver<Chunk>,
+    events: Sender<ReadEvent>,
+) -> JoinHandle<()> {
+    thread::Builder::new()
+        .name(name)
+        .spawn(move || {
+            for path in requests {
+                let mut reader = match WavReader::open(&path) {
+                    Ok(reader) => reader,
+                    Err(error) => {
+                        let _ = events.send(ReadEvent::Failed(error));
+                        continue;
+                    }
+                };
+                let spec = reader.spec();
+                let _ = events.send(ReadEvent::Open(spec));
+                while reader.remaining() > 0 {
+                    // Blocks while every chunk is in flight: this bounds the read-ahead
+                    let Ok(mut chunk) = free.recv() else { return };
+                    chunk.ensure_channels(spec.channels as usize);
+                    match reader.read(&mut chunk.channels, chunk.capacity) {
+                        Ok(frames) => {
+                            chunk.frames = frames;
+                            let _ = events.send(ReadEvent::Data(chunk));
+                        }
+                        Err(error) => {
+                            let _ = events.send(ReadEvent::Failed(error));
+                            break;
+                        }
+                    }
+                }
+                if reader.remaining() == 0 {
+                    let _ = events.send(ReadEvent::End);
+                }
+            }
+        })
+        .expect("failed to spawn batch reader thread")
+}
+
+// =============================================================================
+// Writer
+// =============================================================================
+
+/// Message to the writer.
+pub(crate) enum WriteCommand {
+    /// Start an output file.
+    Create { path: PathBuf, spec: WavSpec },
+    /// Rendered audio of the current file.
+    Data(Chunk),
+    /// Close the current file and report the frames written.
+    Finish,
+    /// Delete the current (partial) file.
+    Abort,
+}
+
+fn spawn_writer(
+    name: String,
+    commands: Receiver<WriteCommand>,
+    free: Sender<Chunk>,
+    results: Sender<io::Result<u64>>,
+) -> JoinHandle<()> {
+    thread::Builder::new()
+        .name(name)
+        .spawn(move || {
+            let mut current: Option<(PathBuf, io::Result<WavWriter>)> = None;
+            for command in commands {
+                match command {
+                    WriteCommand::Create { path, spec } => {
+                        let writer = WavWriter::create(&path, spec);
+                        current = Some((path, writer));
+                    }
+                    WriteCommand::Data(chunk) => {
+                        if let Some((_, Ok(writer))) = &mut current {
+                            if let Err(error) = writer.write(&chunk.channels, chunk.frames) {
+                                current.as_mut().unwrap().1 = Err(error);
+                            }
+                        }
+                        // The reader may be waiting for it
+                        let _ = free.send(chunk);
+                    }
+                    WriteCommand::Finish => {
+                        let result = match current.take() {
+                            Some((path, Ok(writer))) => writer.finish().inspect_err(|_| {
+                                let _ = std::fs::remove_file(&path);
+                            }),
+                            Some((path, Err(error))) => {
+                                let _ = std::fs::remove_file(&path);
+                                Err(error)
+                            }
+                            None => Err(io::Error::other("no output file open")),
+                        };
+                        let _ = results.send(result);
+                    }
+                    WriteCommand::Abort => {
+                        if let Some((path, writer)) = current.take() {
+                            drop(writer);
+                            let _ = std::fs::remove_file(&path);
+                        }
+                    }
+                }
+            }
+        })
+        .expect("failed to spawn batch writer thread")
+}
+
+// =============================================================================
+// Pipeline
+// =============================================================================
+
+/// The I/O threads and channels of one worker.
+pub(crate) struct Pipeline {
+    requests: Option<Sender<PathBuf>>,
+    pub(crate) events: Receiver<ReadEvent>,
+    writes: Option<Sender<WriteCommand>>,
+    pub(crate) results: Receiver<io::Result<u64>>,
+    /// Returns chunks the worker doesn't pass to the writer
+    free: Option<Sender<Chunk>>,
+    threads: Vec<JoinHandle<()>>,
+}
+
+impl Pipeline {
+    /// Start the reader and writer of worker `index` with `chunks` chunks
+    /// of `chunk_frames` frames.
+    pub(crate) fn new(index: usize, chunks: usize, chunk_frames: usize) -> Self {
+        let (request_tx, request_rx) = channel();
+        let (event_tx, event_rx) = channel();
+        let (write_tx, write_rx) = channel();
+        let (result_tx, result_rx) = channel();
+        let (free_tx, free_rx) = channel();
+        for _ in 0..chunks.max(1) {
+            free_tx.send(Chunk::new(chunk_frames)).unwrap();
+        }
+        let threads = vec![
+            spawn_reader(format!("batch reader {index}"), request_rx, free_rx, event_tx),
+            spawn_writer(format!("batch writer {index}"), write_rx, free_tx.clone(), result_tx),
+        ];
+        Self {
+            requests: Some(request_tx),
+            events: event_rx,
+            writes: Some(write_tx),
+            results: result_rx,
+            free: Some(free_tx),
+            threads,
+        }
+    }
+
+    /// Queue a file for reading; its events follow those of earlier requests.
+    pub(crate) fn request(&self, path: PathBuf) {
+        let _ = self.requests.as_ref().unwrap().send(path);
+    }
+
+    /// Send a command to the writer.
+    pub(crate) fn write(&self, command: WriteCommand) {
+        let _ = self.writes.as_ref().unwrap().send(command);
+    }
+
+    /// Hand a chunk back to the reader without writing it.
+    pub(crate) fn recycle(&self, chunk: Chunk) {
+        let _ = self.free.as_ref().unwrap().send(chunk);
+    }
+
+    /// Skip the rest of the current file's read events.
+    pub(crate) fn skip_file(&self) {
+        while let Ok(event) = self.events.recv() {
+            match event {
+                ReadEvent::Data(chunk) => self.recycle(chunk),
+                ReadEvent::End | ReadEvent::Failed(_) => return,
+                ReadEvent::Open(_) => {}
+            }
+        }
+    }
+}
+
+impl Drop for Pipeline {
+    fn drop(&mut self) {
+        // Closing the channels ends both threads, even mid-file (after a
+        // panic): the writer exits first and drops its free-chunk sender,
+        // so a reader waiting for a chunk wakes up
+        self.requests = None;
+        self.writes = None;
+        self.free = None;
+        for thread in self.threads.drain(..).rev() {
+            let _ = thread.join();
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::wav::SampleFormat;
+
+    #[test]
+    fn test_chunks_sized_by_file_channels() {
+        let path = std::env::temp_dir().join(format!("beamer-batch-pipeline-{}.wav", std::process::id()));
+        let spec = WavSpec { channels: 2, sample_rate: 48_000, format: SampleFormat::Float32 };
+        let mut writer = WavWriter::create(&path, spec).unwrap();
+        writer.write(&[vec![0.25; 100], vec![-0.25; 100]], 100).unwrap();
+        writer.finish().unwrap();
+
+        let pipeline = Pipeline::new(0, 2, 64);
+        pipeline.request(path.clone());
+        assert!(matches!(pipeline.events.recv().unwrap(), ReadEvent::Open(s) if s == spec));
+        let ReadEvent::Data(mut chunk) = pipeline.events.recv().unwrap() else { panic!("expected data") };
+        assert_eq!((chunk.channels.len(), chunk.frames), (2, 64));
+        assert!(chunk.channels.iter().all(|c| c.len() == 64));
+        assert_eq!((chunk.channels[0][0], chunk.channels[1][63]), (0.25, -0.25));
+
+        // A wider chain grows the chunk, once
+        chunk.ensure_channels(4);
+        chunk.ensure_channels(3);
+        assert_eq!(chunk.channels.len(), 4);
+        pipeline.recycle(chunk);
+        pipeline.skip_file();
+        std::fs::remove_file(&path).unwrap();
+    }
+}
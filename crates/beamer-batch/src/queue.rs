@@ -0,0 +1,53 @@
+//! Work-stealing job queue.
+
+use std::collections::VecDeque;
+use std::sync::Mutex;
+
+/// One deque of job indices per worker.
+///
+/// A worker takes from the front of its own deque and, when that is empty,
+/// steals from the back of the others. Jobs are dealt round-robin, so with
+/// the largest files first every worker starts on a large file and the
+/// small ones at the end fill the gaps.
+pub(crate) struct JobQueue {
+    deques: Vec<Mutex<VecDeque<usize>>>,
+}
+
+impl JobQueue {
+    /// Deal `jobs` (in priority order) to `workers` deques.
+    pub(crate) fn new(jobs: impl IntoIterator<Item = usize>, workers: usize) -> Self {
+        let mut deques: Vec<VecDeque<usize>> = (0..workers).map(|_| VecDeque::new()).collect();
+        for (i, job) in jobs.into_iter().enumerate() {
+            deques[i % workers].push_back(job);
+        }
+        Self {
+            deques: deques.into_iter().map(Mutex::new).collect(),
+        }
+    }
+
+    /// Next job for `worker`: its own first, then stolen.
+    pub(crate) fn pop(&self, worker: usize) -> Option<usize> {
+        if let Some(job) = self.deques[worker].lock().unwrap().pop_front() {
+            return Some(job);
+        }
+        let count = self.deques.len();
+        (1..count).find_map(|i| self.deques[(worker + i) % count].lock().unwrap().pop_back())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_own_first_then_steal() {
+        let queue = JobQueue::new(0..5, 2);
+        // Worker 0: 0, 2, 4; worker 1: 1, 3
+        assert_eq!(queue.pop(1), Some(1));
+        assert_eq!(queue.pop(1), Some(3));
+        assert_eq!(queue.pop(1), Some(4)); // stolen from the back
+        assert_eq!(queue.pop(0), Some(0));
+        assert_eq!(queue.pop(0), Some(2));
+        assert_eq!((queue.pop(0), queue.pop(1)), (None, None));
+    }
+}
@@ -0,0 +1,590 @@
+//! Batch renderer: jobs, options, workers and the aggregate report.
+
+use std::collections::{HashMap, VecDeque};
+use std::fmt;
+use std::io;
+use std::path::PathBuf;
+use std::sync::mpsc::{channel, Sender};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use beamer_core::trace::{self, category};
+use beamer_core::{ParameterId, Plugin};
+
+use crate::chain::{stage_factory, Chain, RenderConfig, StageFactory};
+use crate::pipeline::{Pipeline, ReadEvent, WriteCommand};
+use crate::queue::JobQueue;
+use crate::wav::{SampleFormat, WavSpec};
+
+// =============================================================================
+// Options
+// =============================================================================
+
+/// Worker count, block size and I/O buffering of a [`BatchRenderer`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct BatchOptions {
+    /// Render threads (0 = one per available core).
+    pub workers: usize,
+    /// Frames per `process()` call.
+    pub block_size: usize,
+    /// Frames per file read/write.
+    pub chunk_frames: usize,
+    /// Chunks each worker's reader may fill ahead of rendering.
+    pub read_ahead: usize,
+    /// Rendered chunks each worker's writer may queue.
+    pub write_behind: usize,
+    /// Output encoding (`None` = same as the input file).
+    pub output_format: Option<SampleFormat>,
+}
+
+impl BatchOptions {
+    /// Defaults: one worker per core, 512-frame blocks, 64k-frame chunks,
+    /// 4 chunks of read-ahead and of write-behind, input encoding.
+    pub const fn new() -> Self {
+        Self {
+            workers: 0,
+            block_size: 512,
+            chunk_frames: 65_536,
+            read_ahead: 4,
+            write_behind: 4,
+            output_format: None,
+        }
+    }
+
+    /// Set the number of render threads (0 = one per available core).
+    pub const fn with_workers(mut self, workers: usize) -> Self {
+        self.workers = workers;
+        self
+    }
+
+    /// Set the frames per `process()` call.
+    pub const fn with_block_size(mut self, block_size: usize) -> Self {
+        self.block_size = block_size;
+        self
+    }
+
+    /// Set the frames per file read/write.
+    pub const fn with_chunk_frames(mut self, chunk_frames: usize) -> Self {
+        self.chunk_frames = chunk_frames;
+        self
+    }
+
+    /// Set the chunks of read-ahead and write-behind per worker.
+    pub const fn with_buffering(mut self, read_ahead: usize, write_behind: usize) -> Self {
+        self.read_ahead = read_ahead;
+        self.write_behind = write_behind;
+        self
+    }
+
+    /// Write every output with this encoding.
+    pub const fn with_output_format(mut self, format: SampleFormat) -> Self {
+        self.output_format = Some(format);
+        self
+    }
+
+    fn worker_count(&self, jobs: usize) -> usize {
+        let workers = match self.workers {
+            0 => thread::available_parallelism().map_or(1, |n| n.get()),
+            n => n,
+        };
+        workers.min(jobs).max(1)
+    }
+}
+
+impl Default for BatchOptions {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// =============================================================================
+// Jobs
+// =============================================================================
+
+/// One input file rendered to one output file.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Job {
+    /// WAV file to read.
+    pub input: PathBuf,
+    /// WAV file to write (created or truncated).
+    pub output: PathBuf,
+    /// `(stage, parameter, normalized value)` set before rendering.
+    ///
+    /// Every other parameter starts at its default.
+    pub parameters: Vec<(usize, ParameterId, f64)>,
+}
+
+impl Job {
+    /// Render `input` to `output` with default parameters.
+    pub fn new(input: impl Into<PathBuf>, output: impl Into<PathBuf>) -> Self {
+        Self {
+            input: input.into(),
+            output: output.into(),
+            parameters: Vec::new(),
+        }
+    }
+
+    /// Set a parameter of chain stage `stage` for this file.
+    pub fn with_parameter(mut self, stage: usize, id: ParameterId, normalized: f64) -> Self {
+        self.parameters.push((stage, id, normalized));
+        self
+    }
+}
+
+// =============================================================================
+// Report
+// =============================================================================
+
+/// A rendered file.
+#[derive(Debug, Clone, PartialEq)]
+pub struct FileReport {
+    /// Index of the job.
+    pub job: usize,
+    /// Frames rendered.
+    pub frames: u64,
+    /// Sample rate of the file.
+    pub sample_rate: u32,
+    /// Time spent in the plugin chain (excludes I/O waits).
+    pub render_time: Duration,
+    /// Worker that rendered the file.
+    pub worker: usize,
+}
+
+impl FileReport {
+    /// Audio duration of the file.
+    pub fn audio_duration(&self) -> Duration {
+        Duration::from_secs_f64(self.frames as f64 / self.sample_rate.max(1) as f64)
+    }
+}
+
+/// A file that could not be rendered.
+#[derive(Debug)]
+pub struct BatchFailure {
+    /// Index of the job.
+    pub job: usize,
+    /// What went wrong (reading, writing or an unknown parameter).
+    pub error: io::Error,
+}
+
+/// Outcome of [`BatchRenderer::render()`].
+#[derive(Debug)]
+pub struct BatchReport {
+    /// Rendered files, in job order.
+    pub files: Vec<FileReport>,
+    /// Failed files, in job order.
+    pub failures: Vec<BatchFailure>,
+    /// Wall-clock time of the whole batch.
+    pub elapsed: Duration,
+    /// Render threads used.
+    pub workers: usize,
+}
+
+impl BatchReport {
+    /// Total frames rendered.
+    pub fn frames(&self) -> u64 {
+        self.files.iter().map(|f| f.frames).sum()
+    }
+
+    /// Total audio rendered.
+    pub fn audio_duration(&self) -> Duration {
+        self.files.iter().map(FileReport::audio_duration).sum()
+    }
+
+    /// Audio time rendered per wall-clock time, over all workers.
+    pub fn realtime_factor(&self) -> f64 {
+        self.audio_duration().as_secs_f64() / self.elapsed.as_secs_f64().max(1e-9)
+    }
+
+    /// Frames rendered per wall-clock second.
+    pub fn frames_per_second(&self) -> f64 {
+        self.frames() as f64 / self.elapsed.as_secs_f64().max(1e-9)
+    }
+
+    /// Share of worker time spent rendering rather than waiting for I/O.
+    pub fn render_utilization(&self) -> f64 {
+        let render: Duration = self.files.iter().map(|f| f.render_time).sum();
+        render.as_secs_f64() / (self.elapsed.as_secs_f64() * self.workers as f64).max(1e-9)
+    }
+}
+
+impl fmt::Display for BatchReport {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        writeln!(
+            f,
+            "{} files ({} failed) on {} workers in {:.2} s",
+            self.files.len() + self.failures.len(),
+            self.failures.len(),
+            self.workers,
+            self.elapsed.as_secs_f64()
+        )?;
+        writeln!(
+            f,
+            "{:.1} s of audio, {:.1}x realtime, {:.0} frames/s, {:.0}% rendering",
+            self.audio_duration().as_secs_f64(),
+            self.realtime_factor(),
+            self.frames_per_second(),
+            self.render_utilization() * 100.0
+        )
+    }
+}
+
+// =============================================================================
+// Renderer
+// =============================================================================
+
+/// Renders WAV files through a chain of plugins on all cores.
+///
+/// Each worker thread keeps one prepared chain per sample rate and reuses
+/// it for every file at that rate (reset between files). Files are dealt
+/// largest first and workers steal from each other when they run dry.
+pub struct BatchRenderer {
+    options: BatchOptions,
+    stages: Vec<StageFactory>,
+}
+
+impl BatchRenderer {
+    /// Create a renderer with an empty chain.
+    pub fn new(options: BatchOptions) -> Self {
+        Self {
+            options,
+            stages: Vec::new(),
+        }
+    }
+
+    /// Append `P::default()` to the chain.
+    pub fn stage<P: Plugin>(self) -> Self
+    where
+        P::Config: RenderConfig,
+    {
+        self.stage_with(P::default)
+    }
+
+    /// Append a plugin created by `make` (called once per worker and sample rate).
+    pub fn stage_with<P: Plugin>(mut self, make: impl Fn() -> P + Send + Sync + 'static) -> Self
+    where
+        P::Config: RenderConfig,
+    {
+        self.stages.push(stage_factory(make));
+        self
+    }
+
+    /// Number of chain stages.
+    pub fn stage_count(&self) -> usize {
+        self.stages.len()
+    }
+
+    /// Render every job and wait for the last file to be written.
+    ///
+    /// # Panics
+    ///
+    /// If the chain is empty, or if a plugin panics.
+    pub fn render(&self, jobs: &[Job]) -> BatchReport {
+        assert!(!self.stages.is_empty(), "batch chain has no stages");
+        let start = Instant::now();
+
+        // Largest files first, so the last ones to finish are short
+        let mut order: Vec<(u64, usize)> = jobs
+            .iter()
+            .enumerate()
+            .map(|(i, job)| (std::fs::metadata(&job.input).map_or(0, |m| m.len()), i))
+            .collect();
+        order.sort_by(|a, b| b.0.cmp(&a.0).then(a.1.cmp(&b.1)));
+
+        let workers = self.options.worker_count(jobs.len());
+        let queue = JobQueue::new(order.into_iter().map(|(_, i)| i), workers);
+        let (outcome_tx, outcome_rx) = channel();
+
+        thread::scope(|scope| {
+            for worker in 0..workers {
+                let outcomes = outcome_tx.clone();
+                let queue = &queue;
+                thread::Builder::new()
+                    .name(format!("batch worker {worker}"))
+                    .spawn_scoped(scope, move || self.run_worker(worker, jobs, queue, outcomes))
+                    .expect("failed to spawn batch worker thread");
+            }
+        });
+        drop(outcome_tx);
+
+        let mut files = Vec::new();
+        let mut failures = Vec::new();
+        for outcome in outcome_rx {
+            match outcome {
+                Ok(file) => files.push(file),
+                Err(failure) => failures.push(failure),
+            }
+        }
+        files.sort_by_key(|f: &FileReport| f.job);
+        failures.sort_by_key(|f: &BatchFailure| f.job);
+
+        BatchReport {
+            files,
+            failures,
+            elapsed: start.elapsed(),
+            workers,
+        }
+    }
+
+    /// Render jobs from `queue` until it is empty.
+    fn run_worker(
+        &self,
+        worker: usize,
+        jobs: &[Job],
+        queue: &JobQueue,
+        outcomes: Sender<Result<FileReport, BatchFailure>>,
+    ) {
+        trace::name_current_thread(&format!("batch worker {worker}"));
+        let options = &self.options;
+        let block_size = options.block_size.max(1);
+        // At least a block per chunk, in whole blocks
+        let chunk_frames = options.chunk_frames.max(block_size).div_ceil(block_size) * block_size;
+        let pipeline = Pipeline::new(worker, options.read_ahead + options.write_behind + 1, chunk_frames);
+        let mut chains: HashMap<u32, Chain> = HashMap::new();
+        // Files handed to the writer, waiting for its result (in order)
+        let mut writing: VecDeque<FileReport> = VecDeque::new();
+        let finish = |report: FileReport, result: io::Result<u64>| {
+            let job = report.job;
+            let _ = outcomes.send(
+                result
+                    .map(|frames| FileReport { frames, ..report })
+                    .map_err(|error| BatchFailure { job, error }),
+            );
+        };
+
+        let mut current = queue.pop(worker);
+        if let Some(job) = current {
+            pipeline.request(jobs[job].input.clone());
+        }
+        while let Some(job) = current {
+            // Read-ahead continues into the next file while this one renders
+            let next = queue.pop(worker);
+            if let Some(next) = next {
+                pipeline.request(jobs[next].input.clone());
+            }
+
+            match self.render_file(worker, job, &jobs[job], &pipeline, &mut chains, block_size) {
+                Ok(report) => writing.push_back(report),
+                Err(error) => {
+                    let _ = outcomes.send(Err(BatchFailure { job, error }));
+                }
+            }
+            while let Ok(result) = pipeline.results.try_recv() {
+                finish(writing.pop_front().unwrap(), result);
+            }
+            current = next;
+        }
+
+        for report in writing {
+            let result = pipeline.results.recv().unwrap_or_else(|_| Err(io::Error::other("batch writer stopped")));
+            finish(report, result);
+        }
+    }
+
+    /// Render one file whose read events are next in the pipeline and hand
+    /// it to the writer. The report's frame count is filled in from the
+    /// writer's result.
+    fn render_file(
+        &self,
+        worker: usize,
+        index: usize,
+        job: &Job,
+        pipeline: &Pipeline,
+        chains: &mut HashMap<u32, Chain>,
+        block_size: usize,
+    ) -> io::Result<FileReport> {
+        let closed = || io::Error::other("batch reader stopped");
+        let spec = match pipeline.events.recv().map_err(|_| closed())? {
+            ReadEvent::Open(spec) => spec,
+            ReadEvent::Failed(error) => return Err(error),
+            ReadEvent::Data(_) | ReadEvent::End => unreachable!("read events out of order"),
+        };
+
+        let chain = chains
+            .entry(spec.sample_rate)
+            .or_insert_with(|| Chain::new(&self.stages, spec.sample_rate as f64, block_size));
+        let unknown = chain.start_file(&job.parameters);
+        if unknown > 0 {
+            pipeline.skip_file();
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                format!("{unknown} parameter(s) not found in the chain"),
+            ));
+        }
+
+        let output_spec = WavSpec {
+            channels: chain.output_channels() as u16,
+            sample_rate: spec.sample_rate,
+            format: self.options.output_format.unwrap_or(spec.format),
+        };
+        pipeline.write(WriteCommand::Create {
+            path: job.output.clone(),
+            spec: output_spec,
+        });
+
+        let mut render_time = Duration::ZERO;
+        let mut position = 0i64;
+        loop {
+            match pipeline.events.recv().map_err(|_| closed()) {
+                Ok(ReadEvent::Data(mut chunk)) => {
+                    let _span = trace::span_in(category::WORKER, "render chunk");
+                    chunk.ensure_channels(chain.output_channels());
+                    let started = Instant::now();
+                    chain.process(&mut chunk.channels, spec.channels as usize, chunk.frames, position);
+                    render_time += started.elapsed();
+                    position += chunk.frames as i64;
+                    pipeline.write(WriteCommand::Data(chunk));
+                }
+                Ok(ReadEvent::End) => break,
+                Ok(ReadEvent::Failed(error)) | Err(error) => {
+                    pipeline.write(WriteCommand::Abort);
+                    return Err(error);
+                }
+                Ok(ReadEvent::Open(_)) => unreachable!("read events out of order"),
+            }
+        }
+
+        pipeline.write(WriteCommand::Finish);
+        Ok(FileReport {
+            job: index,
+            frames: position as u64,
+            sample_rate: spec.sample_rate,
+            render_time,
+            worker,
+        })
+    }
+}
+
+impl fmt::Debug for BatchRenderer {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("BatchRenderer")
+            .field("options", &self.options)
+            .field("stages", &self.stages.len())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::wav::{WavReader, WavWriter};
+    use beamer_core::{
+        AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, HasParameters, NoParameters, ProcessContext,
+    };
+
+    #[derive(Default)]
+    struct HalfPlugin {
+        parameters: NoParameters,
+    }
+
+    struct HalfProcessor {
+        parameters: NoParameters,
+    }
+
+    impl HasParameters for HalfPlugin {
+        type Parameters = NoParameters;
+        fn parameters(&self) -> &NoParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut NoParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl HasParameters for HalfProcessor {
+        type Parameters = NoParameters;
+        fn parameters(&self) -> &NoParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut NoParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl Plugin for HalfPlugin {
+        type Config = AudioSetup;
+        type Processor = HalfProcessor;
+        fn prepare(self, _config: AudioSetup) -> HalfProcessor {
+            HalfProcessor {
+                parameters: self.parameters,
+            }
+        }
+    }
+
+    impl AudioProcessor for HalfProcessor {
+        type Plugin = HalfPlugin;
+
+        fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, _context: &ProcessContext) {
+            for (input, output) in buffer.zip_channels() {
+                for (i, o) in input.iter().zip(output.iter_mut()) {
+                    *o = i * 0.5;
+                }
+            }
+        }
+
+        fn unprepare(self) -> HalfPlugin {
+            HalfPlugin {
+                parameters: self.parameters,
+            }
+        }
+    }
+
+    fn write_dc(path: &std::path::Path, spec: WavSpec, frames: usize) {
+        let mut writer = WavWriter::create(path, spec).unwrap();
+        writer.write(&vec![vec![0.5; frames]; spec.channels as usize], frames).unwrap();
+        writer.finish().unwrap();
+    }
+
+    fn read_all(path: &std::path::Path) -> (WavSpec, Vec<Vec<f32>>) {
+        let mut reader = WavReader::open(path).unwrap();
+        let spec = reader.spec();
+        let frames = reader.frames() as usize;
+        let mut channels = vec![vec![0.0; frames]; spec.channels as usize];
+        reader.read(&mut channels, frames).unwrap();
+        (spec, channels)
+    }
+
+    #[test]
+    fn test_render_chain_over_files() {
+        let dir = std::env::temp_dir().join(format!("beamer-batch-render-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let stereo = WavSpec { channels: 2, sample_rate: 48_000, format: SampleFormat::Float32 };
+        let mono = WavSpec { channels: 1, sample_rate: 44_100, format: SampleFormat::Int16 };
+        write_dc(&dir.join("long.wav"), stereo, 10_000);
+        write_dc(&dir.join("short.wav"), stereo, 700);
+        write_dc(&dir.join("mono.wav"), mono, 3_000);
+
+        let jobs = vec![
+            Job::new(dir.join("short.wav"), dir.join("short-out.wav")),
+            Job::new(dir.join("missing.wav"), dir.join("missing-out.wav")),
+            Job::new(dir.join("long.wav"), dir.join("long-out.wav")),
+            Job::new(dir.join("mono.wav"), dir.join("mono-out.wav")),
+            Job::new(dir.join("long.wav"), dir.join("unknown-out.wav")).with_parameter(1, 42, 0.5),
+        ];
+        let options = BatchOptions::new()
+            .with_workers(2)
+            .with_block_size(256)
+            .with_chunk_frames(1_000)
+            .with_buffering(1, 1);
+        let report = BatchRenderer::new(options).stage::<HalfPlugin>().stage::<HalfPlugin>().render(&jobs);
+
+        assert_eq!(report.workers, 2);
+        assert_eq!(report.files.iter().map(|f| f.job).collect::<Vec<_>>(), vec![0, 2, 3]);
+        assert_eq!(report.failures.iter().map(|f| f.job).collect::<Vec<_>>(), vec![1, 4]);
+        assert_eq!(report.failures[1].error.kind(), io::ErrorKind::InvalidInput);
+        assert_eq!(report.frames(), 13_700);
+        assert!(!dir.join("unknown-out.wav").exists());
+
+        // Two halvings; chunk and block boundaries leave no gaps
+        let (spec, channels) = read_all(&dir.join("long-out.wav"));
+        assert_eq!(spec, stereo);
+        assert!(channels.iter().all(|c| c.len() == 10_000 && c.iter().all(|&s| s == 0.125)));
+
+        // Mono input feeds both channels of the stereo chain, at its own rate
+        let (spec, channels) = read_all(&dir.join("mono-out.wav"));
+        assert_eq!((spec.channels, spec.sample_rate, spec.format), (2, 44_100, SampleFormat::Int16));
+        assert!(channels.iter().all(|c| c.iter().all(|&s| (s - 0.125).abs() < 1e-4)));
+
+        assert!(report.to_string().contains("5 files (2 failed) on 2 workers"));
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+}
@@ -0,0 +1,379 @@
+//! Streaming WAV reader and writer.
+//!
+//! Only what batch rendering needs: RIFF/WAVE files with 16/24/32-bit
+//! integer PCM or 32/64-bit float samples (plain or `WAVE_FORMAT_EXTENSIBLE`
+//! headers), read and written in planar `f32` chunks through reused
+//! buffers. Files larger than 4 GiB (RF64) are not supported.
+
+use std::fs::File;
+use std::io::{self, BufReader, BufWriter, Read, Seek, SeekFrom, Write};
+use std::path::Path;
+
+/// `WAVE_FORMAT_PCM`
+const FORMAT_PCM: u16 = 1;
+/// `WAVE_FORMAT_IEEE_FLOAT`
+const FORMAT_FLOAT: u16 = 3;
+/// `WAVE_FORMAT_EXTENSIBLE` (sub-format in the extension)
+const FORMAT_EXTENSIBLE: u16 = 0xFFFE;
+
+/// I/O buffer size of readers and writers.
+const IO_BUFFER_SIZE: usize = 256 * 1024;
+
+// =============================================================================
+// Format
+// =============================================================================
+
+/// Sample encoding of a WAV file.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum SampleFormat {
+    /// 16-bit signed integer PCM.
+    Int16,
+    /// 24-bit signed integer PCM.
+    Int24,
+    /// 32-bit signed integer PCM.
+    Int32,
+    /// 32-bit IEEE float.
+    Float32,
+    /// 64-bit IEEE float.
+    Float64,
+}
+
+impl SampleFormat {
+    /// Bytes per sample.
+    pub const fn bytes(self) -> usize {
+        match self {
+            SampleFormat::Int16 => 2,
+            SampleFormat::Int24 => 3,
+            SampleFormat::Int32 | SampleFormat::Float32 => 4,
+            SampleFormat::Float64 => 8,
+        }
+    }
+
+    fn from_header(tag: u16, bits: u16) -> Option<Self> {
+        match (tag, bits) {
+            (FORMAT_PCM, 16) => Some(SampleFormat::Int16),
+            (FORMAT_PCM, 24) => Some(SampleFormat::Int24),
+            (FORMAT_PCM, 32) => Some(SampleFormat::Int32),
+            (FORMAT_FLOAT, 32) => Some(SampleFormat::Float32),
+            (FORMAT_FLOAT, 64) => Some(SampleFormat::Float64),
+            _ => None,
+        }
+    }
+
+    fn tag(self) -> u16 {
+        match self {
+            SampleFormat::Float32 | SampleFormat::Float64 => FORMAT_FLOAT,
+            _ => FORMAT_PCM,
+        }
+    }
+
+    /// Decode one sample to f32.
+    #[inline]
+    fn decode(self, bytes: &[u8]) -> f32 {
+        match self {
+            SampleFormat::Int16 => i16::from_le_bytes([bytes[0], bytes[1]]) as f32 / 32_768.0,
+            SampleFormat::Int24 => {
+                (i32::from_le_bytes([0, bytes[0], bytes[1], bytes[2]]) >> 8) as f32 / 8_388_608.0
+            }
+            SampleFormat::Int32 => {
+                i32::from_le_bytes([bytes[0], bytes[1], bytes[2], bytes[3]]) as f32 / 2_147_483_648.0
+            }
+            SampleFormat::Float32 => f32::from_le_bytes([bytes[0], bytes[1], bytes[2], bytes[3]]),
+            SampleFormat::Float64 => f64::from_le_bytes(bytes[..8].try_into().unwrap()) as f32,
+        }
+    }
+
+    /// Encode one f32 sample (integers clamp).
+    #[inline]
+    fn encode(self, sample: f32, out: &mut [u8]) {
+        match self {
+            SampleFormat::Int16 => {
+                let value = (sample * 32_768.0).round().clamp(-32_768.0, 32_767.0) as i16;
+                out.copy_from_slice(&value.to_le_bytes());
+            }
+            SampleFormat::Int24 => {
+                let value = (sample * 8_388_608.0).round().clamp(-8_388_608.0, 8_388_607.0) as i32;
+                out.copy_from_slice(&value.to_le_bytes()[..3]);
+            }
+            SampleFormat::Int32 => {
+                let value = (sample as f64 * 2_147_483_648.0).round().clamp(-2_147_483_648.0, 2_147_483_647.0) as i32;
+                out.copy_from_slice(&value.to_le_bytes());
+            }
+            SampleFormat::Float32 => out.copy_from_slice(&sample.to_le_bytes()),
+            SampleFormat::Float64 => out.copy_from_slice(&(sample as f64).to_le_bytes()),
+        }
+    }
+}
+
+/// Channel count, sample rate and encoding of a WAV file.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct WavSpec {
+    /// Interleaved channels.
+    pub channels: u16,
+    /// Frames per second.
+    pub sample_rate: u32,
+    /// Sample encoding.
+    pub format: SampleFormat,
+}
+
+impl WavSpec {
+    /// Bytes per interleaved frame.
+    #[inline]
+    pub const fn frame_bytes(&self) -> usize {
+        self.channels as usize * self.format.bytes()
+    }
+}
+
+fn invalid(message: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message.to_string())
+}
+
+// =============================================================================
+// Reader
+// =============================================================================
+
+/// Reads a WAV file chunk by chunk into planar f32 buffers.
+pub struct WavReader {
+    file: BufReader<File>,
+    spec: WavSpec,
+    frames: u64,
+    position: u64,
+    /// Interleaved bytes of one chunk, reused
+    scratch: Vec<u8>,
+}
+
+impl WavReader {
+    /// Open a file and parse its header.
+    pub fn open(path: impl AsRef<Path>) -> io::Result<Self> {
+        let mut file = BufReader::with_capacity(IO_BUFFER_SIZE, File::open(path)?);
+
+        let mut riff = [0u8; 12];
+        file.read_exact(&mut riff)?;
+        if &riff[0..4] != b"RIFF" || &riff[8..12] != b"WAVE" {
+            return Err(invalid("not a RIFF/WAVE file"));
+        }
+
+        let mut spec = None;
+        loop {
+            let mut header = [0u8; 8];
+            file.read_exact(&mut header)?;
+            let size = u32::from_le_bytes(header[4..8].try_into().unwrap()) as u64;
+            match &header[0..4] {
+                b"fmt " => {
+                    let mut fmt = vec![0u8; size as usize];
+                    file.read_exact(&mut fmt)?;
+                    if fmt.len() < 16 {
+                        return Err(invalid("short fmt chunk"));
+                    }
+                    let mut tag = u16::from_le_bytes([fmt[0], fmt[1]]);
+                    if tag == FORMAT_EXTENSIBLE && fmt.len() >= 26 {
+                        // First two bytes of the sub-format GUID are the format tag
+                        tag = u16::from_le_bytes([fmt[24], fmt[25]]);
+                    }
+                    let channels = u16::from_le_bytes([fmt[2], fmt[3]]);
+                    let sample_rate = u32::from_le_bytes(fmt[4..8].try_into().unwrap());
+                    let bits = u16::from_le_bytes([fmt[14], fmt[15]]);
+                    let format = SampleFormat::from_header(tag, bits)
+                        .ok_or_else(|| invalid("unsupported sample format"))?;
+                    if channels == 0 {
+                        return Err(invalid("zero channels"));
+                    }
+                    spec = Some(WavSpec { channels, sample_rate, format });
+                    if size % 2 == 1 {
+                        file.seek_relative(1)?;
+                    }
+                }
+                b"data" => {
+                    let spec = spec.ok_or_else(|| invalid("data chunk before fmt chunk"))?;
+                    return Ok(Self {
+                        file,
+                        spec,
+                        frames: size / spec.frame_bytes() as u64,
+                        position: 0,
+                        scratch: Vec::new(),
+                    });
+                }
+                _ => file.seek_relative((size + size % 2) as i64)?,
+            }
+        }
+    }
+
+    /// Format of the file.
+    #[inline]
+    pub fn spec(&self) -> WavSpec {
+        self.spec
+    }
+
+    /// Total frames in the file.
+    #[inline]
+    pub fn frames(&self) -> u64 {
+        self.frames
+    }
+
+    /// Frames not read yet.
+    #[inline]
+    pub fn remaining(&self) -> u64 {
+        self.frames - self.position
+    }
+
+    /// Read up to `max_frames` frames, one slice per file channel.
+    ///
+    /// Each slice must hold at least `max_frames` samples. Returns the
+    /// frames read, 0 at the end of the file.
+    pub fn read(&mut self, channels: &mut [Vec<f32>], max_frames: usize) -> io::Result<usize> {
+        let frames = (max_frames as u64).min(self.remaining()) as usize;
+        let frame_bytes = self.spec.frame_bytes();
+        let sample_bytes = self.spec.format.bytes();
+        self.scratch.resize(frames * frame_bytes, 0);
+        self.file.read_exact(&mut self.scratch)?;
+
+        for (channel, out) in channels.iter_mut().take(self.spec.channels as usize).enumerate() {
+            let offset = channel * sample_bytes;
+            for (sample, frame) in out[..frames].iter_mut().zip(self.scratch.chunks_exact(frame_bytes)) {
+                *sample = self.spec.format.decode(&frame[offset..offset + sample_bytes]);
+            }
+        }
+        self.position += frames as u64;
+        Ok(frames)
+    }
+}
+
+// =============================================================================
+// Writer
+// =============================================================================
+
+/// Writes planar f32 chunks to a WAV file.
+///
+/// Call [`finish()`](Self::finish) to write the final sizes into the header.
+pub struct WavWriter {
+    file: BufWriter<File>,
+    spec: WavSpec,
+    frames: u64,
+    /// Interleaved bytes of one chunk, reused
+    scratch: Vec<u8>,
+}
+
+impl WavWriter {
+    /// Create (or truncate) a file and write a header for `spec`.
+    pub fn create(path: impl AsRef<Path>, spec: WavSpec) -> io::Result<Self> {
+        let mut file = BufWriter::with_capacity(IO_BUFFER_SIZE, File::create(path)?);
+        let block_align = spec.frame_bytes() as u16;
+        let mut header = Vec::with_capacity(44);
+        header.extend_from_slice(b"RIFF");
+        header.extend_from_slice(&0u32.to_le_bytes());
+        header.extend_from_slice(b"WAVEfmt ");
+        header.extend_from_slice(&16u32.to_le_bytes());
+        header.extend_from_slice(&spec.format.tag().to_le_bytes());
+        header.extend_from_slice(&spec.channels.to_le_bytes());
+        header.extend_from_slice(&spec.sample_rate.to_le_bytes());
+        header.extend_from_slice(&(spec.sample_rate * block_align as u32).to_le_bytes());
+        header.extend_from_slice(&block_align.to_le_bytes());
+        header.extend_from_slice(&(spec.format.bytes() as u16 * 8).to_le_bytes());
+        header.extend_from_slice(b"data");
+        header.extend_from_slice(&0u32.to_le_bytes());
+        file.write_all(&header)?;
+        Ok(Self {
+            file,
+            spec,
+            frames: 0,
+            scratch: Vec::new(),
+        })
+    }
+
+    /// Format being written.
+    #[inline]
+    pub fn spec(&self) -> WavSpec {
+        self.spec
+    }
+
+    /// Write `frames` frames, one slice per file channel.
+    pub fn write(&mut self, channels: &[Vec<f32>], frames: usize) -> io::Result<()> {
+        let frame_bytes = self.spec.frame_bytes();
+        let sample_bytes = self.spec.format.bytes();
+        if (self.frames + frames as u64) * frame_bytes as u64 > u32::MAX as u64 - 36 {
+            return Err(io::Error::new(io::ErrorKind::Unsupported, "WAV output larger than 4 GiB"));
+        }
+        self.scratch.resize(frames * frame_bytes, 0);
+
+        for (channel, input) in channels.iter().take(self.spec.channels as usize).enumerate() {
+            let offset = channel * sample_bytes;
+            for (frame, &sample) in self.scratch.chunks_exact_mut(frame_bytes).zip(&input[..frames]) {
+                self.spec.format.encode(sample, &mut frame[offset..offset + sample_bytes]);
+            }
+        }
+        self.file.write_all(&self.scratch)?;
+        self.frames += frames as u64;
+        Ok(())
+    }
+
+    /// Write the header sizes and flush. Returns the frames written.
+    pub fn finish(mut self) -> io::Result<u64> {
+        let data_bytes = (self.frames * self.spec.frame_bytes() as u64) as u32;
+        if data_bytes % 2 == 1 {
+            self.file.write_all(&[0])?;
+        }
+        let riff_size = 36 + data_bytes + data_bytes % 2;
+        self.file.seek(SeekFrom::Start(4))?;
+        self.file.write_all(&riff_size.to_le_bytes())?;
+        self.file.seek(SeekFrom::Start(40))?;
+        self.file.write_all(&data_bytes.to_le_bytes())?;
+        self.file.flush()?;
+        Ok(self.frames)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_round_trip_formats() {
+        let dir = std::env::temp_dir().join(format!("beamer-batch-wav-{}", std::process::id()));
+        std::fs::create_dir_all(&dir).unwrap();
+        let left: Vec<f32> = (0..1001).map(|i| (i as f32 * 0.01).sin() * 0.9).collect();
+        let right: Vec<f32> = left.iter().map(|s| -s).collect();
+
+        for (format, tolerance) in [
+            (SampleFormat::Int16, 1.0 / 32_768.0),
+            (SampleFormat::Int24, 1.0 / 8_388_608.0),
+            (SampleFormat::Int32, 1e-7),
+            (SampleFormat::Float32, 0.0),
+            (SampleFormat::Float64, 0.0),
+        ] {
+            let path = dir.join(format!("{format:?}.wav"));
+            let spec = WavSpec { channels: 2, sample_rate: 44_100, format };
+            let mut writer = WavWriter::create(&path, spec).unwrap();
+            writer.write(&[left[..600].to_vec(), right[..600].to_vec()], 600).unwrap();
+            writer.write(&[left[600..].to_vec(), right[600..].to_vec()], 401).unwrap();
+            assert_eq!(writer.finish().unwrap(), 1001);
+
+            let mut reader = WavReader::open(&path).unwrap();
+            assert_eq!((reader.spec(), reader.frames()), (spec, 1001));
+            let mut channels = vec![vec![0.0; 512]; 2];
+            let mut read = vec![Vec::new(); 2];
+            loop {
+                let frames = reader.read(&mut channels, 512).unwrap();
+                if frames == 0 {
+                    break;
+                }
+                for (out, channel) in read.iter_mut().zip(&channels) {
+                    out.extend_from_slice(&channel[..frames]);
+                }
+            }
+            for (expected, actual) in [&left, &right].into_iter().zip(&read) {
+                assert_eq!(actual.len(), 1001);
+                let error = expected.iter().zip(actual).map(|(a, b)| (a - b).abs()).fold(0.0, f32::max);
+                assert!(error <= tolerance, "{format:?}: error {error}");
+            }
+        }
+        std::fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_rejects_non_wav() {
+        let path = std::env::temp_dir().join(format!("beamer-batch-bad-{}.wav", std::process::id()));
+        std::fs::write(&path, b"RIFF\0\0\0\0AVI LIST").unwrap();
+        assert_eq!(WavReader::open(&path).err().unwrap().kind(), io::ErrorKind::InvalidData);
+        std::fs::remove_file(&path).unwrap();
+    }
+}
@@ -0,0 +1,136 @@
+//! Buffer operation benchmarks against per-sample scalar loops.
+//!
+//! Run with `cargo bench -p beamer-core --bench buffer_ops`. The scalar
+//! versions are the loops plugins write by hand, with per-sample index
+//! math so LLVM can't vectorize them. Numbers are nanoseconds per sample,
+//! best of several runs.
+
+use std::hint::black_box;
+use std::time::Instant;
+
+use beamer_core::buffer_ops::{
+    matrix_row, mix, mix_add, pan_gains, scale_exp_ramp, scale_linear_ramp, simd_backend,
+    sum_to_mono,
+};
+use beamer_core::{BiquadCoefficients, FrameTiles, TileBiquad};
+
+const BLOCK: usize = 512;
+const ROUNDS: usize = 20_000;
+const RUNS: usize = 5;
+
+/// Time `f` over one block and report ns per sample.
+fn bench(name: &str, f: &mut impl FnMut()) {
+    let mut best = f64::MAX;
+    for _ in 0..RUNS {
+        let start = Instant::now();
+        for _ in 0..ROUNDS {
+            f();
+        }
+        let ns = start.elapsed().as_nanos() as f64 / (ROUNDS * BLOCK) as f64;
+        best = best.min(ns);
+    }
+    println!("{name:<32} {best:>8.3} ns/sample");
+}
+
+fn main() {
+    println!("backend: {}", simd_backend());
+
+    let a: Vec<f32> = (0..BLOCK).map(|i| (i as f32 * 0.01).sin()).collect();
+    let b: Vec<f32> = (0..BLOCK).map(|i| (i as f32 * 0.03).cos()).collect();
+    let c: Vec<f32> = (0..BLOCK).map(|i| (i as f32 * 0.07).sin()).collect();
+    let mut out = vec![0.0f32; BLOCK];
+
+    bench("linear ramp (scalar)", &mut || {
+        let step = 1.0 / BLOCK as f32;
+        for (i, s) in black_box(&mut out).iter_mut().enumerate() {
+            *s *= 0.5 + step * i as f32;
+        }
+    });
+    bench("linear ramp (simd)", &mut || scale_linear_ramp(black_box(&mut out), 0.5, 1.5));
+
+    bench("exp ramp (scalar)", &mut || {
+        let ratio = 10f32.powf(1.0 / BLOCK as f32);
+        let mut gain = 0.1;
+        for s in black_box(&mut out).iter_mut() {
+            *s *= gain;
+            gain *= ratio;
+        }
+    });
+    bench("exp ramp (simd)", &mut || scale_exp_ramp(black_box(&mut out), 0.1, 1.0));
+
+    bench("dry/wet mix (scalar)", &mut || {
+        let (out, dry) = (black_box(&mut out), black_box(&a));
+        for i in 0..BLOCK {
+            out[i] = out[i] * 0.7 + dry[i] * 0.3;
+        }
+    });
+    bench("dry/wet mix (simd)", &mut || mix(black_box(&mut out), black_box(&a), 0.7, 0.3));
+
+    bench("mix add (simd)", &mut || mix_add(black_box(&mut out), black_box(&a), 0.5));
+
+    let (mut left, mut right) = (vec![0.0f32; BLOCK], vec![0.0f32; BLOCK]);
+    bench("pan mono (scalar)", &mut || {
+        let (input, left, right) = (black_box(&a), black_box(&mut left), black_box(&mut right));
+        for i in 0..BLOCK {
+            let (gl, gr) = pan_gains(0.3f32);
+            left[i] = input[i] * gl;
+            right[i] = input[i] * gr;
+        }
+    });
+    bench("pan mono (simd)", &mut || {
+        beamer_core::buffer_ops::pan_mono(black_box(&a), &mut left, &mut right, 0.3)
+    });
+
+    bench("sum to mono 3ch (scalar)", &mut || {
+        let out = black_box(&mut out);
+        for i in 0..BLOCK {
+            out[i] = (a[i] + b[i] + c[i]) * 0.33;
+        }
+    });
+    bench("sum to mono 3ch (simd)", &mut || {
+        sum_to_mono(black_box(&mut out), [&a[..], &b[..], &c[..]], 0.33)
+    });
+
+    let inputs = [&a[..], &b[..], &c[..]];
+    bench("matrix row 3ch (simd)", &mut || {
+        matrix_row(black_box(&mut out), black_box(&inputs), &[0.7, 0.2, 0.1])
+    });
+
+    // 9.1.6 bed: 16 channels, numbers are per frame
+    let bed: Vec<Vec<f32>> = (0..16).map(|ch| (0..BLOCK).map(|i| ((i + ch * 31) as f32 * 0.013).sin()).collect()).collect();
+    let mut bed_out = vec![vec![0.0f32; BLOCK]; 16];
+    let coefficients = BiquadCoefficients::new(0.2f32, 0.4, 0.2, 1.0, -0.6, 0.3);
+    let mut states = [[0.0f32; 2]; 16];
+    bench("biquad 16ch (per channel)", &mut || {
+        let c = coefficients;
+        for ((input, output), [z1, z2]) in black_box(&bed).iter().zip(&mut bed_out).zip(&mut states) {
+            for (&x, y) in input.iter().zip(output.iter_mut()) {
+                *y = c.b0 * x + *z1;
+                *z1 = c.b1 * x - c.a1 * *y + *z2;
+                *z2 = c.b2 * x - c.a2 * *y;
+            }
+        }
+    });
+    let mut tiles = FrameTiles::<f32>::new(16, BLOCK);
+    let mut filter = TileBiquad::<f32>::new(16);
+    filter.set_coefficients(coefficients);
+    bench("biquad 16ch (frame tiles)", &mut || {
+        tiles.load(black_box(&bed).iter().map(Vec::as_slice), BLOCK);
+        filter.process(&mut tiles);
+        tiles.store(bed_out.iter_mut().map(Vec::as_mut_slice));
+    });
+
+    let matrix: Vec<f32> = (0..16 * 16).map(|k| (k as f32 * 0.37).cos()).collect();
+    let bed_inputs: Vec<&[f32]> = bed.iter().map(Vec::as_slice).collect();
+    bench("matrix 16x16 (planar rows)", &mut || {
+        for (o, output) in bed_out.iter_mut().enumerate() {
+            matrix_row(black_box(output), black_box(&bed_inputs), &matrix[o * 16..][..16]);
+        }
+    });
+    let mut mixed = FrameTiles::<f32>::new(16, BLOCK);
+    bench("matrix 16x16 (frame tiles)", &mut || {
+        tiles.load(black_box(&bed).iter().map(Vec::as_slice), BLOCK);
+        tiles.mix_matrix_into(&mut mixed, black_box(&matrix));
+        mixed.store(bed_out.iter_mut().map(Vec::as_mut_slice));
+    });
+}
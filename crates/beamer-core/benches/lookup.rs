@@ -0,0 +1,80 @@
+//! Lookup table benchmarks against libm.
+//!
+//! Run with `cargo bench -p beamer-core --bench lookup`. Uses only `std` so
+//! beamer-core keeps its zero-dependency policy; numbers are nanoseconds per
+//! evaluation over a block of inputs, best of several runs.
+
+use std::hint::black_box;
+use std::time::Instant;
+
+use beamer_core::lookup::{
+    fast_db_to_gain, fast_exp, fast_gain_to_db, fast_sin_phase, fast_tanh, sine_table,
+};
+
+const BLOCK: usize = 4096;
+const ROUNDS: usize = 2000;
+const RUNS: usize = 5;
+
+/// Time `f` over the input block and report ns per sample.
+fn bench(name: &str, input: &[f32], output: &mut [f32], f: impl Fn(&[f32], &mut [f32])) {
+    let mut best = f64::MAX;
+    for _ in 0..RUNS {
+        let start = Instant::now();
+        for _ in 0..ROUNDS {
+            f(black_box(input), black_box(&mut *output));
+        }
+        let ns = start.elapsed().as_nanos() as f64 / (ROUNDS * input.len()) as f64;
+        best = best.min(ns);
+    }
+    println!("{name:<28} {best:>8.3} ns/sample");
+}
+
+fn main() {
+    let phases: Vec<f32> = (0..BLOCK).map(|i| i as f32 / BLOCK as f32).collect();
+    let signed: Vec<f32> = (0..BLOCK).map(|i| (i as f32 / BLOCK as f32) * 8.0 - 4.0).collect();
+    let gains: Vec<f32> = (0..BLOCK).map(|i| (i + 1) as f32 / BLOCK as f32).collect();
+    let dbs: Vec<f32> = (0..BLOCK).map(|i| i as f32 / BLOCK as f32 * -96.0).collect();
+    let mut out = vec![0.0f32; BLOCK];
+
+    // Build shared tables before timing
+    let sine = sine_table();
+    black_box(fast_tanh(0.0) + fast_exp(0.0) + fast_gain_to_db(1.0));
+
+    let tau = std::f32::consts::TAU;
+    bench("sin (libm)", &phases, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &p)| *o = (p * tau).sin())
+    });
+    bench("sin (table, linear)", &phases, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &p)| *o = fast_sin_phase(p))
+    });
+    bench("sin (table, linear block)", &phases, &mut out, |i, o| sine.linear_block(i, o));
+    bench("sin (table, cubic block)", &phases, &mut out, |i, o| sine.cubic_block(i, o));
+
+    bench("tanh (libm)", &signed, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &x)| *o = x.tanh())
+    });
+    bench("tanh (table)", &signed, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &x)| *o = fast_tanh(x))
+    });
+
+    bench("exp (libm)", &signed, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &x)| *o = x.exp())
+    });
+    bench("exp (table)", &signed, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &x)| *o = fast_exp(x))
+    });
+
+    bench("gain_to_db (libm)", &gains, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &g)| *o = 20.0 * g.log10())
+    });
+    bench("gain_to_db (table)", &gains, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &g)| *o = fast_gain_to_db(g))
+    });
+
+    bench("db_to_gain (libm)", &dbs, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &d)| *o = 10.0f32.powf(d / 20.0))
+    });
+    bench("db_to_gain (table)", &dbs, &mut out, |i, o| {
+        o.iter_mut().zip(i).for_each(|(o, &d)| *o = fast_db_to_gain(d))
+    });
+}
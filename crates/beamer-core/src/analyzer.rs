@@ -0,0 +1,816 @@
+//! Headless spectrum and waveform analyzer feed.
+//!
+//! Analyzer displays need audio data at UI rate, but computing FFTs on the
+//! audio thread wastes the real-time budget. This module splits the work:
+//!
+//! - [`AnalyzerTap`] lives in the processor. From `process()` it only copies the
+//!   selected channels into a lock-free [`AudioFifo`].
+//! - [`AnalyzerEngine`] drains the ring off the audio thread, decimates, applies
+//!   a Hann window and runs an FFT. It publishes averaged and peak-hold spectra
+//!   plus min/max waveform envelopes into a shared [`AnalyzerFrame`].
+//! - [`AnalyzerView`] is a cheap, cloneable read handle for whatever displays
+//!   the data (WebView bridge, test, logger).
+//!
+//! Nothing here depends on a GUI, so the whole pipeline can be driven
+//! headless by calling [`AnalyzerEngine::update()`] directly, or on a
+//! background thread via [`AnalyzerEngine::spawn()`].
+//!
+//! # Example
+//!
+//! ```ignore
+//! // In Plugin::prepare() (setup thread)
+//! let (tap, engine) = Analyzer::pair(AnalyzerConfig::new().with_fft_size(4096), sample_rate);
+//! let view = engine.view();
+//! let worker = engine.spawn()?;
+//!
+//! // In AudioProcessor::process() (audio thread)
+//! self.analyzer_tap.push_outputs(buffer);
+//!
+//! // On the UI side, at display rate
+//! view.read(|frame| send_to_ui(frame.spectrum_average(0), frame.envelope_max(0)));
+//! ```
+//!
+//! # Real-Time Safety
+//!
+//! [`AnalyzerTap::push()`] never allocates, locks or blocks. When the worker
+//! falls behind and the ring is full, the newest samples are dropped and
+//! counted in [`AnalyzerTap::dropped_samples()`]. All buffers are allocated
+//! by [`Analyzer::pair()`].
+
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread::{self, JoinHandle};
+use std::time::Duration;
+
+use crate::audio_fifo::{AudioFifo, AudioFifoConsumer, AudioFifoProducer, FifoLayout};
+use crate::buffer::Buffer;
+use crate::sample::Sample;
+use crate::types::MAX_CHANNELS;
+
+/// Magnitude floor for published spectra in decibels.
+pub const ANALYZER_DB_FLOOR: f32 = -120.0;
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+/// Analyzer configuration.
+///
+/// Built with const `with_*` methods, so it can live in a `static`.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct AnalyzerConfig {
+    /// Bit mask of channels to capture (bit `n` = channel `n`).
+    pub channel_mask: u32,
+    /// FFT length in decimated samples. Must be a power of two.
+    pub fft_size: usize,
+    /// Decimation factor applied before analysis (1 = none).
+    pub decimation: usize,
+    /// Ring capacity per channel in samples. Rounded up to a power of two.
+    pub ring_capacity: usize,
+    /// Spectrum averaging coefficient per frame (0.0 = none, towards 1.0 = slower).
+    pub averaging: f32,
+    /// Peak-hold fall rate in dB per published frame.
+    pub peak_decay_db: f32,
+    /// Number of min/max points in the waveform envelope.
+    pub envelope_points: usize,
+    /// Time span covered by the waveform envelope in milliseconds.
+    pub envelope_ms: f32,
+    /// Target display rate of the background worker in Hz.
+    pub frame_rate: f32,
+}
+
+impl AnalyzerConfig {
+    /// Create a configuration with defaults: stereo, 2048-point FFT,
+    /// no decimation, 30 Hz frame rate.
+    pub const fn new() -> Self {
+        Self {
+            channel_mask: 0b11,
+            fft_size: 2048,
+            decimation: 1,
+            ring_capacity: 16384,
+            averaging: 0.7,
+            peak_decay_db: 0.5,
+            envelope_points: 512,
+            envelope_ms: 2000.0,
+            frame_rate: 30.0,
+        }
+    }
+
+    /// Select channels to capture by bit mask.
+    pub const fn with_channel_mask(mut self, mask: u32) -> Self {
+        self.channel_mask = mask;
+        self
+    }
+
+    /// Set the FFT length (power of two).
+    pub const fn with_fft_size(mut self, size: usize) -> Self {
+        self.fft_size = size;
+        self
+    }
+
+    /// Set the decimation factor.
+    pub const fn with_decimation(mut self, factor: usize) -> Self {
+        self.decimation = factor;
+        self
+    }
+
+    /// Set the ring capacity per channel in samples.
+    pub const fn with_ring_capacity(mut self, samples: usize) -> Self {
+        self.ring_capacity = samples;
+        self
+    }
+
+    /// Set the spectrum averaging coefficient.
+    pub const fn with_averaging(mut self, coefficient: f32) -> Self {
+        self.averaging = coefficient;
+        self
+    }
+
+    /// Set the peak-hold fall rate in dB per frame.
+    pub const fn with_peak_decay(mut self, db_per_frame: f32) -> Self {
+        self.peak_decay_db = db_per_frame;
+        self
+    }
+
+    /// Set the envelope resolution and time span.
+    pub const fn with_envelope(mut self, points: usize, ms: f32) -> Self {
+        self.envelope_points = points;
+        self.envelope_ms = ms;
+        self
+    }
+
+    /// Set the background worker frame rate in Hz.
+    pub const fn with_frame_rate(mut self, hz: f32) -> Self {
+        self.frame_rate = hz;
+        self
+    }
+
+    /// Number of captured channels.
+    #[inline]
+    pub const fn num_channels(&self) -> usize {
+        self.channel_mask.count_ones() as usize
+    }
+
+    /// Number of spectrum bins (`fft_size / 2 + 1`).
+    #[inline]
+    pub const fn num_bins(&self) -> usize {
+        self.fft_size / 2 + 1
+    }
+}
+
+impl Default for AnalyzerConfig {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// =============================================================================
+// Analyzer
+// =============================================================================
+
+/// Entry point that creates a connected tap/engine pair.
+pub struct Analyzer;
+
+impl Analyzer {
+    /// Create a tap (audio thread) and engine (worker) pair.
+    ///
+    /// Allocates every buffer the analyzer will ever use. Call from the
+    /// setup thread, e.g. in `Plugin::prepare()`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `fft_size` is not a power of two of at least 4, or if
+    /// `decimation` or `envelope_points` is zero.
+    pub fn pair(config: AnalyzerConfig, sample_rate: f64) -> (AnalyzerTap, AnalyzerEngine) {
+        assert!(
+            config.fft_size >= 4 && config.fft_size.is_power_of_two(),
+            "Analyzer fft_size must be a power of two >= 4"
+        );
+        assert!(config.decimation > 0, "Analyzer decimation must be > 0");
+        assert!(config.envelope_points > 0, "Analyzer envelope_points must be > 0");
+
+        let (producer, consumer) = AudioFifo::pair(
+            config.num_channels().max(1),
+            config.ring_capacity,
+            FifoLayout::Planar,
+        );
+        let tap = AnalyzerTap {
+            fifo: producer,
+            channel_mask: config.channel_mask,
+        };
+        (tap, AnalyzerEngine::new(config, sample_rate, consumer))
+    }
+}
+
+// =============================================================================
+// AnalyzerTap (audio thread)
+// =============================================================================
+
+/// Audio-thread side of the analyzer. Copies samples into the ring.
+pub struct AnalyzerTap {
+    fifo: AudioFifoProducer<f32>,
+    channel_mask: u32,
+}
+
+impl AnalyzerTap {
+    /// Push one block of channels into the ring.
+    ///
+    /// Channel `n` of the iterator is captured if bit `n` of the channel mask
+    /// is set. Selected channels missing from the iterator are written as silence.
+    /// Real-time safe: a bounded copy and a few atomic operations.
+    pub fn push<'s, S: Sample + 's>(&mut self, channels: impl IntoIterator<Item = &'s [S]>) {
+        let mut sources: [Option<&[S]>; MAX_CHANNELS] = [None; MAX_CHANNELS];
+        let mut len = 0;
+        for (ch, source) in channels.into_iter().take(MAX_CHANNELS).enumerate() {
+            if self.channel_mask & (1 << ch) != 0 {
+                len = len.max(source.len());
+                sources[ch] = Some(source);
+            }
+        }
+
+        // Frames that don't fit are counted as overflow by the FIFO
+        let mut chunk = self.fifo.write_chunk(len);
+        let selected = (0..MAX_CHANNELS).filter(|&ch| self.channel_mask & (1 << ch) != 0);
+        for (slot, ch) in selected.take(chunk.num_channels()).enumerate() {
+            let source = sources[ch].unwrap_or(&[]);
+            let (head, tail) = chunk.channel_mut(slot);
+            for (i, out) in head.iter_mut().chain(tail).enumerate() {
+                *out = source.get(i).map_or(0.0, |v| v.to_f32());
+            }
+        }
+        chunk.commit();
+    }
+
+    /// Capture the main input channels.
+    #[inline]
+    pub fn push_inputs<S: Sample>(&mut self, buffer: &Buffer<S>) {
+        self.push(buffer.inputs());
+    }
+
+    /// Capture the main output channels (call after processing).
+    #[inline]
+    pub fn push_outputs<S: Sample>(&mut self, buffer: &mut Buffer<S>) {
+        self.push(buffer.outputs_mut().map(|s| &*s));
+    }
+
+    /// Samples dropped because the ring was full.
+    pub fn dropped_samples(&self) -> u64 {
+        self.fifo.overflow_count()
+    }
+}
+
+// =============================================================================
+// AnalyzerFrame (published output)
+// =============================================================================
+
+/// Published analyzer output: spectra and waveform envelopes per channel.
+///
+/// Spectra are in dBFS (a full-scale sine reads 0 dB), clamped to
+/// [`ANALYZER_DB_FLOOR`]. Envelopes are ordered oldest to newest.
+#[derive(Debug, Clone)]
+pub struct AnalyzerFrame {
+    num_channels: usize,
+    num_bins: usize,
+    envelope_points: usize,
+    bin_width: f32,
+    sequence: u64,
+    average: Vec<f32>,
+    peak: Vec<f32>,
+    env_min: Vec<f32>,
+    env_max: Vec<f32>,
+}
+
+impl AnalyzerFrame {
+    fn new(config: &AnalyzerConfig, sample_rate: f64) -> Self {
+        let channels = config.num_channels();
+        let bins = config.num_bins();
+        let points = config.envelope_points;
+        let analysis_rate = sample_rate / config.decimation as f64;
+        Self {
+            num_channels: channels,
+            num_bins: bins,
+            envelope_points: points,
+            bin_width: (analysis_rate / config.fft_size as f64) as f32,
+            sequence: 0,
+            average: vec![ANALYZER_DB_FLOOR; channels * bins],
+            peak: vec![ANALYZER_DB_FLOOR; channels * bins],
+            env_min: vec![0.0; channels * points],
+            env_max: vec![0.0; channels * points],
+        }
+    }
+
+    /// Number of captured channels.
+    #[inline]
+    pub fn num_channels(&self) -> usize {
+        self.num_channels
+    }
+
+    /// Number of spectrum bins per channel.
+    #[inline]
+    pub fn num_bins(&self) -> usize {
+        self.num_bins
+    }
+
+    /// Number of envelope points per channel.
+    #[inline]
+    pub fn envelope_points(&self) -> usize {
+        self.envelope_points
+    }
+
+    /// Center frequency of a spectrum bin in Hz.
+    #[inline]
+    pub fn bin_frequency(&self, bin: usize) -> f32 {
+        bin as f32 * self.bin_width
+    }
+
+    /// Publication counter, incremented on every update with new data.
+    #[inline]
+    pub fn sequence(&self) -> u64 {
+        self.sequence
+    }
+
+    /// Averaged spectrum of a captured channel in dB.
+    pub fn spectrum_average(&self, channel: usize) -> &[f32] {
+        &self.average[channel * self.num_bins..][..self.num_bins]
+    }
+
+    /// Peak-hold spectrum of a captured channel in dB.
+    pub fn spectrum_peak(&self, channel: usize) -> &[f32] {
+        &self.peak[channel * self.num_bins..][..self.num_bins]
+    }
+
+    /// Per-point minimum sample values of a captured channel.
+    pub fn envelope_min(&self, channel: usize) -> &[f32] {
+        &self.env_min[channel * self.envelope_points..][..self.envelope_points]
+    }
+
+    /// Per-point maximum sample values of a captured channel.
+    pub fn envelope_max(&self, channel: usize) -> &[f32] {
+        &self.env_max[channel * self.envelope_points..][..self.envelope_points]
+    }
+}
+
+/// Cloneable read handle for the published [`AnalyzerFrame`].
+#[derive(Clone)]
+pub struct AnalyzerView {
+    frame: Arc<Mutex<AnalyzerFrame>>,
+}
+
+impl AnalyzerView {
+    /// Run a closure against the latest frame.
+    ///
+    /// Holds the frame lock for the duration of the closure; keep it short.
+    /// Never call from the audio thread.
+    pub fn read<R>(&self, f: impl FnOnce(&AnalyzerFrame) -> R) -> R {
+        let guard = self.frame.lock().unwrap_or_else(|e| e.into_inner());
+        f(&guard)
+    }
+
+    /// Copy the latest frame into `dst` without allocating.
+    ///
+    /// `dst` should come from [`snapshot()`](Self::snapshot) so sizes match.
+    pub fn copy_into(&self, dst: &mut AnalyzerFrame) {
+        self.read(|src| dst.clone_from(src));
+    }
+
+    /// Clone the latest frame.
+    pub fn snapshot(&self) -> AnalyzerFrame {
+        self.read(AnalyzerFrame::clone)
+    }
+
+    /// Sequence number of the latest frame.
+    pub fn sequence(&self) -> u64 {
+        self.read(|f| f.sequence)
+    }
+}
+
+// =============================================================================
+// AnalyzerEngine (worker side)
+// =============================================================================
+
+/// Per-channel analysis state owned by the engine.
+struct ChannelState {
+    // Decimator (boxcar average)
+    dec_acc: f32,
+    dec_count: usize,
+
+    // Time-domain history of decimated samples (circular, fft_size long)
+    history: Vec<f32>,
+
+    // Averaged power spectrum (linear) and peak-hold spectrum (dB)
+    avg_power: Vec<f32>,
+    peak_db: Vec<f32>,
+
+    // Envelope accumulation
+    cur_min: f32,
+    cur_max: f32,
+    env_min: Vec<f32>,
+    env_max: Vec<f32>,
+}
+
+/// Worker side of the analyzer: drains the ring and publishes frames.
+pub struct AnalyzerEngine {
+    config: AnalyzerConfig,
+    fifo: AudioFifoConsumer<f32>,
+    frame: Arc<Mutex<AnalyzerFrame>>,
+    channels: Vec<ChannelState>,
+
+    history_pos: usize,
+    env_count: usize,
+    env_pos: usize,
+    samples_per_point: usize,
+
+    // FFT tables and scratch
+    window: Vec<f32>,
+    window_gain: f32,
+    cos_table: Vec<f32>,
+    sin_table: Vec<f32>,
+    bit_reverse: Vec<u32>,
+    re: Vec<f32>,
+    im: Vec<f32>,
+    drain: Vec<f32>,
+
+    sequence: u64,
+}
+
+impl AnalyzerEngine {
+    fn new(config: AnalyzerConfig, sample_rate: f64, fifo: AudioFifoConsumer<f32>) -> Self {
+        let n = config.fft_size;
+        let bins = config.num_bins();
+        let points = config.envelope_points;
+
+        let window: Vec<f32> = (0..n)
+            .map(|i| {
+                let x = i as f64 / n as f64;
+                (0.5 - 0.5 * (2.0 * std::f64::consts::PI * x).cos()) as f32
+            })
+            .collect();
+        let window_gain = window.iter().sum::<f32>() * 0.5;
+
+        let (cos_table, sin_table) = (0..n / 2)
+            .map(|k| {
+                let angle = -2.0 * std::f64::consts::PI * k as f64 / n as f64;
+                (angle.cos() as f32, angle.sin() as f32)
+            })
+            .unzip();
+
+        let bits = n.trailing_zeros();
+        let bit_reverse = (0..n as u32)
+            .map(|i| i.reverse_bits() >> (32 - bits))
+            .collect();
+
+        let analysis_rate = sample_rate / config.decimation as f64;
+        let span = analysis_rate * config.envelope_ms as f64 / 1000.0;
+        let samples_per_point = ((span / points as f64).round() as usize).max(1);
+
+        let channels = (0..config.num_channels())
+            .map(|_| ChannelState {
+                dec_acc: 0.0,
+                dec_count: 0,
+                history: vec![0.0; n],
+                avg_power: vec![0.0; bins],
+                peak_db: vec![ANALYZER_DB_FLOOR; bins],
+                cur_min: f32::MAX,
+                cur_max: f32::MIN,
+                env_min: vec![0.0; points],
+                env_max: vec![0.0; points],
+            })
+            .collect();
+
+        Self {
+            frame: Arc::new(Mutex::new(AnalyzerFrame::new(&config, sample_rate))),
+            drain: vec![0.0; fifo.capacity()],
+            config,
+            fifo,
+            channels,
+            history_pos: 0,
+            env_count: 0,
+            env_pos: 0,
+            samples_per_point,
+            window,
+            window_gain,
+            cos_table,
+            sin_table,
+            bit_reverse,
+            re: vec![0.0; n],
+            im: vec![0.0; n],
+            sequence: 0,
+        }
+    }
+
+    /// Get a read handle for the published frames.
+    pub fn view(&self) -> AnalyzerView {
+        AnalyzerView {
+            frame: Arc::clone(&self.frame),
+        }
+    }
+
+    /// Get the analyzer configuration.
+    pub fn config(&self) -> &AnalyzerConfig {
+        &self.config
+    }
+
+    /// Drain the ring, analyze and publish one frame.
+    ///
+    /// Returns `true` if new samples were consumed and a frame was published.
+    /// Call periodically at display rate, or use [`spawn()`](Self::spawn).
+    pub fn update(&mut self) -> bool {
+        let available = self.fifo.available_read();
+        if available == 0 || self.channels.is_empty() {
+            return false;
+        }
+
+        let decimation = self.config.decimation;
+        let start_dec = self.channels[0].dec_count;
+        let start_pos = self.history_pos;
+        let start_env_count = self.env_count;
+        let start_env_pos = self.env_pos;
+        let mut new_decimated = false;
+
+        let chunk = self.fifo.read_chunk(available);
+        for ch in 0..self.channels.len() {
+            let (head, tail) = chunk.channel(ch);
+            self.drain[..head.len()].copy_from_slice(head);
+            self.drain[head.len()..available].copy_from_slice(tail);
+
+            // Every channel advances the shared positions identically
+            self.history_pos = start_pos;
+            self.env_count = start_env_count;
+            self.env_pos = start_env_pos;
+            debug_assert_eq!(self.channels[ch].dec_count, start_dec);
+
+            let n = self.config.fft_size;
+            let points = self.config.envelope_points;
+            let state = &mut self.channels[ch];
+            for &x in &self.drain[..available] {
+                state.dec_acc += x;
+                state.dec_count += 1;
+                if state.dec_count < decimation {
+                    continue;
+                }
+                let y = state.dec_acc / decimation as f32;
+                state.dec_acc = 0.0;
+                state.dec_count = 0;
+                new_decimated = true;
+
+                state.history[self.history_pos] = y;
+                self.history_pos = (self.history_pos + 1) & (n - 1);
+
+                state.cur_min = state.cur_min.min(y);
+                state.cur_max = state.cur_max.max(y);
+                self.env_count += 1;
+                if self.env_count == self.samples_per_point {
+                    state.env_min[self.env_pos] = state.cur_min;
+                    state.env_max[self.env_pos] = state.cur_max;
+                    state.cur_min = f32::MAX;
+                    state.cur_max = f32::MIN;
+                    self.env_count = 0;
+                    self.env_pos = (self.env_pos + 1) % points;
+                }
+            }
+        }
+        chunk.commit();
+
+        if !new_decimated {
+            return false;
+        }
+
+        for ch in 0..self.channels.len() {
+            self.analyze_channel(ch);
+        }
+        self.publish();
+        true
+    }
+
+    /// Spawn a background thread that calls [`update()`](Self::update) at the
+    /// configured frame rate.
+    pub fn spawn(self) -> std::io::Result<AnalyzerWorker> {
+        let stop = Arc::new(AtomicBool::new(false));
+        let thread_stop = Arc::clone(&stop);
+        let interval = Duration::from_secs_f32(1.0 / self.config.frame_rate.max(1.0));
+        let mut engine = self;
+        let handle = thread::Builder::new()
+            .name("beamer-analyzer".into())
+            .spawn(move || {
+                while !thread_stop.load(Ordering::Acquire) {
+                    engine.update();
+                    thread::sleep(interval);
+                }
+                engine
+            })?;
+        Ok(AnalyzerWorker {
+            stop,
+            handle: Some(handle),
+        })
+    }
+
+    /// Window, transform and accumulate the spectrum of one channel.
+    fn analyze_channel(&mut self, ch: usize) {
+        let n = self.config.fft_size;
+        let state = &mut self.channels[ch];
+
+        // Unroll the circular history oldest-first into bit-reversed order
+        for i in 0..n {
+            let x = state.history[(self.history_pos + i) & (n - 1)] * self.window[i];
+            let j = self.bit_reverse[i] as usize;
+            self.re[j] = x;
+            self.im[j] = 0.0;
+        }
+
+        // Iterative radix-2 decimation-in-time FFT
+        let mut len = 2;
+        while len <= n {
+            let half = len / 2;
+            let stride = n / len;
+            for start in (0..n).step_by(len) {
+                for k in 0..half {
+                    let (wr, wi) = (self.cos_table[k * stride], self.sin_table[k * stride]);
+                    let (a, b) = (start + k, start + k + half);
+                    let tr = self.re[b] * wr - self.im[b] * wi;
+                    let ti = self.re[b] * wi + self.im[b] * wr;
+                    self.re[b] = self.re[a] - tr;
+                    self.im[b] = self.im[a] - ti;
+                    self.re[a] += tr;
+                    self.im[a] += ti;
+                }
+            }
+            len *= 2;
+        }
+
+        let avg = self.config.averaging.clamp(0.0, 0.999);
+        let decay = self.config.peak_decay_db.max(0.0);
+        let scale = 1.0 / (self.window_gain * self.window_gain);
+        for bin in 0..self.config.num_bins() {
+            let power = (self.re[bin] * self.re[bin] + self.im[bin] * self.im[bin]) * scale;
+            state.avg_power[bin] = state.avg_power[bin] * avg + power * (1.0 - avg);
+            let db = power_to_db(power);
+            state.peak_db[bin] = db.max(state.peak_db[bin] - decay);
+        }
+    }
+
+    /// Copy engine state into the shared frame.
+    fn publish(&mut self) {
+        self.sequence += 1;
+        let bins = self.config.num_bins();
+        let points = self.config.envelope_points;
+        let mut frame = self.frame.lock().unwrap_or_else(|e| e.into_inner());
+        frame.sequence = self.sequence;
+        for (ch, state) in self.channels.iter().enumerate() {
+            let average = &mut frame.average[ch * bins..][..bins];
+            for (dst, &p) in average.iter_mut().zip(&state.avg_power) {
+                *dst = power_to_db(p);
+            }
+            frame.peak[ch * bins..][..bins].copy_from_slice(&state.peak_db);
+
+            // Rotate so the oldest point comes first
+            let (newer, older) = state.env_min.split_at(self.env_pos);
+            let env_min = &mut frame.env_min[ch * points..][..points];
+            env_min[..older.len()].copy_from_slice(older);
+            env_min[older.len()..].copy_from_slice(newer);
+            let (newer, older) = state.env_max.split_at(self.env_pos);
+            let env_max = &mut frame.env_max[ch * points..][..points];
+            env_max[..older.len()].copy_from_slice(older);
+            env_max[older.len()..].copy_from_slice(newer);
+        }
+    }
+}
+
+/// Convert linear power to dB, clamped to [`ANALYZER_DB_FLOOR`].
+#[inline]
+fn power_to_db(power: f32) -> f32 {
+    if power <= 0.0 {
+        ANALYZER_DB_FLOOR
+    } else {
+        (10.0 * power.log10()).max(ANALYZER_DB_FLOOR)
+    }
+}
+
+/// Handle to a running background analyzer thread.
+///
+/// Dropping the handle stops and joins the thread.
+pub struct AnalyzerWorker {
+    stop: Arc<AtomicBool>,
+    handle: Option<JoinHandle<AnalyzerEngine>>,
+}
+
+impl AnalyzerWorker {
+    /// Stop the worker and get the engine back.
+    pub fn stop(mut self) -> Option<AnalyzerEngine> {
+        self.stop.store(true, Ordering::Release);
+        self.handle.take().and_then(|h| h.join().ok())
+    }
+}
+
+impl Drop for AnalyzerWorker {
+    fn drop(&mut self) {
+        self.stop.store(true, Ordering::Release);
+        if let Some(handle) = self.handle.take() {
+            let _ = handle.join();
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sine(freq: f32, sample_rate: f32, len: usize) -> Vec<f32> {
+        (0..len)
+            .map(|i| (2.0 * std::f32::consts::PI * freq * i as f32 / sample_rate).sin())
+            .collect()
+    }
+
+    #[test]
+    fn test_spectrum_peak_at_sine_bin() {
+        let config = AnalyzerConfig::new()
+            .with_channel_mask(0b1)
+            .with_fft_size(1024)
+            .with_averaging(0.0);
+        let (mut tap, mut engine) = Analyzer::pair(config, 48000.0);
+
+        // Bin-centered frequency: bin 64
+        let freq = 64.0 * 48000.0 / 1024.0;
+        let signal = sine(freq, 48000.0, 1024);
+        tap.push([signal.as_slice()]);
+        assert!(engine.update());
+
+        let frame = engine.view().snapshot();
+        let spectrum = frame.spectrum_average(0);
+        let (max_bin, max_db) = spectrum
+            .iter()
+            .enumerate()
+            .fold((0, f32::MIN), |acc, (i, &v)| if v > acc.1 { (i, v) } else { acc });
+        assert_eq!(max_bin, 64);
+        assert!(max_db.abs() < 0.5, "full-scale sine should read ~0 dB, got {max_db}");
+        assert!((frame.bin_frequency(64) - freq).abs() < 1e-3);
+    }
+
+    #[test]
+    fn test_envelope_tracks_min_max() {
+        let config = AnalyzerConfig::new()
+            .with_channel_mask(0b10)
+            .with_envelope(4, 1000.0);
+        let (mut tap, mut engine) = Analyzer::pair(config, 400.0);
+
+        // 100 samples per envelope point, second channel captured
+        let silence = vec![0.0f32; 400];
+        let signal = sine(10.0, 400.0, 400);
+        tap.push([silence.as_slice(), signal.as_slice()]);
+        assert!(engine.update());
+
+        let view = engine.view();
+        view.read(|frame| {
+            for (&lo, &hi) in frame.envelope_min(0).iter().zip(frame.envelope_max(0)) {
+                assert!(lo < -0.99 && hi > 0.99);
+            }
+        });
+    }
+
+    #[test]
+    fn test_ring_overflow_counts_dropped() {
+        let config = AnalyzerConfig::new().with_ring_capacity(256);
+        let (mut tap, mut engine) = Analyzer::pair(config, 48000.0);
+
+        let block = vec![0.5f32; 200];
+        tap.push([block.as_slice(), block.as_slice()]);
+        tap.push([block.as_slice(), block.as_slice()]);
+        assert_eq!(tap.dropped_samples(), 144);
+
+        assert!(engine.update());
+        tap.push([block.as_slice(), block.as_slice()]);
+        assert_eq!(tap.dropped_samples(), 144);
+    }
+
+    #[test]
+    fn test_decimation_and_no_data() {
+        let config = AnalyzerConfig::new().with_channel_mask(0b1).with_decimation(4);
+        let (mut tap, mut engine) = Analyzer::pair(config, 48000.0);
+        assert!(!engine.update());
+
+        // Fewer samples than the decimation factor publish nothing
+        tap.push([[1.0f64, 1.0, 1.0].as_slice()]);
+        assert!(!engine.update());
+        tap.push([[1.0f64].as_slice()]);
+        assert!(engine.update());
+        assert_eq!(engine.view().sequence(), 1);
+    }
+
+    #[test]
+    fn test_worker_thread() {
+        let config = AnalyzerConfig::new().with_channel_mask(0b1).with_frame_rate(1000.0);
+        let (mut tap, engine) = Analyzer::pair(config, 48000.0);
+        let view = engine.view();
+        let worker = engine.spawn().unwrap();
+
+        let block = vec![0.25f32; 512];
+        tap.push([block.as_slice()]);
+        for _ in 0..1000 {
+            if view.sequence() > 0 {
+                break;
+            }
+            thread::sleep(Duration::from_millis(1));
+        }
+        assert!(view.sequence() > 0);
+        assert!(worker.stop().is_some());
+    }
+}
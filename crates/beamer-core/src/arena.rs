@@ -0,0 +1,466 @@
+//! Contiguous per-instance memory for DSP state.
+//!
+//! Delay lines, filter state and scratch buffers allocated as separate
+//! `Vec`s end up scattered across the heap. [`DspArena`] makes one
+//! 64-byte-aligned allocation in `prepare()` and hands out [`ArenaSlice`]s
+//! from it, so a processor's audio state is contiguous and freed as one
+//! block.
+//!
+//! # Usage
+//!
+//! 1. Size the arena with an [`ArenaLayout`] (the same slices, in any order).
+//! 2. Create the arena and allocate slices from it.
+//! 3. Store the slices in the processor. The arena itself can be dropped:
+//!    each slice keeps the block alive, and the block is freed when the last
+//!    slice goes away (e.g. on `unprepare()`).
+//!
+//! ```ignore
+//! fn prepare(self, config: AudioSetup) -> MyProcessor {
+//!     let delay_len = (2.0 * config.sample_rate) as usize;
+//!     let layout = ArenaLayout::new()
+//!         .slices::<f32>(2, delay_len)
+//!         .slice::<f32>(config.max_buffer_size);
+//!     let mut arena = DspArena::new(layout);
+//!
+//!     MyProcessor {
+//!         delay_l: arena.alloc(delay_len, 0.0),
+//!         delay_r: arena.alloc(delay_len, 0.0),
+//!         scratch: arena.alloc(config.max_buffer_size, 0.0),
+//!     }
+//! }
+//! ```
+//!
+//! # Alignment
+//!
+//! Every slice starts on a 64-byte boundary ([`ARENA_ALIGN`]), so slices
+//! never share a cache line and are aligned for any SIMD width in use.
+//!
+//! # Huge Pages
+//!
+//! [`DspArena::with_huge_pages()`] aligns and sizes the block to 2 MiB and,
+//! on Linux, asks the kernel to back it with transparent huge pages
+//! (`madvise(MADV_HUGEPAGE)`). This reduces TLB misses for large state such
+//! as long delay lines. Elsewhere, or if the kernel declines, the arena
+//! behaves like [`DspArena::new()`].
+
+use std::alloc::{self, Layout};
+use std::marker::PhantomData;
+use std::ops::{Deref, DerefMut};
+use std::ptr::NonNull;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::Arc;
+
+use crate::residency::{self, ResidencyReport};
+
+/// Alignment of every arena slice, in bytes (one cache line).
+pub const ARENA_ALIGN: usize = 64;
+
+/// Block alignment and size granularity for huge-page arenas.
+const HUGE_PAGE_SIZE: usize = 2 * 1024 * 1024;
+
+#[inline]
+const fn round_up(value: usize, align: usize) -> usize {
+    (value + align - 1) & !(align - 1)
+}
+
+// =============================================================================
+// ArenaLayout
+// =============================================================================
+
+/// Size calculator for a [`DspArena`].
+///
+/// Add every slice the arena will hold; [`size()`](Self::size) includes the
+/// per-slice alignment padding.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ArenaLayout {
+    size: usize,
+}
+
+impl ArenaLayout {
+    /// Empty layout.
+    pub const fn new() -> Self {
+        Self { size: 0 }
+    }
+
+    /// Add one slice of `len` elements of `T`.
+    pub const fn slice<T>(self, len: usize) -> Self {
+        Self {
+            size: self.size + round_up(len * std::mem::size_of::<T>(), ARENA_ALIGN),
+        }
+    }
+
+    /// Add `count` slices of `len` elements of `T` each.
+    pub const fn slices<T>(self, count: usize, len: usize) -> Self {
+        Self {
+            size: self.size + count * round_up(len * std::mem::size_of::<T>(), ARENA_ALIGN),
+        }
+    }
+
+    /// Add `bytes` of raw space (rounded up to the slice alignment).
+    pub const fn bytes(self, bytes: usize) -> Self {
+        Self {
+            size: self.size + round_up(bytes, ARENA_ALIGN),
+        }
+    }
+
+    /// Total size in bytes.
+    #[inline]
+    pub const fn size(&self) -> usize {
+        self.size
+    }
+}
+
+// =============================================================================
+// Block
+// =============================================================================
+
+/// The single allocation behind an arena. Freed when the arena and all its
+/// slices are dropped.
+pub(crate) struct Block {
+    ptr: NonNull<u8>,
+    layout: Layout,
+    huge_pages: bool,
+    /// Set once the block is `mlock`ed; unlocked again on drop
+    locked: AtomicBool,
+}
+
+// SAFETY: Block only owns raw memory; access is mediated by ArenaSlice,
+// whose regions never overlap.
+unsafe impl Send for Block {}
+unsafe impl Sync for Block {}
+
+impl Block {
+    fn new(size: usize, align: usize) -> Self {
+        let layout = Layout::from_size_align(size, align).expect("arena size overflows");
+        let ptr = if size == 0 {
+            // Never dereferenced: every slice in an empty arena is empty
+            NonNull::new(align as *mut u8).unwrap()
+        } else {
+            // SAFETY: size is non-zero
+            let ptr = unsafe { alloc::alloc(layout) };
+            NonNull::new(ptr).unwrap_or_else(|| alloc::handle_alloc_error(layout))
+        };
+        Self {
+            ptr,
+            layout,
+            huge_pages: false,
+            locked: AtomicBool::new(false),
+        }
+    }
+
+    /// Write-fault every page and optionally lock the block in RAM.
+    ///
+    /// Only whole pages are locked (see [`residency::whole_pages()`]), so
+    /// unlocking on drop never affects a neighbouring allocation. Setup
+    /// thread only: must not race with audio-thread use of the slices.
+    pub(crate) fn make_resident(&self, lock: bool, report: &mut ResidencyReport) {
+        let len = self.layout.size();
+        if len == 0 {
+            return;
+        }
+        // SAFETY: the block is live, and callers guarantee no concurrent access
+        unsafe { residency::prefault_raw(self.ptr.as_ptr(), len) };
+        report.regions += 1;
+        report.bytes_prefaulted += len;
+        if lock && !self.locked.load(Ordering::Relaxed) {
+            let Some((start, pages)) = residency::whole_pages(self.ptr.as_ptr(), len) else {
+                return;
+            };
+            match residency::lock(start, pages) {
+                Ok(()) => {
+                    self.locked.store(true, Ordering::Relaxed);
+                    report.bytes_locked += pages;
+                }
+                Err(kind) => {
+                    report.lock_failures += 1;
+                    report.lock_error = Some(kind);
+                }
+            }
+        }
+    }
+}
+
+impl Drop for Block {
+    fn drop(&mut self) {
+        if *self.locked.get_mut() {
+            if let Some((start, pages)) = residency::whole_pages(self.ptr.as_ptr(), self.layout.size()) {
+                residency::unlock(start, pages);
+            }
+        }
+        if self.layout.size() > 0 {
+            // SAFETY: allocated in Block::new with this layout
+            unsafe { alloc::dealloc(self.ptr.as_ptr(), self.layout) }
+        }
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn advise_huge_pages(ptr: *mut u8, len: usize) -> bool {
+    extern "C" {
+        fn madvise(addr: *mut std::ffi::c_void, len: usize, advice: std::ffi::c_int) -> std::ffi::c_int;
+    }
+    const MADV_HUGEPAGE: std::ffi::c_int = 14;
+    // SAFETY: the range is a live allocation aligned to the huge page size
+    unsafe { madvise(ptr.cast(), len, MADV_HUGEPAGE) == 0 }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn advise_huge_pages(_ptr: *mut u8, _len: usize) -> bool {
+    false
+}
+
+// =============================================================================
+// DspArena
+// =============================================================================
+
+/// One contiguous, 64-byte-aligned allocation that hands out slices.
+///
+/// Allocate in `prepare()` (or another setup-thread call), never on the
+/// audio thread. See the [module docs](self) for usage.
+pub struct DspArena {
+    block: Arc<Block>,
+    offset: usize,
+}
+
+impl DspArena {
+    /// Allocate an arena of `layout.size()` bytes.
+    ///
+    /// Inside a [`PrepareScope`](crate::PrepareScope) that locks memory, the
+    /// block is page-aligned and rounded up to whole pages so all of it can
+    /// be locked.
+    pub fn new(layout: ArenaLayout) -> Self {
+        let size = layout.size();
+        if size > 0 && residency::scope_locks() {
+            let page = residency::page_size().max(ARENA_ALIGN);
+            return Self::from_block(Block::new(round_up(size, page), page));
+        }
+        Self::from_block(Block::new(size, ARENA_ALIGN))
+    }
+
+    fn from_block(block: Block) -> Self {
+        let block = Arc::new(block);
+        residency::register_block(&block);
+        Self { block, offset: 0 }
+    }
+
+    /// Allocate an arena backed by transparent huge pages where available.
+    ///
+    /// The block is rounded up to a multiple of 2 MiB. Check
+    /// [`uses_huge_pages()`](Self::uses_huge_pages) for whether the kernel
+    /// accepted the request.
+    pub fn with_huge_pages(layout: ArenaLayout) -> Self {
+        if layout.size() == 0 {
+            return Self::new(layout);
+        }
+        let mut block = Block::new(round_up(layout.size(), HUGE_PAGE_SIZE), HUGE_PAGE_SIZE);
+        block.huge_pages = advise_huge_pages(block.ptr.as_ptr(), block.layout.size());
+        Self::from_block(block)
+    }
+
+    /// Total capacity in bytes.
+    #[inline]
+    pub fn capacity(&self) -> usize {
+        self.block.layout.size()
+    }
+
+    /// Bytes handed out so far, including alignment padding.
+    #[inline]
+    pub fn used(&self) -> usize {
+        self.offset
+    }
+
+    /// Bytes still available.
+    #[inline]
+    pub fn remaining(&self) -> usize {
+        self.capacity() - self.offset
+    }
+
+    /// Whether the kernel accepted the huge-page request.
+    #[inline]
+    pub fn uses_huge_pages(&self) -> bool {
+        self.block.huge_pages
+    }
+
+    /// Start address and length of the whole block.
+    #[inline]
+    pub fn as_ptr_range(&self) -> (*const u8, usize) {
+        (self.block.ptr.as_ptr(), self.capacity())
+    }
+
+    /// Pre-fault the whole block and optionally `mlock` it.
+    ///
+    /// Arenas created inside a [`PrepareScope`](crate::PrepareScope) are
+    /// handled by the framework; call this for arenas created elsewhere.
+    /// Setup thread only, before the slices are used on the audio thread.
+    /// Locking covers the pages that lie entirely inside the block; partial
+    /// pages at its edges are shared with other allocations and stay
+    /// unlocked. A locked block is unlocked when it's freed.
+    pub fn make_resident(&self, lock: bool) -> ResidencyReport {
+        let mut report = ResidencyReport::default();
+        self.block.make_resident(lock, &mut report);
+        report
+    }
+
+    /// Allocate a slice of `len` elements, each set to `value`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the arena doesn't have room; size it with the same slices
+    /// in its [`ArenaLayout`].
+    #[track_caller]
+    pub fn alloc<T: Copy>(&mut self, len: usize, value: T) -> ArenaSlice<T> {
+        let remaining = self.remaining();
+        self.try_alloc(len, value).unwrap_or_else(|| {
+            panic!(
+                "DspArena exhausted: {} x {} bytes requested, {} remaining",
+                len,
+                std::mem::size_of::<T>(),
+                remaining
+            )
+        })
+    }
+
+    /// Allocate a slice of `len` elements, or `None` if the arena is full.
+    pub fn try_alloc<T: Copy>(&mut self, len: usize, value: T) -> Option<ArenaSlice<T>> {
+        assert!(std::mem::align_of::<T>() <= ARENA_ALIGN, "arena slices are 64-byte aligned");
+        let bytes = len.checked_mul(std::mem::size_of::<T>())?;
+        let reserved = round_up(bytes, ARENA_ALIGN);
+        if reserved > self.remaining() {
+            return None;
+        }
+        let ptr = if bytes == 0 {
+            NonNull::dangling()
+        } else {
+            // SAFETY: offset + bytes is within the block, and the region is
+            // handed out once
+            let ptr = unsafe { self.block.ptr.as_ptr().add(self.offset) }.cast::<T>();
+            let slice = unsafe { std::slice::from_raw_parts_mut(ptr, len) };
+            slice.fill(value);
+            NonNull::new(ptr).unwrap()
+        };
+        self.offset += reserved;
+        Some(ArenaSlice {
+            ptr,
+            len,
+            _block: Some(Arc::clone(&self.block)),
+            _marker: PhantomData,
+        })
+    }
+}
+
+// =============================================================================
+// ArenaSlice
+// =============================================================================
+
+/// A slice owned by a [`DspArena`] block.
+///
+/// Dereferences to `[T]`. Keeps the block alive; the block is freed once
+/// the arena and all of its slices are dropped. Dropping a slice never
+/// frees memory on its own, so it's safe on the audio thread only if other
+/// slices or the arena outlive it.
+pub struct ArenaSlice<T> {
+    ptr: NonNull<T>,
+    len: usize,
+    /// `None` for default (empty) slices, so `Default` never allocates
+    _block: Option<Arc<Block>>,
+    _marker: PhantomData<T>,
+}
+
+// SAFETY: ArenaSlice owns its region exclusively, like Box<[T]>.
+unsafe impl<T: Send> Send for ArenaSlice<T> {}
+unsafe impl<T: Sync> Sync for ArenaSlice<T> {}
+
+impl<T> Default for ArenaSlice<T> {
+    /// An empty slice that owns no arena memory (e.g. for state released
+    /// in [`hibernate()`](crate::AudioProcessor::hibernate)). Doesn't
+    /// allocate, so it's usable on the audio thread.
+    fn default() -> Self {
+        Self {
+            ptr: NonNull::dangling(),
+            len: 0,
+            _block: None,
+            _marker: PhantomData,
+        }
+    }
+}
+
+impl<T> Deref for ArenaSlice<T> {
+    type Target = [T];
+
+    #[inline]
+    fn deref(&self) -> &[T] {
+        // SAFETY: ptr/len describe an initialized region owned by this slice
+        unsafe { std::slice::from_raw_parts(self.ptr.as_ptr(), self.len) }
+    }
+}
+
+impl<T> DerefMut for ArenaSlice<T> {
+    #[inline]
+    fn deref_mut(&mut self) -> &mut [T] {
+        // SAFETY: as above, and &mut self guarantees exclusive access
+        unsafe { std::slice::from_raw_parts_mut(self.ptr.as_ptr(), self.len) }
+    }
+}
+
+impl<T: std::fmt::Debug> std::fmt::Debug for ArenaSlice<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_list().entries(self.iter()).finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_slices_are_aligned_and_contiguous() {
+        let layout = ArenaLayout::new().slices::<f32>(2, 100).slice::<f64>(3).slice::<u8>(0);
+        assert_eq!(layout.size(), 2 * 448 + 64);
+
+        let mut arena = DspArena::new(layout);
+        let mut a = arena.alloc(100, 0.0f32);
+        let b = arena.alloc(100, 1.0f32);
+        let c = arena.alloc(3, 2.0f64);
+        let empty = arena.alloc(0, 0u8);
+        assert_eq!(arena.remaining(), 0);
+        assert!(arena.try_alloc(1, 0u8).is_none());
+
+        for ptr in [a.as_ptr() as usize, b.as_ptr() as usize, c.as_ptr() as usize] {
+            assert_eq!(ptr % ARENA_ALIGN, 0);
+        }
+        assert_eq!(b.as_ptr() as usize - a.as_ptr() as usize, 448);
+        assert!(empty.is_empty());
+
+        // Slices outlive the arena handle
+        drop(arena);
+        a[99] = 5.0;
+        assert_eq!((a[99], b[0], c[2]), (5.0, 1.0, 2.0));
+    }
+
+    #[test]
+    fn test_huge_pages_rounds_to_block_size() {
+        let mut arena = DspArena::with_huge_pages(ArenaLayout::new().slice::<f32>(1000));
+        assert_eq!(arena.capacity(), HUGE_PAGE_SIZE);
+        assert_eq!(arena.as_ptr_range().0 as usize % HUGE_PAGE_SIZE, 0);
+        let slice = arena.alloc(1000, 0.5f32);
+        assert_eq!(slice.iter().sum::<f32>(), 500.0);
+        // Whether THP is granted depends on the kernel configuration
+        let _ = arena.uses_huge_pages();
+    }
+
+    #[test]
+    fn test_default_slice_is_empty_and_detached() {
+        let mut slice = ArenaSlice::<f32>::default();
+        assert!(slice.is_empty());
+        assert!(slice.iter_mut().next().is_none());
+        assert!(slice._block.is_none());
+    }
+
+    #[test]
+    #[should_panic(expected = "DspArena exhausted")]
+    fn test_exhaustion_panics() {
+        let mut arena = DspArena::new(ArenaLayout::new().slice::<f32>(16));
+        let _a = arena.alloc(16, 0.0f32);
+        let _b = arena.alloc(1, 0.0f32);
+    }
+}
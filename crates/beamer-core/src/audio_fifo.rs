@@ -0,0 +1,862 @@
+//! Lock-free single-producer/single-consumer audio FIFO.
+//!
+//! Moves blocks of audio frames between exactly two threads (typically the
+//! audio thread and a worker) without locks, allocation or blocking:
+//!
+//! - [`AudioFifo::pair()`] allocates the ring once and returns a connected
+//!   [`AudioFifoProducer`] / [`AudioFifoConsumer`] pair.
+//! - [`AudioFifoProducer::push()`] / [`AudioFifoConsumer::pop()`] copy from and
+//!   into planar channel slices; the `_interleaved` variants take interleaved
+//!   frames. Both work with either storage [`FifoLayout`].
+//! - [`write_chunk()`](AudioFifoProducer::write_chunk) and
+//!   [`read_chunk()`](AudioFifoConsumer::read_chunk) expose the ring storage
+//!   directly as slice pairs (the region before and after the wrap point) for
+//!   zero-copy bulk transfer.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // In Plugin::prepare() (setup thread)
+//! let (producer, consumer) = AudioFifo::pair::<f32>(2, 16_384, FifoLayout::Planar);
+//! spawn_recorder(consumer);
+//!
+//! // In AudioProcessor::process() (audio thread)
+//! self.recorder.push(buffer.inputs());
+//!
+//! // On the recorder thread
+//! let chunk = consumer.read_chunk(consumer.available_read());
+//! for ch in 0..chunk.num_channels() {
+//!     let (head, tail) = chunk.channel(ch);
+//!     file.write(ch, head);
+//!     file.write(ch, tail);
+//! }
+//! chunk.commit();
+//! ```
+//!
+//! # Real-Time Safety
+//!
+//! Every operation is wait-free: a bounded copy plus at most one atomic load,
+//! one atomic store and a counter update, never a retry loop. Each side
+//! caches the other side's index and only reloads it when the cached value
+//! can't satisfy a request.
+//!
+//! The read and write indices live on separate cache lines so the two
+//! threads don't invalidate each other's line on every update.
+//!
+//! # Overflow and Underrun
+//!
+//! Asking for more frames than the ring can provide is never an error:
+//!
+//! - A producer that writes into a full ring drops the newest frames and adds
+//!   them to [`overflow_count()`](AudioFifoProducer::overflow_count).
+//! - A consumer that reads from an underfilled ring gets the available frames;
+//!   [`pop()`](AudioFifoConsumer::pop) fills the rest with silence and adds
+//!   the missing frames to [`underrun_count()`](AudioFifoConsumer::underrun_count).
+//!
+//! Use [`available_write()`](AudioFifoProducer::available_write) and
+//! [`available_read()`](AudioFifoConsumer::available_read) to size requests
+//! without touching the counters.
+
+use std::cell::UnsafeCell;
+use std::ops::Deref;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+
+use crate::sample::Sample;
+use crate::types::MAX_CHANNELS;
+
+// =============================================================================
+// Layout
+// =============================================================================
+
+/// How frames are arranged in the ring storage.
+///
+/// Affects only which zero-copy accessor is available on chunks; the copying
+/// `push`/`pop` methods accept both planar and interleaved data either way.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum FifoLayout {
+    /// One contiguous ring per channel. Chunks expose
+    /// [`channel()`](ReadChunk::channel) slice pairs.
+    #[default]
+    Planar,
+    /// Frames stored channel-interleaved. Chunks expose
+    /// [`interleaved()`](ReadChunk::interleaved) slice pairs.
+    Interleaved,
+}
+
+// =============================================================================
+// Shared State
+// =============================================================================
+
+/// Pads a value to its own cache line.
+///
+/// 128 bytes: x86_64 prefetches adjacent line pairs and Apple silicon uses
+/// 128-byte lines, so 64 would still share a prefetch unit.
+#[repr(align(128))]
+struct CachePadded<T>(T);
+
+impl<T> Deref for CachePadded<T> {
+    type Target = T;
+
+    #[inline]
+    fn deref(&self) -> &T {
+        &self.0
+    }
+}
+
+struct Shared<S> {
+    /// Total frames ever committed by the producer (wrapping).
+    write: CachePadded<AtomicUsize>,
+    /// Total frames ever released by the consumer (wrapping).
+    read: CachePadded<AtomicUsize>,
+    overflows: CachePadded<AtomicU64>,
+    underruns: CachePadded<AtomicU64>,
+    data: Box<[UnsafeCell<S>]>,
+    capacity: usize,
+    mask: usize,
+    num_channels: usize,
+    layout: FifoLayout,
+}
+
+// SAFETY: The producer only touches frames in `[write, read + capacity)` and
+// the consumer only frames in `[read, write)`. Indices are published with
+// Release and observed with Acquire, so a frame is never accessed by both
+// sides at once and its contents are visible before it changes hands.
+unsafe impl<S: Send> Sync for Shared<S> {}
+
+impl<S: Sample> Shared<S> {
+    /// Pointer to the first sample of the ring storage.
+    #[inline]
+    fn base(&self) -> *mut S {
+        // UnsafeCell<S> has the same layout as S
+        UnsafeCell::raw_get(self.data.as_ptr())
+    }
+
+    /// Raw slice pair covering `frames` frames of one channel from `start`.
+    #[inline]
+    fn planar_parts(&self, channel: usize, start: usize, frames: usize) -> [(*mut S, usize); 2] {
+        let offset = start & self.mask;
+        let first = frames.min(self.capacity - offset);
+        // SAFETY: channel < num_channels, so both ranges lie inside `data`.
+        let base = unsafe { self.base().add(channel * self.capacity) };
+        [(unsafe { base.add(offset) }, first), (base, frames - first)]
+    }
+
+    /// Raw slice pair covering `frames` interleaved frames from `start`.
+    #[inline]
+    fn interleaved_parts(&self, start: usize, frames: usize) -> [(*mut S, usize); 2] {
+        let offset = start & self.mask;
+        let first = frames.min(self.capacity - offset);
+        let ch = self.num_channels;
+        // SAFETY: offset + first <= capacity, so both ranges lie inside `data`.
+        let base = self.base();
+        [(unsafe { base.add(offset * ch) }, first * ch), (base, (frames - first) * ch)]
+    }
+}
+
+// =============================================================================
+// AudioFifo
+// =============================================================================
+
+/// Entry point that creates a connected producer/consumer pair.
+pub struct AudioFifo;
+
+impl AudioFifo {
+    /// Create a FIFO holding at least `capacity` frames of `num_channels` channels.
+    ///
+    /// Capacity is rounded up to a power of two (minimum 2) so index wrapping
+    /// is a mask. Allocates the whole ring; call from the setup thread, e.g.
+    /// in `Plugin::prepare()`.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `num_channels` is zero or greater than [`MAX_CHANNELS`].
+    pub fn pair<S: Sample>(
+        num_channels: usize,
+        capacity: usize,
+        layout: FifoLayout,
+    ) -> (AudioFifoProducer<S>, AudioFifoConsumer<S>) {
+        assert!(
+            (1..=MAX_CHANNELS).contains(&num_channels),
+            "AudioFifo num_channels must be 1..={}",
+            MAX_CHANNELS
+        );
+        let capacity = capacity.max(2).next_power_of_two();
+        let data = (0..capacity * num_channels)
+            .map(|_| UnsafeCell::new(S::ZERO))
+            .collect();
+        let shared = Arc::new(Shared {
+            write: CachePadded(AtomicUsize::new(0)),
+            read: CachePadded(AtomicUsize::new(0)),
+            overflows: CachePadded(AtomicU64::new(0)),
+            underruns: CachePadded(AtomicU64::new(0)),
+            data,
+            capacity,
+            mask: capacity - 1,
+            num_channels,
+            layout,
+        });
+        let producer = AudioFifoProducer {
+            shared: Arc::clone(&shared),
+            write: 0,
+            read_cache: 0,
+        };
+        let consumer = AudioFifoConsumer {
+            shared,
+            read: 0,
+            write_cache: 0,
+        };
+        (producer, consumer)
+    }
+}
+
+// =============================================================================
+// AudioFifoProducer
+// =============================================================================
+
+/// Writing side of an [`AudioFifo`]. Owned by exactly one thread.
+pub struct AudioFifoProducer<S: Sample = f32> {
+    shared: Arc<Shared<S>>,
+    /// Local copy of the write index (only this side stores it).
+    write: usize,
+    /// Last observed read index.
+    read_cache: usize,
+}
+
+impl<S: Sample> AudioFifoProducer<S> {
+    /// Ring capacity in frames.
+    #[inline]
+    pub fn capacity(&self) -> usize {
+        self.shared.capacity
+    }
+
+    /// Number of channels per frame.
+    #[inline]
+    pub fn num_channels(&self) -> usize {
+        self.shared.num_channels
+    }
+
+    /// Storage layout.
+    #[inline]
+    pub fn layout(&self) -> FifoLayout {
+        self.shared.layout
+    }
+
+    /// Frames that can be written right now.
+    #[inline]
+    pub fn available_write(&mut self) -> usize {
+        self.read_cache = self.shared.read.load(Ordering::Acquire);
+        self.shared.capacity - self.write.wrapping_sub(self.read_cache)
+    }
+
+    /// Total frames dropped because the ring was full.
+    #[inline]
+    pub fn overflow_count(&self) -> u64 {
+        self.shared.overflows.load(Ordering::Relaxed)
+    }
+
+    /// Total frames the consumer asked for but didn't get.
+    #[inline]
+    pub fn underrun_count(&self) -> u64 {
+        self.shared.underruns.load(Ordering::Relaxed)
+    }
+
+    /// Reserve up to `frames` frames of free space for zero-copy writing.
+    ///
+    /// The chunk may be shorter than requested; the shortfall is added to
+    /// the overflow count. Nothing becomes visible to the consumer until
+    /// [`WriteChunk::commit()`] is called; dropping the chunk discards it.
+    pub fn write_chunk(&mut self, frames: usize) -> WriteChunk<'_, S> {
+        // Only reload the consumer's index when the cached one falls short
+        let free = if frames > self.shared.capacity - self.write.wrapping_sub(self.read_cache) {
+            self.available_write()
+        } else {
+            frames
+        };
+        let granted = frames.min(free);
+        if granted < frames {
+            self.shared
+                .overflows
+                .fetch_add((frames - granted) as u64, Ordering::Relaxed);
+        }
+        WriteChunk {
+            start: self.write,
+            frames: granted,
+            producer: self,
+        }
+    }
+
+    /// Copy planar channels into the ring.
+    ///
+    /// Writes as many frames as the longest channel; shorter or missing
+    /// channels are padded with silence and extra channels are ignored.
+    /// Returns the number of frames written.
+    pub fn push<'s>(&mut self, channels: impl IntoIterator<Item = &'s [S]>) -> usize {
+        let mut sources: [&[S]; MAX_CHANNELS] = [&[]; MAX_CHANNELS];
+        let mut len = 0;
+        for (ch, source) in channels.into_iter().take(self.shared.num_channels).enumerate() {
+            len = len.max(source.len());
+            sources[ch] = source;
+        }
+
+        let mut chunk = self.write_chunk(len);
+        let n = chunk.frames();
+        match chunk.layout() {
+            FifoLayout::Planar => {
+                for (ch, source) in sources[..chunk.num_channels()].iter().enumerate() {
+                    let (head, tail) = chunk.channel_mut(ch);
+                    copy_padded(head, source);
+                    copy_padded(tail, source.get(head.len()..).unwrap_or(&[]));
+                }
+            }
+            FifoLayout::Interleaved => {
+                let num_channels = chunk.num_channels();
+                let (head, tail) = chunk.interleaved_mut();
+                let head_frames = head.len() / num_channels;
+                for (frame, out) in head.chunks_exact_mut(num_channels).enumerate() {
+                    gather_frame(out, &sources, frame);
+                }
+                for (frame, out) in tail.chunks_exact_mut(num_channels).enumerate() {
+                    gather_frame(out, &sources, head_frames + frame);
+                }
+            }
+        }
+        chunk.commit();
+        n
+    }
+
+    /// Copy interleaved frames into the ring.
+    ///
+    /// `samples.len()` should be a multiple of the channel count; a trailing
+    /// partial frame is ignored. Returns the number of frames written.
+    pub fn push_interleaved(&mut self, samples: &[S]) -> usize {
+        let num_channels = self.shared.num_channels;
+        let len = samples.len() / num_channels;
+
+        let mut chunk = self.write_chunk(len);
+        let n = chunk.frames();
+        match chunk.layout() {
+            FifoLayout::Interleaved => {
+                let (head, tail) = chunk.interleaved_mut();
+                let split = head.len();
+                head.copy_from_slice(&samples[..split]);
+                tail.copy_from_slice(&samples[split..split + tail.len()]);
+            }
+            FifoLayout::Planar => {
+                for ch in 0..num_channels {
+                    let (head, tail) = chunk.channel_mut(ch);
+                    for (i, out) in head.iter_mut().chain(tail.iter_mut()).enumerate() {
+                        *out = samples[i * num_channels + ch];
+                    }
+                }
+            }
+        }
+        chunk.commit();
+        n
+    }
+}
+
+/// Frames reserved by [`AudioFifoProducer::write_chunk()`].
+///
+/// Each accessor returns the region before the ring's wrap point and the
+/// region after it; the second slice is empty when the chunk doesn't wrap.
+pub struct WriteChunk<'a, S: Sample> {
+    producer: &'a mut AudioFifoProducer<S>,
+    start: usize,
+    frames: usize,
+}
+
+impl<S: Sample> WriteChunk<'_, S> {
+    /// Number of reserved frames.
+    #[inline]
+    pub fn frames(&self) -> usize {
+        self.frames
+    }
+
+    /// Whether no frames were reserved.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.frames == 0
+    }
+
+    /// Number of channels per frame.
+    #[inline]
+    pub fn num_channels(&self) -> usize {
+        self.producer.shared.num_channels
+    }
+
+    /// Storage layout.
+    #[inline]
+    pub fn layout(&self) -> FifoLayout {
+        self.producer.shared.layout
+    }
+
+    /// Writable slice pair for one channel ([`FifoLayout::Planar`] only).
+    ///
+    /// # Panics
+    ///
+    /// Panics if the FIFO is interleaved or `channel` is out of range.
+    #[inline]
+    pub fn channel_mut(&mut self, channel: usize) -> (&mut [S], &mut [S]) {
+        let shared = &*self.producer.shared;
+        assert!(shared.layout == FifoLayout::Planar, "channel_mut() requires a planar FIFO");
+        assert!(channel < shared.num_channels, "channel out of range");
+        let [(a, a_len), (b, b_len)] = shared.planar_parts(channel, self.start, self.frames);
+        // SAFETY: the range is producer-owned free space, and `&mut self`
+        // prevents handing out overlapping slices.
+        unsafe {
+            (
+                std::slice::from_raw_parts_mut(a, a_len),
+                std::slice::from_raw_parts_mut(b, b_len),
+            )
+        }
+    }
+
+    /// Writable interleaved slice pair ([`FifoLayout::Interleaved`] only).
+    ///
+    /// # Panics
+    ///
+    /// Panics if the FIFO is planar.
+    #[inline]
+    pub fn interleaved_mut(&mut self) -> (&mut [S], &mut [S]) {
+        let shared = &*self.producer.shared;
+        assert!(
+            shared.layout == FifoLayout::Interleaved,
+            "interleaved_mut() requires an interleaved FIFO"
+        );
+        let [(a, a_len), (b, b_len)] = shared.interleaved_parts(self.start, self.frames);
+        // SAFETY: as in channel_mut().
+        unsafe {
+            (
+                std::slice::from_raw_parts_mut(a, a_len),
+                std::slice::from_raw_parts_mut(b, b_len),
+            )
+        }
+    }
+
+    /// Publish the chunk to the consumer.
+    #[inline]
+    pub fn commit(self) {
+        let write = self.start.wrapping_add(self.frames);
+        self.producer.write = write;
+        self.producer.shared.write.store(write, Ordering::Release);
+    }
+}
+
+// =============================================================================
+// AudioFifoConsumer
+// =============================================================================
+
+/// Reading side of an [`AudioFifo`]. Owned by exactly one thread.
+pub struct AudioFifoConsumer<S: Sample = f32> {
+    shared: Arc<Shared<S>>,
+    /// Local copy of the read index (only this side stores it).
+    read: usize,
+    /// Last observed write index.
+    write_cache: usize,
+}
+
+impl<S: Sample> AudioFifoConsumer<S> {
+    /// Ring capacity in frames.
+    #[inline]
+    pub fn capacity(&self) -> usize {
+        self.shared.capacity
+    }
+
+    /// Number of channels per frame.
+    #[inline]
+    pub fn num_channels(&self) -> usize {
+        self.shared.num_channels
+    }
+
+    /// Storage layout.
+    #[inline]
+    pub fn layout(&self) -> FifoLayout {
+        self.shared.layout
+    }
+
+    /// Frames that can be read right now.
+    #[inline]
+    pub fn available_read(&mut self) -> usize {
+        self.write_cache = self.shared.write.load(Ordering::Acquire);
+        self.write_cache.wrapping_sub(self.read)
+    }
+
+    /// Total frames dropped because the ring was full.
+    #[inline]
+    pub fn overflow_count(&self) -> u64 {
+        self.shared.overflows.load(Ordering::Relaxed)
+    }
+
+    /// Total frames asked for but not available.
+    #[inline]
+    pub fn underrun_count(&self) -> u64 {
+        self.shared.underruns.load(Ordering::Relaxed)
+    }
+
+    /// Borrow up to `frames` filled frames for zero-copy reading.
+    ///
+    /// The chunk may be shorter than requested; the shortfall is added to
+    /// the underrun count. Frames are released back to the producer by
+    /// [`ReadChunk::commit()`]; dropping the chunk leaves them in the ring.
+    pub fn read_chunk(&mut self, frames: usize) -> ReadChunk<'_, S> {
+        // Only reload the producer's index when the cached one falls short
+        let filled = if frames > self.write_cache.wrapping_sub(self.read) {
+            self.available_read()
+        } else {
+            frames
+        };
+        let granted = frames.min(filled);
+        if granted < frames {
+            self.shared
+                .underruns
+                .fetch_add((frames - granted) as u64, Ordering::Relaxed);
+        }
+        ReadChunk {
+            start: self.read,
+            frames: granted,
+            consumer: self,
+        }
+    }
+
+    /// Drop up to `frames` frames without reading them. Returns the number dropped.
+    ///
+    /// Doesn't count as an underrun.
+    pub fn discard(&mut self, frames: usize) -> usize {
+        let n = frames.min(self.available_read());
+        self.release(n);
+        n
+    }
+
+    /// Copy frames into planar channel slices.
+    ///
+    /// Reads as many frames as the longest output slice. If fewer are
+    /// available, the rest of every slice is filled with silence and counted
+    /// as underrun. Extra output channels are filled with silence. Returns
+    /// the number of frames read from the ring.
+    pub fn pop<'s>(&mut self, channels: impl IntoIterator<Item = &'s mut [S]>) -> usize {
+        let mut outputs: [&mut [S]; MAX_CHANNELS] = std::array::from_fn(|_| Default::default());
+        let mut num_outputs = 0;
+        let mut len = 0;
+        for (ch, output) in channels.into_iter().take(MAX_CHANNELS).enumerate() {
+            len = len.max(output.len());
+            outputs[ch] = output;
+            num_outputs = ch + 1;
+        }
+        let outputs = &mut outputs[..num_outputs];
+
+        let chunk = self.read_chunk(len);
+        let n = chunk.frames();
+        let num_channels = chunk.num_channels();
+        match chunk.layout() {
+            FifoLayout::Planar => {
+                for (ch, output) in outputs.iter_mut().enumerate().take(num_channels) {
+                    let (head, tail) = chunk.channel(ch);
+                    let head_len = head.len().min(output.len());
+                    output[..head_len].copy_from_slice(&head[..head_len]);
+                    let tail_len = tail.len().min(output.len() - head_len);
+                    output[head_len..head_len + tail_len].copy_from_slice(&tail[..tail_len]);
+                }
+            }
+            FifoLayout::Interleaved => {
+                let (head, tail) = chunk.interleaved();
+                let frames = head.chunks_exact(num_channels).chain(tail.chunks_exact(num_channels));
+                for (i, frame) in frames.enumerate() {
+                    for (output, &sample) in outputs.iter_mut().zip(frame) {
+                        if let Some(out) = output.get_mut(i) {
+                            *out = sample;
+                        }
+                    }
+                }
+            }
+        }
+        chunk.commit();
+
+        for (ch, output) in outputs.iter_mut().enumerate() {
+            let start = if ch < num_channels { n.min(output.len()) } else { 0 };
+            output[start..].fill(S::ZERO);
+        }
+        n
+    }
+
+    /// Copy frames into an interleaved slice.
+    ///
+    /// Like [`pop()`](Self::pop): missing frames are filled with silence and
+    /// counted as underrun. Returns the number of frames read from the ring.
+    pub fn pop_interleaved(&mut self, out: &mut [S]) -> usize {
+        let num_channels = self.shared.num_channels;
+        let len = out.len() / num_channels;
+
+        let chunk = self.read_chunk(len);
+        let n = chunk.frames();
+        match chunk.layout() {
+            FifoLayout::Interleaved => {
+                let (head, tail) = chunk.interleaved();
+                out[..head.len()].copy_from_slice(head);
+                out[head.len()..head.len() + tail.len()].copy_from_slice(tail);
+            }
+            FifoLayout::Planar => {
+                for ch in 0..num_channels {
+                    let (head, tail) = chunk.channel(ch);
+                    for (i, &sample) in head.iter().chain(tail).enumerate() {
+                        out[i * num_channels + ch] = sample;
+                    }
+                }
+            }
+        }
+        chunk.commit();
+
+        out[n * num_channels..].fill(S::ZERO);
+        n
+    }
+
+    #[inline]
+    fn release(&mut self, frames: usize) {
+        self.read = self.read.wrapping_add(frames);
+        self.shared.read.store(self.read, Ordering::Release);
+    }
+}
+
+/// Frames borrowed by [`AudioFifoConsumer::read_chunk()`].
+///
+/// Each accessor returns the region before the ring's wrap point and the
+/// region after it; the second slice is empty when the chunk doesn't wrap.
+pub struct ReadChunk<'a, S: Sample> {
+    consumer: &'a mut AudioFifoConsumer<S>,
+    start: usize,
+    frames: usize,
+}
+
+impl<S: Sample> ReadChunk<'_, S> {
+    /// Number of borrowed frames.
+    #[inline]
+    pub fn frames(&self) -> usize {
+        self.frames
+    }
+
+    /// Whether no frames were borrowed.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.frames == 0
+    }
+
+    /// Number of channels per frame.
+    #[inline]
+    pub fn num_channels(&self) -> usize {
+        self.consumer.shared.num_channels
+    }
+
+    /// Storage layout.
+    #[inline]
+    pub fn layout(&self) -> FifoLayout {
+        self.consumer.shared.layout
+    }
+
+    /// Slice pair for one channel ([`FifoLayout::Planar`] only).
+    ///
+    /// # Panics
+    ///
+    /// Panics if the FIFO is interleaved or `channel` is out of range.
+    #[inline]
+    pub fn channel(&self, channel: usize) -> (&[S], &[S]) {
+        let shared = &*self.consumer.shared;
+        assert!(shared.layout == FifoLayout::Planar, "channel() requires a planar FIFO");
+        assert!(channel < shared.num_channels, "channel out of range");
+        let [(a, a_len), (b, b_len)] = shared.planar_parts(channel, self.start, self.frames);
+        // SAFETY: the range is consumer-owned filled space; the producer
+        // won't touch it until the chunk is committed.
+        unsafe {
+            (
+                std::slice::from_raw_parts(a, a_len),
+                std::slice::from_raw_parts(b, b_len),
+            )
+        }
+    }
+
+    /// Interleaved slice pair ([`FifoLayout::Interleaved`] only).
+    ///
+    /// # Panics
+    ///
+    /// Panics if the FIFO is planar.
+    #[inline]
+    pub fn interleaved(&self) -> (&[S], &[S]) {
+        let shared = &*self.consumer.shared;
+        assert!(
+            shared.layout == FifoLayout::Interleaved,
+            "interleaved() requires an interleaved FIFO"
+        );
+        let [(a, a_len), (b, b_len)] = shared.interleaved_parts(self.start, self.frames);
+        // SAFETY: as in channel().
+        unsafe {
+            (
+                std::slice::from_raw_parts(a, a_len),
+                std::slice::from_raw_parts(b, b_len),
+            )
+        }
+    }
+
+    /// Release the frames back to the producer.
+    #[inline]
+    pub fn commit(self) {
+        self.consumer.release(self.frames);
+    }
+}
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+/// Copy `source` into `dest`, padding with silence.
+#[inline]
+fn copy_padded<S: Sample>(dest: &mut [S], source: &[S]) {
+    let n = dest.len().min(source.len());
+    dest[..n].copy_from_slice(&source[..n]);
+    dest[n..].fill(S::ZERO);
+}
+
+/// Fill one interleaved frame from planar sources, padding with silence.
+#[inline]
+fn gather_frame<S: Sample>(out: &mut [S], sources: &[&[S]], frame: usize) {
+    for (sample, source) in out.iter_mut().zip(sources) {
+        *sample = source.get(frame).copied().unwrap_or(S::ZERO);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::thread;
+
+    #[test]
+    fn test_planar_roundtrip_and_wrap() {
+        let (mut tx, mut rx) = AudioFifo::pair::<f32>(2, 6, FifoLayout::Planar);
+        assert_eq!(tx.capacity(), 8);
+
+        // Advance the indices so the next write wraps
+        assert_eq!(tx.push([&[0.0; 5][..], &[0.0; 5][..]]), 5);
+        assert_eq!(rx.discard(5), 5);
+
+        let left = [1.0, 2.0, 3.0, 4.0, 5.0, 6.0];
+        let right = [-1.0, -2.0, -3.0];
+        assert_eq!(tx.push([&left[..], &right[..]]), 6);
+
+        let chunk = rx.read_chunk(6);
+        let (head, tail) = chunk.channel(0);
+        assert_eq!((head, tail), (&[1.0, 2.0, 3.0][..], &[4.0, 5.0, 6.0][..]));
+        let (head, tail) = chunk.channel(1);
+        assert_eq!((head, tail), (&[-1.0, -2.0, -3.0][..], &[0.0, 0.0, 0.0][..]));
+        chunk.commit();
+        assert_eq!(rx.available_read(), 0);
+    }
+
+    #[test]
+    fn test_interleaved_layout_conversions() {
+        let (mut tx, mut rx) = AudioFifo::pair::<f64>(2, 4, FifoLayout::Interleaved);
+        assert_eq!(tx.push([&[1.0, 2.0][..], &[10.0, 20.0][..]]), 2);
+        assert_eq!(tx.push_interleaved(&[3.0, 30.0]), 1);
+
+        {
+            // Not committed: frames stay in the ring
+            let chunk = rx.read_chunk(2);
+            assert_eq!(chunk.interleaved().0, &[1.0, 10.0, 2.0, 20.0]);
+        }
+
+        let mut left = [0.0; 3];
+        let mut right = [0.0; 3];
+        assert_eq!(rx.pop([&mut left[..], &mut right[..]]), 3);
+        assert_eq!((left, right), ([1.0, 2.0, 3.0], [10.0, 20.0, 30.0]));
+
+        // Planar storage, interleaved I/O
+        let (mut tx, mut rx) = AudioFifo::pair::<f32>(2, 4, FifoLayout::Planar);
+        tx.push_interleaved(&[1.0, -1.0, 2.0, -2.0, 3.0]);
+        let mut out = [9.0; 4];
+        assert_eq!(rx.pop_interleaved(&mut out), 2);
+        assert_eq!(out, [1.0, -1.0, 2.0, -2.0]);
+    }
+
+    #[test]
+    fn test_overflow_and_underrun_counters() {
+        let (mut tx, mut rx) = AudioFifo::pair::<f32>(1, 4, FifoLayout::Planar);
+        assert_eq!(tx.push([&[1.0; 6][..]]), 4);
+        assert_eq!(tx.overflow_count(), 2);
+        assert_eq!(tx.available_write(), 0);
+
+        let mut out = [9.0; 6];
+        assert_eq!(rx.pop([&mut out[..]]), 4);
+        assert_eq!(out, [1.0, 1.0, 1.0, 1.0, 0.0, 0.0]);
+        assert_eq!(rx.underrun_count(), 2);
+
+        // Sizing requests by availability never touches the counters
+        let n = rx.available_read();
+        rx.read_chunk(n).commit();
+        let n = tx.available_write();
+        tx.write_chunk(n).commit();
+        assert_eq!((rx.overflow_count(), tx.underrun_count()), (2, 2));
+    }
+
+    /// Producer and consumer on separate threads, odd block sizes so
+    /// chunks straddle the wrap point. Every frame must arrive exactly once,
+    /// in order, with its channels intact.
+    fn stress(layout: FifoLayout) {
+        const FRAMES: u32 = 200_000;
+        let (mut tx, mut rx) = AudioFifo::pair::<f32>(2, 64, layout);
+
+        let producer = thread::spawn(move || {
+            let mut next = 0u32;
+            let mut left = [0.0f32; 7];
+            let mut right = [0.0f32; 7];
+            while next < FRAMES {
+                let n = tx.available_write().min(7).min((FRAMES - next) as usize);
+                for i in 0..n {
+                    left[i] = (next + i as u32) as f32;
+                    right[i] = -((next + i as u32) as f32);
+                }
+                assert_eq!(tx.push([&left[..n], &right[..n]]), n);
+                next += n as u32;
+                if n == 0 {
+                    thread::yield_now();
+                }
+            }
+            assert_eq!(tx.overflow_count(), 0);
+        });
+
+        let mut expected = 0u32;
+        while expected < FRAMES {
+            let n = rx.available_read().min(13);
+            if n == 0 {
+                thread::yield_now();
+            }
+            let chunk = rx.read_chunk(n);
+            for i in 0..chunk.frames() {
+                let (l, r) = match layout {
+                    FifoLayout::Planar => {
+                        let (lh, lt) = chunk.channel(0);
+                        let (rh, rt) = chunk.channel(1);
+                        let at = |h: &[f32], t: &[f32]| if i < h.len() { h[i] } else { t[i - h.len()] };
+                        (at(lh, lt), at(rh, rt))
+                    }
+                    FifoLayout::Interleaved => {
+                        let (h, t) = chunk.interleaved();
+                        let at = |j: usize| if j < h.len() { h[j] } else { t[j - h.len()] };
+                        (at(i * 2), at(i * 2 + 1))
+                    }
+                };
+                assert_eq!((l, r), (expected as f32, -(expected as f32)));
+                expected += 1;
+            }
+            chunk.commit();
+        }
+        producer.join().unwrap();
+        assert_eq!(rx.underrun_count(), 0);
+    }
+
+    #[test]
+    fn test_threaded_ordering_planar() {
+        stress(FifoLayout::Planar);
+    }
+
+    #[test]
+    fn test_threaded_ordering_interleaved() {
+        stress(FifoLayout::Interleaved);
+    }
+}
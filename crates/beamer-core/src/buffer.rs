@@ -78,6 +78,7 @@
 //! }
 //! ```
 
+use crate::buffer_ops;
 use crate::sample::Sample;
 use crate::types::{MAX_AUX_BUSES, MAX_CHANNELS};
 
@@ -116,6 +117,8 @@ pub struct Buffer<'a, S: Sample = f32> {
     inputs: [Option<&'a [S]>; MAX_CHANNELS],
     /// Output channel slices (mutable audio to host)
     outputs: [Option<&'a mut [S]>; MAX_CHANNELS],
+    /// Channels whose input shares memory with the output at the same index
+    in_place: [bool; MAX_CHANNELS],
     /// Number of active input channels
     num_input_channels: usize,
     /// Number of active output channels
@@ -153,12 +156,37 @@ impl<'a, S: Sample> Buffer<'a, S> {
         Self {
             inputs: input_arr,
             outputs: output_arr,
+            in_place: [false; MAX_CHANNELS],
             num_input_channels,
             num_output_channels,
             num_samples,
         }
     }
 
+    /// Create a buffer where some input channels share memory with outputs.
+    ///
+    /// A `None` input marks the channel as in-place: its input samples live
+    /// in the output channel at the same index. This is how the wrapper
+    /// passes host buffers that alias input and output, without ever holding
+    /// a `&[S]` and a `&mut [S]` to the same memory. `None` without a
+    /// matching output is a missing channel.
+    ///
+    /// This is called by the VST3 wrapper, not by plugin code.
+    #[inline]
+    pub fn new_in_place(
+        inputs: impl IntoIterator<Item = Option<&'a [S]>>,
+        outputs: impl IntoIterator<Item = &'a mut [S]>,
+        num_samples: usize,
+    ) -> Self {
+        let mut buffer = Self::new(std::iter::empty(), outputs, num_samples);
+        for (i, slice) in inputs.into_iter().take(MAX_CHANNELS).enumerate() {
+            buffer.inputs[i] = slice;
+            buffer.in_place[i] = slice.is_none() && buffer.outputs[i].is_some();
+            buffer.num_input_channels = i + 1;
+        }
+        buffer
+    }
+
     // =========================================================================
     // Buffer Info
     // =========================================================================
@@ -193,15 +221,31 @@ impl<'a, S: Sample> Buffer<'a, S> {
         self.num_input_channels == 1 && self.num_output_channels == 1
     }
 
+    /// Returns true if the input channel shares memory with the output
+    /// channel at the same index.
+    ///
+    /// Writing such an output overwrites the input. See
+    /// [`in_place_channels()`](Self::in_place_channels) for processing that
+    /// works either way.
+    #[inline]
+    pub fn is_in_place(&self, channel: usize) -> bool {
+        self.in_place.get(channel).copied().unwrap_or(false)
+    }
+
     // =========================================================================
     // Channel Access
     // =========================================================================
 
     /// Get an input channel by index.
     ///
-    /// Returns an empty slice if the channel doesn't exist.
+    /// Returns an empty slice if the channel doesn't exist. For in-place
+    /// channels this reads the output memory, so it reflects anything
+    /// already written to that output.
     #[inline]
     pub fn input(&self, channel: usize) -> &[S] {
+        if self.is_in_place(channel) {
+            return self.outputs[channel].as_deref().map_or(&[], |ch| &ch[..self.num_samples]);
+        }
         self.inputs
             .get(channel)
             .and_then(|opt| opt.as_ref())
@@ -240,12 +284,13 @@ impl<'a, S: Sample> Buffer<'a, S> {
     // =========================================================================
 
     /// Iterate over all input channels.
+    ///
+    /// In-place channels read the output memory, as with [`input()`](Self::input).
     #[inline]
     pub fn inputs(&self) -> impl Iterator<Item = &[S]> + '_ {
-        let n = self.num_samples;
-        self.inputs[..self.num_input_channels]
-            .iter()
-            .filter_map(move |opt| opt.as_ref().map(|ch| &ch[..n]))
+        (0..self.num_input_channels)
+            .filter(|&ch| self.inputs[ch].is_some() || self.in_place[ch])
+            .map(|ch| self.input(ch))
     }
 
     /// Iterate over all output channels mutably.
@@ -259,8 +304,12 @@ impl<'a, S: Sample> Buffer<'a, S> {
 
     /// Iterate over paired (input, output) channels.
     ///
-    /// This is the most common pattern for in-place processing.
-    /// Only yields channels that exist in both input and output.
+    /// This is the most common pattern for per-sample processing.
+    /// Only yields channels that exist in both input and output, and skips
+    /// in-place channels, which can't be split into two slices. Processors
+    /// that opt into [`supports_in_place()`](crate::AudioProcessor::supports_in_place)
+    /// use [`channel_pairs()`](Self::channel_pairs) or
+    /// [`in_place_channels()`](Self::in_place_channels) instead.
     ///
     /// # Example
     ///
@@ -286,6 +335,74 @@ impl<'a, S: Sample> Buffer<'a, S> {
             })
     }
 
+    /// Iterate over paired channels, distinguishing in-place channels.
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// for pair in buffer.channel_pairs() {
+    ///     match pair {
+    ///         ChannelPair::Separate(input, output) => self.filter.process(input, output),
+    ///         ChannelPair::InPlace(io) => self.filter.process_in_place(io),
+    ///     }
+    /// }
+    /// ```
+    #[inline]
+    pub fn channel_pairs(&mut self) -> impl Iterator<Item = ChannelPair<'_, S>> + use<'_, 'a, S> {
+        let n = self.num_samples;
+        let num_pairs = self.num_input_channels.min(self.num_output_channels);
+        self.inputs[..num_pairs]
+            .iter()
+            .zip(self.outputs[..num_pairs].iter_mut())
+            .zip(&self.in_place[..num_pairs])
+            .filter_map(move |((i_opt, o_opt), &in_place)| match (i_opt.as_ref(), o_opt.as_mut()) {
+                (Some(i), Some(o)) => Some(ChannelPair::Separate(&i[..n], &mut o[..n])),
+                (None, Some(o)) if in_place => Some(ChannelPair::InPlace(&mut o[..n])),
+                _ => None,
+            })
+    }
+
+    /// Get one paired channel by index, distinguishing in-place channels.
+    ///
+    /// Returns `None` if the channel has no input/output pair; see
+    /// [`channel_pairs()`](Self::channel_pairs).
+    #[inline]
+    pub fn channel_pair(&mut self, channel: usize) -> Option<ChannelPair<'_, S>> {
+        let n = self.num_samples;
+        if channel >= self.num_input_channels.min(self.num_output_channels) {
+            return None;
+        }
+        match (self.inputs[channel], self.outputs[channel].as_mut()) {
+            (Some(i), Some(o)) => Some(ChannelPair::Separate(&i[..n], &mut o[..n])),
+            (None, Some(o)) if self.in_place[channel] => Some(ChannelPair::InPlace(&mut o[..n])),
+            _ => None,
+        }
+    }
+
+    /// Iterate over paired output channels, each holding its input samples.
+    ///
+    /// Separate channels are copied from input to output first; in-place
+    /// channels already hold the input and cost nothing. Processing then runs
+    /// in place on every channel.
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// for channel in buffer.in_place_channels() {
+    ///     buffer_ops::scale(channel, gain);
+    /// }
+    /// ```
+    #[inline]
+    pub fn in_place_channels(&mut self) -> impl Iterator<Item = &mut [S]> + use<'_, 'a, S> {
+        self.channel_pairs().map(|pair| match pair {
+            ChannelPair::Separate(input, output) => {
+                output.copy_from_slice(input);
+                output
+            }
+            ChannelPair::InPlace(io) => io,
+        })
+    }
+
     // =========================================================================
     // Bulk Operations
     // =========================================================================
@@ -293,7 +410,7 @@ impl<'a, S: Sample> Buffer<'a, S> {
     /// Copy all input channels to output channels.
     ///
     /// Useful for bypass or passthrough. Only copies channels that exist
-    /// in both input and output.
+    /// in both input and output; in-place channels need no copy.
     pub fn copy_to_output(&mut self) {
         let num_channels = self.num_input_channels.min(self.num_output_channels);
         let n = self.num_samples;
@@ -316,15 +433,121 @@ impl<'a, S: Sample> Buffer<'a, S> {
 
     /// Apply a gain factor to all output channels.
     pub fn apply_output_gain(&mut self, gain: S) {
+        for output in self.outputs_mut() {
+            buffer_ops::scale(output, gain);
+        }
+    }
+
+    /// Apply a gain ramping linearly from `from` to `to` across the block.
+    ///
+    /// `to` is reached on the first sample of the next block, so passing
+    /// the previous block's `to` as `from` gives a click-free ramp.
+    pub fn apply_output_gain_ramp(&mut self, from: S, to: S) {
+        for output in self.outputs_mut() {
+            buffer_ops::scale_linear_ramp(output, from, to);
+        }
+    }
+
+    /// Apply a gain ramping exponentially (linearly in dB) from `from` to `to`.
+    ///
+    /// Falls back to a linear ramp if either gain is zero.
+    pub fn apply_output_gain_ramp_exp(&mut self, from: S, to: S) {
+        for output in self.outputs_mut() {
+            buffer_ops::scale_exp_ramp(output, from, to);
+        }
+    }
+
+    /// Blend the dry inputs into the processed outputs:
+    /// `output = output * wet + input * dry`.
+    ///
+    /// Output channels without a matching input are scaled by `wet` only.
+    ///
+    /// In-place channels no longer hold the dry signal once processed, so
+    /// this can't mix them. Processors that opt into
+    /// [`supports_in_place()`](crate::AudioProcessor::supports_in_place)
+    /// must copy the dry input before processing and mix it themselves.
+    ///
+    /// # Panics
+    ///
+    /// Panics in debug builds if any channel is in place. Release builds
+    /// scale such channels by `wet` only.
+    pub fn mix_dry_wet(&mut self, dry: S, wet: S) {
+        debug_assert!(
+            !self.in_place[..self.num_output_channels].contains(&true),
+            "mix_dry_wet() needs the dry input; in-place channels must mix a dry copy"
+        );
         let n = self.num_samples;
-        for opt in self.outputs[..self.num_output_channels].iter_mut() {
-            if let Some(output) = opt.as_mut() {
-                for sample in &mut output[..n] {
-                    *sample = *sample * gain;
-                }
+        let num_pairs = self.num_input_channels.min(self.num_output_channels);
+        for (ch, opt) in self.outputs[..self.num_output_channels].iter_mut().enumerate() {
+            let Some(output) = opt.as_mut() else { continue };
+            match self.inputs[ch] {
+                Some(input) if ch < num_pairs => buffer_ops::mix(&mut output[..n], &input[..n], wet, dry),
+                _ => buffer_ops::scale(&mut output[..n], wet),
             }
         }
     }
+
+    /// Apply a constant-power pan to output channels 0 and 1.
+    ///
+    /// `pan` ranges from `-1.0` (left) to `1.0` (right). Does nothing unless
+    /// there are at least two output channels.
+    pub fn pan_outputs(&mut self, pan: S) {
+        if self.num_output_channels < 2 {
+            return;
+        }
+        let (left, right) = buffer_ops::pan_gains(pan);
+        let n = self.num_samples;
+        if let [Some(l), Some(r), ..] = &mut self.outputs[..] {
+            buffer_ops::scale(&mut l[..n], left);
+            buffer_ops::scale(&mut r[..n], right);
+        }
+    }
+
+    /// Sum all input channels into `dst`, scaled by `gain`.
+    ///
+    /// Pass `1.0 / num_input_channels` as `gain` for an average.
+    pub fn sum_inputs_to_mono(&self, dst: &mut [S], gain: S) {
+        buffer_ops::sum_to_mono(dst, self.inputs(), gain);
+    }
+
+    /// Add a bus (e.g. an aux return) into the outputs, scaled by `gain`.
+    ///
+    /// Channels are matched by index; extra channels on either side are
+    /// ignored.
+    pub fn add_to_outputs(&mut self, bus: &AuxInput<'_, S>, gain: S) {
+        for (ch, output) in self.outputs_mut().enumerate() {
+            buffer_ops::mix_add(output, bus.input(ch), gain);
+        }
+    }
+
+    /// Split the main bus into an input view and an output view.
+    ///
+    /// Gives simultaneous read access to the inputs and write access to the
+    /// outputs through the same bus views used for auxiliary buses.
+    /// In-place channels appear as missing in the input view.
+    #[inline]
+    pub fn split_main_bus(&mut self) -> (AuxInput<'_, S>, AuxOutput<'_, 'a, S>) {
+        let num_samples = self.num_samples;
+        (
+            AuxInput {
+                channels: &self.inputs[..self.num_input_channels],
+                num_samples,
+            },
+            AuxOutput {
+                channels: &mut self.outputs[..self.num_output_channels],
+                num_samples,
+            },
+        )
+    }
+}
+
+/// A main-bus channel as yielded by [`Buffer::channel_pairs()`].
+pub enum ChannelPair<'b, S: Sample = f32> {
+    /// Input and output live in separate memory.
+    Separate(&'b [S], &'b mut [S]),
+    /// The host passed the same memory for input and output. The slice
+    /// holds the input samples until overwritten.
+    InPlace(&'b mut [S]),
 }
 
 // =============================================================================
@@ -538,6 +761,26 @@ impl<'a, S: Sample> AuxiliaryBuffers<'a, S> {
         })
     }
 
+    /// Get all auxiliary output buses at once, indexed by bus.
+    ///
+    /// Unlike [`iter_outputs()`](Self::iter_outputs), bus indices are
+    /// preserved: entry `n` is `None` if bus `n` doesn't exist or has no channels.
+    pub fn outputs_by_bus(&mut self) -> [Option<AuxOutput<'_, 'a, S>>; MAX_AUX_BUSES] {
+        let num_samples = self.num_samples;
+        let mut views: [Option<AuxOutput<'_, 'a, S>>; MAX_AUX_BUSES] =
+            std::array::from_fn(|_| None);
+        let buses = self.outputs.iter_mut().zip(self.output_channel_counts.iter());
+        for (view, (channels, &count)) in views.iter_mut().zip(buses) {
+            if count > 0 {
+                *view = Some(AuxOutput {
+                    channels: &mut channels[..count],
+                    num_samples,
+                });
+            }
+        }
+        views
+    }
+
     // =========================================================================
     // Iterators
     // =========================================================================
@@ -703,6 +946,11 @@ impl<'a, S: Sample> AuxInput<'a, S> {
             .fold(S::ZERO, |a, b| a.max(b))
     }
 
+    /// Sum all channels into `dst`, scaled by `gain`.
+    pub fn sum_to_mono(&self, dst: &mut [S], gain: S) {
+        buffer_ops::sum_to_mono(dst, self.iter_inputs(), gain);
+    }
+
     /// Calculate the average absolute level of a channel.
     ///
     /// Returns zero if the channel doesn't exist or is empty.
@@ -754,6 +1002,15 @@ pub struct AuxOutput<'borrow, 'data, S: Sample = f32> {
 }
 
 impl<'borrow, 'data, S: Sample> AuxOutput<'borrow, 'data, S> {
+    /// Create a view with no channels, standing in for a disconnected bus.
+    #[inline]
+    pub fn disconnected(num_samples: usize) -> Self {
+        Self {
+            channels: &mut [],
+            num_samples,
+        }
+    }
+
     /// Number of samples in each channel.
     #[inline]
     pub fn num_samples(&self) -> usize {
@@ -822,5 +1079,116 @@ impl<'borrow, 'data, S: Sample> AuxOutput<'borrow, 'data, S> {
             }
         }
     }
+
+    /// Apply a gain factor to all channels.
+    pub fn apply_gain(&mut self, gain: S) {
+        for ch in self.iter_outputs() {
+            buffer_ops::scale(ch, gain);
+        }
+    }
+
+    /// Apply a gain ramping linearly from `from` to `to` across the block.
+    ///
+    /// See [`Buffer::apply_output_gain_ramp()`].
+    pub fn apply_gain_ramp(&mut self, from: S, to: S) {
+        for ch in self.iter_outputs() {
+            buffer_ops::scale_linear_ramp(ch, from, to);
+        }
+    }
+
+    /// Apply a gain ramping exponentially from `from` to `to` across the block.
+    ///
+    /// See [`Buffer::apply_output_gain_ramp_exp()`].
+    pub fn apply_gain_ramp_exp(&mut self, from: S, to: S) {
+        for ch in self.iter_outputs() {
+            buffer_ops::scale_exp_ramp(ch, from, to);
+        }
+    }
+
+    /// Apply a constant-power pan to channels 0 and 1.
+    ///
+    /// See [`Buffer::pan_outputs()`].
+    pub fn pan(&mut self, pan: S) {
+        let (left, right) = buffer_ops::pan_gains(pan);
+        let n = self.num_samples;
+        if let [Some(l), Some(r), ..] = &mut self.channels[..] {
+            buffer_ops::scale(&mut l[..n], left);
+            buffer_ops::scale(&mut r[..n], right);
+        }
+    }
+
+    /// Add `source` into this bus channel by channel, scaled by `gain`.
+    pub fn add_from(&mut self, source: &AuxInput<'_, S>, gain: S) {
+        for (ch, output) in self.iter_outputs().enumerate() {
+            buffer_ops::mix_add(output, source.input(ch), gain);
+        }
+    }
+
+    /// Overwrite this bus with a channel-matrix mix of `source`.
+    ///
+    /// `matrix` is row-major with one row per output channel and
+    /// `source.num_channels()` columns: `out[o] = Σ matrix[o][i] * in[i]`.
+    /// Missing rows produce silence.
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// // Stereo to mono-compatible M/S
+    /// let (input, mut output) = buffer.split_main_bus();
+    /// output.mix_matrix(&input, &[0.5, 0.5, 0.5, -0.5]);
+    /// ```
+    pub fn mix_matrix(&mut self, source: &AuxInput<'_, S>, matrix: &[S]) {
+        let num_inputs = source.num_channels().min(MAX_CHANNELS);
+        let mut inputs: [&[S]; MAX_CHANNELS] = [&[]; MAX_CHANNELS];
+        for (i, input) in inputs[..num_inputs].iter_mut().enumerate() {
+            *input = source.input(i);
+        }
+        let mut rows = matrix.chunks(num_inputs.max(1));
+        for output in self.iter_outputs() {
+            let row = rows.next().unwrap_or(&[]);
+            buffer_ops::matrix_row(output, &inputs[..num_inputs], row);
+        }
+    }
 }
 
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    #[cfg(debug_assertions)]
+    #[should_panic(expected = "dry input")]
+    fn test_mix_dry_wet_rejects_in_place() {
+        let mut io = [1.0f32; 4];
+        let mut buffer = Buffer::new_in_place([None], [&mut io[..]], 4);
+        buffer.mix_dry_wet(0.5, 0.5);
+    }
+
+    #[test]
+    fn test_in_place_channels() {
+        // Channel 0 is in place, channel 1 has separate input
+        let in_r = [2.0f32; 4];
+        let (mut io_l, mut out_r) = ([1.0f32; 4], [0.0f32; 4]);
+        let mut buffer = Buffer::new_in_place([None, Some(&in_r[..])], [&mut io_l[..], &mut out_r[..]], 4);
+
+        assert!(buffer.is_in_place(0) && !buffer.is_in_place(1));
+        assert_eq!((buffer.input(0)[0], buffer.input(1)[0]), (1.0, 2.0));
+        assert_eq!(buffer.inputs().count(), 2);
+        assert_eq!(buffer.zip_channels().count(), 1);
+
+        for channel in buffer.in_place_channels() {
+            for s in channel {
+                *s *= 3.0;
+            }
+        }
+        assert_eq!((buffer.output(0)[3], buffer.output(1)[3]), (3.0, 6.0));
+        // The in-place input now reads the processed samples
+        assert_eq!(buffer.input(0)[3], 3.0);
+
+        let kinds: Vec<bool> = buffer
+            .channel_pairs()
+            .map(|pair| matches!(pair, ChannelPair::InPlace(_)))
+            .collect();
+        assert_eq!(kinds, vec![true, false]);
+    }
+}
@@ -0,0 +1,399 @@
+//! Vectorized slice operations for audio buffers.
+//!
+//! Bulk operations that plugins otherwise write per sample: gain ramps,
+//! multiply-add mixing, constant-power panning, mono summing and matrix
+//! mixdown. [`Buffer`](crate::Buffer), [`AuxInput`](crate::AuxInput) and
+//! [`AuxOutput`](crate::AuxOutput) expose them as methods; the free
+//! functions here work on plain slices.
+//!
+//! # Dispatch
+//!
+//! Every kernel is written once as plain chunked Rust that LLVM vectorizes.
+//! On x86_64 a second copy is compiled with AVX2/FMA enabled and picked at
+//! runtime when the CPU supports it (detection is cached by `std`). Other
+//! targets use the baseline build, which already includes NEON on aarch64.
+//! [`simd_backend()`] reports which copy runs.
+//!
+//! # Ramps
+//!
+//! A ramp `from → to` over `n` samples applies `from` at sample 0 and
+//! reaches `to` at sample `n`, i.e. on the first sample of the next block.
+//! Chaining blocks with `to` as the next `from` gives a continuous ramp.
+//!
+//! # Example
+//!
+//! ```ignore
+//! fn process(&mut self, buffer: &mut Buffer, aux: &mut AuxiliaryBuffers) {
+//!     // ... wet processing into outputs ...
+//!     buffer.mix_dry_wet(1.0 - mix, mix);
+//!     buffer.apply_output_gain_ramp(self.last_gain, gain);
+//!     self.last_gain = gain;
+//! }
+//! ```
+
+use crate::sample::Sample;
+
+/// Samples per unrolled chunk: two AVX registers of `f32`.
+const LANES: usize = 16;
+
+// =============================================================================
+// Dispatch
+// =============================================================================
+
+/// Name of the kernel set selected for this CPU.
+pub fn simd_backend() -> &'static str {
+    #[cfg(target_arch = "x86_64")]
+    if avx2_available() {
+        return "avx2+fma";
+    }
+    #[cfg(target_arch = "aarch64")]
+    return "neon";
+    #[allow(unreachable_code)]
+    "portable"
+}
+
+#[cfg(target_arch = "x86_64")]
+#[inline]
+pub(crate) fn avx2_available() -> bool {
+    std::arch::is_x86_feature_detected!("avx2") && std::arch::is_x86_feature_detected!("fma")
+}
+
+/// Call the AVX2 copy of a kernel when available, the baseline otherwise.
+macro_rules! dispatch {
+    ($kernel:ident($($arg:expr),*)) => {{
+        #[cfg(target_arch = "x86_64")]
+        if avx2_available() {
+            // SAFETY: the CPU supports every feature the wrapper enables.
+            return unsafe { avx2::$kernel($($arg),*) };
+        }
+        kernels::$kernel($($arg),*)
+    }};
+}
+
+pub(crate) use dispatch;
+
+#[cfg(target_arch = "x86_64")]
+mod avx2 {
+    use crate::sample::Sample;
+
+    macro_rules! wrap {
+        ($($name:ident($($arg:ident: $ty:ty),*);)*) => {$(
+            #[target_feature(enable = "avx2,fma")]
+            pub(super) unsafe fn $name<S: Sample>($($arg: $ty),*) {
+                super::kernels::$name($($arg),*)
+            }
+        )*};
+    }
+
+    wrap! {
+        scale(buf: &mut [S], gain: S);
+        scale_linear_ramp(buf: &mut [S], from: S, to: S);
+        scale_exp_ramp(buf: &mut [S], from: S, to: S);
+        copy_scaled(dst: &mut [S], src: &[S], gain: S);
+        mix_add(dst: &mut [S], src: &[S], gain: S);
+        mix(dst: &mut [S], src: &[S], dst_gain: S, src_gain: S);
+    }
+}
+
+// =============================================================================
+// Kernels
+// =============================================================================
+
+/// Target-independent kernel bodies. `#[inline(always)]` so each dispatch
+/// copy is compiled with its own target features.
+mod kernels {
+    use super::LANES;
+    use crate::sample::Sample;
+
+    #[inline(always)]
+    pub fn scale<S: Sample>(buf: &mut [S], gain: S) {
+        for s in buf {
+            *s = *s * gain;
+        }
+    }
+
+    #[inline(always)]
+    pub fn scale_linear_ramp<S: Sample>(buf: &mut [S], from: S, to: S) {
+        let len = buf.len();
+        let step = (to - from) / S::from_f64(len as f64);
+        let offsets: [S; LANES] = std::array::from_fn(|j| step * S::from_f64(j as f64));
+        let mut chunks = buf.chunks_exact_mut(LANES);
+        for (c, chunk) in chunks.by_ref().enumerate() {
+            let base = from + step * S::from_f64((c * LANES) as f64);
+            for (s, &o) in chunk.iter_mut().zip(&offsets) {
+                *s = *s * (base + o);
+            }
+        }
+        let tail = chunks.into_remainder();
+        let base = from + step * S::from_f64((len - tail.len()) as f64);
+        for (s, &o) in tail.iter_mut().zip(&offsets) {
+            *s = *s * (base + o);
+        }
+    }
+
+    #[inline(always)]
+    pub fn scale_exp_ramp<S: Sample>(buf: &mut [S], from: S, to: S) {
+        let (from64, to64) = (from.to_f64(), to.to_f64());
+        // Exponential interpolation needs same-sign, non-zero endpoints
+        let same_sign = from64 * to64 > 0.0;
+        if !same_sign {
+            return scale_linear_ramp(buf, from, to);
+        }
+        let ratio = (to64 / from64).powf(1.0 / buf.len() as f64);
+        let offsets: [S; LANES] = std::array::from_fn(|j| S::from_f64(ratio.powi(j as i32)));
+        let chunk_ratio = ratio.powi(LANES as i32);
+        // Base gain accumulates in f64, so drift stays far below f32 precision
+        let mut base64 = from64;
+        let mut chunks = buf.chunks_exact_mut(LANES);
+        for chunk in chunks.by_ref() {
+            let base = S::from_f64(base64);
+            for (s, &o) in chunk.iter_mut().zip(&offsets) {
+                *s = *s * (base * o);
+            }
+            base64 *= chunk_ratio;
+        }
+        let base = S::from_f64(base64);
+        for (s, &o) in chunks.into_remainder().iter_mut().zip(&offsets) {
+            *s = *s * (base * o);
+        }
+    }
+
+    #[inline(always)]
+    pub fn copy_scaled<S: Sample>(dst: &mut [S], src: &[S], gain: S) {
+        for (d, &s) in dst.iter_mut().zip(src) {
+            *d = s * gain;
+        }
+    }
+
+    #[inline(always)]
+    pub fn mix_add<S: Sample>(dst: &mut [S], src: &[S], gain: S) {
+        for (d, &s) in dst.iter_mut().zip(src) {
+            *d = *d + s * gain;
+        }
+    }
+
+    #[inline(always)]
+    pub fn mix<S: Sample>(dst: &mut [S], src: &[S], dst_gain: S, src_gain: S) {
+        for (d, &s) in dst.iter_mut().zip(src) {
+            *d = *d * dst_gain + s * src_gain;
+        }
+    }
+}
+
+// =============================================================================
+// Slice Operations
+// =============================================================================
+
+/// Multiply every sample by `gain`.
+#[inline]
+pub fn scale<S: Sample>(buf: &mut [S], gain: S) {
+    dispatch!(scale(buf, gain))
+}
+
+/// Multiply by a gain moving linearly from `from` to `to`.
+///
+/// See the [module docs](self#ramps) for endpoint semantics.
+#[inline]
+pub fn scale_linear_ramp<S: Sample>(buf: &mut [S], from: S, to: S) {
+    if from == to {
+        return scale(buf, from);
+    }
+    dispatch!(scale_linear_ramp(buf, from, to))
+}
+
+/// Multiply by a gain moving exponentially (linearly in dB) from `from` to `to`.
+///
+/// Falls back to a linear ramp when either endpoint is zero or they differ
+/// in sign.
+#[inline]
+pub fn scale_exp_ramp<S: Sample>(buf: &mut [S], from: S, to: S) {
+    if from == to {
+        return scale(buf, from);
+    }
+    dispatch!(scale_exp_ramp(buf, from, to))
+}
+
+/// `dst = src * gain` over the shorter of the two slices.
+#[inline]
+pub fn copy_scaled<S: Sample>(dst: &mut [S], src: &[S], gain: S) {
+    dispatch!(copy_scaled(dst, src, gain))
+}
+
+/// `dst += src * gain` over the shorter of the two slices.
+#[inline]
+pub fn mix_add<S: Sample>(dst: &mut [S], src: &[S], gain: S) {
+    dispatch!(mix_add(dst, src, gain))
+}
+
+/// `dst = dst * dst_gain + src * src_gain` over the shorter of the two slices.
+#[inline]
+pub fn mix<S: Sample>(dst: &mut [S], src: &[S], dst_gain: S, src_gain: S) {
+    dispatch!(mix(dst, src, dst_gain, src_gain))
+}
+
+/// Constant-power pan gains `(left, right)` for `pan` in `-1.0..=1.0`.
+///
+/// Center gives `-3 dB` on both sides; `left² + right² = 1` everywhere.
+#[inline]
+pub fn pan_gains<S: Sample>(pan: S) -> (S, S) {
+    let angle = (pan.clamp(S::ZERO - S::ONE, S::ONE) + S::ONE) * S::from_f64(std::f64::consts::FRAC_PI_4);
+    (angle.cos(), angle.sin())
+}
+
+/// Pan a mono signal into a stereo pair with a constant-power law.
+#[inline]
+pub fn pan_mono<S: Sample>(input: &[S], left: &mut [S], right: &mut [S], pan: S) {
+    let (gl, gr) = pan_gains(pan);
+    copy_scaled(left, input, gl);
+    copy_scaled(right, input, gr);
+}
+
+/// Sum channels into `dst`, scaled by `gain`.
+///
+/// `dst` is cleared first, so an empty iterator yields silence.
+pub fn sum_to_mono<'a, S: Sample>(dst: &mut [S], channels: impl IntoIterator<Item = &'a [S]>, gain: S) {
+    let mut channels = channels.into_iter();
+    match channels.next() {
+        Some(first) => {
+            let n = dst.len().min(first.len());
+            copy_scaled(&mut dst[..n], first, gain);
+            dst[n..].fill(S::ZERO);
+        }
+        None => {
+            dst.fill(S::ZERO);
+            return;
+        }
+    }
+    for channel in channels {
+        mix_add(dst, channel, gain);
+    }
+}
+
+/// Mix `inputs` into `dst` with one coefficient per input: `dst = Σ row[i] * inputs[i]`.
+///
+/// One row of a channel matrix. Zero coefficients are skipped; missing
+/// inputs (`row` longer than `inputs`) count as silence.
+pub fn matrix_row<S: Sample>(dst: &mut [S], inputs: &[&[S]], row: &[S]) {
+    dst.fill(S::ZERO);
+    for (&input, &gain) in inputs.iter().zip(row) {
+        if gain != S::ZERO {
+            mix_add(dst, input, gain);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn ramp_reference(n: usize, gain_at: impl Fn(usize) -> f64) -> Vec<f32> {
+        (0..n).map(|i| gain_at(i) as f32).collect()
+    }
+
+    fn assert_close(actual: &[f32], expected: &[f32], tolerance: f32) {
+        assert_eq!(actual.len(), expected.len());
+        for (i, (a, e)) in actual.iter().zip(expected).enumerate() {
+            assert!((a - e).abs() <= tolerance, "sample {i}: {a} vs {e}");
+        }
+    }
+
+    #[test]
+    fn test_ramps_match_reference() {
+        // Lengths around the chunk size exercise the remainder path
+        for n in [1, 7, 16, 37, 512] {
+            let mut linear = vec![1.0f32; n];
+            scale_linear_ramp(&mut linear, 0.5, 1.5);
+            assert_close(&linear, &ramp_reference(n, |i| 0.5 + i as f64 / n as f64), 1e-5);
+
+            let mut exp = vec![1.0f32; n];
+            scale_exp_ramp(&mut exp, 0.1, 1.0);
+            let expected = ramp_reference(n, |i| 0.1 * 10f64.powf(i as f64 / n as f64));
+            assert_close(&exp, &expected, 1e-5);
+        }
+
+        // Zero endpoint: linear fallback
+        let mut buf = vec![2.0f64; 4];
+        scale_exp_ramp(&mut buf, 1.0, 0.0);
+        assert_eq!(buf, vec![2.0, 1.5, 1.0, 0.5]);
+    }
+
+    #[test]
+    fn test_mixing() {
+        let src: Vec<f32> = (0..37).map(|i| i as f32).collect();
+        let mut dst = vec![1.0f32; 37];
+        mix_add(&mut dst, &src, 0.5);
+        assert_eq!(dst[10], 6.0);
+        mix(&mut dst, &src, 2.0, -1.0);
+        assert_eq!(dst[10], 2.0);
+        copy_scaled(&mut dst, &src, 3.0);
+        assert_eq!(dst[36], 108.0);
+        scale(&mut dst, 0.5);
+        assert_eq!(dst[36], 54.0);
+    }
+
+    #[test]
+    fn test_constant_power_pan() {
+        let (l, r) = pan_gains(0.0f32);
+        assert!((l - std::f32::consts::FRAC_1_SQRT_2).abs() < 1e-6 && (l - r).abs() < 1e-6);
+        for pan in [-1.0f64, -0.3, 0.6, 1.0, 4.0] {
+            let (l, r) = pan_gains(pan);
+            assert!((l * l + r * r - 1.0).abs() < 1e-12);
+        }
+        let (l, r) = pan_gains(-1.0f64);
+        assert!((l - 1.0).abs() < 1e-12 && r.abs() < 1e-12);
+
+        let (mut left, mut right) = ([0.0f32; 3], [0.0f32; 3]);
+        pan_mono(&[1.0; 3], &mut left, &mut right, 1.0);
+        assert!(left[0].abs() < 1e-6 && (right[2] - 1.0).abs() < 1e-6);
+    }
+
+    #[test]
+    fn test_sum_and_matrix() {
+        let (a, b) = ([1.0f32; 20], [3.0f32; 20]);
+        let mut mono = [9.0f32; 20];
+        sum_to_mono(&mut mono, [&a[..], &b[..]], 0.5);
+        assert!(mono.iter().all(|&s| s == 2.0));
+        sum_to_mono(&mut mono, std::iter::empty(), 1.0);
+        assert!(mono.iter().all(|&s| s == 0.0));
+
+        // Downmix style row: L + 0.5 * C, R unused
+        let center = [2.0f32; 20];
+        matrix_row(&mut mono, &[&a[..], &b[..], &center[..]], &[1.0, 0.0, 0.5]);
+        assert!(mono.iter().all(|&s| s == 2.0));
+    }
+
+    #[test]
+    fn test_buffer_methods() {
+        use crate::buffer::{AuxiliaryBuffers, Buffer};
+
+        let (in_l, in_r) = ([1.0f32; 8], [-1.0f32; 8]);
+        let (mut out_l, mut out_r) = ([0.5f32; 8], [0.5f32; 8]);
+        let mut buffer = Buffer::new([&in_l[..], &in_r[..]], [&mut out_l[..], &mut out_r[..]], 8);
+
+        buffer.mix_dry_wet(0.5, 2.0);
+        assert_eq!((buffer.output(0)[0], buffer.output(1)[0]), (1.5, 0.5));
+
+        buffer.apply_output_gain_ramp(0.0, 1.0);
+        assert_eq!(buffer.output(0)[4], 0.75);
+
+        let mut mono = [0.0f32; 8];
+        buffer.sum_inputs_to_mono(&mut mono, 0.5);
+        assert_eq!(mono, [0.0; 8]);
+
+        // M/S encode through the main bus views
+        let (input, mut output) = buffer.split_main_bus();
+        output.mix_matrix(&input, &[0.5, 0.5, 0.5, -0.5]);
+        assert_eq!((output.output(0)[3], output.output(1)[3]), (0.0, 1.0));
+
+        // Sum an aux return into the main outputs
+        let ret = [[0.25f32; 8], [0.25f32; 8]];
+        let aux = AuxiliaryBuffers::new([[&ret[0][..], &ret[1][..]]], std::iter::empty::<[&mut [f32]; 0]>(), 8);
+        buffer.add_to_outputs(&aux.input(0).unwrap(), 2.0);
+        assert_eq!((buffer.output(0)[3], buffer.output(1)[3]), (0.5, 1.5));
+    }
+
+    #[test]
+    fn test_backend_name() {
+        assert!(["avx2+fma", "neon", "portable"].contains(&simd_backend()));
+    }
+}
@@ -0,0 +1,457 @@
+//! Parallel per-output-bus rendering on a real-time worker pool.
+//!
+//! Multi-output instruments (drum machines, multi-timbral samplers) render
+//! every output bus on the host's single process thread. When the buses are
+//! independent, [`BusRenderPool`] splits them into jobs that run concurrently
+//! on a small set of pre-spawned worker threads and joins before `process()`
+//! returns.
+//!
+//! # Declaring the Partitioning
+//!
+//! The plugin declares the partitioning by implementing [`BusJob`] for the
+//! state that renders each bus (e.g. a drum voice group) and keeping one job
+//! per output bus. Each job owns everything it mutates, which is what makes
+//! it safe to run jobs in parallel.
+//!
+//! Output bus indices follow the host's numbering: bus 0 is the main output
+//! ([`Buffer`]), bus `n` is auxiliary output `n - 1` ([`AuxiliaryBuffers`]).
+//!
+//! # Example
+//!
+//! ```ignore
+//! struct DrumGroup { bus: usize, voices: [DrumVoice; 4] }
+//!
+//! impl BusJob for DrumGroup {
+//!     fn output_bus(&self) -> usize { self.bus }
+//!
+//!     fn render(&mut self, _input: &AuxInput, output: &mut AuxOutput, _context: &ProcessContext) {
+//!         output.clear();
+//!         for voice in &mut self.voices {
+//!             voice.render_into(output);
+//!         }
+//!     }
+//! }
+//!
+//! // In prepare() (setup thread)
+//! let pool = BusRenderPool::new(3)?;
+//!
+//! // In process() (audio thread) - MIDI already routed into the groups
+//! self.pool.render_buses(&mut self.groups, buffer, aux, context);
+//! ```
+//!
+//! # Real-Time Safety
+//!
+//! Worker threads are spawned by [`BusRenderPool::new()`]. Dispatching a batch
+//! performs no allocation and takes no locks: jobs are claimed through a
+//! single atomic counter, the calling thread renders jobs itself while the
+//! workers help, and completion is awaited by spinning. Idle workers park and
+//! are woken with [`Thread::unpark()`](std::thread::Thread::unpark).
+//!
+//! Worker threads run at normal priority. Hosts that expose an audio
+//! workgroup or real-time priority API should promote them separately.
+
+use std::cell::Cell;
+use std::marker::PhantomData;
+use std::panic::{self, AssertUnwindSafe};
+use std::sync::atomic::{AtomicBool, AtomicPtr, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Arc;
+use std::thread::{self, JoinHandle, Thread};
+
+use crate::buffer::{AuxInput, AuxOutput, AuxiliaryBuffers, Buffer};
+use crate::process_context::ProcessContext;
+use crate::sample::Sample;
+use crate::trace;
+use crate::types::MAX_BUSES;
+
+/// Spin iterations an idle worker waits for new work before parking.
+const WORKER_SPIN_ITERATIONS: u32 = 4096;
+
+// =============================================================================
+// BusJob
+// =============================================================================
+
+/// A unit of output rendering that targets one output bus.
+///
+/// Implementors must own all state they mutate, so that jobs for different
+/// buses can run in parallel.
+pub trait BusJob<S: Sample = f32>: Send {
+    /// The output bus this job renders into (0 = main, `n` = aux output `n - 1`).
+    fn output_bus(&self) -> usize;
+
+    /// Render one block.
+    ///
+    /// `input` is the main input bus (shared by all jobs). `output` is the
+    /// job's output bus; it has no channels if the host did not connect the
+    /// bus, so voice state still advances when a bus is inactive.
+    fn render(&mut self, input: &AuxInput<'_, S>, output: &mut AuxOutput<'_, '_, S>, context: &ProcessContext);
+}
+
+// =============================================================================
+// BusRenderPool
+// =============================================================================
+
+/// Type-erased batch of jobs, stored on the dispatching thread's stack.
+struct Batch<'a> {
+    run: &'a (dyn Fn(usize) + Sync),
+    /// Trace instance of the dispatching thread, so job spans are attributed to it.
+    instance: u32,
+}
+
+/// State shared between the dispatching thread and the workers.
+struct PoolShared {
+    /// Epoch in the high 32 bits, next unclaimed job index in the low 32 bits.
+    state: AtomicU64,
+    /// Number of jobs in the current batch.
+    len: AtomicUsize,
+    /// Pointer to the current [`Batch`].
+    batch: AtomicPtr<Batch<'static>>,
+    /// Jobs completed in the current batch.
+    done: AtomicUsize,
+    /// Set if any job in the current batch panicked.
+    panicked: AtomicBool,
+    shutdown: AtomicBool,
+}
+
+impl PoolShared {
+    /// Claim and run one job of the current batch.
+    ///
+    /// Returns `false` if there was nothing left to claim.
+    fn run_one(&self) -> bool {
+        let state = self.state.load(Ordering::Acquire);
+        let index = (state & u32::MAX as u64) as usize;
+        let len = self.len.load(Ordering::Relaxed);
+        let batch = self.batch.load(Ordering::Relaxed);
+        if index >= len || batch.is_null() {
+            return false;
+        }
+        // The epoch is part of the compared value and indices only grow, so a
+        // successful claim proves the batch read above is still in flight.
+        if self
+            .state
+            .compare_exchange_weak(state, state + 1, Ordering::AcqRel, Ordering::Relaxed)
+            .is_err()
+        {
+            return true;
+        }
+
+        // SAFETY: job `index` is claimed and not yet done, so the dispatching
+        // thread is still waiting in `dispatch()` and the batch is alive.
+        let (run, instance) = unsafe { ((*batch).run, (*batch).instance) };
+        let _instance = trace::instance_scope(instance);
+        let span = trace::span_in(trace::category::WORKER, "bus job");
+        if panic::catch_unwind(AssertUnwindSafe(|| run(index))).is_err() {
+            self.panicked.store(true, Ordering::Relaxed);
+        }
+        // Recorded before signalling completion, so it ends inside the batch
+        drop(span);
+        self.done.fetch_add(1, Ordering::Release);
+        true
+    }
+}
+
+/// A fixed pool of worker threads for rendering output buses in parallel.
+///
+/// Create in `prepare()`; dropping the pool stops and joins the workers.
+pub struct BusRenderPool {
+    shared: Arc<PoolShared>,
+    threads: Vec<Thread>,
+    handles: Vec<JoinHandle<()>>,
+    /// Opts out of `Sync`: a batch may only be dispatched from one thread at a time.
+    _not_sync: PhantomData<Cell<()>>,
+}
+
+impl BusRenderPool {
+    /// Spawn a pool with `num_workers` helper threads.
+    ///
+    /// The calling thread also renders, so `num_workers + 1` jobs can run at
+    /// once. A pool with zero workers renders everything inline.
+    pub fn new(num_workers: usize) -> std::io::Result<Self> {
+        let shared = Arc::new(PoolShared {
+            state: AtomicU64::new(0),
+            len: AtomicUsize::new(0),
+            batch: AtomicPtr::new(std::ptr::null_mut()),
+            done: AtomicUsize::new(0),
+            panicked: AtomicBool::new(false),
+            shutdown: AtomicBool::new(false),
+        });
+
+        let mut handles = Vec::with_capacity(num_workers);
+        for index in 0..num_workers {
+            let shared = Arc::clone(&shared);
+            let name = format!("beamer-bus-render-{index}");
+            let handle = thread::Builder::new().name(name.clone()).spawn(move || {
+                trace::name_current_thread(&name);
+                worker_loop(&shared)
+            })?;
+            handles.push(handle);
+        }
+        let threads = handles.iter().map(|h| h.thread().clone()).collect();
+
+        Ok(Self {
+            shared,
+            threads,
+            handles,
+            _not_sync: PhantomData,
+        })
+    }
+
+    /// Number of helper threads (excluding the calling thread).
+    #[inline]
+    pub fn num_workers(&self) -> usize {
+        self.threads.len()
+    }
+
+    /// Run `f` on every item in parallel and wait for all of them.
+    ///
+    /// Each item is visited exactly once, by exactly one thread.
+    ///
+    /// # Panics
+    ///
+    /// Panics after all items finished if `f` panicked for any of them.
+    pub fn for_each_mut<T: Send>(&self, items: &mut [T], f: impl Fn(&mut T) + Sync) {
+        if self.threads.is_empty() || items.len() <= 1 {
+            items.iter_mut().for_each(f);
+            return;
+        }
+
+        let base = SendPtr(items.as_mut_ptr());
+        let run = |index: usize| {
+            // SAFETY: every index below `items.len()` is claimed exactly once,
+            // so no two threads ever alias the same item.
+            let item = unsafe { &mut *base.get().add(index) };
+            f(item);
+        };
+        self.dispatch(items.len(), &run);
+    }
+
+    /// Render every job into its output bus in parallel.
+    ///
+    /// Jobs whose bus is not connected, or whose bus was already claimed by an
+    /// earlier job in the slice, render into an empty output. At most
+    /// [`MAX_BUSES`] jobs are rendered.
+    pub fn render_buses<S: Sample, J: BusJob<S>>(
+        &self,
+        jobs: &mut [J],
+        buffer: &mut Buffer<S>,
+        aux: &mut AuxiliaryBuffers<S>,
+        context: &ProcessContext,
+    ) {
+        debug_assert!(jobs.len() <= MAX_BUSES, "more bus jobs than MAX_BUSES");
+
+        let count = jobs.len().min(MAX_BUSES);
+        let num_samples = buffer.num_samples();
+        let (input, main_output) = buffer.split_main_bus();
+        let mut main_output = Some(main_output);
+        let mut aux_outputs = aux.outputs_by_bus();
+        let mut claimed = [false; MAX_BUSES];
+
+        let mut tasks: [Option<(&mut J, TaskOutput<'_, '_, '_, S>)>; MAX_BUSES] =
+            std::array::from_fn(|_| None);
+        for (task, job) in tasks.iter_mut().zip(jobs.iter_mut()) {
+            let bus = job.output_bus();
+            if bus < MAX_BUSES {
+                debug_assert!(!claimed[bus], "output bus {bus} claimed by more than one job");
+                claimed[bus] = true;
+            }
+            let output = match bus {
+                0 => main_output.take().map(TaskOutput::Main),
+                _ => aux_outputs.get_mut(bus - 1).and_then(Option::take).map(TaskOutput::Aux),
+            };
+            let output =
+                output.unwrap_or_else(|| TaskOutput::Aux(AuxOutput::disconnected(num_samples)));
+            *task = Some((job, output));
+        }
+
+        self.for_each_mut(&mut tasks[..count], |task| match task {
+            Some((job, TaskOutput::Main(output))) => job.render(&input, output, context),
+            Some((job, TaskOutput::Aux(output))) => job.render(&input, output, context),
+            None => {}
+        });
+    }
+
+    /// Publish a batch, help render it and wait for completion.
+    fn dispatch(&self, len: usize, run: &(dyn Fn(usize) + Sync)) {
+        let shared = &*self.shared;
+        let batch = Batch {
+            run,
+            instance: trace::current_instance(),
+        };
+
+        shared.done.store(0, Ordering::Relaxed);
+        shared.panicked.store(false, Ordering::Relaxed);
+        shared.len.store(len, Ordering::Relaxed);
+        shared
+            .batch
+            .store(&batch as *const Batch<'_> as *mut Batch<'static>, Ordering::Relaxed);
+        let epoch = (shared.state.load(Ordering::Relaxed) >> 32) + 1;
+        shared.state.store(epoch << 32, Ordering::Release);
+
+        for thread in &self.threads {
+            thread.unpark();
+        }
+
+        // Render alongside the workers, then wait for stragglers
+        while shared.run_one() {}
+        while shared.done.load(Ordering::Acquire) < len {
+            std::hint::spin_loop();
+        }
+
+        // No job can be claimed any more; retire the batch pointer
+        shared.batch.store(std::ptr::null_mut(), Ordering::Relaxed);
+
+        if shared.panicked.load(Ordering::Relaxed) {
+            panic!("BusRenderPool job panicked");
+        }
+    }
+}
+
+impl Drop for BusRenderPool {
+    fn drop(&mut self) {
+        self.shared.shutdown.store(true, Ordering::Release);
+        for thread in &self.threads {
+            thread.unpark();
+        }
+        for handle in self.handles.drain(..) {
+            let _ = handle.join();
+        }
+    }
+}
+
+/// Worker thread body: claim jobs while available, spin briefly, then park.
+fn worker_loop(shared: &PoolShared) {
+    loop {
+        let mut spins = 0;
+        while spins < WORKER_SPIN_ITERATIONS {
+            if shared.shutdown.load(Ordering::Acquire) {
+                return;
+            }
+            if shared.run_one() {
+                spins = 0;
+            } else {
+                spins += 1;
+                std::hint::spin_loop();
+            }
+        }
+        thread::park();
+    }
+}
+
+/// Output view of one task. Main and aux buses carry different data lifetimes.
+enum TaskOutput<'b, 'm, 'x, S: Sample> {
+    Main(AuxOutput<'b, 'm, S>),
+    Aux(AuxOutput<'b, 'x, S>),
+}
+
+/// Raw pointer wrapper that can be shared with worker threads.
+struct SendPtr<T>(*mut T);
+
+// Manual impls: the derives would require `T: Copy`
+impl<T> Clone for SendPtr<T> {
+    fn clone(&self) -> Self {
+        *self
+    }
+}
+
+impl<T> Copy for SendPtr<T> {}
+
+impl<T> SendPtr<T> {
+    #[inline]
+    fn get(self) -> *mut T {
+        self.0
+    }
+}
+
+// SAFETY: only used for items of a `T: Send` slice where each element is
+// accessed by exactly one thread.
+unsafe impl<T: Send> Send for SendPtr<T> {}
+unsafe impl<T: Send> Sync for SendPtr<T> {}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    struct Tone {
+        bus: usize,
+        value: f32,
+        blocks: usize,
+    }
+
+    impl BusJob for Tone {
+        fn output_bus(&self) -> usize {
+            self.bus
+        }
+
+        fn render(&mut self, _input: &AuxInput<'_, f32>, output: &mut AuxOutput<'_, '_, f32>, _context: &ProcessContext) {
+            output.fill(self.value);
+            self.blocks += 1;
+        }
+    }
+
+    #[test]
+    fn test_for_each_mut_visits_every_item_once() {
+        let pool = BusRenderPool::new(3).unwrap();
+        let mut items = vec![0u32; 64];
+        for _ in 0..100 {
+            pool.for_each_mut(&mut items, |x| *x += 1);
+        }
+        assert!(items.iter().all(|&x| x == 100));
+    }
+
+    #[test]
+    fn test_render_buses_routes_jobs() {
+        let pool = BusRenderPool::new(2).unwrap();
+        let input = [0.0f32; 16];
+        let mut main = [[0.0f32; 16]; 2];
+        let mut aux = [[[0.0f32; 16]; 2]; 3];
+
+        // Bus 9 doesn't exist and renders into a disconnected output
+        let mut jobs = vec![
+            Tone { bus: 0, value: 1.0, blocks: 0 },
+            Tone { bus: 1, value: 2.0, blocks: 0 },
+            Tone { bus: 2, value: 3.0, blocks: 0 },
+            Tone { bus: 3, value: 4.0, blocks: 0 },
+            Tone { bus: 9, value: 9.0, blocks: 0 },
+        ];
+
+        {
+            let [m0, m1] = &mut main;
+            let mut buffer = Buffer::new([&input[..], &input[..]], [&mut m0[..], &mut m1[..]], 16);
+            let mut aux_buffers = AuxiliaryBuffers::new(
+                std::iter::empty::<[&[f32]; 0]>(),
+                aux.iter_mut().map(|bus| bus.iter_mut().map(|ch| &mut ch[..])),
+                16,
+            );
+            pool.render_buses(&mut jobs, &mut buffer, &mut aux_buffers, &ProcessContext::default());
+        }
+
+        assert!(main.iter().flatten().all(|&s| s == 1.0));
+        for (bus, expected) in aux.iter().zip([2.0, 3.0, 4.0]) {
+            assert!(bus.iter().flatten().all(|&s| s == expected));
+        }
+        assert!(jobs.iter().all(|job| job.blocks == 1));
+    }
+
+    #[test]
+    fn test_inline_pool() {
+        let pool = BusRenderPool::new(0).unwrap();
+        let mut items = [1, 2, 3];
+        pool.for_each_mut(&mut items, |x| *x *= 2);
+        assert_eq!(items, [2, 4, 6]);
+    }
+
+    #[test]
+    fn test_job_spans_carry_dispatching_instance() {
+        trace::enable(crate::TraceConfig::new());
+        let pool = BusRenderPool::new(2).unwrap();
+        let instance = trace::next_instance_id();
+        let mut items = [0u32; 8];
+        {
+            let _scope = trace::instance_scope(instance);
+            pool.for_each_mut(&mut items, |x| *x += 1);
+        }
+
+        let snapshot = trace::drain();
+        let jobs = snapshot.spans.iter().filter(|s| s.instance == instance);
+        assert_eq!(jobs.filter(|s| s.name == "bus job").count(), items.len());
+    }
+}
@@ -44,7 +44,7 @@
 //! }
 //! ```
 
-use crate::buffer::Buffer;
+use crate::buffer::{Buffer, ChannelPair};
 use crate::sample::Sample;
 
 // =============================================================================
@@ -154,6 +154,33 @@ impl CrossfadeCurve {
 /// }
 /// ```
 ///
+/// # Latency Compensation
+///
+/// A processor that reports [`latency_samples()`](crate::AudioProcessor::latency_samples)
+/// delays its wet signal, so crossfading to the raw input misaligns the
+/// two. [`with_latency()`](Self::with_latency) adds a dry-path delay line
+/// of the same length. It has to see every buffer, so call
+/// [`passthrough()`](Self::passthrough) or [`finish()`](Self::finish) on
+/// every path:
+///
+/// ```ignore
+/// match self.bypass_handler.begin(is_bypassed) {
+///     // DSP sleeps: only the dry delay line runs
+///     BypassAction::Passthrough => self.bypass_handler.passthrough(buffer),
+///     _ => {
+///         if self.bypass_handler.woke() {
+///             self.eq.reset(); // state is stale after sleeping
+///         }
+///         self.eq.process(buffer);
+///         self.bypass_handler.finish(buffer);
+///     }
+/// }
+/// ```
+///
+/// When bypass is released, the output stays on the delayed dry signal for
+/// one latency period while the DSP refills its own delay, then crossfades
+/// back to wet.
+///
 /// # Sample Type Flexibility
 ///
 /// BypassHandler is not generic over sample type. The `finish()` method
@@ -162,8 +189,29 @@ impl CrossfadeCurve {
 ///
 /// # Real-Time Safety
 ///
-/// This struct performs no heap allocations and is safe to use in
-/// audio processing callbacks.
+/// This struct performs no heap allocations in `begin()`, `capture_dry()`,
+/// `finish()` or `passthrough()` and is safe to use in audio processing
+/// callbacks. The dry delay line is allocated by `with_latency()`, the dry
+/// capture by `with_dry_capture()`.
+///
+/// # In-Place Processing
+///
+/// `finish()` reads the dry signal from the input after your DSP has run,
+/// but [in-place](crate::ChannelPair::InPlace) channels hold the wet signal
+/// by then. Processors that opt into
+/// [`supports_in_place()`](crate::AudioProcessor::supports_in_place)
+/// allocate a capture with [`with_dry_capture()`](Self::with_dry_capture)
+/// and save the dry input before processing:
+///
+/// ```ignore
+/// if self.bypass_handler.begin(is_bypassed) == BypassAction::ProcessAndCrossfade {
+///     self.bypass_handler.capture_dry(buffer);
+/// }
+/// ```
+///
+/// Without a capture, `finish()` panics in debug builds on in-place
+/// channels and leaves them wet in release builds. `passthrough()` needs no
+/// capture: nothing has overwritten the input.
 pub struct BypassHandler {
     /// Current bypass state
     state: BypassState,
@@ -173,6 +221,78 @@ pub struct BypassHandler {
     ramp_samples: u32,
     /// Crossfade curve to use
     curve: CrossfadeCurve,
+    /// Samples left to hold fully dry after leaving bypass (latency refill)
+    preroll: u32,
+    /// Set when leaving full bypass, cleared by the next `begin()`
+    woke: bool,
+    /// Dry-path delay matching the processor's latency
+    dry_delay: Option<DryDelay>,
+    /// Dry input of in-place channels, saved before processing
+    dry_capture: Option<DryCapture>,
+}
+
+/// Per-channel ring buffers holding the last `latency` input samples.
+struct DryDelay {
+    /// `channels * latency` samples, channel-major
+    ring: Vec<f64>,
+    latency: usize,
+    channels: usize,
+    /// Index of the oldest sample (the next one read), shared by all channels
+    pos: usize,
+}
+
+/// Per-channel copies of the dry input of in-place channels.
+struct DryCapture {
+    /// `channels * max_frames` samples, channel-major
+    samples: Vec<f64>,
+    channels: usize,
+    max_frames: usize,
+    /// Frames captured since the last `begin()` (0 = none)
+    frames: usize,
+}
+
+/// Where a channel's dry signal comes from in [`BypassHandler::run()`].
+enum DrySource<'a, S> {
+    Input(&'a [S]),
+    Captured(&'a [f64]),
+    /// In-place channel in passthrough: the output still holds the input
+    Output,
+}
+
+/// Ramp state while walking one buffer.
+#[derive(Clone, Copy)]
+struct Cursor {
+    state: BypassState,
+    position: u32,
+    preroll: u32,
+}
+
+impl Cursor {
+    /// (wet, dry) gains for the next sample, or `None` to leave the wet
+    /// output untouched.
+    #[inline]
+    fn next<S: Sample>(&mut self, ramp_samples: u32, curve: CrossfadeCurve) -> Option<(S, S)> {
+        if self.preroll > 0 {
+            self.preroll -= 1;
+            return Some((S::ZERO, S::ONE));
+        }
+        match self.state {
+            BypassState::Active => None,
+            BypassState::Bypassed => Some((S::ZERO, S::ONE)),
+            // Ramp shortened to zero mid-transition: snaps on the next begin()
+            _ if ramp_samples == 0 => None,
+            BypassState::RampingToBypassed => {
+                let gains = curve.gains(self.position as f64 / ramp_samples as f64);
+                self.position = (self.position + 1).min(ramp_samples);
+                Some(gains)
+            }
+            BypassState::RampingToActive => {
+                let gains = curve.gains(self.position as f64 / ramp_samples as f64);
+                self.position = self.position.saturating_sub(1);
+                Some(gains)
+            }
+        }
+    }
 }
 
 impl BypassHandler {
@@ -187,7 +307,54 @@ impl BypassHandler {
             ramp_position: 0,
             ramp_samples,
             curve,
+            preroll: 0,
+            woke: false,
+            dry_delay: None,
+            dry_capture: None,
+        }
+    }
+
+    /// Create a bypass handler whose dry path is delayed by
+    /// `latency_samples`, for `channels` main channels.
+    ///
+    /// Pass the full main bus width: channels past `channels` have no
+    /// delayed dry, so they stay wet while crossfading and pass undelayed in
+    /// [`passthrough()`](Self::passthrough). Allocates the delay line; call
+    /// from `prepare()`. See
+    /// [Latency Compensation](Self#latency-compensation) for the calling
+    /// pattern.
+    pub fn with_latency(
+        ramp_samples: u32,
+        curve: CrossfadeCurve,
+        latency_samples: u32,
+        channels: usize,
+    ) -> Self {
+        let latency = latency_samples as usize;
+        let mut handler = Self::new(ramp_samples, curve);
+        if latency > 0 && channels > 0 {
+            handler.dry_delay = Some(DryDelay {
+                ring: vec![0.0; channels * latency],
+                latency,
+                channels,
+                pos: 0,
+            });
         }
+        handler
+    }
+
+    /// Allocate room to capture the dry input of up to `channels` in-place
+    /// channels, for blocks of up to `max_block_size` frames.
+    ///
+    /// Allocates; call from `prepare()`. See
+    /// [In-Place Processing](Self#in-place-processing).
+    pub fn with_dry_capture(mut self, max_block_size: usize, channels: usize) -> Self {
+        self.dry_capture = Some(DryCapture {
+            samples: vec![0.0; channels * max_block_size],
+            channels,
+            max_frames: max_block_size,
+            frames: 0,
+        });
+        self
     }
 
     /// Get the current bypass state.
@@ -223,6 +390,19 @@ impl BypassHandler {
         self.ramp_samples
     }
 
+    /// Get the dry-path delay in samples (0 without latency compensation).
+    #[inline]
+    pub fn latency_samples(&self) -> u32 {
+        self.dry_delay.as_ref().map_or(0, |d| d.latency as u32)
+    }
+
+    /// Returns true for the buffer in which processing resumes after full
+    /// bypass. The DSP didn't run while bypassed, so reset its state here.
+    #[inline]
+    pub fn woke(&self) -> bool {
+        self.woke
+    }
+
     /// Set the ramp length. Takes effect on next state transition.
     pub fn set_ramp_samples(&mut self, samples: u32) {
         self.ramp_samples = samples;
@@ -233,6 +413,14 @@ impl BypassHandler {
         self.curve = curve;
     }
 
+    /// Clear the dry delay line (e.g. from `set_active(true)`).
+    pub fn reset(&mut self) {
+        if let Some(delay) = &mut self.dry_delay {
+            delay.ring.fill(0.0);
+            delay.pos = 0;
+        }
+    }
+
     /// Begin bypass processing for this buffer.
     ///
     /// Call this at the start of your `process()` method. It updates the internal
@@ -260,11 +448,16 @@ impl BypassHandler {
     /// }
     /// ```
     pub fn begin(&mut self, bypassed: bool) -> BypassAction {
+        self.woke = false;
+        if let Some(capture) = &mut self.dry_capture {
+            capture.frames = 0;
+        }
         self.set_bypass(bypassed);
 
         match self.state {
             BypassState::Bypassed => BypassAction::Passthrough,
-            BypassState::Active => BypassAction::Process,
+            BypassState::Active if self.preroll == 0 => BypassAction::Process,
+            BypassState::Active => BypassAction::ProcessAndCrossfade,
             BypassState::RampingToBypassed | BypassState::RampingToActive => {
                 BypassAction::ProcessAndCrossfade
             }
@@ -274,20 +467,60 @@ impl BypassHandler {
     /// Finish bypass processing by applying the crossfade.
     ///
     /// Call this AFTER your DSP processing when `begin()` returned
-    /// `BypassAction::ProcessAndCrossfade`.
+    /// `BypassAction::ProcessAndCrossfade` (with latency compensation:
+    /// after every processed buffer).
     ///
     /// This blends the wet signal (in output buffer) with the dry signal
-    /// (in input buffer) according to the current ramp position.
+    /// (in input buffer, delayed by the latency) according to the current
+    /// ramp position.
     ///
     /// # Arguments
     /// * `buffer` - The buffer containing processed (wet) output and original (dry) input
     pub fn finish<S: Sample>(&mut self, buffer: &mut Buffer<S>) {
-        let num_samples = buffer.num_samples();
-        self.apply_crossfade(buffer, num_samples);
+        if self.dry_delay.is_none() && !self.is_ramping() && self.preroll == 0 {
+            return;
+        }
+        self.run(buffer, false);
+    }
+
+    /// Save the dry input of in-place channels before your DSP overwrites it.
+    ///
+    /// Call between `begin()` and processing when `begin()` returned
+    /// `ProcessAndCrossfade`. Does nothing without
+    /// [`with_dry_capture()`](Self::with_dry_capture) or for blocks longer
+    /// than its maximum block size.
+    pub fn capture_dry<S: Sample>(&mut self, buffer: &Buffer<S>) {
+        let Some(capture) = &mut self.dry_capture else { return };
+        let n = buffer.num_samples();
+        if n > capture.max_frames {
+            return;
+        }
+        let channels = capture.channels.min(buffer.num_input_channels());
+        for ch in (0..channels).filter(|&ch| buffer.is_in_place(ch)) {
+            let row = &mut capture.samples[ch * capture.max_frames..][..n];
+            for (d, &x) in row.iter_mut().zip(buffer.input(ch)) {
+                *d = x.to_f64();
+            }
+        }
+        capture.frames = n;
+    }
+
+    /// Write the (latency-delayed) input to the output.
+    ///
+    /// Call this when `begin()` returned `BypassAction::Passthrough`. Without
+    /// latency compensation it's [`Buffer::copy_to_output()`].
+    pub fn passthrough<S: Sample>(&mut self, buffer: &mut Buffer<S>) {
+        if self.dry_delay.is_none() {
+            buffer.copy_to_output();
+            return;
+        }
+        self.run(buffer, true);
     }
 
     /// Update bypass target state (internal).
     fn set_bypass(&mut self, bypassed: bool) {
+        let latency = self.latency_samples();
+
         // Handle instant bypass (zero ramp) - snap directly to final state
         if self.ramp_samples == 0 {
             let target = if bypassed {
@@ -296,9 +529,16 @@ impl BypassHandler {
                 BypassState::Active
             };
             if self.state != target {
+                if self.state == BypassState::Bypassed {
+                    self.woke = true;
+                    self.preroll = latency;
+                }
                 self.state = target;
                 self.ramp_position = 0;
             }
+            if bypassed {
+                self.preroll = 0;
+            }
             return;
         }
 
@@ -307,20 +547,25 @@ impl BypassHandler {
             (BypassState::Active, true) => {
                 self.state = BypassState::RampingToBypassed;
                 self.ramp_position = 0;
+                self.preroll = 0;
             }
             // Reverse: was ramping to bypass, now going back to active
             (BypassState::RampingToBypassed, false) => {
                 self.state = BypassState::RampingToActive;
                 // Keep current ramp_position for smooth reversal
             }
-            // Start ramping to active
+            // Start ramping to active, after the DSP has refilled its latency
             (BypassState::Bypassed, false) => {
                 self.state = BypassState::RampingToActive;
                 self.ramp_position = self.ramp_samples;
+                self.preroll = latency;
+                self.woke = true;
             }
             // Reverse: was ramping to active, now going back to bypass
             (BypassState::RampingToActive, true) => {
                 self.state = BypassState::RampingToBypassed;
+                // Still dry if the preroll hadn't finished
+                self.preroll = 0;
                 // Keep current ramp_position for smooth reversal
             }
             // Already in correct stable state, or continuing ramp
@@ -328,48 +573,132 @@ impl BypassHandler {
         }
     }
 
-    fn apply_crossfade<S: Sample>(&mut self, buffer: &mut Buffer<S>, num_samples: usize) {
-        // Guard: instant bypass when ramp_samples is 0
-        if self.ramp_samples == 0 {
-            return;
+    /// Mix delayed dry into the output per the ramp (or fully, if
+    /// `force_dry`) and advance the ramp and the delay line.
+    fn run<S: Sample>(&mut self, buffer: &mut Buffer<S>, force_dry: bool) {
+        let n = buffer.num_samples();
+        let ramp_samples = self.ramp_samples;
+        let curve = self.curve;
+        let start = Cursor {
+            state: if force_dry { BypassState::Bypassed } else { self.state },
+            position: self.ramp_position,
+            preroll: if force_dry { 0 } else { self.preroll },
+        };
+
+        // Rings and captures are indexed by channel, so walk real channel
+        // indices rather than the pairs that exist. Every ring advances each
+        // buffer, even for channels without a pair, so all stay in phase.
+        let num_pairs = buffer.num_input_channels().min(buffer.num_output_channels());
+        let ring_channels = self.dry_delay.as_ref().map_or(0, |d| d.channels);
+        let pos = self.dry_delay.as_ref().map_or(0, |d| d.pos);
+        let captured = self.dry_capture.as_ref().filter(|capture| capture.frames == n);
+        for ch in 0..num_pairs.max(ring_channels) {
+            let mut ring = self.dry_delay.as_mut().and_then(|d| d.channel(ch));
+            let pair = if ch < num_pairs { buffer.channel_pair(ch) } else { None };
+            let Some(pair) = pair else {
+                // Inactive channel: its input is silence
+                if let Some(ring) = ring {
+                    DryDelay::write_silence(ring, pos, n);
+                }
+                continue;
+            };
+            if ring_channels > 0 && ring.is_none() {
+                // Past the delayed channels: undelayed dry would comb
+                // against the delayed wet, so leave the wet signal alone
+                if let (true, ChannelPair::Separate(input, output)) = (force_dry, pair) {
+                    output.copy_from_slice(input);
+                }
+                continue;
+            }
+            let (source, output) = match pair {
+                ChannelPair::Separate(input, output) => (DrySource::Input(input), output),
+                ChannelPair::InPlace(io) if force_dry => (DrySource::Output, io),
+                ChannelPair::InPlace(io) => {
+                    match captured.filter(|capture| ch < capture.channels) {
+                        Some(capture) => (DrySource::Captured(&capture.samples[ch * capture.max_frames..][..n]), io),
+                        None => {
+                            debug_assert!(false, "in-place channel {ch} has no dry capture; call capture_dry() before processing");
+                            if let Some(ring) = ring {
+                                DryDelay::write_silence(ring, pos, n);
+                            }
+                            continue;
+                        }
+                    }
+                }
+            };
+
+            let mut cursor = start;
+            let mut k = pos;
+            for i in 0..n {
+                let x = match source {
+                    DrySource::Input(input) => input[i],
+                    DrySource::Captured(samples) => S::from_f64(samples[i]),
+                    DrySource::Output => output[i],
+                };
+                // Delayed dry: swap the oldest ring sample for this input
+                let dry = match ring.as_deref_mut() {
+                    Some(ring) => {
+                        let dry = S::from_f64(ring[k]);
+                        ring[k] = x.to_f64();
+                        k += 1;
+                        if k == ring.len() {
+                            k = 0;
+                        }
+                        dry
+                    }
+                    None => x,
+                };
+                if let Some((wet_gain, dry_gain)) = cursor.next::<S>(ramp_samples, curve) {
+                    output[i] = output[i] * wet_gain + dry * dry_gain;
+                }
+            }
         }
 
-        // Guard: no channels to process
-        let num_channels = buffer.num_input_channels().min(buffer.num_output_channels());
-        if num_channels == 0 {
+        if let Some(delay) = &mut self.dry_delay {
+            delay.pos = (delay.pos + n) % delay.latency;
+        }
+        if force_dry {
             return;
         }
 
-        let ramp_samples_f = self.ramp_samples as f64;
-        let ramping_to_bypass = self.state == BypassState::RampingToBypassed;
-
-        // Process sample by sample
-        for sample_idx in 0..num_samples {
-            // Calculate normalized position (0.0 = wet, 1.0 = dry)
-            let t = (self.ramp_position as f64) / ramp_samples_f;
-            let (wet_gain, dry_gain): (S, S) = self.curve.gains(t);
-
-            // Apply crossfade to all channels for this sample
-            for ch in 0..num_channels {
-                let dry = buffer.input(ch)[sample_idx];
-                let wet = buffer.output(ch)[sample_idx];
-                buffer.output(ch)[sample_idx] = wet * wet_gain + dry * dry_gain;
+        // Advance the shared ramp state past this buffer
+        let held = (self.preroll as usize).min(n);
+        self.preroll -= held as u32;
+        let ramped = (n - held) as u32;
+        match self.state {
+            BypassState::RampingToBypassed => {
+                self.ramp_position = self.ramp_position.saturating_add(ramped).min(ramp_samples);
+                if self.ramp_position >= ramp_samples {
+                    self.state = BypassState::Bypassed;
+                }
             }
-
-            // Advance ramp position (once per sample)
-            if ramping_to_bypass {
-                self.ramp_position = (self.ramp_position + 1).min(self.ramp_samples);
-            } else {
-                self.ramp_position = self.ramp_position.saturating_sub(1);
+            BypassState::RampingToActive => {
+                self.ramp_position = self.ramp_position.saturating_sub(ramped);
+                if self.ramp_position == 0 {
+                    self.state = BypassState::Active;
+                }
             }
+            BypassState::Active | BypassState::Bypassed => {}
         }
+    }
+}
 
-        // Check if ramp complete
-        if ramping_to_bypass && self.ramp_position >= self.ramp_samples {
-            self.state = BypassState::Bypassed;
-        } else if !ramping_to_bypass && self.ramp_position == 0 {
-            self.state = BypassState::Active;
+impl DryDelay {
+    /// Ring of one channel, or `None` past the configured channel count.
+    #[inline]
+    fn channel(&mut self, ch: usize) -> Option<&mut [f64]> {
+        (ch < self.channels).then(|| &mut self.ring[ch * self.latency..(ch + 1) * self.latency])
+    }
+
+    /// Advance one channel's ring by `n` samples of silence from `pos`.
+    fn write_silence(ring: &mut [f64], pos: usize, n: usize) {
+        if n >= ring.len() {
+            ring.fill(0.0);
+            return;
         }
+        let (head, tail) = (n.min(ring.len() - pos), n.saturating_sub(ring.len() - pos));
+        ring[pos..pos + head].fill(0.0);
+        ring[..tail].fill(0.0);
     }
 }
 
@@ -379,3 +708,164 @@ impl Default for BypassHandler {
         Self::new(64, CrossfadeCurve::Linear)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const LATENCY: usize = 10;
+    const BLOCK: usize = 16;
+
+    /// A "linear-phase" processor: pure delay of LATENCY samples.
+    struct Lookahead {
+        ring: [f32; LATENCY],
+        pos: usize,
+    }
+
+    impl Lookahead {
+        fn process(&mut self, input: &[f32], output: &mut [f32]) {
+            for (x, y) in input.iter().zip(output) {
+                *y = self.ring[self.pos];
+                self.ring[self.pos] = *x;
+                self.pos = (self.pos + 1) % LATENCY;
+            }
+        }
+    }
+
+    #[test]
+    fn test_latency_compensated_bypass_stays_aligned() {
+        let mut handler = BypassHandler::with_latency(8, CrossfadeCurve::Linear, LATENCY as u32, 1);
+        let mut dsp = Lookahead { ring: [0.0; LATENCY], pos: 0 };
+        let signal: Vec<f32> = (0..BLOCK * 20).map(|i| i as f32 + 1.0).collect();
+        let mut dsp_calls = 0;
+
+        for (block, input) in signal.chunks(BLOCK).enumerate() {
+            let bypassed = (3..12).contains(&block);
+            let mut output = [0.0f32; BLOCK];
+
+            match handler.begin(bypassed) {
+                BypassAction::Passthrough => {
+                    handler.passthrough(&mut Buffer::new([input], [&mut output[..]], BLOCK));
+                }
+                _ => {
+                    if handler.woke() {
+                        dsp = Lookahead { ring: [0.0; LATENCY], pos: 0 };
+                    }
+                    dsp_calls += 1;
+                    dsp.process(input, &mut output);
+                    handler.finish(&mut Buffer::new([input], [&mut output[..]], BLOCK));
+                }
+            }
+
+            // Wet and delayed dry agree, so every crossfade is seamless
+            let start = block * BLOCK;
+            for (i, &y) in output.iter().enumerate() {
+                let expected = (start + i).checked_sub(LATENCY).map_or(0.0, |j| signal[j]);
+                assert!((y - expected).abs() < 1e-3, "block {block} sample {i}: {y} != {expected}");
+            }
+        }
+
+        // The DSP slept through most of the bypassed blocks
+        assert!(dsp_calls < 14, "dsp ran {dsp_calls} times");
+        assert!(handler.is_active());
+    }
+
+    #[test]
+    fn test_uncompensated_crossfade_reaches_dry() {
+        let mut handler = BypassHandler::new(BLOCK as u32, CrossfadeCurve::Linear);
+        let input = [1.0f32; BLOCK];
+        let mut output = [0.0f32; BLOCK];
+
+        assert_eq!(handler.begin(true), BypassAction::ProcessAndCrossfade);
+        handler.finish(&mut Buffer::new([&input[..]], [&mut output[..]], BLOCK));
+        assert_eq!(output[0], 0.0);
+        assert!((output[BLOCK - 1] - (BLOCK - 1) as f32 / BLOCK as f32).abs() < 1e-6);
+
+        assert_eq!(handler.begin(true), BypassAction::Passthrough);
+        assert_eq!(handler.latency_samples(), 0);
+    }
+
+    #[test]
+    fn test_in_place_crossfade_uses_captured_dry() {
+        let mut handler = BypassHandler::new(BLOCK as u32, CrossfadeCurve::Linear).with_dry_capture(BLOCK, 1);
+        let mut io = [1.0f32; BLOCK];
+
+        assert_eq!(handler.begin(true), BypassAction::ProcessAndCrossfade);
+        let mut buffer = Buffer::new_in_place([None], [&mut io[..]], BLOCK);
+        handler.capture_dry(&buffer);
+        buffer.output(0).fill(0.0); // wet
+        handler.finish(&mut buffer);
+
+        // Same ramp as with a separate input: dry comes from the capture
+        assert_eq!(io[0], 0.0);
+        assert!((io[BLOCK - 1] - (BLOCK - 1) as f32 / BLOCK as f32).abs() < 1e-6);
+    }
+
+    #[test]
+    fn test_inactive_channel_ring_stays_in_phase() {
+        let mut handler = BypassHandler::with_latency(0, CrossfadeCurve::Linear, LATENCY as u32, 2);
+        let signal: Vec<f32> = (0..BLOCK * 3).map(|i| i as f32 + 1.0).collect();
+        let delayed = |i: usize| i.checked_sub(LATENCY).map_or(0.0, |j| signal[j]);
+
+        for block in 0..3 {
+            let input = &signal[block * BLOCK..(block + 1) * BLOCK];
+            let mut left = [0.0f32; BLOCK];
+            let mut right = [0.0f32; BLOCK];
+            assert_eq!(handler.begin(true), BypassAction::Passthrough);
+            if block == 1 {
+                // Right channel inactive for one buffer
+                handler.passthrough(&mut Buffer::new([input], [&mut left[..]], BLOCK));
+                continue;
+            }
+            handler.passthrough(&mut Buffer::new([input, input], [&mut left[..], &mut right[..]], BLOCK));
+            for i in 0..BLOCK {
+                let t = block * BLOCK + i;
+                assert_eq!(left[i], delayed(t));
+                // Samples from the inactive buffer come back as silence
+                let silenced = t.checked_sub(LATENCY).is_some_and(|j| (BLOCK..2 * BLOCK).contains(&j));
+                let expected = if silenced { 0.0 } else { delayed(t) };
+                assert_eq!(right[i], expected, "block {block} sample {i}");
+            }
+        }
+    }
+
+    #[test]
+    fn test_channels_past_delay_stay_wet() {
+        let mut handler = BypassHandler::with_latency(BLOCK as u32, CrossfadeCurve::Linear, LATENCY as u32, 1);
+        let input = [1.0f32; BLOCK];
+        let (mut left, mut right) = ([0.5f32; BLOCK], [0.5f32; BLOCK]);
+
+        assert_eq!(handler.begin(true), BypassAction::ProcessAndCrossfade);
+        handler.finish(&mut Buffer::new([&input[..], &input[..]], [&mut left[..], &mut right[..]], BLOCK));
+        // The delayed channel fades towards its delayed dry, still silent at 5
+        assert_eq!(left[5], 0.5 * (1.0 - 5.0 / BLOCK as f32));
+        assert_eq!(right, [0.5; BLOCK]);
+
+        // Fully bypassed, the undelayed input passes through
+        assert_eq!(handler.begin(true), BypassAction::Passthrough);
+        handler.passthrough(&mut Buffer::new([&input[..], &input[..]], [&mut left[..], &mut right[..]], BLOCK));
+        assert_eq!(right, input);
+    }
+
+    #[test]
+    fn test_passthrough_delays_each_channel_by_index() {
+        // Channel 0 in place, channel 1 separate: each keeps its own ring
+        let mut handler = BypassHandler::with_latency(0, CrossfadeCurve::Linear, LATENCY as u32, 2);
+        let right: Vec<f32> = (0..BLOCK * 2).map(|i| -(i as f32) - 1.0).collect();
+        for block in 0..2 {
+            let range = block * BLOCK..(block + 1) * BLOCK;
+            let mut left: Vec<f32> = range.clone().map(|i| i as f32 + 1.0).collect();
+            let mut out_right = [0.0f32; BLOCK];
+            assert_eq!(handler.begin(true), BypassAction::Passthrough);
+            handler.passthrough(&mut Buffer::new_in_place(
+                [None, Some(&right[range.clone()])],
+                [&mut left[..], &mut out_right[..]],
+                BLOCK,
+            ));
+            for (i, (l, r)) in left.iter().zip(&out_right).enumerate() {
+                let delayed = (block * BLOCK + i).checked_sub(LATENCY).map_or(0.0, |j| j as f32 + 1.0);
+                assert_eq!((*l, *r), (delayed, -delayed));
+            }
+        }
+    }
+}
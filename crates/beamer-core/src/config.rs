@@ -17,6 +17,9 @@
 //!     .with_sub_categories("Fx|Dynamics");
 //! ```
 
+use crate::deadline::DeadlineConfig;
+use crate::residency::MemoryPolicy;
+
 /// Format-agnostic plugin configuration.
 ///
 /// Contains metadata shared across all plugin formats. Format-specific
@@ -47,6 +50,12 @@ pub struct PluginConfig {
 
     /// Whether this plugin has an editor/GUI.
     pub has_editor: bool,
+
+    /// Pre-faulting/locking of memory allocated in `prepare()`.
+    pub memory_policy: MemoryPolicy,
+
+    /// Load thresholds for the quality level in `ProcessContext`.
+    pub deadline: DeadlineConfig,
 }
 
 impl PluginConfig {
@@ -69,6 +78,8 @@ impl PluginConfig {
             category: "Fx",
             sub_categories: "",
             has_editor: false,
+            memory_policy: MemoryPolicy::Default,
+            deadline: DeadlineConfig::new(),
         }
     }
 
@@ -113,4 +124,16 @@ impl PluginConfig {
         self.has_editor = true;
         self
     }
+
+    /// Set the memory policy (see [`MemoryPolicy`]).
+    pub const fn with_memory_policy(mut self, policy: MemoryPolicy) -> Self {
+        self.memory_policy = policy;
+        self
+    }
+
+    /// Set the load thresholds for quality levels (see [`DeadlineConfig`]).
+    pub const fn with_deadline(mut self, deadline: DeadlineConfig) -> Self {
+        self.deadline = deadline;
+        self
+    }
 }
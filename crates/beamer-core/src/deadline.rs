@@ -0,0 +1,276 @@
+//! Deadline-aware quality levels.
+//!
+//! Each block has a real-time budget of `num_samples / sample_rate`
+//! seconds. [`DeadlineMonitor`] tracks a moving average of the time the
+//! instance spends against that budget and maps it to a [`QualityLevel`]
+//! with hysteresis. The format wrappers feed it after every `process()`
+//! and pass the level to the next block in
+//! [`ProcessContext::quality`](crate::ProcessContext::quality).
+//!
+//! Processors that can trade quality for time check the level and scale
+//! down oversampling, voice count, FFT overlap and the like:
+//!
+//! ```ignore
+//! fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, context: &ProcessContext) {
+//!     let oversampling = match context.quality {
+//!         QualityLevel::Full => 4,
+//!         QualityLevel::Reduced => 2,
+//!         QualityLevel::Minimal => 1,
+//!     };
+//!     self.saturator.process(buffer, oversampling);
+//! }
+//! ```
+//!
+//! # Behavior
+//!
+//! - The load is an exponential moving average of `elapsed / budget` with
+//!   a time constant in audio time, so it reacts the same at any block
+//!   size.
+//! - Overload degrades immediately, skipping levels if needed.
+//! - Recovery goes up one level at a time, once the load has dropped
+//!   `hysteresis` below the threshold that caused the degradation and the
+//!   current level has been held for `hold` seconds. This keeps a
+//!   processor whose reduced mode is much cheaper from flapping.
+
+use std::time::Duration;
+
+// =============================================================================
+// QualityLevel
+// =============================================================================
+
+/// Processing quality the instance can currently afford.
+///
+/// Ordered from best to cheapest: `Full < Reduced < Minimal`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq, PartialOrd, Ord, Hash)]
+pub enum QualityLevel {
+    /// Within budget: full quality.
+    #[default]
+    Full,
+    /// Using too much of the budget: reduce expensive options.
+    Reduced,
+    /// Close to missing deadlines: cheapest acceptable processing.
+    Minimal,
+}
+
+impl QualityLevel {
+    /// Returns true at full quality.
+    #[inline]
+    pub const fn is_full(self) -> bool {
+        matches!(self, Self::Full)
+    }
+
+    /// The next better level (`Full` stays `Full`).
+    #[inline]
+    pub const fn raised(self) -> Self {
+        match self {
+            Self::Full | Self::Reduced => Self::Full,
+            Self::Minimal => Self::Reduced,
+        }
+    }
+}
+
+// =============================================================================
+// DeadlineConfig
+// =============================================================================
+
+/// Thresholds and timing for [`DeadlineMonitor`].
+///
+/// Loads are fractions of the block's real-time budget (1.0 = the whole
+/// block duration).
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct DeadlineConfig {
+    /// Degrade to `Reduced` above this load.
+    pub reduced_above: f64,
+    /// Degrade to `Minimal` above this load.
+    pub minimal_above: f64,
+    /// How far below a threshold the load must fall to recover past it.
+    pub hysteresis: f64,
+    /// Moving-average time constant in seconds of audio.
+    pub time_constant: f64,
+    /// Minimum seconds of audio at a degraded level before recovering.
+    pub hold: f64,
+}
+
+impl DeadlineConfig {
+    /// Default thresholds: reduce above 60% load, minimal above 85%,
+    /// 20% hysteresis, 200 ms averaging, 1 s hold.
+    pub const fn new() -> Self {
+        Self {
+            reduced_above: 0.6,
+            minimal_above: 0.85,
+            hysteresis: 0.2,
+            time_constant: 0.2,
+            hold: 1.0,
+        }
+    }
+
+    /// Set the load thresholds for `Reduced` and `Minimal`.
+    pub const fn with_thresholds(mut self, reduced_above: f64, minimal_above: f64) -> Self {
+        self.reduced_above = reduced_above;
+        self.minimal_above = minimal_above;
+        self
+    }
+
+    /// Set the recovery hysteresis.
+    pub const fn with_hysteresis(mut self, hysteresis: f64) -> Self {
+        self.hysteresis = hysteresis;
+        self
+    }
+
+    /// Set the averaging time constant in seconds.
+    pub const fn with_time_constant(mut self, seconds: f64) -> Self {
+        self.time_constant = seconds;
+        self
+    }
+
+    /// Set the minimum time at a degraded level in seconds.
+    pub const fn with_hold(mut self, seconds: f64) -> Self {
+        self.hold = seconds;
+        self
+    }
+}
+
+impl Default for DeadlineConfig {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// =============================================================================
+// DeadlineMonitor
+// =============================================================================
+
+/// Moving-average load tracker that picks a [`QualityLevel`].
+///
+/// Real-time safe: [`record()`](Self::record) does a few float operations
+/// and never allocates.
+#[derive(Debug, Clone)]
+pub struct DeadlineMonitor {
+    config: DeadlineConfig,
+    /// Averaged fraction of the budget in use
+    load: f64,
+    level: QualityLevel,
+    /// Seconds of audio since the level last changed
+    held: f64,
+}
+
+impl DeadlineMonitor {
+    /// Create a monitor at full quality.
+    pub fn new(config: DeadlineConfig) -> Self {
+        Self {
+            config,
+            load: 0.0,
+            level: QualityLevel::Full,
+            held: 0.0,
+        }
+    }
+
+    /// Current quality level.
+    #[inline]
+    pub fn level(&self) -> QualityLevel {
+        self.level
+    }
+
+    /// Averaged load as a fraction of the real-time budget.
+    #[inline]
+    pub fn load(&self) -> f64 {
+        self.load
+    }
+
+    /// Return to full quality and forget the load history.
+    pub fn reset(&mut self) {
+        self.load = 0.0;
+        self.level = QualityLevel::Full;
+        self.held = 0.0;
+    }
+
+    /// Record the time spent on a block of `num_samples` and return the
+    /// level for the next block.
+    pub fn record(&mut self, elapsed: Duration, num_samples: usize, sample_rate: f64) -> QualityLevel {
+        if num_samples == 0 || sample_rate <= 0.0 {
+            return self.level;
+        }
+        let budget = num_samples as f64 / sample_rate;
+        let block_load = elapsed.as_secs_f64() / budget;
+
+        let alpha = if self.config.time_constant > 0.0 {
+            1.0 - (-budget / self.config.time_constant).exp()
+        } else {
+            1.0
+        };
+        self.load += alpha * (block_load - self.load);
+        self.held += budget;
+
+        let target = if self.load > self.config.minimal_above {
+            QualityLevel::Minimal
+        } else if self.load > self.config.reduced_above {
+            QualityLevel::Reduced
+        } else {
+            QualityLevel::Full
+        };
+
+        if target > self.level {
+            self.level = target;
+            self.held = 0.0;
+        } else if !self.level.is_full() && self.held >= self.config.hold {
+            let threshold = match self.level {
+                QualityLevel::Minimal => self.config.minimal_above,
+                _ => self.config.reduced_above,
+            };
+            if self.load < threshold - self.config.hysteresis {
+                self.level = self.level.raised();
+                self.held = 0.0;
+            }
+        }
+        self.level
+    }
+}
+
+impl Default for DeadlineMonitor {
+    fn default() -> Self {
+        Self::new(DeadlineConfig::new())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const SAMPLE_RATE: f64 = 48_000.0;
+    const BLOCK: usize = 480; // 10 ms
+
+    /// Feed `blocks` blocks at `load` and return the final level.
+    fn run(monitor: &mut DeadlineMonitor, load: f64, blocks: usize) -> QualityLevel {
+        let elapsed = Duration::from_secs_f64(load * BLOCK as f64 / SAMPLE_RATE);
+        (0..blocks).fold(monitor.level(), |_, _| monitor.record(elapsed, BLOCK, SAMPLE_RATE))
+    }
+
+    #[test]
+    fn test_degrades_under_load() {
+        let mut monitor = DeadlineMonitor::default();
+        assert_eq!(run(&mut monitor, 0.3, 100), QualityLevel::Full);
+        assert_eq!(run(&mut monitor, 0.7, 100), QualityLevel::Reduced);
+        assert_eq!(run(&mut monitor, 1.2, 100), QualityLevel::Minimal);
+        assert!(monitor.load() > 1.1);
+
+        // A single spike is averaged out
+        let mut monitor = DeadlineMonitor::default();
+        run(&mut monitor, 0.2, 100);
+        assert_eq!(run(&mut monitor, 3.0, 1), QualityLevel::Full);
+    }
+
+    #[test]
+    fn test_recovers_with_hysteresis_and_hold() {
+        let mut monitor = DeadlineMonitor::default();
+        run(&mut monitor, 1.2, 100);
+        assert_eq!(monitor.level(), QualityLevel::Minimal);
+
+        // Below the minimal threshold but inside the hysteresis band: stays
+        assert_eq!(run(&mut monitor, 0.75, 300), QualityLevel::Minimal);
+
+        // Clearly below: recovers one level, then waits out the hold
+        assert_eq!(run(&mut monitor, 0.1, 20), QualityLevel::Reduced);
+        assert_eq!(run(&mut monitor, 0.1, 70), QualityLevel::Reduced);
+        assert_eq!(run(&mut monitor, 0.1, 20), QualityLevel::Full);
+    }
+}
@@ -0,0 +1,682 @@
+//! Frame-major channel tiles for wide buses.
+//!
+//! On a 9.1.6 or 22.2 bus, per-channel loops over [`Buffer::output()`]
+//! run the same math 16–24 times on separate slices, and recursive
+//! kernels such as filters can't vectorize along time at all.
+//! [`FrameTiles`] transposes the planar channels into tiles of `W`
+//! channels (8 by default; 16 fills two AVX registers of `f32`) in which
+//! each frame is one `[S; W]`, so kernels that treat channels alike work
+//! on a whole tile per step:
+//!
+//! - [`apply_gains()`](FrameTiles::apply_gains) - per-channel trims
+//! - [`mix_matrix_into()`](FrameTiles::mix_matrix_into) - gain matrix
+//! - [`linked_peak()`](FrameTiles::linked_peak) /
+//!   [`linked_power()`](FrameTiles::linked_power) and
+//!   [`apply_frame_gains()`](FrameTiles::apply_frame_gains) - linked
+//!   detection and gain for dynamics
+//! - [`TileBiquad`] - one filter design applied to every channel
+//!
+//! Custom kernels use [`tile_mut()`](FrameTiles::tile_mut).
+//!
+//! # Layout
+//!
+//! Tile `t` holds channels `t * W .. t * W + W`. Lanes past the channel
+//! count are zero after [`load()`](FrameTiles::load) and every kernel
+//! here keeps them zero, so they never show up in linked detection.
+//!
+//! Transposes run in blocks of [`BLOCK_FRAMES`] frames, so the tile rows
+//! being written stay in L1 whatever the host block size. Kernels use the
+//! [`buffer_ops`](crate::buffer_ops) dispatch: plain Rust that LLVM
+//! vectorizes, with an AVX2/FMA copy picked at runtime on x86_64.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // prepare(): all allocation happens here
+//! let channels = setup.layout.main_output_channels as usize;
+//! let tiles = FrameTiles::<f32>::new(channels, setup.max_buffer_size);
+//! let crossover = TileBiquad::new(channels);
+//!
+//! fn process(&mut self, buffer: &mut Buffer, aux: &mut AuxiliaryBuffers, context: &ProcessContext) {
+//!     let n = buffer.num_samples();
+//!     self.tiles.load_inputs(buffer);
+//!     self.crossover.process(&mut self.tiles);
+//!     self.tiles.linked_peak(&mut self.key[..n]);
+//!     self.compute_gain(&mut self.key[..n]); // envelope + gain computer
+//!     self.tiles.apply_frame_gains(&self.key[..n]);
+//!     self.tiles.store_outputs(buffer);
+//! }
+//! ```
+
+use crate::buffer::Buffer;
+use crate::buffer_ops::dispatch;
+#[cfg(target_arch = "x86_64")]
+use crate::buffer_ops::avx2_available;
+use crate::sample::Sample;
+
+/// Frames per transpose block.
+pub const BLOCK_FRAMES: usize = 64;
+
+// =============================================================================
+// Kernels
+// =============================================================================
+
+/// Target-independent kernel bodies, one tile at a time.
+mod kernels {
+    use super::{BiquadCoefficients, BLOCK_FRAMES};
+    use crate::sample::Sample;
+
+    #[inline(always)]
+    pub fn load_tile<S: Sample, const W: usize>(tile: &mut [[S; W]], lanes: &[&[S]; W]) {
+        for (b, block) in tile.chunks_mut(BLOCK_FRAMES).enumerate() {
+            let start = b * BLOCK_FRAMES;
+            for (lane, src) in lanes.iter().enumerate() {
+                // Missing or short channels read as silence
+                let src = src.get(start..).unwrap_or(&[]);
+                let n = block.len().min(src.len());
+                for (frame, &s) in block[..n].iter_mut().zip(src) {
+                    frame[lane] = s;
+                }
+                for frame in &mut block[n..] {
+                    frame[lane] = S::ZERO;
+                }
+            }
+        }
+    }
+
+    #[inline(always)]
+    pub fn store_tile<S: Sample, const W: usize>(tile: &[[S; W]], lanes: &mut [&mut [S]; W]) {
+        for (b, block) in tile.chunks(BLOCK_FRAMES).enumerate() {
+            let start = b * BLOCK_FRAMES;
+            for (lane, dst) in lanes.iter_mut().enumerate() {
+                let Some(dst) = dst.get_mut(start..) else { continue };
+                for (d, frame) in dst.iter_mut().zip(block) {
+                    *d = frame[lane];
+                }
+            }
+        }
+    }
+
+    #[inline(always)]
+    pub fn scale_lanes<S: Sample, const W: usize>(tile: &mut [[S; W]], gains: &[S; W]) {
+        for frame in tile {
+            for (x, &g) in frame.iter_mut().zip(gains) {
+                *x = *x * g;
+            }
+        }
+    }
+
+    #[inline(always)]
+    pub fn scale_frames<S: Sample, const W: usize>(tile: &mut [[S; W]], gains: &[S]) {
+        for (frame, &g) in tile.iter_mut().zip(gains) {
+            for x in frame {
+                *x = *x * g;
+            }
+        }
+    }
+
+    #[inline(always)]
+    pub fn peak<S: Sample, const W: usize>(dst: &mut [S], tile: &[[S; W]]) {
+        for (d, frame) in dst.iter_mut().zip(tile) {
+            let mut peak = *d;
+            for &x in frame {
+                peak = peak.max(x.abs());
+            }
+            *d = peak;
+        }
+    }
+
+    #[inline(always)]
+    pub fn sum_squares<S: Sample, const W: usize>(dst: &mut [S], tile: &[[S; W]]) {
+        for (d, frame) in dst.iter_mut().zip(tile) {
+            let mut sum = *d;
+            for &x in frame {
+                sum = sum + x * x;
+            }
+            *d = sum;
+        }
+    }
+
+    #[inline(always)]
+    pub fn matrix_tile<S: Sample, const W: usize>(dst: &mut [[S; W]], src: &[[S; W]], columns: &[[S; W]; W]) {
+        for (d, s) in dst.iter_mut().zip(src) {
+            let mut acc = *d;
+            for (&x, column) in s.iter().zip(columns) {
+                for (y, &c) in acc.iter_mut().zip(column) {
+                    *y = *y + x * c;
+                }
+            }
+            *d = acc;
+        }
+    }
+
+    #[inline(always)]
+    pub fn biquad<S: Sample, const W: usize>(
+        tile: &mut [[S; W]],
+        c: &BiquadCoefficients<S>,
+        state: &mut [[S; W]; 2],
+    ) {
+        // Transposed direct form II, one lane per channel
+        let [mut z1, mut z2] = *state;
+        for frame in tile {
+            for lane in 0..W {
+                let x = frame[lane];
+                let y = c.b0 * x + z1[lane];
+                z1[lane] = c.b1 * x - c.a1 * y + z2[lane];
+                z2[lane] = c.b2 * x - c.a2 * y;
+                frame[lane] = y;
+            }
+        }
+        *state = [z1, z2];
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+mod avx2 {
+    use super::BiquadCoefficients;
+    use crate::sample::Sample;
+
+    macro_rules! wrap {
+        ($($name:ident($($arg:ident: $ty:ty),*);)*) => {$(
+            #[target_feature(enable = "avx2,fma")]
+            pub(super) unsafe fn $name<S: Sample, const W: usize>($($arg: $ty),*) {
+                super::kernels::$name($($arg),*)
+            }
+        )*};
+    }
+
+    wrap! {
+        load_tile(tile: &mut [[S; W]], lanes: &[&[S]; W]);
+        store_tile(tile: &[[S; W]], lanes: &mut [&mut [S]; W]);
+        scale_lanes(tile: &mut [[S; W]], gains: &[S; W]);
+        scale_frames(tile: &mut [[S; W]], gains: &[S]);
+        peak(dst: &mut [S], tile: &[[S; W]]);
+        sum_squares(dst: &mut [S], tile: &[[S; W]]);
+        matrix_tile(dst: &mut [[S; W]], src: &[[S; W]], columns: &[[S; W]; W]);
+        biquad(tile: &mut [[S; W]], c: &BiquadCoefficients<S>, state: &mut [[S; W]; 2]);
+    }
+}
+
+fn load_tile<S: Sample, const W: usize>(tile: &mut [[S; W]], lanes: &[&[S]; W]) {
+    dispatch!(load_tile(tile, lanes))
+}
+
+fn store_tile<S: Sample, const W: usize>(tile: &[[S; W]], lanes: &mut [&mut [S]; W]) {
+    dispatch!(store_tile(tile, lanes))
+}
+
+fn scale_lanes<S: Sample, const W: usize>(tile: &mut [[S; W]], gains: &[S; W]) {
+    dispatch!(scale_lanes(tile, gains))
+}
+
+fn scale_frames<S: Sample, const W: usize>(tile: &mut [[S; W]], gains: &[S]) {
+    dispatch!(scale_frames(tile, gains))
+}
+
+fn peak<S: Sample, const W: usize>(dst: &mut [S], tile: &[[S; W]]) {
+    dispatch!(peak(dst, tile))
+}
+
+fn sum_squares<S: Sample, const W: usize>(dst: &mut [S], tile: &[[S; W]]) {
+    dispatch!(sum_squares(dst, tile))
+}
+
+fn matrix_tile<S: Sample, const W: usize>(dst: &mut [[S; W]], src: &[[S; W]], columns: &[[S; W]; W]) {
+    dispatch!(matrix_tile(dst, src, columns))
+}
+
+fn biquad<S: Sample, const W: usize>(tile: &mut [[S; W]], c: &BiquadCoefficients<S>, state: &mut [[S; W]; 2]) {
+    dispatch!(biquad(tile, c, state))
+}
+
+// =============================================================================
+// Frame Tiles
+// =============================================================================
+
+/// Frame-major copy of a multichannel block, in tiles of `W` channels.
+///
+/// Allocates in [`new()`](Self::new) only; every other method is real-time
+/// safe.
+pub struct FrameTiles<S: Sample = f32, const W: usize = 8> {
+    /// Tile-major: tile `t` is `data[t * stride..][..stride]`
+    data: Vec<[S; W]>,
+    channels: usize,
+    /// Frames per tile (the maximum block size, at least 1)
+    stride: usize,
+    /// Valid frames of the current block
+    frames: usize,
+}
+
+impl<S: Sample, const W: usize> FrameTiles<S, W> {
+    /// Tiles for `channels` channels and blocks of up to `max_frames` frames.
+    pub fn new(channels: usize, max_frames: usize) -> Self {
+        assert!(W > 0, "tile width must be non-zero");
+        let stride = max_frames.max(1);
+        Self {
+            data: vec![[S::ZERO; W]; channels.div_ceil(W) * stride],
+            channels,
+            stride,
+            frames: 0,
+        }
+    }
+
+    /// Channels held.
+    #[inline]
+    pub fn channels(&self) -> usize {
+        self.channels
+    }
+
+    /// Number of tiles: `channels` divided by `W`, rounded up.
+    #[inline]
+    pub fn num_tiles(&self) -> usize {
+        self.channels.div_ceil(W)
+    }
+
+    /// Frames of the current block.
+    #[inline]
+    pub fn frames(&self) -> usize {
+        self.frames
+    }
+
+    /// Largest block that fits.
+    #[inline]
+    pub fn max_frames(&self) -> usize {
+        self.stride
+    }
+
+    /// Frames of tile `t` (channels `t * W ..`) for the current block.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the tile doesn't exist.
+    #[inline]
+    pub fn tile(&self, t: usize) -> &[[S; W]] {
+        &self.data[t * self.stride..][..self.frames]
+    }
+
+    /// Mutable frames of tile `t`, for custom channel-parallel kernels.
+    ///
+    /// Kernels should leave lanes past [`channels()`](Self::channels) at zero.
+    ///
+    /// # Panics
+    ///
+    /// Panics if the tile doesn't exist.
+    #[inline]
+    pub fn tile_mut(&mut self, t: usize) -> &mut [[S; W]] {
+        &mut self.data[t * self.stride..][..self.frames]
+    }
+
+    fn tiles(&self) -> impl Iterator<Item = &[[S; W]]> + '_ {
+        let frames = self.frames;
+        self.data.chunks_exact(self.stride).map(move |tile| &tile[..frames])
+    }
+
+    fn tiles_mut(&mut self) -> impl Iterator<Item = &mut [[S; W]]> + '_ {
+        let frames = self.frames;
+        self.data.chunks_exact_mut(self.stride).map(move |tile| &mut tile[..frames])
+    }
+
+    // =========================================================================
+    // Transposes
+    // =========================================================================
+
+    /// Start a block of `frames` frames (clamped to [`max_frames()`](Self::max_frames))
+    /// from planar channels.
+    ///
+    /// Channels past [`channels()`](Self::channels) are ignored; missing
+    /// channels and samples read as silence.
+    pub fn load<'s>(&mut self, channels: impl IntoIterator<Item = &'s [S]>, frames: usize)
+    where
+        S: 's,
+    {
+        self.frames = frames.min(self.stride);
+        let mut channels = channels.into_iter();
+        let mut remaining = self.channels;
+        for tile in self.tiles_mut() {
+            let mut lanes: [&[S]; W] = [&[]; W];
+            for lane in &mut lanes[..remaining.min(W)] {
+                *lane = channels.next().unwrap_or(&[]);
+            }
+            remaining = remaining.saturating_sub(W);
+            load_tile(tile, &lanes);
+        }
+    }
+
+    /// Write the current block back to planar channels.
+    ///
+    /// Writes at most [`frames()`](Self::frames) samples per channel;
+    /// extra channels are left untouched.
+    pub fn store<'d>(&self, channels: impl IntoIterator<Item = &'d mut [S]>)
+    where
+        S: 'd,
+    {
+        let mut channels = channels.into_iter();
+        let mut remaining = self.channels;
+        for tile in self.tiles() {
+            let mut lanes: [&mut [S]; W] = std::array::from_fn(|_| &mut [][..]);
+            for lane in &mut lanes[..remaining.min(W)] {
+                *lane = channels.next().unwrap_or(&mut []);
+            }
+            remaining = remaining.saturating_sub(W);
+            store_tile(tile, &mut lanes);
+        }
+    }
+
+    /// Load a buffer's main inputs, keeping channel indices.
+    ///
+    /// Unlike [`Buffer::inputs()`], inactive inputs count as silent
+    /// channels rather than being skipped.
+    pub fn load_inputs(&mut self, buffer: &Buffer<'_, S>) {
+        let channels = buffer.num_input_channels();
+        self.load((0..channels).map(|ch| buffer.input(ch)), buffer.num_samples());
+    }
+
+    /// Store the current block to a buffer's main outputs.
+    pub fn store_outputs(&self, buffer: &mut Buffer<'_, S>) {
+        self.store(buffer.outputs_mut());
+    }
+
+    // =========================================================================
+    // Kernels
+    // =========================================================================
+
+    /// Multiply each channel by its own gain.
+    ///
+    /// Channels without a gain (`gains` shorter than the channel count)
+    /// are left unchanged.
+    pub fn apply_gains(&mut self, gains: &[S]) {
+        for (t, tile) in self.tiles_mut().enumerate() {
+            let lanes: [S; W] = std::array::from_fn(|lane| gains.get(t * W + lane).copied().unwrap_or(S::ONE));
+            scale_lanes(tile, &lanes);
+        }
+    }
+
+    /// Multiply every channel of frame `i` by `gains[i]`.
+    ///
+    /// The gain stage of linked dynamics. Frames without a gain are left
+    /// unchanged.
+    pub fn apply_frame_gains(&mut self, gains: &[S]) {
+        for tile in self.tiles_mut() {
+            scale_frames(tile, gains);
+        }
+    }
+
+    /// Per-frame peak across all channels: `dst[i] = max |x[ch][i]|`.
+    ///
+    /// The detector input of linked dynamics. Writes at most
+    /// [`frames()`](Self::frames) values.
+    pub fn linked_peak(&self, dst: &mut [S]) {
+        let n = self.frames.min(dst.len());
+        let dst = &mut dst[..n];
+        dst.fill(S::ZERO);
+        for tile in self.tiles() {
+            peak(dst, tile);
+        }
+    }
+
+    /// Per-frame mean square across all channels: `dst[i] = Σ x[ch][i]² / channels`.
+    ///
+    /// Writes at most [`frames()`](Self::frames) values.
+    pub fn linked_power(&self, dst: &mut [S]) {
+        let n = self.frames.min(dst.len());
+        let dst = &mut dst[..n];
+        dst.fill(S::ZERO);
+        for tile in self.tiles() {
+            sum_squares(dst, tile);
+        }
+        if self.channels > 1 {
+            crate::buffer_ops::scale(dst, S::from_f64(1.0 / self.channels as f64));
+        }
+    }
+
+    /// Mix into `dst` through a gain matrix.
+    ///
+    /// `matrix` is row-major with one row of `self.channels()` coefficients
+    /// per output channel, as in [`AuxOutput::mix_matrix()`](crate::AuxOutput::mix_matrix);
+    /// missing coefficients count as zero. `dst` takes this block's frame
+    /// count (clamped to its capacity).
+    pub fn mix_matrix_into(&self, dst: &mut Self, matrix: &[S]) {
+        let inputs = self.channels;
+        let outputs = dst.channels;
+        dst.frames = self.frames.min(dst.stride);
+        let frames = dst.frames;
+        for (t, out) in dst.tiles_mut().enumerate() {
+            out.fill([S::ZERO; W]);
+            for (u, src) in self.data.chunks_exact(self.stride).enumerate() {
+                // columns[i][o]: input u * W + i to output t * W + o
+                let columns: [[S; W]; W] = std::array::from_fn(|i| {
+                    std::array::from_fn(|o| {
+                        let (input, output) = (u * W + i, t * W + o);
+                        match input < inputs && output < outputs {
+                            true => matrix.get(output * inputs + input).copied().unwrap_or(S::ZERO),
+                            false => S::ZERO,
+                        }
+                    })
+                });
+                if columns.iter().flatten().all(|&c| c == S::ZERO) {
+                    continue;
+                }
+                matrix_tile(out, &src[..frames], &columns);
+            }
+        }
+    }
+}
+
+// =============================================================================
+// Tile Biquad
+// =============================================================================
+
+/// Normalized biquad coefficients (`a0 = 1`).
+///
+/// `y = b0·x + b1·x₋₁ + b2·x₋₂ − a1·y₋₁ − a2·y₋₂`
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct BiquadCoefficients<S: Sample = f32> {
+    pub b0: S,
+    pub b1: S,
+    pub b2: S,
+    pub a1: S,
+    pub a2: S,
+}
+
+impl<S: Sample> BiquadCoefficients<S> {
+    /// Passes the signal through unchanged.
+    pub const IDENTITY: Self = Self {
+        b0: S::ONE,
+        b1: S::ZERO,
+        b2: S::ZERO,
+        a1: S::ZERO,
+        a2: S::ZERO,
+    };
+
+    /// Normalize raw coefficients by `a0`.
+    pub fn new(b0: S, b1: S, b2: S, a0: S, a1: S, a2: S) -> Self {
+        Self {
+            b0: b0 / a0,
+            b1: b1 / a0,
+            b2: b2 / a0,
+            a1: a1 / a0,
+            a2: a2 / a0,
+        }
+    }
+}
+
+impl<S: Sample> Default for BiquadCoefficients<S> {
+    fn default() -> Self {
+        Self::IDENTITY
+    }
+}
+
+/// One biquad design run on every channel of a [`FrameTiles`].
+///
+/// Each channel keeps its own state; the coefficients are shared, so a
+/// frame of a tile is filtered in a single vector step.
+pub struct TileBiquad<S: Sample = f32, const W: usize = 8> {
+    coefficients: BiquadCoefficients<S>,
+    /// `[z1, z2]` per tile
+    state: Vec<[[S; W]; 2]>,
+}
+
+impl<S: Sample, const W: usize> TileBiquad<S, W> {
+    /// Identity filter with state for `channels` channels.
+    pub fn new(channels: usize) -> Self {
+        Self {
+            coefficients: BiquadCoefficients::IDENTITY,
+            state: vec![[[S::ZERO; W]; 2]; channels.div_ceil(W)],
+        }
+    }
+
+    /// Current coefficients.
+    #[inline]
+    pub fn coefficients(&self) -> BiquadCoefficients<S> {
+        self.coefficients
+    }
+
+    /// Change the coefficients, keeping the filter state.
+    #[inline]
+    pub fn set_coefficients(&mut self, coefficients: BiquadCoefficients<S>) {
+        self.coefficients = coefficients;
+    }
+
+    /// Clear the filter state of every channel.
+    pub fn reset(&mut self) {
+        self.state.fill([[S::ZERO; W]; 2]);
+    }
+
+    /// Filter the current block in place.
+    ///
+    /// Tiles beyond the channel count given to [`new()`](Self::new) are
+    /// left unfiltered.
+    pub fn process(&mut self, tiles: &mut FrameTiles<S, W>) {
+        debug_assert!(self.state.len() >= tiles.num_tiles(), "TileBiquad has fewer channels than the tiles");
+        for (tile, state) in tiles.tiles_mut().zip(&mut self.state) {
+            biquad(tile, &self.coefficients, state);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::buffer_ops::matrix_row;
+
+    /// `channels` planar signals of `frames` distinct samples.
+    fn planar(channels: usize, frames: usize) -> Vec<Vec<f32>> {
+        (0..channels)
+            .map(|ch| (0..frames).map(|i| ((i * 7 + ch * 13) as f32 * 0.011).sin() * (1.0 + ch as f32 * 0.1)).collect())
+            .collect()
+    }
+
+    fn assert_close(actual: &[f32], expected: &[f32], tolerance: f32) {
+        assert_eq!(actual.len(), expected.len());
+        for (i, (a, e)) in actual.iter().zip(expected).enumerate() {
+            assert!((a - e).abs() <= tolerance, "sample {i}: {a} vs {e}");
+        }
+    }
+
+    #[test]
+    fn test_round_trip_pads_silent_lanes() {
+        // 11 channels over two 8-wide tiles and one 16-wide tile; 150 frames cross transpose blocks
+        let input = planar(11, 150);
+        let mut output = vec![vec![0.0f32; 150]; 11];
+
+        let mut tiles = FrameTiles::<f32, 8>::new(11, 200);
+        tiles.load(input.iter().map(Vec::as_slice), 150);
+        assert_eq!((tiles.num_tiles(), tiles.frames()), (2, 150));
+        assert_eq!(tiles.tile(1)[3][..3], [input[8][3], input[9][3], input[10][3]]);
+        assert!(tiles.tile(1).iter().all(|frame| frame[3..] == [0.0; 5]));
+        tiles.store(output.iter_mut().map(Vec::as_mut_slice));
+        assert_eq!(output, input);
+
+        let mut wide = FrameTiles::<f32, 16>::new(11, 150);
+        output.iter_mut().for_each(|ch| ch.fill(0.0));
+        wide.load(input.iter().map(Vec::as_slice), 150);
+        wide.store(output.iter_mut().map(Vec::as_mut_slice));
+        assert_eq!(output, input);
+    }
+
+    #[test]
+    fn test_matrix_matches_planar_mixdown() {
+        // 12 inputs down to 10 outputs (7.1.4 → 7.1.2 style fold)
+        let input = planar(12, 100);
+        let matrix: Vec<f32> = (0..10 * 12).map(|k| if k % 5 == 0 { 0.0 } else { (k as f32 * 0.37).cos() * 0.5 }).collect();
+
+        let mut source = FrameTiles::<f32>::new(12, 128);
+        let mut dest = FrameTiles::<f32>::new(10, 128);
+        source.load(input.iter().map(Vec::as_slice), 100);
+        source.mix_matrix_into(&mut dest, &matrix);
+        let mut output = vec![vec![0.0f32; 100]; 10];
+        dest.store(output.iter_mut().map(Vec::as_mut_slice));
+
+        let inputs: Vec<&[f32]> = input.iter().map(Vec::as_slice).collect();
+        for (o, channel) in output.iter().enumerate() {
+            let mut expected = vec![0.0f32; 100];
+            matrix_row(&mut expected, &inputs, &matrix[o * 12..][..12]);
+            assert_close(channel, &expected, 1e-5);
+        }
+        // Padding lanes of the last output tile stay silent
+        assert!(dest.tile(1).iter().all(|frame| frame[2..] == [0.0; 6]));
+    }
+
+    #[test]
+    fn test_biquad_matches_per_channel_filter() {
+        let input = planar(10, 300);
+        let c = BiquadCoefficients::new(0.2f32, 0.4, 0.2, 1.0, -0.6, 0.3);
+        let mut tiles = FrameTiles::<f32>::new(10, 128);
+        let mut filter = TileBiquad::<f32>::new(10);
+        filter.set_coefficients(c);
+
+        // Three blocks, so state carries across calls
+        let mut output = vec![vec![0.0f32; 300]; 10];
+        for start in (0..300).step_by(128) {
+            let n = (300 - start).min(128);
+            tiles.load(input.iter().map(|ch| &ch[start..start + n]), n);
+            filter.process(&mut tiles);
+            tiles.store(output.iter_mut().map(|ch| &mut ch[start..start + n]));
+        }
+
+        for (channel, signal) in input.iter().enumerate() {
+            let (mut z1, mut z2) = (0.0f32, 0.0f32);
+            let expected: Vec<f32> = signal
+                .iter()
+                .map(|&x| {
+                    let y = c.b0 * x + z1;
+                    z1 = c.b1 * x - c.a1 * y + z2;
+                    z2 = c.b2 * x - c.a2 * y;
+                    y
+                })
+                .collect();
+            assert_close(&output[channel], &expected, 1e-5);
+        }
+    }
+
+    #[test]
+    fn test_linked_detection_and_gain() {
+        let input = planar(9, 50);
+        let mut tiles = FrameTiles::<f32>::new(9, 64);
+        tiles.load(input.iter().map(Vec::as_slice), 50);
+
+        let mut peak = [0.0f32; 50];
+        let mut power = [0.0f32; 50];
+        tiles.linked_peak(&mut peak);
+        tiles.linked_power(&mut power);
+        for i in 0..50 {
+            let expected_peak = input.iter().map(|ch| ch[i].abs()).fold(0.0, f32::max);
+            let expected_power = input.iter().map(|ch| ch[i] * ch[i]).sum::<f32>() / 9.0;
+            assert_eq!(peak[i], expected_peak);
+            assert!((power[i] - expected_power).abs() < 1e-6);
+        }
+
+        // Per-frame gain times per-channel trim
+        let frame_gains: Vec<f32> = (0..50).map(|i| 1.0 - i as f32 * 0.01).collect();
+        let trims = [0.5f32, 2.0];
+        tiles.apply_frame_gains(&frame_gains);
+        tiles.apply_gains(&trims);
+        let mut output = vec![vec![0.0f32; 50]; 9];
+        tiles.store(output.iter_mut().map(Vec::as_mut_slice));
+        for (ch, channel) in output.iter().enumerate() {
+            let trim = trims.get(ch).copied().unwrap_or(1.0);
+            let expected: Vec<f32> = input[ch].iter().zip(&frame_gains).map(|(x, g)| x * g * trim).collect();
+            assert_close(channel, &expected, 1e-6);
+        }
+    }
+}
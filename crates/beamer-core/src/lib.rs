@@ -11,6 +11,7 @@
 //! - [`Plugin`] - Complete plugin trait combining DSP and parameters
 //! - [`AudioProcessor`] - Core DSP processing trait
 //! - [`Parameters`] - Parameter collection trait
+//! - [`SmootherBank`] - All smoothed parameters of a collection advanced together
 //! - [`EditorDelegate`] - GUI configuration and callbacks
 //!
 //! ## Types
@@ -19,21 +20,42 @@
 //! - [`Rect`] - Rectangle in pixels
 //! - [`Buffer`] - Main audio I/O buffer
 //! - [`AuxiliaryBuffers`] - Sidechain and aux bus access
+//! - [`buffer_ops`] - Vectorized gain ramps, mixing, panning and mixdown
+//! - [`FrameTiles`] - Frame-major channel tiles for gain matrices, linked dynamics and shared filters on wide buses
+//! - [`BusRenderPool`] - Parallel per-output-bus rendering
 //! - [`BusInfo`] - Audio bus configuration
 //! - [`ParameterInfo`] - Parameter metadata
 //! - [`PluginError`] - Error types
 //! - [`MidiEvent`] - MIDI event types
+//! - [`MidiOutputFilter`] - Opt-in coalescing and rate limiting of MIDI output
 //! - [`Transport`] - DAW transport/timing state
 //! - [`ProcessContext`] - Processing context with sample rate and transport
+//! - [`LookupTable`] - Interpolated function tables with shared `fast_*` helpers
+//! - [`Analyzer`] - Headless spectrum/waveform analyzer feed
+//! - [`DspArena`] - Contiguous 64-byte-aligned arena for per-instance DSP state
+//! - [`AudioFifo`] - Lock-free SPSC audio FIFO for moving frames between threads
+//! - [`UiSync`] - Frame-coalesced parameter/meter diffs for editor UIs
+//! - [`SharedService`] - Lazily created, reference-counted process-wide services
+//! - [`trace`] - Per-thread span recording with Chrome Trace Event export
 
+pub mod analyzer;
+pub mod arena;
+pub mod audio_fifo;
 pub mod buffer;
+pub mod buffer_ops;
+pub mod bus_render;
 pub mod bypass;
 pub mod config;
+pub mod deadline;
 pub mod editor;
 pub mod error;
+pub mod frame_tiles;
+pub mod lookup;
 pub mod midi;
 pub mod midi_cc_config;
+pub mod midi_cc_curves;
 pub mod midi_cc_state;
+pub mod midi_output;
 pub mod parameter_format;
 pub mod parameter_groups;
 pub mod parameter_info;
@@ -42,16 +64,35 @@ pub mod parameter_store;
 pub mod parameter_types;
 pub mod plugin;
 pub mod process_context;
+pub mod residency;
 pub mod sample;
+pub mod shared;
+pub mod smoother_bank;
 pub mod smoothing;
+pub mod trace;
 pub mod types;
+pub mod ui_sync;
 
 // Re-exports for convenience
-pub use buffer::{AuxiliaryBuffers, AuxInput, AuxOutput, Buffer};
+pub use analyzer::{
+    Analyzer, AnalyzerConfig, AnalyzerEngine, AnalyzerFrame, AnalyzerTap, AnalyzerView,
+    AnalyzerWorker, ANALYZER_DB_FLOOR,
+};
+pub use arena::{ArenaLayout, ArenaSlice, DspArena, ARENA_ALIGN};
+pub use audio_fifo::{AudioFifo, AudioFifoConsumer, AudioFifoProducer, FifoLayout, ReadChunk, WriteChunk};
+pub use buffer::{AuxiliaryBuffers, AuxInput, AuxOutput, Buffer, ChannelPair};
+pub use bus_render::{BusJob, BusRenderPool};
 pub use config::PluginConfig;
+pub use deadline::{DeadlineConfig, DeadlineMonitor, QualityLevel};
 pub use bypass::{BypassAction, BypassHandler, BypassState, CrossfadeCurve};
 pub use editor::{EditorConstraints, EditorDelegate, NoEditor};
 pub use error::{PluginError, PluginResult};
+pub use frame_tiles::{BiquadCoefficients, FrameTiles, TileBiquad};
+pub use lookup::{
+    fast_cos, fast_db_to_gain, fast_exp, fast_exp2, fast_gain_to_db, fast_log2, fast_sin,
+    fast_sin_phase, fast_tanh, init_shared_tables, sine_table, tanh_table, LookupTable,
+    GAIN_DB_FLOOR,
+};
 pub use midi::{
     // Basic types
     cc, ChannelPressure, ControlChange, MidiBuffer, MidiChannel, MidiEvent, MidiEventKind,
@@ -84,13 +125,21 @@ pub use parameter_groups::{GroupId, GroupInfo, ParameterGroups, ROOT_GROUP_ID};
 pub use parameter_info::{ParameterFlags, ParameterInfo};
 pub use parameter_store::{NoParameters, ParameterStore};
 pub use parameter_types::{BoolParameter, EnumParameter, EnumParameterValue, FloatParameter, IntParameter, ParameterRef, Parameters};
+pub use smoother_bank::SmootherBank;
 pub use smoothing::{Smoother, SmoothingStyle};
-pub use midi_cc_config::{controller, MidiCcConfig, MAX_CC_CONTROLLER};
+pub use midi_cc_config::{controller, CcCurveMode, MidiCcConfig, MAX_CC_CONTROLLER};
+pub use midi_cc_curves::MidiCcCurves;
 pub use midi_cc_state::{MidiCcState, MIDI_CC_PARAM_BASE};
+pub use midi_output::{MidiOutputConfig, MidiOutputFilter};
 pub use plugin::{
     AudioProcessor, AudioSetup, BusInfo, BusLayout, BusType, FullAudioSetup, HasParameters,
-    Midi1Assignment, Midi2Assignment, MidiControllerAssignment, NoConfig, Plugin, ProcessorConfig,
+    Midi1Assignment, Midi2Assignment, MidiControllerAssignment, NoConfig, Plugin, ProcessCapabilities,
+    ProcessorConfig,
 };
 pub use process_context::{FrameRate, ProcessContext, Transport};
+pub use residency::{MemoryPolicy, PrepareScope, ResidencyReport};
 pub use sample::Sample;
+pub use shared::SharedService;
+pub use trace::{TraceConfig, TraceSnapshot, TraceSpan};
 pub use types::{ParameterId, ParameterValue, Rect, Size, MAX_AUX_BUSES, MAX_BUSES, MAX_CHANNELS};
+pub use ui_sync::{UiDiff, UiSync, UiSyncConfig, UiSyncEmitter, UiSyncWriter};
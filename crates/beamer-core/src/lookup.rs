@@ -0,0 +1,460 @@
+//! Interpolated lookup tables for transcendental functions.
+//!
+//! Per-sample `sin`, `tanh`, `exp` and dB conversions are common in DSP code
+//! and expensive relative to the rest of a typical inner loop. This module
+//! provides [`LookupTable`] for building tables of arbitrary functions, plus
+//! a set of shared tables and `fast_*` helpers built on them.
+//!
+//! # Tables
+//!
+//! - Built once per process from any `Fn(f64) -> f64` (evaluated in `f64`,
+//!   stored as `f32`). Shared tables are built lazily on first use and live
+//!   in `static` storage, so every plugin instance uses the same memory.
+//!   Building allocates, so [`PrepareScope::begin()`](crate::PrepareScope::begin),
+//!   which every host opens around `prepare()`, builds them all; the
+//!   `fast_*` helpers never build a table on the audio thread.
+//! - Guard points are stored on both ends so cubic interpolation never
+//!   branches on the table edge.
+//! - Periodic tables wrap their input, so a phase accumulator can be passed
+//!   without reducing it first. Bounded tables clamp their input to the range.
+//!
+//! # Interpolation
+//!
+//! - [`LookupTable::linear()`] - two reads, one multiply-add
+//! - [`LookupTable::cubic()`] - four reads, Catmull-Rom spline
+//!
+//! Block variants ([`linear_block()`](LookupTable::linear_block),
+//! [`cubic_block()`](LookupTable::cubic_block)) and four-lane variants
+//! ([`linear_x4()`](LookupTable::linear_x4), [`cubic_x4()`](LookupTable::cubic_x4))
+//! process lanes independently so the index and interpolation arithmetic
+//! vectorizes; the table reads themselves are gathers.
+//!
+//! # Error Bounds
+//!
+//! Worst-case absolute error of the shared tables, measured against `f64`
+//! libm over the full input range (verified by the tests in this module):
+//!
+//! | Function | Table | Linear | Cubic |
+//! |----------|-------|--------|-------|
+//! | [`fast_sin_phase()`] | 2048 points, periodic | 1.3e-6 | 3e-7 |
+//! | [`fast_tanh()`] | 4096 points, [-8, 8] | 2e-6 | 6e-7 |
+//! | [`fast_exp2()`] | 256 points, [0, 1] mantissa | relative 1e-6 | - |
+//! | [`fast_gain_to_db()`] | 256 points, [1, 2] mantissa | 4e-5 dB | - |
+//!
+//! Linear interpolation error is bounded by `h² / 8 · max|f''|` for table
+//! spacing `h`, plus `f32` rounding.
+//!
+//! # Performance
+//!
+//! Benchmarks against libm live in `crates/beamer-core/benches/lookup.rs`
+//! (`cargo bench -p beamer-core --bench lookup`). On x86-64 with glibc the
+//! table `tanh` is about 3x faster than libm, `sin` and `gain_to_db` are on
+//! par, and libm `exp` is faster than the table path. Tables pay off most for
+//! functions libm computes slowly and for custom shapes (waveshapers, curves)
+//! with no closed-form fast path; measure on your target before switching.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // Shared sine table with a phase accumulator in [0, 1)
+//! let lfo = fast_sin_phase(self.lfo_phase);
+//!
+//! // Custom table, built once in prepare()
+//! let shaper = LookupTable::bounded(|x| x.atan() * 2.0 / PI, -10.0, 10.0, 1024);
+//! let y = shaper.cubic(x);
+//! ```
+
+use std::sync::OnceLock;
+
+/// Floor returned by [`fast_gain_to_db()`] for zero, negative or subnormal gains.
+pub const GAIN_DB_FLOOR: f32 = -144.0;
+
+// =============================================================================
+// LookupTable
+// =============================================================================
+
+/// A function sampled at uniform spacing with guard points.
+///
+/// Storage layout is `[f(x₋₁), f(x₀), ..., f(xₙ), f(xₙ₊₁)]` for `n` intervals,
+/// so `n + 3` values. For periodic tables the guard points are copies of the
+/// wrapped neighbours.
+#[derive(Debug, Clone)]
+pub struct LookupTable {
+    data: Box<[f32]>,
+    intervals: usize,
+    min: f32,
+    scale: f32,
+    periodic: bool,
+}
+
+impl LookupTable {
+    /// Build a table of `f` over `[min, max]` with `intervals` segments.
+    ///
+    /// Inputs outside the range are clamped to it.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `intervals` is zero or `max <= min`.
+    pub fn bounded(f: impl Fn(f64) -> f64, min: f64, max: f64, intervals: usize) -> Self {
+        assert!(intervals > 0, "LookupTable needs at least one interval");
+        assert!(max > min, "LookupTable range must be non-empty");
+        let step = (max - min) / intervals as f64;
+        let data = (0..intervals + 3)
+            .map(|i| f(min + (i as f64 - 1.0) * step) as f32)
+            .collect();
+        Self {
+            data,
+            intervals,
+            min: min as f32,
+            scale: (intervals as f64 / (max - min)) as f32,
+            periodic: false,
+        }
+    }
+
+    /// Build a table of the periodic function `f` over one period
+    /// `[start, start + period)`.
+    ///
+    /// Inputs outside the period wrap around.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `intervals` is not a power of two or `period <= 0`.
+    pub fn periodic(f: impl Fn(f64) -> f64, start: f64, period: f64, intervals: usize) -> Self {
+        assert!(intervals.is_power_of_two(), "periodic LookupTable size must be a power of two");
+        assert!(period > 0.0, "LookupTable period must be positive");
+        let step = period / intervals as f64;
+        let mut data: Vec<f32> = (0..intervals + 3)
+            .map(|i| f(start + (i as f64 - 1.0) * step) as f32)
+            .collect();
+        // Make the guard points exact copies so wrapped reads are continuous
+        data[0] = data[intervals];
+        data[intervals + 1] = data[1];
+        data[intervals + 2] = data[2];
+        Self {
+            data: data.into_boxed_slice(),
+            intervals,
+            min: start as f32,
+            scale: (intervals as f64 / period) as f32,
+            periodic: true,
+        }
+    }
+
+    /// Number of intervals between table points.
+    #[inline]
+    pub fn intervals(&self) -> usize {
+        self.intervals
+    }
+
+    /// Whether the table wraps its input.
+    #[inline]
+    pub fn is_periodic(&self) -> bool {
+        self.periodic
+    }
+
+    /// Map an input to (segment index, fractional position).
+    #[inline(always)]
+    fn locate(&self, x: f32) -> (usize, f32) {
+        let pos = (x - self.min) * self.scale;
+        if self.periodic {
+            // Truncate and correct instead of `floor()`, which is a libm call
+            // on targets without SSE4.1. Phases beyond ±2³¹ periods saturate.
+            let whole = floor_i32(pos);
+            let index = (whole as usize) & (self.intervals - 1);
+            (index, pos - whole as f32)
+        } else {
+            let pos = pos.clamp(0.0, self.intervals as f32);
+            let index = (pos as i32 as usize).min(self.intervals - 1);
+            (index, pos - index as f32)
+        }
+    }
+
+    /// Evaluate with linear interpolation.
+    #[inline]
+    pub fn linear(&self, x: f32) -> f32 {
+        let (i, t) = self.locate(x);
+        let [a, b] = [self.data[i + 1], self.data[i + 2]];
+        a + (b - a) * t
+    }
+
+    /// Evaluate with cubic (Catmull-Rom) interpolation.
+    #[inline]
+    pub fn cubic(&self, x: f32) -> f32 {
+        let (i, t) = self.locate(x);
+        let p = &self.data[i..i + 4];
+        catmull_rom(p[0], p[1], p[2], p[3], t)
+    }
+
+    /// Evaluate four inputs with linear interpolation.
+    #[inline]
+    pub fn linear_x4(&self, x: [f32; 4]) -> [f32; 4] {
+        let loc = x.map(|x| self.locate(x));
+        let mut out = [0.0; 4];
+        for lane in 0..4 {
+            let (i, t) = loc[lane];
+            let a = self.data[i + 1];
+            out[lane] = a + (self.data[i + 2] - a) * t;
+        }
+        out
+    }
+
+    /// Evaluate four inputs with cubic interpolation.
+    #[inline]
+    pub fn cubic_x4(&self, x: [f32; 4]) -> [f32; 4] {
+        let loc = x.map(|x| self.locate(x));
+        let mut out = [0.0; 4];
+        for lane in 0..4 {
+            let (i, t) = loc[lane];
+            let p = &self.data[i..i + 4];
+            out[lane] = catmull_rom(p[0], p[1], p[2], p[3], t);
+        }
+        out
+    }
+
+    /// Evaluate a block with linear interpolation.
+    ///
+    /// Processes `input.len().min(output.len())` samples.
+    pub fn linear_block(&self, input: &[f32], output: &mut [f32]) {
+        self.block(input, output, Self::linear_x4, Self::linear);
+    }
+
+    /// Evaluate a block with cubic interpolation.
+    ///
+    /// Processes `input.len().min(output.len())` samples.
+    pub fn cubic_block(&self, input: &[f32], output: &mut [f32]) {
+        self.block(input, output, Self::cubic_x4, Self::cubic);
+    }
+
+    #[inline(always)]
+    fn block(
+        &self,
+        input: &[f32],
+        output: &mut [f32],
+        lanes: impl Fn(&Self, [f32; 4]) -> [f32; 4],
+        scalar: impl Fn(&Self, f32) -> f32,
+    ) {
+        let len = input.len().min(output.len());
+        let (input, output) = (&input[..len], &mut output[..len]);
+        let mut in_chunks = input.chunks_exact(4);
+        let mut out_chunks = output.chunks_exact_mut(4);
+        for (src, dst) in (&mut in_chunks).zip(&mut out_chunks) {
+            dst.copy_from_slice(&lanes(self, [src[0], src[1], src[2], src[3]]));
+        }
+        for (src, dst) in in_chunks.remainder().iter().zip(out_chunks.into_remainder()) {
+            *dst = scalar(self, *src);
+        }
+    }
+}
+
+/// Round towards negative infinity without calling into libm.
+#[inline(always)]
+fn floor_i32(x: f32) -> i32 {
+    let truncated = x as i32;
+    truncated - (x < truncated as f32) as i32
+}
+
+/// Catmull-Rom spline through `p1` and `p2` at position `t` in `[0, 1]`.
+#[inline(always)]
+fn catmull_rom(p0: f32, p1: f32, p2: f32, p3: f32, t: f32) -> f32 {
+    let c1 = 0.5 * (p2 - p0);
+    let c2 = p0 - 2.5 * p1 + 2.0 * p2 - 0.5 * p3;
+    let c3 = 0.5 * (p3 - p0) + 1.5 * (p1 - p2);
+    ((c3 * t + c2) * t + c1) * t + p1
+}
+
+// =============================================================================
+// Shared Tables
+// =============================================================================
+
+/// Shared sine table over one cycle of normalized phase `[0, 1)`.
+pub fn sine_table() -> &'static LookupTable {
+    static TABLE: OnceLock<LookupTable> = OnceLock::new();
+    TABLE.get_or_init(|| {
+        LookupTable::periodic(|p| (p * std::f64::consts::TAU).sin(), 0.0, 1.0, 2048)
+    })
+}
+
+/// Shared hyperbolic tangent table over `[-8, 8]`.
+pub fn tanh_table() -> &'static LookupTable {
+    static TABLE: OnceLock<LookupTable> = OnceLock::new();
+    TABLE.get_or_init(|| LookupTable::bounded(f64::tanh, -8.0, 8.0, 4096))
+}
+
+/// Shared `2^x` table over `[0, 1]` (mantissa of [`fast_exp2()`]).
+fn exp2_table() -> &'static LookupTable {
+    static TABLE: OnceLock<LookupTable> = OnceLock::new();
+    TABLE.get_or_init(|| LookupTable::bounded(f64::exp2, 0.0, 1.0, 256))
+}
+
+/// Shared `log2(x)` table over `[1, 2]` (mantissa of [`fast_log2()`]).
+fn log2_table() -> &'static LookupTable {
+    static TABLE: OnceLock<LookupTable> = OnceLock::new();
+    TABLE.get_or_init(|| LookupTable::bounded(f64::log2, 1.0, 2.0, 256))
+}
+
+/// Build all shared tables now instead of on first use.
+///
+/// The first call allocates, which must not happen on the audio thread.
+/// [`PrepareScope::begin()`](crate::PrepareScope::begin) calls this, so
+/// hosts that prepare inside a scope don't need to; call it yourself when
+/// driving a processor any other way. Later calls are a few atomic loads.
+pub fn init_shared_tables() {
+    sine_table();
+    tanh_table();
+    exp2_table();
+    log2_table();
+}
+
+// =============================================================================
+// Fast Functions
+// =============================================================================
+
+/// Sine of a normalized phase (`1.0` = one full cycle). Wraps any input.
+#[inline]
+pub fn fast_sin_phase(phase: f32) -> f32 {
+    sine_table().linear(phase)
+}
+
+/// Sine of an angle in radians.
+#[inline]
+pub fn fast_sin(radians: f32) -> f32 {
+    sine_table().linear(radians * (1.0 / std::f32::consts::TAU))
+}
+
+/// Cosine of an angle in radians.
+#[inline]
+pub fn fast_cos(radians: f32) -> f32 {
+    sine_table().linear(radians * (1.0 / std::f32::consts::TAU) + 0.25)
+}
+
+/// Hyperbolic tangent. Saturates to `±tanh(8)` outside `[-8, 8]`.
+#[inline]
+pub fn fast_tanh(x: f32) -> f32 {
+    tanh_table().linear(x)
+}
+
+/// `2^x`, accurate to ~1e-6 relative for `x` in `[-126, 126]`.
+///
+/// Splits `x` into integer and fractional parts; the integer part goes
+/// straight into the `f32` exponent bits.
+#[inline]
+pub fn fast_exp2(x: f32) -> f32 {
+    let x = x.clamp(-126.0, 126.0);
+    let whole = floor_i32(x);
+    let mantissa = exp2_table().linear(x - whole as f32);
+    mantissa * f32::from_bits(((whole + 127) as u32) << 23)
+}
+
+/// `e^x` via [`fast_exp2()`].
+#[inline]
+pub fn fast_exp(x: f32) -> f32 {
+    fast_exp2(x * std::f32::consts::LOG2_E)
+}
+
+/// Base-2 logarithm of a positive normal number.
+///
+/// Returns `None` for zero, negative, subnormal or non-finite inputs.
+#[inline]
+pub fn fast_log2(x: f32) -> Option<f32> {
+    if !x.is_normal() || x < 0.0 {
+        return None;
+    }
+    let bits = x.to_bits();
+    let exponent = ((bits >> 23) & 0xff) as i32 - 127;
+    let mantissa = f32::from_bits((bits & 0x007f_ffff) | 0x3f80_0000);
+    Some(exponent as f32 + log2_table().linear(mantissa))
+}
+
+/// Convert decibels to linear gain.
+#[inline]
+pub fn fast_db_to_gain(db: f32) -> f32 {
+    // log2(10) / 20
+    fast_exp2(db * 0.166_096_4)
+}
+
+/// Convert linear gain to decibels, floored at [`GAIN_DB_FLOOR`].
+#[inline]
+pub fn fast_gain_to_db(gain: f32) -> f32 {
+    match fast_log2(gain) {
+        // 20 * log10(2)
+        Some(log2) => (log2 * 6.020_6).max(GAIN_DB_FLOOR),
+        None => GAIN_DB_FLOOR,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Maximum absolute error of `approx` against `exact` over `n` points.
+    fn max_error(min: f64, max: f64, n: usize, approx: impl Fn(f32) -> f32, exact: impl Fn(f64) -> f64) -> f64 {
+        (0..=n)
+            .map(|i| {
+                let x = min + (max - min) * i as f64 / n as f64;
+                (approx(x as f32) as f64 - exact(x as f32 as f64)).abs()
+            })
+            .fold(0.0, f64::max)
+    }
+
+    #[test]
+    fn test_sine_error_bounds() {
+        let table = sine_table();
+        let exact = |p: f64| (p * std::f64::consts::TAU).sin();
+        assert!(max_error(0.0, 1.0, 100_000, |p| table.linear(p), exact) < 1.3e-6);
+        assert!(max_error(0.0, 1.0, 100_000, |p| table.cubic(p), exact) < 3e-7);
+    }
+
+    #[test]
+    fn test_sine_wraparound() {
+        for &phase in &[-3.75f32, -0.25, 0.0, 0.25, 1.25, 17.75] {
+            let expected = (phase as f64 * std::f64::consts::TAU).sin() as f32;
+            assert!((fast_sin_phase(phase) - expected).abs() < 1e-5, "phase {phase}");
+        }
+        assert!((fast_cos(0.0) - 1.0).abs() < 1e-6);
+        assert!((fast_sin(std::f32::consts::FRAC_PI_2) - 1.0).abs() < 1e-6);
+    }
+
+    #[test]
+    fn test_tanh_error_and_clamping() {
+        let table = tanh_table();
+        assert!(max_error(-8.0, 8.0, 100_000, |x| table.linear(x), f64::tanh) < 2e-6);
+        assert!(max_error(-8.0, 8.0, 100_000, |x| table.cubic(x), f64::tanh) < 6e-7);
+        assert!((fast_tanh(100.0) - 1.0).abs() < 1e-6);
+        assert!((fast_tanh(-100.0) + 1.0).abs() < 1e-6);
+    }
+
+    #[test]
+    fn test_exp_and_db_conversions() {
+        for i in -1000..=1000 {
+            let x = i as f32 * 0.05;
+            let exact = (x as f64).exp2();
+            assert!(((fast_exp2(x) as f64 - exact) / exact).abs() < 1e-6, "exp2({x})");
+        }
+        assert!((fast_exp(1.0) - std::f32::consts::E).abs() < 1e-5);
+
+        for i in -1440..=240 {
+            let db = i as f32 * 0.1;
+            let gain = fast_db_to_gain(db);
+            assert!((fast_gain_to_db(gain) - db).abs() < 2e-4, "db {db}");
+            let exact = 20.0 * (gain as f64).log10();
+            assert!((fast_gain_to_db(gain) as f64 - exact).abs() < 4e-5);
+        }
+        assert_eq!(fast_gain_to_db(0.0), GAIN_DB_FLOOR);
+        assert_eq!(fast_gain_to_db(-1.0), GAIN_DB_FLOOR);
+    }
+
+    #[test]
+    fn test_block_matches_scalar() {
+        let table = LookupTable::bounded(|x| x * x * x, -2.0, 2.0, 64);
+        let input: Vec<f32> = (0..37).map(|i| i as f32 * 0.11 - 2.0).collect();
+        let mut linear = vec![0.0; input.len()];
+        let mut cubic = vec![0.0; input.len()];
+        table.linear_block(&input, &mut linear);
+        table.cubic_block(&input, &mut cubic);
+        for (i, &x) in input.iter().enumerate() {
+            assert_eq!(linear[i], table.linear(x));
+            assert_eq!(cubic[i], table.cubic(x));
+            // Catmull-Rom reproduces cubics only approximately, linear is worse
+            assert!((cubic[i] - x * x * x).abs() < 2e-3);
+        }
+    }
+}
@@ -1715,6 +1715,22 @@ impl MidiBuffer {
         }
     }
 
+    /// Keep only the events for which `keep` returns true, in order.
+    ///
+    /// Visits every event once, front to back. Does not allocate.
+    pub fn retain<F: FnMut(&MidiEvent) -> bool>(&mut self, mut keep: F) {
+        let mut kept = 0;
+        for index in 0..self.len {
+            if keep(&self.events[index]) {
+                if index != kept {
+                    self.events.swap(kept, index);
+                }
+                kept += 1;
+            }
+        }
+        self.len = kept;
+    }
+
     /// Iterate over events in the buffer.
     #[inline]
     pub fn iter(&self) -> impl Iterator<Item = &MidiEvent> {
@@ -62,6 +62,13 @@
 //! - [`MidiCcConfig::SYNTH_BASIC`] - Pitch bend, mod wheel, volume, expression, sustain
 //! - [`MidiCcConfig::SYNTH_FULL`] - Basic + aftertouch, pan, breath controller
 //! - [`MidiCcConfig::EFFECT_BASIC`] - Mod wheel, expression (for modulated effects)
+//!
+//! # Control-Rate Curves
+//!
+//! With [`MidiCcConfig::with_curves()`] the framework also renders every
+//! enabled controller into a per-block buffer (see
+//! [`MidiCcCurves`](crate::MidiCcCurves)), so instruments can apply pitch bend
+//! or mod wheel with block math instead of replaying CC events.
 
 // =============================================================================
 // Constants
@@ -78,6 +85,22 @@ pub mod controller {
     pub const PITCH_BEND: u8 = 129;
 }
 
+// =============================================================================
+// CcCurveMode
+// =============================================================================
+
+/// How host CC points are rendered into per-block controller curves.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum CcCurveMode {
+    /// No curves; controllers are only available as events and current values.
+    #[default]
+    Off,
+    /// Ramp linearly between consecutive points (VST3 automation semantics).
+    Linear,
+    /// Hold each value until the next point's sample offset.
+    Stepped,
+}
+
 // =============================================================================
 // MidiCcConfig
 // =============================================================================
@@ -105,6 +128,8 @@ pub mod controller {
 pub struct MidiCcConfig {
     /// Enabled controller flags
     enabled: [bool; MAX_CC_CONTROLLER],
+    /// Per-block curve rendering for the enabled controllers
+    curve_mode: CcCurveMode,
 }
 
 impl MidiCcConfig {
@@ -164,6 +189,7 @@ impl MidiCcConfig {
     pub const fn new() -> Self {
         Self {
             enabled: [false; MAX_CC_CONTROLLER],
+            curve_mode: CcCurveMode::Off,
         }
     }
 
@@ -239,6 +265,16 @@ impl MidiCcConfig {
         self
     }
 
+    /// Render the enabled controllers into per-block curves.
+    ///
+    /// Plugins read them via [`ProcessContext::midi_cc_curves()`](crate::ProcessContext::midi_cc_curves).
+    /// CC events are still delivered to `process_midi()`.
+    #[inline]
+    pub const fn with_curves(mut self, mode: CcCurveMode) -> Self {
+        self.curve_mode = mode;
+        self
+    }
+
     // =========================================================================
     // Query Methods
     // =========================================================================
@@ -286,6 +322,12 @@ impl MidiCcConfig {
         count
     }
 
+    /// Curve rendering mode ([`CcCurveMode::Off`] unless set via [`with_curves()`](Self::with_curves)).
+    #[inline]
+    pub const fn curve_mode(&self) -> CcCurveMode {
+        self.curve_mode
+    }
+
     /// Get the enabled flags array (for framework use).
     #[inline]
     pub const fn enabled_flags(&self) -> &[bool; MAX_CC_CONTROLLER] {
@@ -309,6 +351,7 @@ impl core::fmt::Debug for MidiCcConfig {
             .collect();
         f.debug_struct("MidiCcConfig")
             .field("enabled_controllers", &enabled)
+            .field("curve_mode", &self.curve_mode)
             .finish()
     }
 }
@@ -406,6 +449,15 @@ mod tests {
         assert_eq!(CONFIG.enabled_count(), 2);
     }
 
+    #[test]
+    fn test_curve_mode() {
+        const CONFIG: MidiCcConfig = MidiCcConfig::SYNTH_BASIC.with_curves(CcCurveMode::Linear);
+
+        assert_eq!(CONFIG.curve_mode(), CcCurveMode::Linear);
+        assert_eq!(MidiCcConfig::SYNTH_BASIC.curve_mode(), CcCurveMode::Off);
+        assert_eq!(CONFIG.enabled_count(), 5);
+    }
+
     #[test]
     #[should_panic(expected = "CC number must be 0-127")]
     fn test_invalid_cc_panics() {
@@ -0,0 +1,415 @@
+//! Sample-accurate control-rate curves for MIDI CC emulation.
+//!
+//! [`MidiCcState`](crate::MidiCcState) holds one current value per controller.
+//! The host's CC parameter queues carry several points per block, though, and
+//! as `MidiEvent`s those points need an event state machine in the plugin.
+//! [`MidiCcCurves`] renders them into one preallocated buffer per enabled
+//! controller instead, so the plugin can apply pitch bend or mod wheel with
+//! plain block math:
+//!
+//! ```ignore
+//! fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, context: &ProcessContext) {
+//!     if let Some(bend) = context.midi_cc_curves().and_then(|c| c.pitch_bend()) {
+//!         for (ratio, &b) in self.ratios.iter_mut().zip(bend) {
+//!             *ratio = fast_exp(b * BEND_RANGE_LN);
+//!         }
+//!     }
+//! }
+//! ```
+//!
+//! Enabled with [`MidiCcConfig::with_curves()`](crate::MidiCcConfig::with_curves).
+//! The wrapper owns the curves and renders them before `process()`; plugins
+//! only read them.
+
+use crate::midi_cc_config::{controller, CcCurveMode, MAX_CC_CONTROLLER};
+use crate::midi_cc_state::MidiCcState;
+
+// =============================================================================
+// Constants
+// =============================================================================
+
+/// Slot index marking a controller without a curve.
+const NO_SLOT: u8 = u8::MAX;
+
+// =============================================================================
+// MidiCcCurves
+// =============================================================================
+
+/// Per-block curves for every enabled MIDI controller.
+///
+/// Values use the same ranges as [`MidiCcState`]: pitch bend is -1.0 to 1.0,
+/// everything else 0.0 to 1.0. All curves live in one contiguous allocation
+/// (controller-major), sized for the maximum block size in [`new()`](Self::new).
+///
+/// Per block the wrapper calls [`begin_block()`](Self::begin_block), then
+/// [`push_point()`](Self::push_point) for each host point in offset order,
+/// then [`end_block()`](Self::end_block). Controllers without points hold
+/// their last value.
+pub struct MidiCcCurves {
+    /// Interpolation between points
+    mode: CcCurveMode,
+    /// Controller number → slot index (`NO_SLOT` if not enabled)
+    slots: [u8; MAX_CC_CONTROLLER],
+    /// Slot index → controller number
+    controllers: Vec<u8>,
+    /// Curve storage, `capacity` samples per slot
+    data: Vec<f32>,
+    /// Samples per slot
+    capacity: usize,
+    /// Samples in the current block
+    num_samples: usize,
+    /// First sample of the block the accessors expose
+    window_start: usize,
+    /// Samples the accessors expose
+    window_len: usize,
+    /// Per slot: last sample written this block (-1 = previous block's end)
+    anchor: Vec<isize>,
+    /// Per slot: value at `anchor`
+    anchor_value: Vec<f32>,
+    /// Per slot: leading samples known to equal `anchor_value` from earlier blocks
+    held: Vec<usize>,
+}
+
+impl MidiCcCurves {
+    /// Allocate curves for the controllers enabled in `state`.
+    ///
+    /// Setup thread only. Each curve starts at its controller's current value.
+    pub fn new(state: &MidiCcState, max_block_size: usize) -> Self {
+        let controllers: Vec<u8> = state.enabled_controllers().collect();
+        let mut slots = [NO_SLOT; MAX_CC_CONTROLLER];
+        for (slot, &controller) in controllers.iter().enumerate() {
+            slots[controller as usize] = slot as u8;
+        }
+        let anchor_value: Vec<f32> = controllers.iter().map(|&c| Self::current_value(state, c)).collect();
+
+        let mut curves = Self {
+            mode: state.curve_mode(),
+            slots,
+            data: vec![0.0; controllers.len() * max_block_size],
+            capacity: max_block_size,
+            num_samples: 0,
+            window_start: 0,
+            window_len: 0,
+            anchor: vec![-1; controllers.len()],
+            anchor_value,
+            held: vec![0; controllers.len()],
+            controllers,
+        };
+        curves.fill_held();
+        curves
+    }
+
+    // =========================================================================
+    // Curve Access (for plugins via ProcessContext)
+    // =========================================================================
+
+    /// Curve for a controller (0-127, or [`controller::AFTERTOUCH`] /
+    /// [`controller::PITCH_BEND`]), one value per sample of the block
+    /// (or of the window set with [`set_window()`](Self::set_window)).
+    ///
+    /// Returns `None` if the controller isn't enabled.
+    #[inline]
+    pub fn curve(&self, controller: u8) -> Option<&[f32]> {
+        let slot = self.slot(controller)?;
+        let start = slot * self.capacity + self.window_start;
+        Some(&self.data[start..start + self.window_len])
+    }
+
+    /// Pitch bend curve (-1.0 to 1.0).
+    #[inline]
+    pub fn pitch_bend(&self) -> Option<&[f32]> {
+        self.curve(controller::PITCH_BEND)
+    }
+
+    /// Channel aftertouch curve (0.0 to 1.0).
+    #[inline]
+    pub fn aftertouch(&self) -> Option<&[f32]> {
+        self.curve(controller::AFTERTOUCH)
+    }
+
+    /// Mod wheel (CC 1) curve (0.0 to 1.0).
+    #[inline]
+    pub fn mod_wheel(&self) -> Option<&[f32]> {
+        self.curve(1)
+    }
+
+    /// Curve for a MIDI CC (0.0 to 1.0). Alias of [`curve()`](Self::curve).
+    #[inline]
+    pub fn cc(&self, cc: u8) -> Option<&[f32]> {
+        self.curve(cc)
+    }
+
+    /// Whether a controller's curve is flat for the whole block (or window).
+    ///
+    /// Lets a plugin take a scalar path; a flat curve's value is its first sample.
+    #[inline]
+    pub fn is_constant(&self, controller: u8) -> bool {
+        self.slot(controller)
+            .is_some_and(|slot| self.held[slot] >= self.window_start + self.window_len)
+    }
+
+    /// Interpolation mode.
+    #[inline]
+    pub fn mode(&self) -> CcCurveMode {
+        self.mode
+    }
+
+    /// Samples in the current block (or window).
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.window_len
+    }
+
+    /// Whether the current block (or window) is empty.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.window_len == 0
+    }
+
+    // =========================================================================
+    // Rendering (framework use)
+    // =========================================================================
+
+    /// Start a block of `num_samples` (clamped to the allocated maximum).
+    #[inline]
+    pub fn begin_block(&mut self, num_samples: usize) {
+        self.num_samples = num_samples.min(self.capacity);
+        self.window_start = 0;
+        self.window_len = self.num_samples;
+    }
+
+    /// Add a host point: `normalized` (0.0-1.0) reached at `sample_offset`.
+    ///
+    /// Points for one controller must arrive in offset order, as in a VST3
+    /// parameter queue. In [`CcCurveMode::Linear`] the curve ramps from the
+    /// previous point (or the last value of the previous block); in
+    /// [`CcCurveMode::Stepped`] it jumps at the offset. Unknown controllers
+    /// are ignored.
+    pub fn push_point(&mut self, controller: u8, sample_offset: u32, normalized: f64) {
+        let Some(slot) = self.slot(controller) else {
+            return;
+        };
+        if self.num_samples == 0 {
+            return;
+        }
+        let value = Self::plain_value(controller, normalized);
+        let offset = (sample_offset as usize).min(self.num_samples - 1);
+        let curve = &mut self.data[slot * self.capacity..][..self.num_samples];
+        let anchor = self.anchor[slot];
+        let from = self.anchor_value[slot];
+        self.held[slot] = 0;
+
+        if offset as isize <= anchor {
+            // Same (or out-of-order) offset: the latest value wins
+            curve[anchor as usize] = value;
+        } else {
+            let start = (anchor + 1) as usize;
+            match self.mode {
+                CcCurveMode::Linear => {
+                    let step = (value - from) / (offset as isize - anchor) as f32;
+                    for (i, sample) in curve[start..=offset].iter_mut().enumerate() {
+                        *sample = from + step * (i + 1) as f32;
+                    }
+                    // Land exactly on the point despite rounding
+                    curve[offset] = value;
+                }
+                CcCurveMode::Stepped | CcCurveMode::Off => {
+                    curve[start..offset].fill(from);
+                    curve[offset] = value;
+                }
+            }
+            self.anchor[slot] = offset as isize;
+        }
+        self.anchor_value[slot] = value;
+    }
+
+    /// Finish the block: hold each curve's last value to the block end.
+    pub fn end_block(&mut self) {
+        for slot in 0..self.controllers.len() {
+            let anchor = self.anchor[slot];
+            if anchor >= 0 {
+                let start = slot * self.capacity;
+                self.data[start + anchor as usize + 1..start + self.num_samples].fill(self.anchor_value[slot]);
+                self.anchor[slot] = -1;
+            } else if self.held[slot] < self.num_samples {
+                // Had points last block: flatten the whole lane once
+                let start = slot * self.capacity;
+                self.data[start..start + self.capacity].fill(self.anchor_value[slot]);
+                self.held[slot] = self.capacity;
+            }
+        }
+    }
+
+    /// Expose `len` samples from `start` of the rendered block to the accessors.
+    ///
+    /// For wrappers that split a block (e.g. at parameter changes) and call
+    /// `process()` once per part. [`begin_block()`](Self::begin_block) resets
+    /// the window to the whole block.
+    #[inline]
+    pub fn set_window(&mut self, start: usize, len: usize) {
+        self.window_start = start.min(self.num_samples);
+        self.window_len = len.min(self.num_samples - self.window_start);
+    }
+
+    /// Reset every curve to its controller's current value in `state`.
+    ///
+    /// Setup thread only (e.g. on reactivation).
+    pub fn reset(&mut self, state: &MidiCcState) {
+        for (slot, &controller) in self.controllers.iter().enumerate() {
+            self.anchor_value[slot] = Self::current_value(state, controller);
+            self.anchor[slot] = -1;
+        }
+        self.fill_held();
+    }
+
+    // =========================================================================
+    // Internal Methods
+    // =========================================================================
+
+    #[inline]
+    fn slot(&self, controller: u8) -> Option<usize> {
+        match self.slots.get(controller as usize) {
+            Some(&slot) if slot != NO_SLOT => Some(slot as usize),
+            _ => None,
+        }
+    }
+
+    /// Fill every lane with its anchor value.
+    fn fill_held(&mut self) {
+        for slot in 0..self.controllers.len() {
+            let start = slot * self.capacity;
+            self.data[start..start + self.capacity].fill(self.anchor_value[slot]);
+            self.held[slot] = self.capacity;
+        }
+    }
+
+    /// Normalized host value → curve value (pitch bend becomes bipolar).
+    #[inline]
+    fn plain_value(controller: u8, normalized: f64) -> f32 {
+        let normalized = normalized.clamp(0.0, 1.0);
+        if controller == controller::PITCH_BEND {
+            (normalized * 2.0 - 1.0) as f32
+        } else {
+            normalized as f32
+        }
+    }
+
+    fn current_value(state: &MidiCcState, controller: u8) -> f32 {
+        if controller == controller::PITCH_BEND {
+            state.pitch_bend()
+        } else if controller == controller::AFTERTOUCH {
+            state.aftertouch()
+        } else {
+            state.cc(controller)
+        }
+    }
+}
+
+impl core::fmt::Debug for MidiCcCurves {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        f.debug_struct("MidiCcCurves")
+            .field("mode", &self.mode)
+            .field("controllers", &self.controllers)
+            .field("capacity", &self.capacity)
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::midi_cc_config::MidiCcConfig;
+
+    fn curves(mode: CcCurveMode, max_block_size: usize) -> MidiCcCurves {
+        let config = MidiCcConfig::new().with_pitch_bend().with_mod_wheel().with_curves(mode);
+        MidiCcCurves::new(&MidiCcState::from_config(&config), max_block_size)
+    }
+
+    #[test]
+    fn test_initial_values_and_disabled_controllers() {
+        let mut curves = curves(CcCurveMode::Linear, 64);
+        curves.begin_block(16);
+        curves.end_block();
+
+        assert_eq!(curves.pitch_bend().unwrap(), &[0.0; 16]);
+        assert_eq!(curves.mod_wheel().unwrap(), &[0.0; 16]);
+        assert!(curves.is_constant(1));
+        assert!(curves.cc(7).is_none());
+        assert!(curves.aftertouch().is_none());
+        assert!(!curves.is_constant(7));
+    }
+
+    #[test]
+    fn test_linear_ramp_between_points() {
+        let mut curves = curves(CcCurveMode::Linear, 64);
+        curves.begin_block(8);
+        curves.push_point(1, 3, 1.0);
+        curves.end_block();
+
+        let mw = curves.mod_wheel().unwrap();
+        assert_eq!(mw, &[0.25, 0.5, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0]);
+        assert!(!curves.is_constant(1));
+
+        // The next block starts from the held value
+        curves.begin_block(4);
+        curves.push_point(1, 1, 0.0);
+        curves.end_block();
+        assert_eq!(curves.mod_wheel().unwrap(), &[0.5, 0.0, 0.0, 0.0]);
+    }
+
+    #[test]
+    fn test_stepped_and_pitch_bend_range() {
+        let mut curves = curves(CcCurveMode::Stepped, 64);
+        curves.begin_block(6);
+        curves.push_point(controller::PITCH_BEND, 2, 1.0);
+        curves.push_point(controller::PITCH_BEND, 4, 0.0);
+        curves.end_block();
+
+        assert_eq!(curves.pitch_bend().unwrap(), &[0.0, 0.0, 1.0, 1.0, -1.0, -1.0]);
+    }
+
+    #[test]
+    fn test_held_after_points() {
+        let mut curves = curves(CcCurveMode::Linear, 8);
+        curves.begin_block(4);
+        curves.push_point(1, 0, 0.5);
+        curves.end_block();
+
+        // Untouched block after a varying one flattens the lane
+        curves.begin_block(8);
+        curves.end_block();
+        assert_eq!(curves.mod_wheel().unwrap(), &[0.5; 8]);
+        assert!(curves.is_constant(1));
+    }
+
+    #[test]
+    fn test_offsets_clamped_to_block() {
+        let mut curves = curves(CcCurveMode::Stepped, 8);
+        curves.begin_block(4);
+        curves.push_point(1, 100, 1.0);
+        curves.push_point(1, 3, 0.5);
+        curves.end_block();
+
+        assert_eq!(curves.mod_wheel().unwrap(), &[0.0, 0.0, 0.0, 0.5]);
+    }
+
+    #[test]
+    fn test_window() {
+        let mut curves = curves(CcCurveMode::Stepped, 8);
+        curves.begin_block(6);
+        curves.push_point(1, 4, 1.0);
+        curves.end_block();
+
+        curves.set_window(2, 3);
+        assert_eq!(curves.len(), 3);
+        assert_eq!(curves.mod_wheel().unwrap(), &[0.0, 0.0, 1.0]);
+        assert!(curves.is_constant(controller::PITCH_BEND));
+
+        // Clamped to the block
+        curves.set_window(5, 10);
+        assert_eq!(curves.mod_wheel().unwrap(), &[1.0]);
+
+        curves.begin_block(6);
+        assert_eq!(curves.len(), 6);
+    }
+}
@@ -10,7 +10,7 @@
 
 use std::sync::atomic::{AtomicU64, Ordering};
 
-use crate::midi_cc_config::{controller, MidiCcConfig, MAX_CC_CONTROLLER};
+use crate::midi_cc_config::{controller, CcCurveMode, MidiCcConfig, MAX_CC_CONTROLLER};
 use crate::parameter_groups::{GroupInfo, ParameterGroups, ROOT_GROUP_ID};
 use crate::parameter_info::{ParameterFlags, ParameterInfo};
 use crate::parameter_store::ParameterStore;
@@ -59,6 +59,8 @@ pub struct MidiCcState {
     parameter_infos: Vec<CcParameterInfo>,
     /// Total enabled controller count
     enabled_count: usize,
+    /// Per-block curve rendering (copied from config)
+    curve_mode: CcCurveMode,
 }
 
 /// Internal storage for parameter info
@@ -101,6 +103,7 @@ impl MidiCcState {
             values,
             parameter_infos,
             enabled_count,
+            curve_mode: config.curve_mode(),
         }
     }
 
@@ -185,6 +188,12 @@ impl MidiCcState {
         self.enabled_count
     }
 
+    /// Curve rendering mode from the config (see [`MidiCcCurves`](crate::MidiCcCurves)).
+    #[inline]
+    pub fn curve_mode(&self) -> CcCurveMode {
+        self.curve_mode
+    }
+
     /// Iterate over enabled controller numbers.
     pub fn enabled_controllers(&self) -> impl Iterator<Item = u8> + '_ {
         self.parameter_infos.iter().map(|info| info.controller)
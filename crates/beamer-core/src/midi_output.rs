@@ -0,0 +1,462 @@
+//! Coalescing and rate limiting of a processor's MIDI output.
+//!
+//! A MIDI effect that transforms or generates controllers continuously can
+//! write hundreds of CCs per block, most of them repeating the previous
+//! value. Every one is converted, handed to the host, routed and, while
+//! recording, stored. [`MidiOutputFilter`] thins the output buffer in place
+//! after `process_midi()`, before the wrapper converts it:
+//!
+//! - **Duplicates:** CC, pitch bend and channel pressure events that repeat
+//!   the last value sent on their controller are dropped.
+//! - **Same offset:** of several events for one controller at one sample
+//!   offset, only the last is kept.
+//! - **Resolution:** CC values are compared after quantizing to N steps, so
+//!   a generator writing smooth f32 ramps only sends when the value the
+//!   host would store actually changes.
+//! - **Rate:** each controller sends at most once per interval. A value
+//!   held back by the limit is sent when the interval has passed, so the
+//!   last value always arrives.
+//!
+//! The filter is opt-in per processor through
+//! [`AudioProcessor::MIDI_OUTPUT`](crate::AudioProcessor::MIDI_OUTPUT):
+//!
+//! ```ignore
+//! impl AudioProcessor for CcGenerator {
+//!     const MIDI_OUTPUT: MidiOutputConfig = MidiOutputConfig::COALESCED
+//!         .with_cc_resolution(128)
+//!         .with_cc_max_rate(500.0);
+//!     // ...
+//! }
+//! ```
+//!
+//! Notes, program changes, SysEx and note expression pass through unchanged
+//! and keep their order.
+//!
+//! # Real-Time Safety
+//!
+//! [`MidiOutputFilter::new()`] allocates; [`filter()`](MidiOutputFilter::filter)
+//! and [`reset()`](MidiOutputFilter::reset) do not.
+
+use crate::midi::{MidiBuffer, MidiEvent, MidiEventKind, MAX_MIDI_EVENTS};
+
+/// Number of MIDI channels.
+const CHANNELS: usize = 16;
+
+/// Number of CC controllers per channel.
+const CONTROLLERS: usize = 128;
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+/// Which output thinning stages a processor uses.
+///
+/// The default, [`PASS_THROUGH`](Self::PASS_THROUGH), sends every event as
+/// written and costs nothing.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct MidiOutputConfig {
+    /// Drop CC, pitch bend and channel pressure events repeating the last value sent.
+    pub drop_duplicates: bool,
+    /// Keep only the last event per controller at each sample offset.
+    pub merge_same_offset: bool,
+    /// Compare CC values quantized to this many steps (0 = exact values).
+    pub cc_resolution: u16,
+    /// Maximum sends per second per CC controller (0 = unlimited).
+    pub cc_max_rate: f64,
+}
+
+impl MidiOutputConfig {
+    /// Every event is sent (the default).
+    pub const PASS_THROUGH: Self = Self {
+        drop_duplicates: false,
+        merge_same_offset: false,
+        cc_resolution: 0,
+        cc_max_rate: 0.0,
+    };
+
+    /// Duplicates dropped and same-offset events merged; no resolution or
+    /// rate limit.
+    pub const COALESCED: Self = Self {
+        drop_duplicates: true,
+        merge_same_offset: true,
+        cc_resolution: 0,
+        cc_max_rate: 0.0,
+    };
+
+    /// Compare CC values quantized to `steps` (128 for 7-bit, 16384 for 14-bit).
+    ///
+    /// Implies dropping duplicates.
+    pub const fn with_cc_resolution(mut self, steps: u16) -> Self {
+        self.cc_resolution = steps;
+        self.drop_duplicates = true;
+        self
+    }
+
+    /// Send each CC controller at most `per_second` times per second.
+    pub const fn with_cc_max_rate(mut self, per_second: f64) -> Self {
+        self.cc_max_rate = per_second;
+        self
+    }
+
+    /// Returns true if the output is sent unchanged.
+    ///
+    /// Wrappers check this on the constant, so the filter compiles away.
+    pub const fn is_pass_through(&self) -> bool {
+        !self.drop_duplicates && !self.merge_same_offset && self.cc_resolution == 0 && self.cc_max_rate <= 0.0
+    }
+}
+
+impl Default for MidiOutputConfig {
+    fn default() -> Self {
+        Self::PASS_THROUGH
+    }
+}
+
+// =============================================================================
+// Filter
+// =============================================================================
+
+/// Last value sent on one CC controller.
+#[derive(Debug, Clone, Copy)]
+struct CcLane {
+    /// Quantized value last sent (NaN = nothing sent yet).
+    sent: f32,
+    /// Absolute sample time of the last send.
+    sent_at: u64,
+    /// Value held back by the rate limit (NaN = none).
+    pending: f32,
+    /// `(block, offset + 1)` of the last event seen in the backward scan.
+    seen: (u32, u32),
+}
+
+impl CcLane {
+    const EMPTY: Self = Self {
+        sent: f32::NAN,
+        sent_at: 0,
+        pending: f32::NAN,
+        seen: (0, 0),
+    };
+}
+
+/// Per-controller state for thinning one output stream.
+///
+/// Create one per plugin instance when buffers are allocated and call
+/// [`filter()`](Self::filter) on the output buffer once per block.
+pub struct MidiOutputFilter {
+    config: MidiOutputConfig,
+    /// Minimum samples between sends of one CC controller (0 = unlimited).
+    interval: u64,
+    /// Absolute sample time of the current block's first sample.
+    block_start: u64,
+    /// Block counter for the same-offset scan (never 0).
+    block: u32,
+    cc: Box<[[CcLane; CONTROLLERS]; CHANNELS]>,
+    /// Bit per controller with a pending value.
+    pending: [u128; CHANNELS],
+    pitch_bend: [f32; CHANNELS],
+    channel_pressure: [f32; CHANNELS],
+    /// Events superseded at their offset (same-offset merge), by index.
+    superseded: Box<[bool; MAX_MIDI_EVENTS]>,
+    /// Held-back CCs due in the current block: `(offset, channel, controller)`.
+    due: Vec<(u32, u8, u8)>,
+}
+
+impl MidiOutputFilter {
+    /// Create a filter for `config` at `sample_rate`.
+    pub fn new(config: MidiOutputConfig, sample_rate: f64) -> Self {
+        let interval = if config.cc_max_rate > 0.0 && sample_rate > 0.0 {
+            (sample_rate / config.cc_max_rate).round() as u64
+        } else {
+            0
+        };
+        Self {
+            config,
+            interval,
+            block_start: 0,
+            block: 1,
+            cc: Box::new([[CcLane::EMPTY; CONTROLLERS]; CHANNELS]),
+            pending: [0; CHANNELS],
+            pitch_bend: [f32::NAN; CHANNELS],
+            channel_pressure: [f32::NAN; CHANNELS],
+            superseded: Box::new([false; MAX_MIDI_EVENTS]),
+            due: Vec::with_capacity(CHANNELS * CONTROLLERS),
+        }
+    }
+
+    /// The configuration this filter applies.
+    #[inline]
+    pub fn config(&self) -> &MidiOutputConfig {
+        &self.config
+    }
+
+    /// Forget every value sent (after a reset or transport jump).
+    ///
+    /// The next event on each controller is sent, and held-back values are
+    /// discarded.
+    pub fn reset(&mut self) {
+        for channel in self.cc.iter_mut() {
+            channel.fill(CcLane::EMPTY);
+        }
+        self.pending = [0; CHANNELS];
+        self.pitch_bend = [f32::NAN; CHANNELS];
+        self.channel_pressure = [f32::NAN; CHANNELS];
+        self.block_start = 0;
+        self.block = 1;
+    }
+
+    /// Thin `output` in place for a block of `num_samples` samples.
+    ///
+    /// Events must be in sample offset order, as `process_midi()` writes
+    /// them. Held-back values that come due in this block are appended.
+    pub fn filter(&mut self, output: &mut MidiBuffer, num_samples: usize) {
+        if self.config.merge_same_offset {
+            self.mark_superseded(output);
+        }
+
+        let mut index = 0;
+        output.retain(|event| {
+            let keep = !(self.config.merge_same_offset && self.superseded[index]) && self.keep(event);
+            index += 1;
+            keep
+        });
+
+        if self.interval > 0 {
+            self.flush_pending(output, num_samples as u64);
+        }
+
+        self.block_start += num_samples as u64;
+        self.block = self.block.wrapping_add(1).max(1);
+    }
+
+    /// Mark events followed by another event for the same controller at the
+    /// same offset.
+    fn mark_superseded(&mut self, output: &MidiBuffer) {
+        let block = self.block;
+        let mut bend_seen = [u32::MAX; CHANNELS];
+        let mut pressure_seen = [u32::MAX; CHANNELS];
+        for (index, event) in output.as_slice().iter().enumerate().rev() {
+            let offset = event.sample_offset;
+            self.superseded[index] = match &event.event {
+                MidiEventKind::ControlChange(cc) => {
+                    let lane = &mut self.cc[cc.channel as usize & 15][cc.controller as usize & 127];
+                    let later = lane.seen == (block, offset + 1);
+                    lane.seen = (block, offset + 1);
+                    later
+                }
+                MidiEventKind::PitchBend(bend) => {
+                    let seen = &mut bend_seen[bend.channel as usize & 15];
+                    std::mem::replace(seen, offset) == offset
+                }
+                MidiEventKind::ChannelPressure(pressure) => {
+                    let seen = &mut pressure_seen[pressure.channel as usize & 15];
+                    std::mem::replace(seen, offset) == offset
+                }
+                _ => false,
+            };
+        }
+    }
+
+    /// Decide whether one event is sent, updating the controller state.
+    fn keep(&mut self, event: &MidiEvent) -> bool {
+        match &event.event {
+            MidiEventKind::ControlChange(cc) => {
+                let (channel, controller) = (cc.channel as usize & 15, cc.controller as usize & 127);
+                let value = quantize(cc.value, self.config.cc_resolution);
+                let now = self.block_start + event.sample_offset as u64;
+                let lane = &mut self.cc[channel][controller];
+
+                if self.config.drop_duplicates && value == lane.sent {
+                    // Back where it was: nothing left to send
+                    lane.pending = f32::NAN;
+                    self.pending[channel] &= !(1 << controller);
+                    return false;
+                }
+                if self.interval > 0 && !lane.sent.is_nan() && now < lane.sent_at + self.interval {
+                    lane.pending = cc.value;
+                    self.pending[channel] |= 1 << controller;
+                    return false;
+                }
+                lane.sent = value;
+                lane.sent_at = now;
+                lane.pending = f32::NAN;
+                self.pending[channel] &= !(1 << controller);
+                true
+            }
+            MidiEventKind::PitchBend(bend) if self.config.drop_duplicates => {
+                let sent = &mut self.pitch_bend[bend.channel as usize & 15];
+                std::mem::replace(sent, bend.value) != bend.value
+            }
+            MidiEventKind::ChannelPressure(pressure) if self.config.drop_duplicates => {
+                let sent = &mut self.channel_pressure[pressure.channel as usize & 15];
+                std::mem::replace(sent, pressure.pressure) != pressure.pressure
+            }
+            _ => true,
+        }
+    }
+
+    /// Append held-back CC values whose interval ends in this block.
+    ///
+    /// They go after the last event, sorted by due offset, to keep the
+    /// buffer in offset order.
+    fn flush_pending(&mut self, output: &mut MidiBuffer, num_samples: u64) {
+        let block_end = self.block_start + num_samples;
+        let last_offset = output.as_slice().last().map_or(0, |event| event.sample_offset as u64);
+        self.due.clear();
+        for channel in 0..CHANNELS {
+            let mut bits = self.pending[channel];
+            while bits != 0 {
+                let controller = bits.trailing_zeros() as usize;
+                bits &= bits - 1;
+
+                let due = self.cc[channel][controller].sent_at + self.interval;
+                if due < block_end {
+                    let offset = due.saturating_sub(self.block_start).max(last_offset).min(num_samples.saturating_sub(1));
+                    self.due.push((offset as u32, channel as u8, controller as u8));
+                }
+            }
+        }
+        // Within capacity (one entry per controller), so this doesn't allocate
+        self.due.sort_unstable();
+
+        for &(offset, channel, controller) in &self.due {
+            if output.len() >= MAX_MIDI_EVENTS {
+                // The rest stay pending for the next block
+                break;
+            }
+            let lane = &mut self.cc[channel as usize][controller as usize];
+            output.push(MidiEvent::control_change(offset, channel, controller, lane.pending));
+            lane.sent = quantize(lane.pending, self.config.cc_resolution);
+            lane.sent_at = self.block_start + offset as u64;
+            lane.pending = f32::NAN;
+            self.pending[channel as usize] &= !(1 << controller);
+        }
+    }
+}
+
+impl core::fmt::Debug for MidiOutputFilter {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        f.debug_struct("MidiOutputFilter")
+            .field("config", &self.config)
+            .field("interval", &self.interval)
+            .field("block_start", &self.block_start)
+            .finish_non_exhaustive()
+    }
+}
+
+/// Quantize a normalized value to `steps` steps (0 = unchanged).
+#[inline]
+fn quantize(value: f32, steps: u16) -> f32 {
+    if steps == 0 {
+        value
+    } else {
+        let steps = (steps - 1).max(1) as f32;
+        (value * steps).round() / steps
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn cc(offset: u32, controller: u8, value: f32) -> MidiEvent {
+        MidiEvent::control_change(offset, 0, controller, value)
+    }
+
+    fn buffer(events: &[MidiEvent]) -> MidiBuffer {
+        let mut buffer = MidiBuffer::new();
+        for event in events {
+            buffer.push(event.clone());
+        }
+        buffer
+    }
+
+    fn values(buffer: &MidiBuffer) -> Vec<(u32, u8, f32)> {
+        buffer
+            .iter()
+            .filter_map(|event| match &event.event {
+                MidiEventKind::ControlChange(cc) => Some((event.sample_offset, cc.controller, cc.value)),
+                _ => None,
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_duplicates_and_same_offset() {
+        let mut filter = MidiOutputFilter::new(MidiOutputConfig::COALESCED, 48_000.0);
+        let mut output = buffer(&[
+            cc(0, 1, 0.5),
+            MidiEvent::note_on(0, 0, 60, 1.0, -1, 0.0, 0),
+            cc(0, 1, 0.6),
+            cc(4, 1, 0.6),
+            cc(8, 2, 0.5),
+            cc(9, 1, 0.7),
+        ]);
+        filter.filter(&mut output, 64);
+
+        // 0.5 superseded at offset 0, the second 0.6 is a duplicate
+        assert_eq!(values(&output), vec![(0, 1, 0.6), (8, 2, 0.5), (9, 1, 0.7)]);
+        assert!(matches!(output.as_slice()[0].event, MidiEventKind::NoteOn(_)));
+
+        // State carries over blocks
+        let mut output = buffer(&[cc(0, 1, 0.7), cc(3, 2, 0.25)]);
+        filter.filter(&mut output, 64);
+        assert_eq!(values(&output), vec![(3, 2, 0.25)]);
+    }
+
+    #[test]
+    fn test_resolution() {
+        let config = MidiOutputConfig::PASS_THROUGH.with_cc_resolution(128);
+        let mut filter = MidiOutputFilter::new(config, 48_000.0);
+
+        // A slow f32 ramp: one event per 7-bit step survives
+        let ramp: Vec<_> = (0..256).map(|i| cc(i, 7, i as f32 / 1024.0)).collect();
+        let mut output = buffer(&ramp);
+        filter.filter(&mut output, 256);
+        assert!((32..=34).contains(&output.len()), "{} events", output.len());
+    }
+
+    #[test]
+    fn test_rate_limit_sends_last_value() {
+        // 1 kHz at 48 kHz: one send per 48 samples
+        let config = MidiOutputConfig::COALESCED.with_cc_max_rate(1_000.0);
+        let mut filter = MidiOutputFilter::new(config, 48_000.0);
+
+        let ramp: Vec<_> = (0..64).map(|i| cc(i, 1, i as f32 / 64.0)).collect();
+        let mut output = buffer(&ramp);
+        filter.filter(&mut output, 64);
+        let sent = values(&output);
+        assert_eq!(sent.iter().map(|e| e.0).collect::<Vec<_>>(), vec![0, 48]);
+
+        // The held-back final value follows once the interval has passed
+        let mut output = MidiBuffer::new();
+        filter.filter(&mut output, 64);
+        assert_eq!(values(&output), vec![(32, 1, 63.0 / 64.0)]);
+
+        // Nothing left afterwards
+        let mut output = MidiBuffer::new();
+        filter.filter(&mut output, 64);
+        assert!(output.is_empty());
+    }
+
+    #[test]
+    fn test_held_back_values_flush_in_offset_order() {
+        let config = MidiOutputConfig::COALESCED.with_cc_max_rate(1_000.0);
+        let mut filter = MidiOutputFilter::new(config, 48_000.0);
+
+        // CC 2 comes due before CC 1 despite the lower controller number
+        let mut output = buffer(&[cc(20, 2, 0.1), cc(30, 2, 0.2), cc(40, 1, 0.1), cc(50, 1, 0.2)]);
+        filter.filter(&mut output, 64);
+        assert_eq!(values(&output), vec![(20, 2, 0.1), (40, 1, 0.1)]);
+
+        let mut output = MidiBuffer::new();
+        filter.filter(&mut output, 64);
+        assert_eq!(values(&output), vec![(4, 2, 0.2), (24, 1, 0.2)]);
+    }
+
+    #[test]
+    fn test_pass_through_config() {
+        assert!(MidiOutputConfig::default().is_pass_through());
+        assert!(!MidiOutputConfig::COALESCED.is_pass_through());
+        assert!(!MidiOutputConfig::PASS_THROUGH.with_cc_max_rate(100.0).is_pass_through());
+    }
+}
@@ -179,6 +179,18 @@ pub trait Parameters: Send + Sync + ParameterGroups {
         // Default: no-op (macro generates override for parameter-containing structs)
     }
 
+    /// Set every parameter's ID to its declared ID XOR `salt`, recursively.
+    ///
+    /// Elements of a `#[nested]` array share one struct type, so their
+    /// declared IDs are identical. The parent gives element `i` the salt
+    /// `fnv1a_32("band{i}")` (XORed with its own salt), which makes the IDs
+    /// unique while `by_id()` can still map a host ID back to the declared
+    /// one with a single XOR per element. Absolute, so calling it again is
+    /// harmless. The default implementation does nothing.
+    fn salt_ids(&mut self, _salt: ParameterId) {
+        // Default: no-op (macro generates override)
+    }
+
     // =========================================================================
     // Nested Group Discovery (for recursive group ID assignment)
     // =========================================================================
@@ -443,6 +455,37 @@ pub trait Parameters: Send + Sync + ParameterGroups {
         // Default no-op. The #[derive(Parameters)] macro generates an override
         // that calls reset_smoothing on each parameter field.
     }
+
+    /// Visit every [`FloatParameter`] that has a smoother, nested ones included.
+    ///
+    /// The order is fixed by the struct layout, so repeated walks visit the
+    /// parameters in the same order. Used by
+    /// [`SmootherBank`](crate::smoother_bank::SmootherBank) to gather all
+    /// smoothers of a collection.
+    fn for_each_smoothed(&self, _f: &mut dyn FnMut(&FloatParameter)) {
+        // Default no-op. The #[derive(Parameters)] macro generates an override
+        // that calls for_each_smoothed on each parameter field.
+    }
+}
+
+/// Panic if two parameters of a collection share an ID.
+///
+/// `#[derive(Parameters)]` checks declared IDs at compile time, but the
+/// salted IDs of `#[nested]` array elements only exist once
+/// [`salt_ids()`](Parameters::salt_ids) has run, so the derived
+/// `set_group_ids()` calls this afterwards. A duplicate would make
+/// `by_id()` resolve host automation to the wrong parameter. Allocates;
+/// call at construction only.
+pub fn assert_unique_ids<P: Parameters + ?Sized>(parameters: &P, collection: &str) {
+    let mut ids: Vec<(ParameterId, &'static str)> =
+        parameters.iter().map(|p| (p.info().id, p.info().name)).collect();
+    ids.sort_unstable_by_key(|&(id, _)| id);
+    if let Some(pair) = ids.windows(2).find(|pair| pair[0].0 == pair[1].0) {
+        panic!(
+            "Parameter ID collision in {collection}: \"{}\" and \"{}\" both have ID {}; rename one string ID",
+            pair[0].1, pair[1].1, pair[0].0
+        );
+    }
 }
 
 // =============================================================================
@@ -840,6 +883,11 @@ impl FloatParameter {
         self.info.group_id = group_id;
     }
 
+    /// Set the parameter ID in-place (for array elements of nested groups).
+    pub fn set_id(&mut self, id: ParameterId) {
+        self.info.id = id;
+    }
+
     /// Make the parameter read-only (display only, not automatable).
     pub fn readonly(mut self) -> Self {
         self.info.flags.is_readonly = true;
@@ -925,6 +973,23 @@ impl FloatParameter {
         self
     }
 
+    /// Smoothing style, or `None` without a smoother.
+    #[inline]
+    pub fn smoothing_style(&self) -> Option<SmoothingStyle> {
+        self.smoother.as_ref().map(Smoother::style)
+    }
+
+    /// Call `f` with this parameter if it has a smoother.
+    ///
+    /// Used by the `#[derive(Parameters)]` macro for
+    /// [`Parameters::for_each_smoothed()`].
+    #[inline]
+    pub fn for_each_smoothed(&self, f: &mut dyn FnMut(&FloatParameter)) {
+        if self.smoother.is_some() {
+            f(self);
+        }
+    }
+
     /// Set sample rate for smoothing.
     ///
     /// Call this from `AudioProcessor::setup()`. If using oversampling,
@@ -1238,6 +1303,11 @@ impl IntParameter {
         self.info.group_id = group_id;
     }
 
+    /// Set the parameter ID in-place (for array elements of nested groups).
+    pub fn set_id(&mut self, id: ParameterId) {
+        self.info.id = id;
+    }
+
     /// Make the parameter read-only.
     pub fn readonly(mut self) -> Self {
         self.info.flags.is_readonly = true;
@@ -1295,6 +1365,14 @@ impl IntParameter {
     pub fn reset_smoothing(&mut self) {
         // No-op: IntParameter doesn't support smoothing
     }
+
+    /// No-op for compatibility with the `#[derive(Parameters)]` macro.
+    ///
+    /// Integer parameters don't support smoothing, so this does nothing.
+    #[inline]
+    pub fn for_each_smoothed(&self, _f: &mut dyn FnMut(&FloatParameter)) {
+        // No-op: IntParameter doesn't support smoothing
+    }
 }
 
 impl ParameterRef for IntParameter {
@@ -1490,6 +1568,11 @@ impl BoolParameter {
         self.info.group_id = group_id;
     }
 
+    /// Set the parameter ID in-place (for array elements of nested groups).
+    pub fn set_id(&mut self, id: ParameterId) {
+        self.info.id = id;
+    }
+
     /// Make the parameter read-only.
     pub fn readonly(mut self) -> Self {
         self.info.flags.is_readonly = true;
@@ -1546,6 +1629,14 @@ impl BoolParameter {
     pub fn reset_smoothing(&mut self) {
         // No-op: BoolParameter doesn't support smoothing
     }
+
+    /// No-op for compatibility with the `#[derive(Parameters)]` macro.
+    ///
+    /// Boolean parameters don't support smoothing, so this does nothing.
+    #[inline]
+    pub fn for_each_smoothed(&self, _f: &mut dyn FnMut(&FloatParameter)) {
+        // No-op: BoolParameter doesn't support smoothing
+    }
 }
 
 impl ParameterRef for BoolParameter {
@@ -1810,6 +1901,11 @@ impl<E: EnumParameterValue> EnumParameter<E> {
         self.info.group_id = group_id;
     }
 
+    /// Set the parameter ID in-place (for array elements of nested groups).
+    pub fn set_id(&mut self, id: ParameterId) {
+        self.info.id = id;
+    }
+
     /// Make the parameter read-only.
     pub fn readonly(mut self) -> Self {
         self.info.flags.is_readonly = true;
@@ -1873,6 +1969,14 @@ impl<E: EnumParameterValue> EnumParameter<E> {
     pub fn reset_smoothing(&mut self) {
         // No-op: EnumParameter doesn't support smoothing
     }
+
+    /// No-op for compatibility with the `#[derive(Parameters)]` macro.
+    ///
+    /// Enum parameters don't support smoothing, so this does nothing.
+    #[inline]
+    pub fn for_each_smoothed(&self, _f: &mut dyn FnMut(&FloatParameter)) {
+        // No-op: EnumParameter doesn't support smoothing
+    }
 }
 
 impl<E: EnumParameterValue> ParameterRef for EnumParameter<E> {
@@ -2004,3 +2108,47 @@ fn db_to_linear(db: f64) -> f64 {
         10.0_f64.powf(db / 20.0)
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    struct Pair {
+        a: FloatParameter,
+        b: FloatParameter,
+    }
+
+    impl ParameterGroups for Pair {}
+
+    impl Parameters for Pair {
+        fn count(&self) -> usize {
+            2
+        }
+
+        fn iter(&self) -> Box<dyn Iterator<Item = &dyn ParameterRef> + '_> {
+            Box::new([&self.a as &dyn ParameterRef, &self.b].into_iter())
+        }
+
+        fn by_id(&self, id: ParameterId) -> Option<&dyn ParameterRef> {
+            self.iter().find(|p| p.info().id == id)
+        }
+    }
+
+    fn pair(a: ParameterId, b: ParameterId) -> Pair {
+        Pair {
+            a: FloatParameter::new("A", 0.0, 0.0..=1.0).with_id(a),
+            b: FloatParameter::new("B", 0.0, 0.0..=1.0).with_id(b),
+        }
+    }
+
+    #[test]
+    fn test_unique_ids_pass() {
+        assert_unique_ids(&pair(1, 2), "Pair");
+    }
+
+    #[test]
+    #[should_panic(expected = "Parameter ID collision in Pair")]
+    fn test_duplicate_ids_panic() {
+        assert_unique_ids(&pair(7, 7), "Pair");
+    }
+}
@@ -19,6 +19,7 @@ use crate::midi::{
     NoteExpressionTypeInfo, PhysicalUIMap,
 };
 use crate::midi_cc_config::MidiCcConfig;
+use crate::midi_output::MidiOutputConfig;
 use crate::parameter_groups::ParameterGroups;
 use crate::parameter_store::ParameterStore;
 use crate::process_context::ProcessContext;
@@ -274,6 +275,117 @@ impl BusInfo {
     }
 }
 
+// =============================================================================
+// Process Capabilities
+// =============================================================================
+
+/// Per-block wrapper stages a processor uses, known at compile time.
+///
+/// Every `process()` call in the format wrappers runs several stages around
+/// the plugin's own DSP. Each one that a processor leaves out of
+/// [`AudioProcessor::CAPABILITIES`] is removed by the compiler, because the
+/// wrapper checks these fields as constants. A plain audio effect declares
+/// [`AUDIO_ONLY`](Self::AUDIO_ONLY) and pays almost nothing around its
+/// `process()`:
+///
+/// ```ignore
+/// impl AudioProcessor for GainProcessor {
+///     const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY;
+///     // ...
+/// }
+/// ```
+///
+/// Declaring less than the processor uses is a bug: host MIDI is dropped,
+/// aux buses arrive empty, and the transport is the default. The default is
+/// [`ALL`](Self::ALL), so existing processors behave as before.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ProcessCapabilities {
+    /// Read host MIDI events and call `process_midi()`.
+    pub midi_input: bool,
+    /// Turn `IMidiMapping` CC parameter changes into MIDI events
+    /// (only useful with [`Plugin::midi_cc_config()`]).
+    pub midi_cc: bool,
+    /// Send events from the `process_midi()` output buffer to the host.
+    pub midi_output: bool,
+    /// Collect auxiliary bus channels into [`AuxiliaryBuffers`].
+    pub aux_buses: bool,
+    /// Use the native `process_f64()` path when the host runs at 64-bit
+    /// and [`AudioProcessor::supports_double_precision()`] is true.
+    pub double_precision: bool,
+    /// Read transport information from the host.
+    pub transport: bool,
+}
+
+impl ProcessCapabilities {
+    /// Every stage (the default).
+    pub const ALL: Self = Self {
+        midi_input: true,
+        midi_cc: true,
+        midi_output: true,
+        aux_buses: true,
+        double_precision: true,
+        transport: true,
+    };
+
+    /// No stage: main bus audio and parameters only.
+    pub const AUDIO_ONLY: Self = Self {
+        midi_input: false,
+        midi_cc: false,
+        midi_output: false,
+        aux_buses: false,
+        double_precision: false,
+        transport: false,
+    };
+
+    /// Enable MIDI input.
+    pub const fn with_midi_input(mut self) -> Self {
+        self.midi_input = true;
+        self
+    }
+
+    /// Enable CC parameter conversion.
+    pub const fn with_midi_cc(mut self) -> Self {
+        self.midi_cc = true;
+        self
+    }
+
+    /// Enable MIDI output.
+    pub const fn with_midi_output(mut self) -> Self {
+        self.midi_output = true;
+        self
+    }
+
+    /// Enable auxiliary buses.
+    pub const fn with_aux_buses(mut self) -> Self {
+        self.aux_buses = true;
+        self
+    }
+
+    /// Enable the native 64-bit path.
+    pub const fn with_double_precision(mut self) -> Self {
+        self.double_precision = true;
+        self
+    }
+
+    /// Enable transport information.
+    pub const fn with_transport(mut self) -> Self {
+        self.transport = true;
+        self
+    }
+
+    /// Whether `process_midi()` is called at all.
+    #[inline]
+    pub const fn processes_midi(self) -> bool {
+        self.midi_input || self.midi_cc || self.midi_output
+    }
+}
+
+impl Default for ProcessCapabilities {
+    fn default() -> Self {
+        Self::ALL
+    }
+}
+
 // =============================================================================
 // AudioProcessor Trait
 // =============================================================================
@@ -327,6 +439,16 @@ pub trait AudioProcessor: HasParameters {
     /// The Parameters type must match the plugin's Parameters type.
     type Plugin: Plugin<Processor = Self, Parameters = Self::Parameters>;
 
+    /// Wrapper stages this processor uses; the rest compile away.
+    ///
+    /// See [`ProcessCapabilities`]. Default: [`ProcessCapabilities::ALL`].
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::ALL;
+
+    /// Thinning applied to the `process_midi()` output before it is sent.
+    ///
+    /// See [`MidiOutputConfig`]. Default: [`MidiOutputConfig::PASS_THROUGH`].
+    const MIDI_OUTPUT: MidiOutputConfig = MidiOutputConfig::PASS_THROUGH;
+
     /// Process an audio buffer with transport context.
     ///
     /// This is the main DSP entry point, called on the audio thread for each
@@ -451,6 +573,42 @@ pub trait AudioProcessor: HasParameters {
     /// Default implementation does nothing.
     fn set_active(&mut self, _active: bool) {}
 
+    /// Release large DSP allocations while deactivated.
+    ///
+    /// Called on the setup thread right after `set_active(false)`. Disabled
+    /// or frozen tracks stay deactivated for a long time; dropping delay
+    /// lines, lookahead buffers, sample caches etc. here means they don't
+    /// hold memory meanwhile. Keep anything that can't be rebuilt (e.g. in
+    /// a compact serialized form).
+    ///
+    /// The wrapper releases its own conversion and MIDI buffers at the same
+    /// point. `process()` is never called while hibernated.
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// fn hibernate(&mut self) {
+    ///     self.delay_line = DelayLine::default(); // frees the buffer
+    /// }
+    ///
+    /// fn resume(&mut self) {
+    ///     self.delay_line = DelayLine::new(self.max_delay_samples);
+    /// }
+    /// ```
+    ///
+    /// Default implementation does nothing.
+    fn hibernate(&mut self) {}
+
+    /// Restore what [`hibernate()`](Self::hibernate) released.
+    ///
+    /// Called on the setup thread right before `set_active(true)`, so
+    /// before the next `process()`. Allocations made here are covered by
+    /// the plugin's [`MemoryPolicy`](crate::MemoryPolicy) like those made
+    /// in `prepare()`.
+    ///
+    /// Default implementation does nothing.
+    fn resume(&mut self) {}
+
     /// Get the tail length in samples.
     ///
     /// This indicates how many samples of audio "tail" the plugin produces
@@ -522,6 +680,42 @@ pub trait AudioProcessor: HasParameters {
         false
     }
 
+    // =========================================================================
+    // In-Place Processing
+    // =========================================================================
+
+    /// Returns true if `process()` handles in-place main-bus channels.
+    ///
+    /// Many hosts pass the same memory for input and output channels. When
+    /// this returns `false` (default), the wrapper copies such inputs into
+    /// pre-allocated scratch memory so every channel has a separate input and
+    /// [`Buffer::zip_channels()`] works as usual.
+    ///
+    /// Return `true` to skip that copy: aliased channels then arrive as
+    /// in-place channels ([`Buffer::is_in_place()`]), which `zip_channels()`
+    /// does not yield. Process them through [`Buffer::in_place_channels()`]
+    /// or [`Buffer::channel_pairs()`].
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// fn supports_in_place(&self) -> bool {
+    ///     true
+    /// }
+    ///
+    /// fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, _context: &ProcessContext) {
+    ///     let gain = self.parameters.gain_linear();
+    ///     for channel in buffer.in_place_channels() {
+    ///         buffer_ops::scale(channel, gain);
+    ///     }
+    /// }
+    /// ```
+    ///
+    /// Default returns `false`.
+    fn supports_in_place(&self) -> bool {
+        false
+    }
+
     /// Process an audio buffer at 64-bit (double) precision.
     ///
     /// This is the f64 equivalent of `process()`. Override this method AND
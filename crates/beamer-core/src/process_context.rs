@@ -28,9 +28,16 @@
 //!         let mod_wheel = cc.mod_wheel();    // 0.0 to 1.0
 //!         let volume = cc.cc(7);             // 0.0 to 1.0
 //!     }
+//!
+//!     // Sample-accurate curves (MidiCcConfig::with_curves), one value per sample
+//!     if let Some(mod_wheel) = context.midi_cc_curves().and_then(|c| c.mod_wheel()) {
+//!         // ...
+//!     }
 //! }
 //! ```
 
+use crate::deadline::QualityLevel;
+use crate::midi_cc_curves::MidiCcCurves;
 use crate::midi_cc_state::MidiCcState;
 
 // =============================================================================
@@ -376,11 +383,22 @@ pub struct ProcessContext<'a> {
     /// Host transport and timing information.
     pub transport: Transport,
 
+    /// Quality the instance can afford, from its recent share of the
+    /// real-time budget (see [`DeadlineMonitor`](crate::DeadlineMonitor)). Always `Full` unless the
+    /// wrapper measured an overload.
+    pub quality: QualityLevel,
+
     /// MIDI CC state for direct access to controller values.
     ///
     /// Only present if the plugin returned `Some(MidiCcConfig)` from
     /// `midi_cc_config()`. Use [`ProcessContext::midi_cc()`] to access.
     midi_cc_state: Option<&'a MidiCcState>,
+
+    /// Per-block controller curves.
+    ///
+    /// Only present if the plugin's `MidiCcConfig` enables curves. Use
+    /// [`ProcessContext::midi_cc_curves()`] to access.
+    midi_cc_curves: Option<&'a MidiCcCurves>,
 }
 
 impl<'a> ProcessContext<'a> {
@@ -393,7 +411,9 @@ impl<'a> ProcessContext<'a> {
             sample_rate,
             num_samples,
             transport,
+            quality: QualityLevel::Full,
             midi_cc_state: None,
+            midi_cc_curves: None,
         }
     }
 
@@ -411,7 +431,9 @@ impl<'a> ProcessContext<'a> {
             sample_rate,
             num_samples,
             transport,
+            quality: QualityLevel::Full,
             midi_cc_state: Some(midi_cc_state),
+            midi_cc_curves: None,
         }
     }
 
@@ -424,10 +446,30 @@ impl<'a> ProcessContext<'a> {
             sample_rate,
             num_samples,
             transport: Transport::default(),
+            quality: QualityLevel::Full,
             midi_cc_state: None,
+            midi_cc_curves: None,
         }
     }
 
+    /// Set the quality level.
+    ///
+    /// This is called by the VST3 wrapper, not by plugin code.
+    #[inline]
+    pub fn with_quality(mut self, quality: QualityLevel) -> Self {
+        self.quality = quality;
+        self
+    }
+
+    /// Attach rendered MIDI CC curves.
+    ///
+    /// This is called by the VST3 wrapper, not by plugin code.
+    #[inline]
+    pub fn with_midi_cc_curves(mut self, curves: Option<&'a MidiCcCurves>) -> Self {
+        self.midi_cc_curves = curves;
+        self
+    }
+
     /// Returns MIDI CC state for direct access to controller values.
     ///
     /// Only returns `Some` if the plugin returned `Some(MidiCcConfig)` from
@@ -449,6 +491,26 @@ impl<'a> ProcessContext<'a> {
         self.midi_cc_state
     }
 
+    /// Returns sample-accurate curves for the enabled MIDI controllers.
+    ///
+    /// Only returns `Some` if the plugin's `MidiCcConfig` was built with
+    /// [`with_curves()`](crate::MidiCcConfig::with_curves). Each curve has
+    /// [`num_samples`](Self::num_samples) values.
+    ///
+    /// # Example
+    ///
+    /// ```ignore
+    /// if let Some(bend) = context.midi_cc_curves().and_then(|c| c.pitch_bend()) {
+    ///     for (out, &b) in self.pitch.iter_mut().zip(bend) {
+    ///         *out = self.base_pitch + b * 2.0; // ±2 semitones
+    ///     }
+    /// }
+    /// ```
+    #[inline]
+    pub fn midi_cc_curves(&self) -> Option<&MidiCcCurves> {
+        self.midi_cc_curves
+    }
+
     /// Calculates the duration of this buffer in seconds.
     #[inline]
     pub fn buffer_duration(&self) -> f64 {
@@ -480,7 +542,9 @@ impl Default for ProcessContext<'_> {
             sample_rate: 44100.0,
             num_samples: 0,
             transport: Transport::default(),
+            quality: QualityLevel::Full,
             midi_cc_state: None,
+            midi_cc_curves: None,
         }
     }
 }
@@ -0,0 +1,444 @@
+//! Pre-faulting and locking of DSP memory.
+//!
+//! Freshly allocated memory isn't backed by physical pages until it's first
+//! written, and may be paged out later under memory pressure. Either way the
+//! audio thread takes a page fault the first time it touches a delay line.
+//! [`MemoryPolicy`] lets a plugin move that cost to the setup thread:
+//!
+//! - [`MemoryPolicy::Prefault`] writes every page once after `prepare()`.
+//! - [`MemoryPolicy::PrefaultAndLock`] also `mlock`s the memory where the OS
+//!   permits it (see `RLIMIT_MEMLOCK` on Linux). Failures are reported, not
+//!   fatal.
+//!
+//! ```ignore
+//! pub static CONFIG: PluginConfig = PluginConfig::new("My Delay")
+//!     .with_memory_policy(MemoryPolicy::PrefaultAndLock);
+//! ```
+//!
+//! # What's Covered
+//!
+//! The format wrappers run `prepare()` inside a [`PrepareScope`]. Every
+//! [`DspArena`](crate::DspArena) created in that scope, by the plugin or by
+//! the wrapper's own conversion buffers, is made resident when the scope
+//! finishes. Plain `Vec`s are not tracked; allocate audio state from an arena
+//! to have it covered. Arenas created elsewhere can be handled directly with
+//! [`DspArena::make_resident()`](crate::DspArena::make_resident).
+//!
+//! # Page Granularity
+//!
+//! `mlock` works on whole pages, and unlocking a freed block would also
+//! unlock any page it shares with a live neighbour. So only pages that lie
+//! entirely inside a block are ever locked. Arenas created while a locking
+//! scope is active are page-aligned and padded to whole pages, so that
+//! covers all of them.
+
+use std::cell::{Cell, RefCell};
+use std::fmt;
+use std::io::ErrorKind;
+use std::marker::PhantomData;
+use std::mem::MaybeUninit;
+use std::sync::{Arc, Weak};
+
+use crate::arena::Block;
+
+/// Stride used to touch memory. Real pages are at least this large, so one
+/// write per stride faults in every page.
+const TOUCH_STRIDE: usize = 4096;
+
+// =============================================================================
+// MemoryPolicy
+// =============================================================================
+
+/// What to do with memory allocated during `prepare()`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub enum MemoryPolicy {
+    /// Leave memory to the OS (pages fault in on first use).
+    #[default]
+    Default,
+    /// Write-fault every page on the setup thread.
+    Prefault,
+    /// Pre-fault and `mlock` so pages are never swapped out.
+    PrefaultAndLock,
+}
+
+impl MemoryPolicy {
+    /// Whether this policy touches memory at all.
+    #[inline]
+    pub const fn is_enabled(self) -> bool {
+        !matches!(self, Self::Default)
+    }
+
+    /// Whether this policy locks memory.
+    #[inline]
+    pub const fn locks(self) -> bool {
+        matches!(self, Self::PrefaultAndLock)
+    }
+}
+
+// =============================================================================
+// ResidencyReport
+// =============================================================================
+
+/// Outcome of making memory resident.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ResidencyReport {
+    /// Number of memory regions processed.
+    pub regions: usize,
+    /// Bytes written to fault in their pages.
+    pub bytes_prefaulted: usize,
+    /// Bytes successfully locked in RAM.
+    pub bytes_locked: usize,
+    /// Number of regions the OS refused to lock.
+    pub lock_failures: usize,
+    /// Error from the most recent failed lock.
+    pub lock_error: Option<ErrorKind>,
+}
+
+impl ResidencyReport {
+    /// Add another report's counts to this one.
+    pub fn merge(&mut self, other: &ResidencyReport) {
+        self.regions += other.regions;
+        self.bytes_prefaulted += other.bytes_prefaulted;
+        self.bytes_locked += other.bytes_locked;
+        self.lock_failures += other.lock_failures;
+        if other.lock_error.is_some() {
+            self.lock_error = other.lock_error;
+        }
+    }
+}
+
+impl fmt::Display for ResidencyReport {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(
+            f,
+            "{} regions, {} KiB prefaulted, {} KiB locked",
+            self.regions,
+            self.bytes_prefaulted.div_ceil(1024),
+            self.bytes_locked.div_ceil(1024),
+        )?;
+        if self.lock_failures > 0 {
+            write!(f, ", {} lock failures", self.lock_failures)?;
+            if let Some(kind) = self.lock_error {
+                write!(f, " ({kind})")?;
+            }
+        }
+        Ok(())
+    }
+}
+
+// =============================================================================
+// PrepareScope
+// =============================================================================
+
+thread_local! {
+    /// Arena blocks created in the innermost active scope on this thread.
+    static SCOPE_BLOCKS: RefCell<Option<Vec<Weak<Block>>>> = const { RefCell::new(None) };
+
+    /// Whether any active scope on this thread locks memory.
+    static SCOPE_LOCKS: Cell<bool> = const { Cell::new(false) };
+}
+
+/// Whether arenas created now will be locked by an enclosing scope.
+pub(crate) fn scope_locks() -> bool {
+    SCOPE_LOCKS.with(Cell::get)
+}
+
+/// Record a new arena block in the active scope, if any.
+pub(crate) fn register_block(block: &Arc<Block>) {
+    SCOPE_BLOCKS.with(|blocks| {
+        if let Some(blocks) = blocks.borrow_mut().as_mut() {
+            blocks.push(Arc::downgrade(block));
+        }
+    });
+}
+
+/// Collects arenas allocated on the setup thread and makes them resident.
+///
+/// Used by the format wrappers around `prepare()`; plugins don't need it.
+/// Scopes nest: an inner scope handles its own arenas and also passes them
+/// to the outer scope. The scope is tied to the thread that created it.
+///
+/// ```ignore
+/// let scope = PrepareScope::begin(config.memory_policy);
+/// let processor = plugin.prepare(setup);
+/// let report = scope.finish();
+/// ```
+pub struct PrepareScope {
+    policy: MemoryPolicy,
+    outer: Option<Vec<Weak<Block>>>,
+    outer_locks: bool,
+    report: ResidencyReport,
+    finished: bool,
+    _not_send: PhantomData<*const ()>,
+}
+
+impl PrepareScope {
+    /// Start collecting arenas created on this thread.
+    ///
+    /// Also builds the shared lookup tables
+    /// ([`init_shared_tables()`](crate::init_shared_tables)), so every host
+    /// that prepares inside a scope keeps their first-use allocation off the
+    /// audio thread.
+    pub fn begin(policy: MemoryPolicy) -> Self {
+        crate::lookup::init_shared_tables();
+        let outer = SCOPE_BLOCKS.with(|blocks| blocks.borrow_mut().replace(Vec::new()));
+        // Blocks are forwarded outwards, so any locking scope locks them
+        let outer_locks = SCOPE_LOCKS.with(|locks| locks.replace(locks.get() || policy.locks()));
+        Self {
+            policy,
+            outer,
+            outer_locks,
+            report: ResidencyReport::default(),
+            finished: false,
+            _not_send: PhantomData,
+        }
+    }
+
+    /// The policy this scope applies.
+    #[inline]
+    pub fn policy(&self) -> MemoryPolicy {
+        self.policy
+    }
+
+    /// Pre-fault memory the wrapper owns outside any arena (e.g. MIDI event
+    /// buffers). Prefault only: such memory is never locked, because it
+    /// isn't unlocked again when freed.
+    pub fn prefault<T: ?Sized>(&mut self, value: &mut T) {
+        if !self.policy.is_enabled() {
+            return;
+        }
+        let len = std::mem::size_of_val(value);
+        if len == 0 {
+            return;
+        }
+        // SAFETY: `value` is exclusively borrowed for the duration of the call
+        unsafe { prefault_raw((value as *mut T).cast::<u8>(), len) };
+        self.report.regions += 1;
+        self.report.bytes_prefaulted += len;
+    }
+
+    /// Stop collecting and apply the policy to every arena still alive.
+    pub fn finish(mut self) -> ResidencyReport {
+        let blocks = self.restore();
+        if self.policy.is_enabled() {
+            for block in blocks.iter().filter_map(Weak::upgrade) {
+                block.make_resident(self.policy.locks(), &mut self.report);
+            }
+        }
+        self.report
+    }
+
+    /// Reinstate the outer scope, forwarding this scope's blocks to it.
+    fn restore(&mut self) -> Vec<Weak<Block>> {
+        self.finished = true;
+        SCOPE_LOCKS.with(|locks| locks.set(self.outer_locks));
+        let outer = self.outer.take();
+        let blocks = SCOPE_BLOCKS.with(|current| std::mem::replace(&mut *current.borrow_mut(), outer));
+        let blocks = blocks.unwrap_or_default();
+        SCOPE_BLOCKS.with(|current| {
+            if let Some(outer) = current.borrow_mut().as_mut() {
+                outer.extend(blocks.iter().cloned());
+            }
+        });
+        blocks
+    }
+}
+
+impl Drop for PrepareScope {
+    fn drop(&mut self) {
+        if !self.finished {
+            self.restore();
+        }
+    }
+}
+
+// =============================================================================
+// OS Primitives
+// =============================================================================
+
+/// Write every page in `ptr..ptr + len` back with its current contents.
+///
+/// # Safety
+///
+/// The range must be a live allocation with no concurrent access.
+pub(crate) unsafe fn prefault_raw(ptr: *mut u8, len: usize) {
+    // MaybeUninit: the range may include uninitialized bytes or padding
+    let ptr = ptr.cast::<MaybeUninit<u8>>();
+    let mut offset = 0;
+    while offset < len {
+        let p = ptr.add(offset);
+        p.write_volatile(p.read_volatile());
+        offset += TOUCH_STRIDE;
+    }
+    let last = ptr.add(len - 1);
+    last.write_volatile(last.read_volatile());
+}
+
+#[cfg(unix)]
+extern "C" {
+    fn mlock(addr: *const std::ffi::c_void, len: usize) -> std::ffi::c_int;
+    fn munlock(addr: *const std::ffi::c_void, len: usize) -> std::ffi::c_int;
+    fn getpagesize() -> std::ffi::c_int;
+}
+
+/// Size of a virtual memory page, the unit `mlock` works in.
+#[cfg(unix)]
+pub(crate) fn page_size() -> usize {
+    // SAFETY: getpagesize has no preconditions
+    let size = unsafe { getpagesize() };
+    usize::try_from(size).ok().filter(|s| s.is_power_of_two()).unwrap_or(TOUCH_STRIDE)
+}
+
+#[cfg(not(unix))]
+pub(crate) fn page_size() -> usize {
+    TOUCH_STRIDE
+}
+
+/// The page-aligned part of `ptr..ptr + len`: the pages no other
+/// allocation can share. `None` if the range holds no whole page.
+pub(crate) fn whole_pages(ptr: *const u8, len: usize) -> Option<(*const u8, usize)> {
+    let page = page_size();
+    let start = (ptr as usize).checked_next_multiple_of(page)?;
+    let end = (ptr as usize + len) & !(page - 1);
+    (start < end).then(|| (ptr.wrapping_add(start - ptr as usize), end - start))
+}
+
+/// Lock a range in RAM.
+#[cfg(unix)]
+pub(crate) fn lock(ptr: *const u8, len: usize) -> Result<(), ErrorKind> {
+    // SAFETY: mlock only changes residency of the range; it doesn't touch contents
+    if unsafe { mlock(ptr.cast(), len) } == 0 {
+        Ok(())
+    } else {
+        Err(std::io::Error::last_os_error().kind())
+    }
+}
+
+/// Unlock a range previously locked with [`lock()`].
+#[cfg(unix)]
+pub(crate) fn unlock(ptr: *const u8, len: usize) {
+    // SAFETY: as for mlock
+    unsafe { munlock(ptr.cast(), len) };
+}
+
+#[cfg(not(unix))]
+pub(crate) fn lock(_ptr: *const u8, _len: usize) -> Result<(), ErrorKind> {
+    Err(ErrorKind::Unsupported)
+}
+
+#[cfg(not(unix))]
+pub(crate) fn unlock(_ptr: *const u8, _len: usize) {}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::arena::{ArenaLayout, DspArena};
+
+    #[test]
+    fn scope_covers_only_arenas_created_inside() {
+        let layout = ArenaLayout::new().slice::<f32>(10_000);
+        let _before = DspArena::new(layout);
+
+        let scope = PrepareScope::begin(MemoryPolicy::Prefault);
+        let mut arena = DspArena::new(layout);
+        let slice = arena.alloc(10_000, 1.5f32);
+        let dropped = DspArena::new(layout);
+        drop(dropped);
+        let report = scope.finish();
+
+        assert_eq!(report.regions, 1);
+        assert_eq!(report.bytes_prefaulted, layout.size());
+        assert_eq!(report.bytes_locked, 0);
+        assert!(slice.iter().all(|&s| s == 1.5));
+    }
+
+    #[test]
+    fn default_policy_does_nothing() {
+        let scope = PrepareScope::begin(MemoryPolicy::Default);
+        let _arena = DspArena::new(ArenaLayout::new().bytes(4096));
+        let mut midi = [0u8; 256];
+        let mut scope = scope;
+        scope.prefault(&mut midi);
+        assert_eq!(scope.finish(), ResidencyReport::default());
+    }
+
+    #[test]
+    fn lock_succeeds_or_reports_failure() {
+        let scope = PrepareScope::begin(MemoryPolicy::PrefaultAndLock);
+        let arena = DspArena::new(ArenaLayout::new().bytes(8192));
+        let report = scope.finish();
+
+        assert_eq!(report.regions, 1);
+        if report.lock_failures == 0 {
+            assert_eq!(report.bytes_locked, arena.capacity());
+            // Already locked: a second pass doesn't lock again
+            assert_eq!(arena.make_resident(true).bytes_locked, 0);
+        } else {
+            assert_eq!(report.bytes_locked, 0);
+            assert!(report.lock_error.is_some());
+        }
+    }
+
+    #[test]
+    fn locking_scope_pads_arenas_to_whole_pages() {
+        let page = page_size();
+        let scope = PrepareScope::begin(MemoryPolicy::PrefaultAndLock);
+        let inner = PrepareScope::begin(MemoryPolicy::Prefault);
+        // Blocks from an inner scope still reach the locking outer one
+        let a = DspArena::new(ArenaLayout::new().bytes(100));
+        inner.finish();
+        let b = DspArena::new(ArenaLayout::new().bytes(page + 1));
+        let report = scope.finish();
+
+        for arena in [&a, &b] {
+            let (ptr, len) = arena.as_ptr_range();
+            assert_eq!(ptr as usize % page, 0);
+            assert_eq!(len % page, 0);
+            assert_eq!(whole_pages(ptr, len), Some((ptr, len)));
+        }
+        assert_eq!(b.capacity(), 2 * page);
+        if report.lock_failures == 0 {
+            assert_eq!(report.bytes_locked, a.capacity() + b.capacity());
+        }
+
+        // Outside the scope, arenas are only cache-line aligned again
+        assert!(!scope_locks());
+        assert_eq!(DspArena::new(ArenaLayout::new().bytes(100)).capacity(), 128);
+    }
+
+    #[test]
+    fn whole_pages_excludes_shared_edges() {
+        let page = page_size();
+        let base = (page * 16) as *const u8;
+        assert_eq!(whole_pages(base, page), Some((base, page)));
+        // Partial pages at either end belong to the neighbours too
+        assert_eq!(whole_pages(base.wrapping_add(64), page), None);
+        assert_eq!(
+            whole_pages(base.wrapping_add(64), 3 * page),
+            Some((base.wrapping_add(page), 2 * page))
+        );
+        assert_eq!(whole_pages(base, 0), None);
+    }
+
+    #[test]
+    fn nested_scopes_forward_to_outer() {
+        let layout = ArenaLayout::new().bytes(1024);
+        let outer = PrepareScope::begin(MemoryPolicy::Prefault);
+        let _a = DspArena::new(layout);
+
+        let mut inner = PrepareScope::begin(MemoryPolicy::Prefault);
+        let _b = DspArena::new(layout);
+        let mut extra = vec![0u32; 100];
+        inner.prefault(extra.as_mut_slice());
+        let inner_report = inner.finish();
+        assert_eq!(inner_report.regions, 2);
+        assert_eq!(inner_report.bytes_prefaulted, 1024 + 400);
+
+        // An abandoned scope still restores the outer one
+        drop(PrepareScope::begin(MemoryPolicy::Prefault));
+        let _c = DspArena::new(layout);
+
+        assert_eq!(outer.finish().regions, 3);
+        assert!(SCOPE_BLOCKS.with(|blocks| blocks.borrow().is_none()));
+    }
+}
@@ -0,0 +1,145 @@
+//! Process-wide services shared by every plugin instance in a module.
+//!
+//! A binary exporting several plugin classes (see `export_vst3!` with a class
+//! list) is loaded once per process, so its `static` items are shared by every
+//! instance of every class in it. [`SharedService`] builds on that for
+//! resources that are too expensive to create per instance: worker pools,
+//! decoded sample or impulse-response caches, large tables.
+//!
+//! - Created lazily by the first instance that asks for it
+//! - Reference counted: instances hold an [`Arc`], and the service is dropped
+//!   when the last instance releases it (no threads or caches left behind
+//!   once the host closes the last plugin)
+//! - Created again on the next request after that
+//!
+//! Static read-only data needs none of this: a `static` (or the shared
+//! [`lookup`](crate::lookup) tables) is already one copy per module.
+//!
+//! # Example
+//!
+//! ```ignore
+//! static IR_CACHE: SharedService<IrCache> = SharedService::new();
+//!
+//! fn prepare(self, setup: AudioSetup) -> ReverbProcessor {
+//!     // Same cache for every reverb and delay instance in this binary
+//!     let cache = IR_CACHE.acquire(IrCache::default);
+//!     // ...
+//! }
+//! ```
+//!
+//! # Thread Safety
+//!
+//! Acquiring takes a mutex and may run the initializer: call it from
+//! `prepare()` or the constructor, never from `process()`. The service itself
+//! is shared between instances that may process concurrently on different
+//! host threads, so it must synchronize internally (`T: Send + Sync`).
+
+use std::sync::{Arc, Mutex, Weak};
+
+/// A lazily created, reference-counted, process-wide service.
+///
+/// Declare as a `static`; see the [module docs](self).
+pub struct SharedService<T> {
+    slot: Mutex<Option<Weak<T>>>,
+}
+
+impl<T: Send + Sync> SharedService<T> {
+    /// Create an empty slot (usable in `static` initializers).
+    pub const fn new() -> Self {
+        Self {
+            slot: Mutex::new(None),
+        }
+    }
+
+    /// Get the live service, or create it with `init`.
+    pub fn acquire(&self, init: impl FnOnce() -> T) -> Arc<T> {
+        match self.try_acquire(|| Ok::<T, std::convert::Infallible>(init())) {
+            Ok(service) => service,
+            Err(never) => match never {},
+        }
+    }
+
+    /// Get the live service, or create it with a fallible `init`.
+    ///
+    /// On error nothing is stored and the next call tries again.
+    pub fn try_acquire<E>(&self, init: impl FnOnce() -> Result<T, E>) -> Result<Arc<T>, E> {
+        // The lock is held across init so concurrent first requests create one service
+        let mut slot = self.slot.lock().unwrap_or_else(|e| e.into_inner());
+        if let Some(service) = slot.as_ref().and_then(Weak::upgrade) {
+            return Ok(service);
+        }
+        let service = Arc::new(init()?);
+        *slot = Some(Arc::downgrade(&service));
+        Ok(service)
+    }
+
+    /// Get the service if some instance currently holds it.
+    pub fn get(&self) -> Option<Arc<T>> {
+        let slot = self.slot.lock().unwrap_or_else(|e| e.into_inner());
+        slot.as_ref().and_then(Weak::upgrade)
+    }
+
+    /// Returns true if some instance currently holds the service.
+    pub fn is_live(&self) -> bool {
+        self.get().is_some()
+    }
+}
+
+impl<T: Send + Sync> Default for SharedService<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[test]
+    fn test_shared_until_last_release() {
+        static SERVICE: SharedService<Vec<f32>> = SharedService::new();
+        let created = AtomicUsize::new(0);
+        let init = || {
+            created.fetch_add(1, Ordering::Relaxed);
+            vec![0.5; 1024]
+        };
+
+        let a = SERVICE.acquire(init);
+        let b = SERVICE.acquire(init);
+        assert!(Arc::ptr_eq(&a, &b));
+        assert_eq!(created.load(Ordering::Relaxed), 1);
+
+        drop(a);
+        assert!(SERVICE.is_live());
+        drop(b);
+        assert!(!SERVICE.is_live());
+
+        // Created again after the last instance released it
+        let _c = SERVICE.acquire(init);
+        assert_eq!(created.load(Ordering::Relaxed), 2);
+    }
+
+    #[test]
+    fn test_failed_init_is_retried() {
+        let service: SharedService<u32> = SharedService::new();
+        assert_eq!(service.try_acquire(|| Err("busy")).unwrap_err(), "busy");
+        assert!(service.get().is_none());
+        assert_eq!(*service.try_acquire(|| Ok::<_, ()>(7)).unwrap(), 7);
+    }
+
+    #[test]
+    fn test_concurrent_first_acquire_creates_once() {
+        static SERVICE: SharedService<usize> = SharedService::new();
+        static CREATED: AtomicUsize = AtomicUsize::new(0);
+
+        let services: Vec<Arc<usize>> = std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..8)
+                .map(|_| scope.spawn(|| SERVICE.acquire(|| CREATED.fetch_add(1, Ordering::Relaxed))))
+                .collect();
+            handles.into_iter().map(|h| h.join().unwrap()).collect()
+        });
+        assert_eq!(CREATED.load(Ordering::Relaxed), 1);
+        assert!(services.windows(2).all(|w| Arc::ptr_eq(&w[0], &w[1])));
+    }
+}
@@ -0,0 +1,511 @@
+//! All smoothed parameters of a collection, advanced together.
+//!
+//! Each [`FloatParameter`](crate::FloatParameter) owns its own [`Smoother`](crate::Smoother):
+//! `tick_smoothed()` on 60 parameters is 60 scattered structs, 60 atomic
+//! loads and 60 style dispatches per sample. [`SmootherBank`] gathers the
+//! smoothers of a whole [`Parameters`] collection into structure-of-arrays
+//! lanes grouped by style (`current`, `target` and `coefficient` arrays), so
+//! one sample of every parameter is a branch-free loop per style that LLVM
+//! vectorizes, and targets are read from the atomics once per block.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // In prepare()
+//! let mut smoothers = SmootherBank::from_parameters(&parameters);
+//! smoothers.set_sample_rate(config.sample_rate);
+//! smoothers.set_max_block_size(config.max_buffer_size);
+//! let cutoff = smoothers.slot(parameters.cutoff.id()).unwrap();
+//!
+//! // In process(): one target update, then per block...
+//! self.smoothers.update_targets(&self.parameters);
+//! self.smoothers.fill(buffer.num_samples());
+//! let cutoff = self.smoothers.row(self.cutoff);  // [sample] for this parameter
+//!
+//! // ...or per sample
+//! self.smoothers.tick();
+//! let cutoff = self.smoothers.value(self.cutoff);
+//! ```
+//!
+//! Values follow the same curves as [`Smoother`](crate::Smoother) with the
+//! same style, sample rate and targets. Use either the bank or the
+//! parameters' own `tick_smoothed()`, not both: they keep separate state.
+//!
+//! # Real-Time Safety
+//!
+//! Construction and [`set_max_block_size()`](SmootherBank::set_max_block_size)
+//! allocate; everything else, including [`update_targets()`](SmootherBank::update_targets),
+//! is allocation-free.
+
+use crate::parameter_types::{ParameterRef, Parameters};
+use crate::smoothing::SmoothingStyle;
+use crate::types::ParameterId;
+
+/// Threshold for snapping to the target (same as [`Smoother`](crate::Smoother)).
+const SNAP_THRESHOLD: f64 = 1e-8;
+
+/// Lane group of a smoothing style. Lanes are stored grouped in this order.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, PartialOrd, Ord)]
+enum Group {
+    /// One-pole (exponential); `None` is a one-pole with coefficient 1.
+    Pole,
+    /// One-pole in the log domain.
+    Log,
+    /// Linear ramps.
+    Linear,
+}
+
+impl Group {
+    fn of(style: SmoothingStyle) -> Self {
+        match style {
+            SmoothingStyle::None | SmoothingStyle::Exponential(_) => Group::Pole,
+            SmoothingStyle::Logarithmic(_) => Group::Log,
+            SmoothingStyle::Linear(_) => Group::Linear,
+        }
+    }
+}
+
+/// Smoothers of many parameters in structure-of-arrays lanes.
+///
+/// Parameters are addressed by slot: the order they were added (for
+/// [`from_parameters()`](Self::from_parameters), the order of
+/// [`Parameters::for_each_smoothed()`]).
+#[derive(Debug, Clone, Default)]
+pub struct SmootherBank {
+    sample_rate: f64,
+
+    // Per slot
+    ids: Vec<ParameterId>,
+    styles: Vec<SmoothingStyle>,
+    lane_of: Vec<usize>,
+
+    // Per lane, grouped: pole lanes, then log lanes, then linear lanes
+    current: Vec<f64>,
+    target: Vec<f64>,
+    /// One-pole coefficient (pole, log) or increment per sample (linear).
+    coefficient: Vec<f64>,
+    /// `ln(current)` / `ln(target)` (log lanes only).
+    log_current: Vec<f64>,
+    log_target: Vec<f64>,
+    /// Samples until the target is reached (linear lanes only).
+    remaining: Vec<u32>,
+    pole_end: usize,
+    log_end: usize,
+
+    // Block scratch, [lane][sample]
+    block: Vec<f32>,
+    max_block_size: usize,
+    block_len: usize,
+}
+
+impl SmootherBank {
+    /// Create an empty bank.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Create a bank with every smoothed parameter of `parameters`, starting
+    /// at their current values.
+    pub fn from_parameters<P: Parameters + ?Sized>(parameters: &P) -> Self {
+        let mut bank = Self::new();
+        parameters.for_each_smoothed(&mut |parameter| {
+            if let Some(style) = parameter.smoothing_style() {
+                bank.add(parameter.id(), style, parameter.get());
+            }
+        });
+        bank
+    }
+
+    /// Add a smoother starting at `value` and return its slot.
+    pub fn add(&mut self, id: ParameterId, style: SmoothingStyle, value: f64) -> usize {
+        let group = Group::of(style);
+        let lane = match group {
+            Group::Pole => self.pole_end,
+            Group::Log => self.log_end,
+            Group::Linear => self.current.len(),
+        };
+        for other in self.lane_of.iter_mut().filter(|l| **l >= lane) {
+            *other += 1;
+        }
+        self.current.insert(lane, value);
+        self.target.insert(lane, value);
+        self.coefficient.insert(lane, coefficient(style, self.sample_rate));
+        self.log_current.insert(lane, value.ln());
+        self.log_target.insert(lane, value.ln());
+        self.remaining.insert(lane, 0);
+        match group {
+            Group::Pole => {
+                self.pole_end += 1;
+                self.log_end += 1;
+            }
+            Group::Log => self.log_end += 1,
+            Group::Linear => {}
+        }
+
+        self.ids.push(id);
+        self.styles.push(style);
+        self.lane_of.push(lane);
+        if self.max_block_size > 0 {
+            self.block.resize(self.current.len() * self.max_block_size, 0.0);
+        }
+        self.ids.len() - 1
+    }
+
+    /// Number of smoothed parameters.
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.ids.len()
+    }
+
+    /// Returns true if the bank has no parameters.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.ids.is_empty()
+    }
+
+    /// Slot of parameter `id`.
+    pub fn slot(&self, id: ParameterId) -> Option<usize> {
+        self.ids.iter().position(|&other| other == id)
+    }
+
+    /// Parameter ID of a slot.
+    #[inline]
+    pub fn id(&self, slot: usize) -> ParameterId {
+        self.ids[slot]
+    }
+
+    /// Set the sample rate and recompute one-pole coefficients.
+    ///
+    /// Linear ramps pick up the new rate with their next target, as with
+    /// [`Smoother`](crate::Smoother).
+    pub fn set_sample_rate(&mut self, sample_rate: f64) {
+        self.sample_rate = sample_rate;
+        for (&style, &lane) in self.styles.iter().zip(&self.lane_of) {
+            if Group::of(style) != Group::Linear {
+                self.coefficient[lane] = coefficient(style, sample_rate);
+            }
+        }
+    }
+
+    /// Allocate the block scratch for [`fill()`](Self::fill).
+    pub fn set_max_block_size(&mut self, max_block_size: usize) {
+        self.max_block_size = max_block_size;
+        self.block = vec![0.0; self.current.len() * max_block_size];
+        self.block_len = 0;
+    }
+
+    // =========================================================================
+    // Targets
+    // =========================================================================
+
+    /// Set the target of one slot.
+    pub fn set_target(&mut self, slot: usize, target: f64) {
+        let lane = self.lane_of[slot];
+        if (self.target[lane] - target).abs() < 1e-10 {
+            return;
+        }
+        self.target[lane] = target;
+
+        match self.styles[slot] {
+            SmoothingStyle::None => self.current[lane] = target,
+            SmoothingStyle::Linear(ms) => {
+                let samples = ((ms * self.sample_rate / 1000.0) as u32).max(1);
+                self.remaining[lane] = samples;
+                self.coefficient[lane] = (target - self.current[lane]) / samples as f64;
+            }
+            SmoothingStyle::Exponential(_) => {}
+            SmoothingStyle::Logarithmic(_) => self.log_target[lane] = target.ln(),
+        }
+    }
+
+    /// Read every target from `parameters` (one atomic load per parameter).
+    ///
+    /// `parameters` must be the collection the bank was built from.
+    pub fn update_targets<P: Parameters + ?Sized>(&mut self, parameters: &P) {
+        let mut slot = 0;
+        parameters.for_each_smoothed(&mut |parameter| {
+            if slot < self.ids.len() {
+                debug_assert_eq!(self.ids[slot], parameter.id(), "bank built from other parameters");
+                self.set_target(slot, parameter.get());
+            }
+            slot += 1;
+        });
+    }
+
+    /// Jump one slot to `value` (no ramp).
+    pub fn reset(&mut self, slot: usize, value: f64) {
+        let lane = self.lane_of[slot];
+        self.current[lane] = value;
+        self.target[lane] = value;
+        self.log_current[lane] = value.ln();
+        self.log_target[lane] = value.ln();
+        self.remaining[lane] = 0;
+    }
+
+    /// Jump every slot to the current value of its parameter (after loading state).
+    pub fn reset_from<P: Parameters + ?Sized>(&mut self, parameters: &P) {
+        let mut slot = 0;
+        parameters.for_each_smoothed(&mut |parameter| {
+            if slot < self.ids.len() {
+                self.reset(slot, parameter.get());
+            }
+            slot += 1;
+        });
+    }
+
+    // =========================================================================
+    // Advancing
+    // =========================================================================
+
+    /// Advance every parameter by one sample.
+    ///
+    /// Read the results with [`value()`](Self::value).
+    #[inline]
+    pub fn tick(&mut self) {
+        let (pole_end, log_end) = (self.pole_end, self.log_end);
+
+        // One-pole: y += coef * (target - y), snapped when close
+        for ((current, &target), &coef) in self.current[..pole_end]
+            .iter_mut()
+            .zip(&self.target[..pole_end])
+            .zip(&self.coefficient[..pole_end])
+        {
+            let next = *current + coef * (target - *current);
+            *current = if (next - target).abs() < SNAP_THRESHOLD { target } else { next };
+        }
+
+        // One-pole in the log domain (positive values only; others jump)
+        for i in pole_end..log_end {
+            let target = self.target[i];
+            if target > 0.0 && self.current[i] > 0.0 {
+                let log_target = self.log_target[i];
+                let log_next = self.log_current[i] + self.coefficient[i] * (log_target - self.log_current[i]);
+                let next = log_next.exp();
+                let snap = (next - target).abs() < SNAP_THRESHOLD;
+                self.current[i] = if snap { target } else { next };
+                self.log_current[i] = if snap { log_target } else { log_next };
+            } else {
+                self.current[i] = target;
+                self.log_current[i] = self.log_target[i];
+            }
+        }
+
+        // Linear: step while samples remain, land exactly on the target
+        for (((current, &target), &step), remaining) in self.current[log_end..]
+            .iter_mut()
+            .zip(&self.target[log_end..])
+            .zip(&self.coefficient[log_end..])
+            .zip(&mut self.remaining[log_end..])
+        {
+            let left = remaining.saturating_sub(1);
+            *current = if left == 0 { target } else { *current + step };
+            *remaining = left;
+        }
+    }
+
+    /// Advance every parameter by `samples` without producing values.
+    pub fn skip(&mut self, samples: usize) {
+        for i in 0..self.pole_end {
+            let decay = (1.0 - self.coefficient[i]).powi(samples as i32);
+            let next = self.target[i] + (self.current[i] - self.target[i]) * decay;
+            self.current[i] = if (next - self.target[i]).abs() < SNAP_THRESHOLD { self.target[i] } else { next };
+        }
+        for i in self.pole_end..self.log_end {
+            let target = self.target[i];
+            if target > 0.0 && self.current[i] > 0.0 {
+                let decay = (1.0 - self.coefficient[i]).powi(samples as i32);
+                let log_next = self.log_target[i] + (self.log_current[i] - self.log_target[i]) * decay;
+                self.current[i] = log_next.exp();
+                self.log_current[i] = log_next;
+                if (self.current[i] - target).abs() < SNAP_THRESHOLD {
+                    self.current[i] = target;
+                    self.log_current[i] = self.log_target[i];
+                }
+            } else {
+                self.current[i] = target;
+                self.log_current[i] = self.log_target[i];
+            }
+        }
+        for i in self.log_end..self.current.len() {
+            let count = (samples as u32).min(self.remaining[i]);
+            if count > 0 {
+                self.current[i] += self.coefficient[i] * count as f64;
+                self.remaining[i] -= count;
+                if self.remaining[i] == 0 {
+                    self.current[i] = self.target[i];
+                }
+            }
+        }
+    }
+
+    /// Render the next `len` samples of every parameter into the block scratch.
+    ///
+    /// Read them with [`row()`](Self::row). `len` is clamped to the
+    /// [maximum block size](Self::set_max_block_size).
+    pub fn fill(&mut self, len: usize) {
+        let len = len.min(self.max_block_size);
+        let stride = self.max_block_size;
+        for sample in 0..len {
+            self.tick();
+            for (lane, &value) in self.current.iter().enumerate() {
+                self.block[lane * stride + sample] = value as f32;
+            }
+        }
+        self.block_len = len;
+    }
+
+    // =========================================================================
+    // Values
+    // =========================================================================
+
+    /// Current smoothed value of a slot.
+    #[inline]
+    pub fn value(&self, slot: usize) -> f64 {
+        self.current[self.lane_of[slot]]
+    }
+
+    /// Current smoothed value of a slot as f32.
+    #[inline]
+    pub fn value_f32(&self, slot: usize) -> f32 {
+        self.value(slot) as f32
+    }
+
+    /// Target value of a slot.
+    #[inline]
+    pub fn target(&self, slot: usize) -> f64 {
+        self.target[self.lane_of[slot]]
+    }
+
+    /// Samples of a slot from the last [`fill()`](Self::fill).
+    #[inline]
+    pub fn row(&self, slot: usize) -> &[f32] {
+        let start = self.lane_of[slot] * self.max_block_size;
+        &self.block[start..start + self.block_len]
+    }
+
+    /// Returns true if any parameter is still moving toward its target.
+    ///
+    /// Lets a processor skip per-sample work for blocks where every
+    /// parameter is settled.
+    pub fn is_smoothing(&self) -> bool {
+        let settled = |i: usize| (self.current[i] - self.target[i]).abs() <= SNAP_THRESHOLD;
+        !(0..self.log_end).all(settled) || self.remaining[self.log_end..].iter().any(|&r| r > 0)
+    }
+}
+
+/// One-pole coefficient of a style (0 for linear, computed per target).
+fn coefficient(style: SmoothingStyle, sample_rate: f64) -> f64 {
+    match style {
+        SmoothingStyle::None => 1.0,
+        SmoothingStyle::Linear(_) => 0.0,
+        SmoothingStyle::Exponential(ms) | SmoothingStyle::Logarithmic(ms) => {
+            // Same as Smoother: reaches ~63% in `ms` milliseconds
+            let samples_per_tau = ms / 1000.0 * sample_rate;
+            if sample_rate <= 0.0 {
+                0.0
+            } else if samples_per_tau > 0.0 {
+                1.0 - (-1.0 / samples_per_tau).exp()
+            } else {
+                1.0
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::smoothing::Smoother;
+
+    const STYLES: [SmoothingStyle; 4] = [
+        SmoothingStyle::Exponential(5.0),
+        SmoothingStyle::Linear(2.0),
+        SmoothingStyle::Logarithmic(10.0),
+        SmoothingStyle::None,
+    ];
+
+    /// Bank and standalone smoothers for the same styles and start values.
+    fn pair() -> (SmootherBank, Vec<Smoother>) {
+        let mut bank = SmootherBank::new();
+        let mut smoothers = Vec::new();
+        // Interleave styles so slots and lanes differ
+        for (i, &style) in STYLES.iter().chain(STYLES.iter()).enumerate() {
+            let start = 100.0 + i as f64;
+            assert_eq!(bank.add(i as ParameterId, style, start), i);
+            let mut smoother = Smoother::new(style);
+            smoother.set_sample_rate(48_000.0);
+            smoother.reset(start);
+            smoothers.push(smoother);
+        }
+        bank.set_sample_rate(48_000.0);
+        (bank, smoothers)
+    }
+
+    fn set_targets(bank: &mut SmootherBank, smoothers: &mut [Smoother], round: usize) {
+        for (slot, smoother) in smoothers.iter_mut().enumerate() {
+            let target = 50.0 + ((slot * 7 + round * 13) % 17) as f64 * 40.0;
+            bank.set_target(slot, target);
+            smoother.set_target(target);
+        }
+    }
+
+    #[test]
+    fn test_tick_matches_smoother() {
+        let (mut bank, mut smoothers) = pair();
+        for round in 0..4 {
+            set_targets(&mut bank, &mut smoothers, round);
+            for _ in 0..300 {
+                bank.tick();
+                for (slot, smoother) in smoothers.iter_mut().enumerate() {
+                    let expected = smoother.tick();
+                    let actual = bank.value(slot);
+                    assert!((actual - expected).abs() < 1e-9 * expected.abs().max(1.0), "slot {slot}: {actual} vs {expected}");
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn test_skip_matches_smoother() {
+        let (mut bank, mut smoothers) = pair();
+        set_targets(&mut bank, &mut smoothers, 1);
+        bank.skip(37);
+        for (slot, smoother) in smoothers.iter_mut().enumerate() {
+            smoother.skip(37);
+            assert!((bank.value(slot) - smoother.current()).abs() < 1e-9 * smoother.current().abs().max(1.0));
+        }
+    }
+
+    #[test]
+    fn test_fill_rows_and_settling() {
+        let (mut bank, mut smoothers) = pair();
+        bank.set_max_block_size(64);
+        set_targets(&mut bank, &mut smoothers, 2);
+        assert!(bank.is_smoothing());
+
+        bank.fill(64);
+        for (slot, smoother) in smoothers.iter_mut().enumerate() {
+            let row = bank.row(slot);
+            assert_eq!(row.len(), 64);
+            for &value in row {
+                assert_eq!(value, smoother.tick() as f32);
+            }
+        }
+
+        // Linear (2 ms) and None are settled; one-poles take longer
+        for _ in 0..48_000 {
+            bank.tick();
+        }
+        assert!(!bank.is_smoothing());
+    }
+
+    #[test]
+    fn test_slots_by_id() {
+        let (mut bank, _) = pair();
+        assert_eq!(bank.len(), 8);
+        assert_eq!(bank.slot(5), Some(5));
+        assert_eq!(bank.slot(99), None);
+        bank.reset(5, 3.0);
+        assert_eq!((bank.value(5), bank.target(5)), (3.0, 3.0));
+    }
+}
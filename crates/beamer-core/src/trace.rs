@@ -0,0 +1,650 @@
+//! Timeline tracing of processing stages, DSP code and worker jobs.
+//!
+//! Averaged timings (the deadline monitor, benchmarks) say how long a block
+//! took; a timeline says *where* inside the block the time went, on which
+//! thread, and how worker jobs overlapped the audio thread. This module
+//! records timed spans into fixed-size per-thread rings and exports them as
+//! Chrome Trace Event JSON, which opens directly in Perfetto
+//! (<https://ui.perfetto.dev>) or `chrome://tracing`.
+//!
+//! - The wrappers record their stages ([`category::WRAPPER`], [`category::MIDI`])
+//!   and tag every span with the plugin instance that produced it
+//! - [`BusRenderPool`](crate::BusRenderPool) records each job ([`category::WORKER`])
+//! - Plugin code adds its own spans with [`span()`]
+//!
+//! # Example
+//!
+//! ```ignore
+//! // Test harness or render tool, before creating instances
+//! trace::enable(TraceConfig::new());
+//!
+//! // Plugin DSP code (audio thread)
+//! fn process(&mut self, buffer: &mut Buffer, aux: &mut AuxiliaryBuffers, context: &ProcessContext) {
+//!     let _span = trace::span("oscillators");
+//!     // ...
+//! }
+//!
+//! // After rendering (off the audio thread)
+//! trace::write_chrome_trace_file("render.trace.json")?;
+//! ```
+//!
+//! # Real-Time Safety
+//!
+//! Tracing is off by default, and a disabled span costs one relaxed atomic
+//! load. [`enable()`] allocates every ring up front; after that, recording
+//! takes no locks and never allocates: each thread claims a ring on its
+//! first span through an atomic counter and is its only writer. A full ring
+//! drops new spans (counted in [`TraceSnapshot::dropped`]) rather than
+//! overwriting ones the reader may be copying. Timestamps come from a
+//! monotonic clock ([`Instant`]) relative to the moment tracing was enabled.
+//!
+//! Rings are drained off the audio thread with [`drain()`]. Threads keep
+//! their ring for the life of the process, so `max_threads` bounds the number
+//! of distinct threads that can be traced. Claiming a ring takes an
+//! uncontended lock once per thread, to attach its name.
+
+use std::cell::{Cell, UnsafeCell};
+use std::fmt;
+use std::fs::File;
+use std::io::{self, BufWriter, Write};
+use std::path::Path;
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Mutex, OnceLock};
+use std::time::Instant;
+
+/// Default number of spans each thread ring holds.
+pub const DEFAULT_RING_CAPACITY: usize = 8192;
+
+/// Default number of threads that can record spans.
+pub const DEFAULT_MAX_THREADS: usize = 32;
+
+/// Maximum stored thread name length in bytes (longer names are truncated).
+pub const MAX_THREAD_NAME_LEN: usize = 32;
+
+/// Span categories used by the framework (Chrome trace `cat` field).
+pub mod category {
+    /// Wrapper stages: the whole `process()` call, parameter changes, audio.
+    pub const WRAPPER: &str = "wrapper";
+    /// MIDI stages: event conversion and `process_midi()`.
+    pub const MIDI: &str = "midi";
+    /// Plugin DSP code (default category of [`span()`](super::span)).
+    pub const DSP: &str = "dsp";
+    /// Jobs run by worker pools.
+    pub const WORKER: &str = "worker";
+}
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+/// Ring sizes for [`enable()`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TraceConfig {
+    /// Spans per thread ring (rounded up to a power of two).
+    pub ring_capacity: usize,
+    /// Number of thread rings.
+    pub max_threads: usize,
+}
+
+impl TraceConfig {
+    /// Default configuration.
+    pub const fn new() -> Self {
+        Self {
+            ring_capacity: DEFAULT_RING_CAPACITY,
+            max_threads: DEFAULT_MAX_THREADS,
+        }
+    }
+
+    /// Set the number of spans per thread ring.
+    pub const fn with_ring_capacity(mut self, ring_capacity: usize) -> Self {
+        self.ring_capacity = ring_capacity;
+        self
+    }
+
+    /// Set the number of thread rings.
+    pub const fn with_max_threads(mut self, max_threads: usize) -> Self {
+        self.max_threads = max_threads;
+        self
+    }
+}
+
+impl Default for TraceConfig {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// =============================================================================
+// Records
+// =============================================================================
+
+/// One recorded span.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TraceSpan {
+    /// Ring (thread) index that recorded the span.
+    pub thread: u32,
+    /// Plugin instance that was current on the thread (0 = none).
+    pub instance: u32,
+    /// Category, see [`category`].
+    pub category: &'static str,
+    /// Span name.
+    pub name: &'static str,
+    /// Start time in nanoseconds since tracing was enabled.
+    pub start_ns: u64,
+    /// Duration in nanoseconds.
+    pub duration_ns: u64,
+}
+
+/// Spans and thread names drained from the rings.
+#[derive(Debug, Clone, Default)]
+pub struct TraceSnapshot {
+    /// Spans in per-thread recording order.
+    pub spans: Vec<TraceSpan>,
+    /// `(thread, name)` of every named thread that has a ring.
+    pub threads: Vec<(u32, String)>,
+    /// Spans lost since tracing was enabled (full ring or no free ring).
+    pub dropped: u64,
+}
+
+impl TraceSnapshot {
+    /// Write the snapshot as Chrome Trace Event JSON.
+    ///
+    /// Spans become complete (`"ph": "X"`) events with microsecond
+    /// timestamps, one track per thread, with the instance in `args`.
+    pub fn write_chrome_json<W: Write>(&self, mut out: W) -> io::Result<()> {
+        out.write_all(b"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[")?;
+        let mut first = true;
+        for (thread, name) in &self.threads {
+            separator(&mut out, &mut first)?;
+            write!(
+                out,
+                "{{\"ph\":\"M\",\"pid\":1,\"tid\":{thread},\"name\":\"thread_name\",\"args\":{{\"name\":\"{}\"}}}}",
+                JsonStr(name)
+            )?;
+        }
+        for span in &self.spans {
+            separator(&mut out, &mut first)?;
+            write!(
+                out,
+                "{{\"ph\":\"X\",\"pid\":1,\"tid\":{},\"cat\":\"{}\",\"name\":\"{}\",\"ts\":{},\"dur\":{},\"args\":{{\"instance\":{}}}}}",
+                span.thread,
+                JsonStr(span.category),
+                JsonStr(span.name),
+                Micros(span.start_ns),
+                Micros(span.duration_ns),
+                span.instance
+            )?;
+        }
+        out.write_all(b"]}\n")
+    }
+}
+
+fn separator<W: Write>(out: &mut W, first: &mut bool) -> io::Result<()> {
+    if !std::mem::take(first) {
+        out.write_all(b",")?;
+    }
+    Ok(())
+}
+
+/// Nanoseconds formatted as microseconds with three decimals.
+struct Micros(u64);
+
+impl fmt::Display for Micros {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        write!(f, "{}.{:03}", self.0 / 1000, self.0 % 1000)
+    }
+}
+
+/// JSON string contents with escaping.
+struct JsonStr<'a>(&'a str);
+
+impl fmt::Display for JsonStr<'_> {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        for c in self.0.chars() {
+            match c {
+                '"' => f.write_str("\\\"")?,
+                '\\' => f.write_str("\\\\")?,
+                c if (c as u32) < 0x20 => write!(f, "\\u{:04x}", c as u32)?,
+                c => fmt::Write::write_char(f, c)?,
+            }
+        }
+        Ok(())
+    }
+}
+
+// =============================================================================
+// Rings
+// =============================================================================
+
+/// Span as stored in a ring (the thread is implied by the ring).
+#[derive(Clone, Copy)]
+struct Record {
+    instance: u32,
+    category: &'static str,
+    name: &'static str,
+    start_ns: u64,
+    duration_ns: u64,
+}
+
+const EMPTY_RECORD: Record = Record {
+    instance: 0,
+    category: "",
+    name: "",
+    start_ns: 0,
+    duration_ns: 0,
+};
+
+/// Single-producer (owning thread), single-consumer (drain) span ring.
+struct Ring {
+    records: Box<[UnsafeCell<Record>]>,
+    mask: usize,
+    /// Total spans written (producer).
+    head: AtomicUsize,
+    /// Total spans read (consumer).
+    tail: AtomicUsize,
+    dropped: AtomicU64,
+    /// Thread name bytes and length (0 = unnamed).
+    name: Mutex<ThreadName>,
+}
+
+// SAFETY: slots in `tail..head` are only read by the consumer and slots
+// outside it only written by the producer; the indices publish the slots
+// with release/acquire ordering.
+unsafe impl Sync for Ring {}
+
+impl Ring {
+    fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(1).next_power_of_two();
+        Self {
+            records: (0..capacity).map(|_| UnsafeCell::new(EMPTY_RECORD)).collect(),
+            mask: capacity - 1,
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+            dropped: AtomicU64::new(0),
+            name: Mutex::new(([0; MAX_THREAD_NAME_LEN], 0)),
+        }
+    }
+
+    /// Append a record (owning thread only).
+    fn push(&self, record: Record) {
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Acquire);
+        if head.wrapping_sub(tail) > self.mask {
+            self.dropped.fetch_add(1, Ordering::Relaxed);
+            return;
+        }
+        // SAFETY: the slot is outside `tail..head`, so the consumer is not reading it
+        unsafe { *self.records[head & self.mask].get() = record };
+        self.head.store(head.wrapping_add(1), Ordering::Release);
+    }
+
+    /// Move all published records into `out` (under the drain lock).
+    fn drain_into(&self, thread: u32, out: &mut Vec<TraceSpan>) {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let head = self.head.load(Ordering::Acquire);
+        let mut index = tail;
+        while index != head {
+            // SAFETY: the slot is inside `tail..head`, published by the producer
+            let record = unsafe { *self.records[index & self.mask].get() };
+            out.push(TraceSpan {
+                thread,
+                instance: record.instance,
+                category: record.category,
+                name: record.name,
+                start_ns: record.start_ns,
+                duration_ns: record.duration_ns,
+            });
+            index = index.wrapping_add(1);
+        }
+        self.tail.store(head, Ordering::Release);
+    }
+}
+
+struct Tracer {
+    epoch: Instant,
+    rings: Box<[Ring]>,
+    /// Rings claimed so far (may exceed the ring count).
+    claimed: AtomicUsize,
+    /// Spans from threads that found no free ring.
+    unclaimed_dropped: AtomicU64,
+    /// Serializes consumers.
+    drain_lock: Mutex<()>,
+}
+
+static TRACER: OnceLock<Tracer> = OnceLock::new();
+static ENABLED: AtomicBool = AtomicBool::new(false);
+static NEXT_INSTANCE: AtomicU32 = AtomicU32::new(1);
+
+/// Fixed-size thread name: bytes and length.
+type ThreadName = ([u8; MAX_THREAD_NAME_LEN], usize);
+
+/// Thread has not recorded yet.
+const SLOT_UNCLAIMED: usize = usize::MAX;
+/// All rings were taken when the thread first recorded.
+const SLOT_NONE: usize = usize::MAX - 1;
+
+thread_local! {
+    static SLOT: Cell<usize> = const { Cell::new(SLOT_UNCLAIMED) };
+    static INSTANCE: Cell<u32> = const { Cell::new(0) };
+    static THREAD_NAME: Cell<ThreadName> =
+        const { Cell::new(([0; MAX_THREAD_NAME_LEN], 0)) };
+}
+
+impl Tracer {
+    /// The calling thread's ring, claimed on first use.
+    fn ring(&self) -> Option<&Ring> {
+        let slot = SLOT.with(|slot| {
+            if slot.get() == SLOT_UNCLAIMED {
+                let index = self.claimed.fetch_add(1, Ordering::Relaxed);
+                slot.set(if index < self.rings.len() { index } else { SLOT_NONE });
+                if let Some(ring) = self.rings.get(index) {
+                    set_ring_name(ring, THREAD_NAME.with(Cell::get));
+                }
+            }
+            slot.get()
+        });
+        self.rings.get(slot)
+    }
+
+    fn now_ns(&self) -> u64 {
+        self.epoch.elapsed().as_nanos() as u64
+    }
+}
+
+fn set_ring_name(ring: &Ring, name: ThreadName) {
+    *ring.name.lock().unwrap_or_else(|e| e.into_inner()) = name;
+}
+
+// =============================================================================
+// Control
+// =============================================================================
+
+/// Start recording spans.
+///
+/// The first call allocates the rings; later calls re-enable recording and
+/// ignore `config`.
+pub fn enable(config: TraceConfig) {
+    TRACER.get_or_init(|| Tracer {
+        epoch: Instant::now(),
+        rings: (0..config.max_threads.max(1))
+            .map(|_| Ring::new(config.ring_capacity))
+            .collect(),
+        claimed: AtomicUsize::new(0),
+        unclaimed_dropped: AtomicU64::new(0),
+        drain_lock: Mutex::new(()),
+    });
+    ENABLED.store(true, Ordering::Release);
+}
+
+/// Stop recording spans. Recorded spans stay available to [`drain()`].
+pub fn disable() {
+    ENABLED.store(false, Ordering::Release);
+}
+
+/// Returns true if spans are being recorded.
+#[inline]
+pub fn is_enabled() -> bool {
+    ENABLED.load(Ordering::Relaxed)
+}
+
+#[inline]
+fn tracer() -> Option<&'static Tracer> {
+    if is_enabled() {
+        TRACER.get()
+    } else {
+        None
+    }
+}
+
+/// Current trace time in nanoseconds (0 while tracing was never enabled).
+pub fn now_ns() -> u64 {
+    TRACER.get().map_or(0, Tracer::now_ns)
+}
+
+/// Name the calling thread in exported traces.
+///
+/// May be called before tracing is enabled; the name is attached to the
+/// thread's ring when it records its first span.
+pub fn name_current_thread(name: &str) {
+    let mut len = name.len().min(MAX_THREAD_NAME_LEN);
+    while !name.is_char_boundary(len) {
+        len -= 1;
+    }
+    let mut bytes = [0; MAX_THREAD_NAME_LEN];
+    bytes[..len].copy_from_slice(&name.as_bytes()[..len]);
+    THREAD_NAME.with(|cell| cell.set((bytes, len)));
+
+    if let Some(tracer) = TRACER.get() {
+        if let Some(ring) = tracer.rings.get(SLOT.with(Cell::get)) {
+            set_ring_name(ring, (bytes, len));
+        }
+    }
+}
+
+// =============================================================================
+// Instances
+// =============================================================================
+
+/// Allocate a process-unique plugin instance ID for span tagging.
+pub fn next_instance_id() -> u32 {
+    NEXT_INSTANCE.fetch_add(1, Ordering::Relaxed)
+}
+
+/// Instance current on this thread (0 = none).
+#[inline]
+pub fn current_instance() -> u32 {
+    INSTANCE.with(Cell::get)
+}
+
+/// Make `instance` current on this thread until the guard drops.
+///
+/// Wrappers open a scope around each `process()` call so every span in it
+/// (including plugin spans) is attributed to the instance.
+#[inline]
+pub fn instance_scope(instance: u32) -> InstanceScope {
+    InstanceScope {
+        previous: INSTANCE.with(|current| current.replace(instance)),
+    }
+}
+
+/// Guard returned by [`instance_scope()`]; restores the previous instance.
+#[must_use = "the instance is only current while the guard is alive"]
+pub struct InstanceScope {
+    previous: u32,
+}
+
+impl Drop for InstanceScope {
+    #[inline]
+    fn drop(&mut self) {
+        INSTANCE.with(|current| current.set(self.previous));
+    }
+}
+
+// =============================================================================
+// Recording
+// =============================================================================
+
+/// Time a plugin DSP span ([`category::DSP`]) until the guard drops.
+#[inline]
+pub fn span(name: &'static str) -> Span {
+    span_in(category::DSP, name)
+}
+
+/// Time a span in `category` until the guard drops.
+#[inline]
+pub fn span_in(category: &'static str, name: &'static str) -> Span {
+    Span {
+        category,
+        name,
+        start_ns: tracer().map(Tracer::now_ns),
+    }
+}
+
+/// Guard returned by [`span()`] and [`span_in()`]; records the span on drop.
+///
+/// Inert if tracing was disabled when it was created.
+#[must_use = "the span ends when the guard drops"]
+pub struct Span {
+    category: &'static str,
+    name: &'static str,
+    start_ns: Option<u64>,
+}
+
+impl Drop for Span {
+    #[inline]
+    fn drop(&mut self) {
+        if let Some(start_ns) = self.start_ns {
+            record(self.category, self.name, start_ns, now_ns());
+        }
+    }
+}
+
+/// Record a span with explicit [`now_ns()`] timestamps.
+pub fn record(category: &'static str, name: &'static str, start_ns: u64, end_ns: u64) {
+    let Some(tracer) = tracer() else {
+        return;
+    };
+    let Some(ring) = tracer.ring() else {
+        tracer.unclaimed_dropped.fetch_add(1, Ordering::Relaxed);
+        return;
+    };
+    ring.push(Record {
+        instance: current_instance(),
+        category,
+        name,
+        start_ns,
+        duration_ns: end_ns.saturating_sub(start_ns),
+    });
+}
+
+// =============================================================================
+// Export
+// =============================================================================
+
+/// Take every span recorded since the last drain (allocates; not for the audio thread).
+pub fn drain() -> TraceSnapshot {
+    let mut snapshot = TraceSnapshot::default();
+    let Some(tracer) = TRACER.get() else {
+        return snapshot;
+    };
+    let _lock = tracer.drain_lock.lock().unwrap_or_else(|e| e.into_inner());
+
+    let claimed = tracer.claimed.load(Ordering::Acquire).min(tracer.rings.len());
+    snapshot.dropped = tracer.unclaimed_dropped.load(Ordering::Relaxed);
+    for (index, ring) in tracer.rings[..claimed].iter().enumerate() {
+        ring.drain_into(index as u32, &mut snapshot.spans);
+        snapshot.dropped += ring.dropped.load(Ordering::Relaxed);
+        let (bytes, len) = *ring.name.lock().unwrap_or_else(|e| e.into_inner());
+        if len > 0 {
+            snapshot.threads.push((index as u32, String::from_utf8_lossy(&bytes[..len]).into_owned()));
+        }
+    }
+    snapshot
+}
+
+/// Drain all spans and write them to `path` as Chrome Trace Event JSON.
+///
+/// Returns the number of spans written.
+pub fn write_chrome_trace_file(path: impl AsRef<Path>) -> io::Result<usize> {
+    let snapshot = drain();
+    let mut out = BufWriter::new(File::create(path)?);
+    snapshot.write_chrome_json(&mut out)?;
+    out.flush()?;
+    Ok(snapshot.spans.len())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    // The tracer is process-wide: tests filter the spans they record by a
+    // unique name and run their recording on a dedicated thread.
+
+    fn spans_named(snapshot: &TraceSnapshot, name: &str) -> Vec<TraceSpan> {
+        snapshot.spans.iter().filter(|s| s.name == name).copied().collect()
+    }
+
+    #[test]
+    fn test_spans_nest_and_carry_instance() {
+        enable(TraceConfig::new());
+        let instance = next_instance_id();
+        std::thread::spawn(move || {
+            name_current_thread("nest-test");
+            {
+                let _scope = instance_scope(instance);
+                let _outer = span_in(category::WRAPPER, "nest-outer");
+                let _inner = span("nest-inner");
+            }
+            // Instance restored once the scope ends
+            assert_eq!(current_instance(), 0);
+        })
+        .join()
+        .unwrap();
+
+        let snapshot = drain();
+        let outer = spans_named(&snapshot, "nest-outer");
+        let inner = spans_named(&snapshot, "nest-inner");
+        assert_eq!((outer.len(), inner.len()), (1, 1));
+        let (outer, inner) = (outer[0], inner[0]);
+        assert_eq!(outer.category, category::WRAPPER);
+        assert_eq!(inner.category, category::DSP);
+        assert_eq!((outer.instance, inner.instance), (instance, instance));
+        assert_eq!(outer.thread, inner.thread);
+        assert!(inner.start_ns >= outer.start_ns);
+        assert!(inner.start_ns + inner.duration_ns <= outer.start_ns + outer.duration_ns);
+        assert!(snapshot.threads.contains(&(outer.thread, "nest-test".to_string())));
+    }
+
+    #[test]
+    fn test_full_ring_drops_new_spans() {
+        let ring = Ring::new(3);
+        for start_ns in 0..6 {
+            ring.push(Record {
+                start_ns,
+                ..EMPTY_RECORD
+            });
+        }
+        let mut spans = Vec::new();
+        ring.drain_into(7, &mut spans);
+        let starts: Vec<u64> = spans.iter().map(|s| s.start_ns).collect();
+        assert_eq!(starts, [0, 1, 2, 3]);
+        assert!(spans.iter().all(|s| s.thread == 7));
+        assert_eq!(ring.dropped.load(Ordering::Relaxed), 2);
+
+        // Space is reusable after a drain
+        ring.push(Record {
+            start_ns: 9,
+            ..EMPTY_RECORD
+        });
+        spans.clear();
+        ring.drain_into(7, &mut spans);
+        assert_eq!(spans.len(), 1);
+        assert_eq!(spans[0].start_ns, 9);
+    }
+
+    #[test]
+    fn test_chrome_json() {
+        let snapshot = TraceSnapshot {
+            spans: vec![TraceSpan {
+                thread: 2,
+                instance: 5,
+                category: category::MIDI,
+                name: "say \"hi\"",
+                start_ns: 1_234_567,
+                duration_ns: 89,
+            }],
+            threads: vec![(2, "audio".into())],
+            dropped: 0,
+        };
+        let mut json = Vec::new();
+        snapshot.write_chrome_json(&mut json).unwrap();
+        let json = String::from_utf8(json).unwrap();
+        assert_eq!(
+            json,
+            "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\
+             {\"ph\":\"M\",\"pid\":1,\"tid\":2,\"name\":\"thread_name\",\"args\":{\"name\":\"audio\"}},\
+             {\"ph\":\"X\",\"pid\":1,\"tid\":2,\"cat\":\"midi\",\"name\":\"say \\\"hi\\\"\",\"ts\":1234.567,\"dur\":0.089,\"args\":{\"instance\":5}}\
+             ]}\n"
+        );
+    }
+}
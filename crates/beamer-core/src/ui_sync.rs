@@ -0,0 +1,641 @@
+//! Frame-coalesced parameter and meter sync for editor UIs.
+//!
+//! Automation playback can change parameters thousands of times per second,
+//! and meters update every audio block. Sending one IPC message per change
+//! would flood a WebView. This module batches changes instead:
+//!
+//! - [`UiSyncWriter`] marks parameters dirty and updates meters from any
+//!   thread, including the audio thread. Lock-free and allocation-free.
+//! - [`UiSyncEmitter`] runs on the UI side. [`poll()`](UiSyncEmitter::poll)
+//!   collects everything that changed since the last frame into one
+//!   [`UiDiff`], at most once per frame interval and only while the UI keeps
+//!   up with acknowledgements.
+//! - [`UiDiff`] encodes as compact JSON (the `sync` event of the IPC
+//!   protocol) or binary.
+//!
+//! Nothing here depends on a GUI: the emitter takes the current time as an
+//! argument, so tests can drive it with a mock consumer and synthetic clock.
+//!
+//! # Example
+//!
+//! ```ignore
+//! // Setup
+//! let (writer, mut emitter) = UiSync::pair(&parameters, NUM_METERS, UiSyncConfig::new());
+//!
+//! // Host thread, in setParamNormalized(); audio thread, per block
+//! writer.mark_parameter(id);
+//! writer.set_meter(0, output_peak);
+//!
+//! // UI timer
+//! if emitter.poll(Instant::now(), &parameters, &mut diff) {
+//!     json.clear();
+//!     diff.write_json(&mut json);
+//!     webview.emit(&json);
+//! }
+//!
+//! // When the UI reports it applied frame `seq`
+//! emitter.ack(seq);
+//! ```
+//!
+//! # Coalescing
+//!
+//! - Parameters: a dirty bit per parameter. The diff carries the value at
+//!   poll time, so any number of changes between frames costs one entry.
+//!   Values equal to the last sent value are skipped.
+//! - Meters: each slot holds the peak since the last frame (values are
+//!   treated as non-negative magnitudes). Unchanged slots are skipped.
+//!
+//! # Backpressure
+//!
+//! Each diff carries a sequence number. When `max_frames_in_flight` frames
+//! are unacknowledged, `poll()` emits nothing and changes keep accumulating,
+//! so a slow UI receives fewer, larger frames instead of a growing backlog.
+
+use std::fmt::Write as _;
+use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+
+use crate::parameter_store::ParameterStore;
+use crate::types::{ParameterId, ParameterValue};
+
+// =============================================================================
+// Configuration
+// =============================================================================
+
+/// UI sync configuration.
+///
+/// Built with const `with_*` methods, so it can live in a `static`.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct UiSyncConfig {
+    /// Maximum diffs per second.
+    pub max_frame_rate: f64,
+    /// Unacknowledged diffs allowed before `poll()` holds back.
+    pub max_frames_in_flight: u32,
+}
+
+impl UiSyncConfig {
+    /// Default configuration: 60 frames per second, 2 frames in flight.
+    pub const fn new() -> Self {
+        Self {
+            max_frame_rate: 60.0,
+            max_frames_in_flight: 2,
+        }
+    }
+
+    /// Set the frame rate cap.
+    pub const fn with_max_frame_rate(mut self, fps: f64) -> Self {
+        self.max_frame_rate = fps;
+        self
+    }
+
+    /// Set the number of unacknowledged frames allowed.
+    pub const fn with_max_frames_in_flight(mut self, frames: u32) -> Self {
+        self.max_frames_in_flight = frames;
+        self
+    }
+
+    /// Minimum time between two diffs.
+    #[inline]
+    pub fn frame_interval(&self) -> Duration {
+        if self.max_frame_rate > 0.0 {
+            Duration::from_secs_f64(1.0 / self.max_frame_rate)
+        } else {
+            Duration::ZERO
+        }
+    }
+}
+
+impl Default for UiSyncConfig {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+// =============================================================================
+// Shared State
+// =============================================================================
+
+struct Shared {
+    /// Parameter IDs sorted ascending, with their index in the store.
+    lookup: Box<[(ParameterId, u32)]>,
+    /// Dirty bit per parameter index.
+    dirty: Box<[AtomicU64]>,
+    /// Peak per meter slot since the last frame, as `f32` bits.
+    meters: Box<[AtomicU32]>,
+}
+
+impl Shared {
+    #[inline]
+    fn mark_index(&self, index: usize) {
+        self.dirty[index / 64].fetch_or(1 << (index % 64), Ordering::Release);
+    }
+}
+
+// =============================================================================
+// UiSync
+// =============================================================================
+
+/// Entry point that creates a connected writer/emitter pair.
+pub struct UiSync;
+
+impl UiSync {
+    /// Create a sync layer for every parameter in `parameters` plus
+    /// `num_meters` meter slots.
+    ///
+    /// All parameters start dirty so the first diff is a full snapshot.
+    /// Allocates; call from the setup thread.
+    pub fn pair<P: ParameterStore + ?Sized>(
+        parameters: &P,
+        num_meters: usize,
+        config: UiSyncConfig,
+    ) -> (UiSyncWriter, UiSyncEmitter) {
+        let ids: Vec<ParameterId> = (0..parameters.count())
+            .filter_map(|i| parameters.info(i).map(|info| info.id))
+            .collect();
+        let mut lookup: Vec<(ParameterId, u32)> =
+            ids.iter().enumerate().map(|(i, &id)| (id, i as u32)).collect();
+        lookup.sort_unstable_by_key(|&(id, _)| id);
+
+        let shared = Arc::new(Shared {
+            lookup: lookup.into_boxed_slice(),
+            dirty: (0..ids.len().div_ceil(64)).map(|_| AtomicU64::new(0)).collect(),
+            meters: (0..num_meters).map(|_| AtomicU32::new(0)).collect(),
+        });
+        let writer = UiSyncWriter {
+            shared: Arc::clone(&shared),
+        };
+        writer.mark_all();
+
+        let emitter = UiSyncEmitter {
+            shared,
+            last_values: vec![f64::NAN; ids.len()],
+            last_meters: vec![f32::NAN; num_meters],
+            ids,
+            config,
+            last_frame: None,
+            sequence: 0,
+            acked: 0,
+            frames_held: 0,
+        };
+        (writer, emitter)
+    }
+}
+
+// =============================================================================
+// UiSyncWriter
+// =============================================================================
+
+/// Change-reporting side of the sync layer. Cheap to clone; every method
+/// is lock-free and safe on the audio thread.
+#[derive(Clone)]
+pub struct UiSyncWriter {
+    shared: Arc<Shared>,
+}
+
+impl UiSyncWriter {
+    /// Mark a parameter as changed. Unknown IDs are ignored.
+    ///
+    /// `O(log n)` lookup, no allocation.
+    #[inline]
+    pub fn mark_parameter(&self, id: ParameterId) {
+        if let Ok(pos) = self.shared.lookup.binary_search_by_key(&id, |&(id, _)| id) {
+            self.shared.mark_index(self.shared.lookup[pos].1 as usize);
+        }
+    }
+
+    /// Mark every parameter as changed (e.g. after loading state).
+    pub fn mark_all(&self) {
+        let count = self.shared.lookup.len();
+        for (word, bits) in self.shared.dirty.iter().enumerate() {
+            let remaining = count - word * 64;
+            let mask = if remaining >= 64 { u64::MAX } else { (1 << remaining) - 1 };
+            bits.fetch_or(mask, Ordering::Release);
+        }
+    }
+
+    /// Report a meter value. The frame carries the peak since the last frame.
+    ///
+    /// Values are magnitudes: negative values and NaN count as zero.
+    /// Out-of-range slots are ignored.
+    #[inline]
+    pub fn set_meter(&self, slot: usize, value: f32) {
+        if let Some(meter) = self.shared.meters.get(slot) {
+            // For non-negative floats, bit patterns order like the values,
+            // so an integer max is a float max.
+            let value = if value > 0.0 { value } else { 0.0 };
+            meter.fetch_max(value.to_bits(), Ordering::Relaxed);
+        }
+    }
+
+    /// Number of meter slots.
+    #[inline]
+    pub fn num_meters(&self) -> usize {
+        self.shared.meters.len()
+    }
+}
+
+// =============================================================================
+// UiSyncEmitter
+// =============================================================================
+
+/// UI side of the sync layer: turns accumulated changes into diffs.
+pub struct UiSyncEmitter {
+    shared: Arc<Shared>,
+    /// Parameter ID per store index.
+    ids: Vec<ParameterId>,
+    last_values: Vec<ParameterValue>,
+    last_meters: Vec<f32>,
+    config: UiSyncConfig,
+    last_frame: Option<Instant>,
+    sequence: u64,
+    acked: u64,
+    frames_held: u64,
+}
+
+impl UiSyncEmitter {
+    /// Get the configuration.
+    #[inline]
+    pub fn config(&self) -> &UiSyncConfig {
+        &self.config
+    }
+
+    /// Sequence number of the last emitted diff (0 before the first).
+    #[inline]
+    pub fn sequence(&self) -> u64 {
+        self.sequence
+    }
+
+    /// Diffs emitted but not yet acknowledged.
+    #[inline]
+    pub fn frames_in_flight(&self) -> u64 {
+        self.sequence - self.acked
+    }
+
+    /// Number of polls held back by backpressure.
+    #[inline]
+    pub fn frames_held(&self) -> u64 {
+        self.frames_held
+    }
+
+    /// Acknowledge every diff up to and including `sequence`.
+    pub fn ack(&mut self, sequence: u64) {
+        self.acked = self.acked.max(sequence.min(self.sequence));
+    }
+
+    /// Forget what the UI has seen and send everything on the next frame.
+    ///
+    /// Use when the editor (re)opens. Also clears in-flight frames, since a
+    /// new UI won't acknowledge the old ones.
+    pub fn request_full_sync(&mut self) {
+        self.last_values.fill(f64::NAN);
+        self.last_meters.fill(f32::NAN);
+        self.acked = self.sequence;
+        UiSyncWriter {
+            shared: Arc::clone(&self.shared),
+        }
+        .mark_all();
+    }
+
+    /// Collect changes into `diff` if a frame is due.
+    ///
+    /// Returns `false` (leaving changes pending) when called before the frame
+    /// interval has elapsed, while too many frames are unacknowledged, or
+    /// when nothing changed. `diff` is cleared and refilled, reusing its
+    /// allocations.
+    pub fn poll<P: ParameterStore + ?Sized>(
+        &mut self,
+        now: Instant,
+        parameters: &P,
+        diff: &mut UiDiff,
+    ) -> bool {
+        if let Some(last) = self.last_frame {
+            if now.saturating_duration_since(last) < self.config.frame_interval() {
+                return false;
+            }
+        }
+        if self.frames_in_flight() >= self.config.max_frames_in_flight as u64 {
+            self.frames_held += 1;
+            return false;
+        }
+
+        diff.clear();
+        for (word, bits) in self.shared.dirty.iter().enumerate() {
+            let mut set = bits.swap(0, Ordering::Acquire);
+            while set != 0 {
+                let index = word * 64 + set.trailing_zeros() as usize;
+                set &= set - 1;
+                let id = self.ids[index];
+                let value = parameters.get_normalized(id);
+                if value.to_bits() != self.last_values[index].to_bits() {
+                    self.last_values[index] = value;
+                    diff.parameters.push((id, value));
+                }
+            }
+        }
+        for (slot, meter) in self.shared.meters.iter().enumerate() {
+            let value = f32::from_bits(meter.swap(0, Ordering::Relaxed));
+            if value.to_bits() != self.last_meters[slot].to_bits() {
+                self.last_meters[slot] = value;
+                diff.meters.push((slot as u32, value));
+            }
+        }
+
+        if diff.is_empty() {
+            return false;
+        }
+        self.sequence += 1;
+        diff.sequence = self.sequence;
+        self.last_frame = Some(now);
+        true
+    }
+}
+
+// =============================================================================
+// UiDiff
+// =============================================================================
+
+/// Changes since the previous frame.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct UiDiff {
+    /// Frame sequence number, starting at 1. Pass to [`UiSyncEmitter::ack()`].
+    pub sequence: u64,
+    /// Changed parameters as `(id, normalized value)`, in store order.
+    pub parameters: Vec<(ParameterId, ParameterValue)>,
+    /// Changed meters as `(slot, peak since last frame)`.
+    pub meters: Vec<(u32, f32)>,
+}
+
+impl UiDiff {
+    /// Create an empty diff.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Clear all entries, keeping allocations.
+    pub fn clear(&mut self) {
+        self.sequence = 0;
+        self.parameters.clear();
+        self.meters.clear();
+    }
+
+    /// Whether the diff has no entries.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.parameters.is_empty() && self.meters.is_empty()
+    }
+
+    /// Append the diff as a `sync` IPC event:
+    ///
+    /// ```json
+    /// {"event":"sync","data":{"seq":7,"params":[[1234,0.75]],"meters":[[0,0.5]]}}
+    /// ```
+    pub fn write_json(&self, out: &mut String) {
+        fn number(out: &mut String, value: f64) {
+            if value.is_finite() {
+                let _ = write!(out, "{}", value);
+            } else {
+                out.push_str("null");
+            }
+        }
+
+        let _ = write!(out, "{{\"event\":\"sync\",\"data\":{{\"seq\":{},\"params\":[", self.sequence);
+        for (i, &(id, value)) in self.parameters.iter().enumerate() {
+            if i > 0 {
+                out.push(',');
+            }
+            let _ = write!(out, "[{},", id);
+            number(out, value);
+            out.push(']');
+        }
+        out.push_str("],\"meters\":[");
+        for (i, &(slot, value)) in self.meters.iter().enumerate() {
+            if i > 0 {
+                out.push(',');
+            }
+            let _ = write!(out, "[{},", slot);
+            number(out, value as f64);
+            out.push(']');
+        }
+        out.push_str("]}}");
+    }
+
+    /// Append the diff in binary form (all little-endian):
+    ///
+    /// ```text
+    /// seq: u64, param_count: u32, meter_count: u32,
+    /// param_count x (id: u32, value: f64),
+    /// meter_count x (slot: u32, value: f32)
+    /// ```
+    pub fn write_binary(&self, out: &mut Vec<u8>) {
+        out.reserve(16 + self.parameters.len() * 12 + self.meters.len() * 8);
+        out.extend_from_slice(&self.sequence.to_le_bytes());
+        out.extend_from_slice(&(self.parameters.len() as u32).to_le_bytes());
+        out.extend_from_slice(&(self.meters.len() as u32).to_le_bytes());
+        for &(id, value) in &self.parameters {
+            out.extend_from_slice(&id.to_le_bytes());
+            out.extend_from_slice(&value.to_le_bytes());
+        }
+        for &(slot, value) in &self.meters {
+            out.extend_from_slice(&slot.to_le_bytes());
+            out.extend_from_slice(&value.to_le_bytes());
+        }
+    }
+
+    /// Parse the format written by [`write_binary()`](Self::write_binary).
+    ///
+    /// Returns `None` if the data is truncated or has trailing bytes.
+    pub fn read_binary(data: &[u8]) -> Option<Self> {
+        fn take<const N: usize>(data: &mut &[u8]) -> Option<[u8; N]> {
+            let (head, rest) = data.split_at_checked(N)?;
+            *data = rest;
+            head.try_into().ok()
+        }
+
+        let mut data = data;
+        let sequence = u64::from_le_bytes(take(&mut data)?);
+        let param_count = u32::from_le_bytes(take(&mut data)?) as usize;
+        let meter_count = u32::from_le_bytes(take(&mut data)?) as usize;
+        if data.len() != param_count * 12 + meter_count * 8 {
+            return None;
+        }
+        let mut diff = Self {
+            sequence,
+            parameters: Vec::with_capacity(param_count),
+            meters: Vec::with_capacity(meter_count),
+        };
+        for _ in 0..param_count {
+            let id = u32::from_le_bytes(take(&mut data)?);
+            let value = f64::from_le_bytes(take(&mut data)?);
+            diff.parameters.push((id, value));
+        }
+        for _ in 0..meter_count {
+            let slot = u32::from_le_bytes(take(&mut data)?);
+            let value = f32::from_le_bytes(take(&mut data)?);
+            diff.meters.push((slot, value));
+        }
+        Some(diff)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::parameter_info::ParameterInfo;
+    use std::sync::atomic::AtomicU64;
+
+    /// Minimal store: `count` parameters with IDs `100 + index`.
+    struct Store {
+        infos: Vec<ParameterInfo>,
+        values: Vec<AtomicU64>,
+    }
+
+    impl Store {
+        fn new(count: u32) -> Self {
+            Self {
+                infos: (0..count).map(|i| ParameterInfo::new(100 + i, "P")).collect(),
+                values: (0..count).map(|_| AtomicU64::new(0)).collect(),
+            }
+        }
+    }
+
+    impl ParameterStore for Store {
+        fn count(&self) -> usize {
+            self.infos.len()
+        }
+        fn info(&self, index: usize) -> Option<&ParameterInfo> {
+            self.infos.get(index)
+        }
+        fn get_normalized(&self, id: ParameterId) -> ParameterValue {
+            f64::from_bits(self.values[(id - 100) as usize].load(Ordering::Relaxed))
+        }
+        fn set_normalized(&self, id: ParameterId, value: ParameterValue) {
+            self.values[(id - 100) as usize].store(value.to_bits(), Ordering::Relaxed);
+        }
+        fn normalized_to_string(&self, _id: ParameterId, normalized: ParameterValue) -> String {
+            normalized.to_string()
+        }
+        fn string_to_normalized(&self, _id: ParameterId, string: &str) -> Option<ParameterValue> {
+            string.parse().ok()
+        }
+        fn normalized_to_plain(&self, _id: ParameterId, normalized: ParameterValue) -> ParameterValue {
+            normalized
+        }
+        fn plain_to_normalized(&self, _id: ParameterId, plain: ParameterValue) -> ParameterValue {
+            plain
+        }
+    }
+
+    /// Mock UI: applies diffs to its own copy of the state.
+    #[derive(Default)]
+    struct MockUi {
+        params: std::collections::HashMap<ParameterId, f64>,
+        meters: std::collections::HashMap<u32, f32>,
+        frames: u32,
+    }
+
+    impl MockUi {
+        fn receive(&mut self, bytes: &[u8]) -> u64 {
+            let diff = UiDiff::read_binary(bytes).unwrap();
+            self.params.extend(diff.parameters.iter().copied());
+            self.meters.extend(diff.meters.iter().copied());
+            self.frames += 1;
+            diff.sequence
+        }
+    }
+
+    const FRAME: Duration = Duration::from_millis(10);
+
+    #[test]
+    fn test_automation_burst_coalesces_to_one_frame() {
+        let store = Store::new(70); // spans two dirty words
+        let config = UiSyncConfig::new().with_max_frame_rate(100.0);
+        let (writer, mut emitter) = UiSync::pair(&store, 2, config);
+        let (mut ui, mut diff, mut bytes) = (MockUi::default(), UiDiff::new(), Vec::new());
+        let t0 = Instant::now();
+
+        // First frame is a full snapshot
+        assert!(emitter.poll(t0, &store, &mut diff));
+        assert_eq!(diff.parameters.len(), 70);
+        diff.write_binary(&mut bytes);
+        emitter.ack(ui.receive(&bytes));
+
+        // 1000 automation points on one parameter, many meter updates
+        for i in 0..1000 {
+            store.set_normalized(169, i as f64 / 999.0);
+            writer.mark_parameter(169);
+            writer.set_meter(1, (i % 10) as f32 / 10.0);
+        }
+        writer.mark_parameter(9999); // unknown ID: ignored
+
+        // Rate cap: too early
+        assert!(!emitter.poll(t0 + FRAME / 2, &store, &mut diff));
+        assert!(emitter.poll(t0 + FRAME, &store, &mut diff));
+        assert_eq!(diff.parameters, vec![(169, 1.0)]);
+        assert_eq!(diff.meters, vec![(1, 0.9f32)]);
+
+        bytes.clear();
+        diff.write_binary(&mut bytes);
+        emitter.ack(ui.receive(&bytes));
+        assert_eq!((ui.frames, ui.params[&169], ui.meters[&1]), (2, 1.0, 0.9));
+
+        // No meter reports since: the meter falls to zero, then goes quiet
+        assert!(emitter.poll(t0 + FRAME * 2, &store, &mut diff));
+        assert_eq!((diff.parameters.len(), diff.meters.clone()), (0, vec![(1, 0.0)]));
+        emitter.ack(diff.sequence);
+        assert!(!emitter.poll(t0 + FRAME * 3, &store, &mut diff));
+    }
+
+    #[test]
+    fn test_backpressure_holds_and_coalesces() {
+        let store = Store::new(4);
+        let config = UiSyncConfig::new()
+            .with_max_frame_rate(0.0)
+            .with_max_frames_in_flight(1);
+        let (writer, mut emitter) = UiSync::pair(&store, 0, config);
+        let mut diff = UiDiff::new();
+        let now = Instant::now();
+
+        assert!(emitter.poll(now, &store, &mut diff));
+        assert_eq!(emitter.frames_in_flight(), 1);
+
+        // UI hasn't acknowledged: changes accumulate
+        for value in [0.1, 0.2, 0.3] {
+            store.set_normalized(101, value);
+            writer.mark_parameter(101);
+            assert!(!emitter.poll(now, &store, &mut diff));
+        }
+        assert_eq!(emitter.frames_held(), 3);
+
+        emitter.ack(diff.sequence);
+        assert!(emitter.poll(now, &store, &mut diff));
+        assert_eq!((diff.sequence, diff.parameters.clone()), (2, vec![(101, 0.3)]));
+
+        // A reopened editor gets a full snapshot without acking old frames
+        emitter.request_full_sync();
+        assert!(emitter.poll(now, &store, &mut diff));
+        assert_eq!(diff.parameters.len(), 4);
+    }
+
+    #[test]
+    fn test_encodings() {
+        let diff = UiDiff {
+            sequence: 7,
+            parameters: vec![(1234, 0.75), (5, f64::NAN)],
+            meters: vec![(0, 0.5)],
+        };
+        let mut json = String::new();
+        diff.write_json(&mut json);
+        assert_eq!(
+            json,
+            r#"{"event":"sync","data":{"seq":7,"params":[[1234,0.75],[5,null]],"meters":[[0,0.5]]}}"#
+        );
+
+        let mut bytes = Vec::new();
+        diff.write_binary(&mut bytes);
+        let decoded = UiDiff::read_binary(&bytes).unwrap();
+        assert_eq!((decoded.sequence, decoded.meters.clone()), (7, vec![(0, 0.5)]));
+        assert_eq!(decoded.parameters[0], (1234, 0.75));
+        assert!(UiDiff::read_binary(&bytes[..bytes.len() - 1]).is_none());
+    }
+}
@@ -0,0 +1,190 @@
+//! Reading and writing atom sequences in host memory.
+//!
+//! Both directions work in place on the port buffers: events are read as
+//! borrowed byte slices and written straight into the host's output
+//! sequence, so neither side allocates.
+
+use std::marker::PhantomData;
+use std::mem::size_of;
+
+use crate::sys::{atom_pad_size, LV2_Atom, LV2_Atom_Event, LV2_Atom_Sequence, LV2_Atom_Sequence_Body};
+
+// =============================================================================
+// Reading
+// =============================================================================
+
+/// One event of an input sequence.
+#[derive(Debug, Clone, Copy)]
+pub struct AtomEvent<'a> {
+    /// Time stamp in frames from the start of the block.
+    pub frames: i64,
+    /// Body type URID.
+    pub type_: u32,
+    /// Body bytes.
+    pub body: &'a [u8],
+}
+
+/// Iterator over the events of an atom sequence.
+pub struct SequenceIter<'a> {
+    ptr: *const u8,
+    end: *const u8,
+    _marker: PhantomData<&'a LV2_Atom_Sequence>,
+}
+
+impl<'a> SequenceIter<'a> {
+    /// Iterate a sequence the host connected to an input port.
+    ///
+    /// # Safety
+    ///
+    /// `sequence` must be null or point to a valid sequence of
+    /// `sequence.atom.size` body bytes that outlives `'a`.
+    pub unsafe fn new(sequence: *const LV2_Atom_Sequence) -> Self {
+        if sequence.is_null() {
+            return Self::empty();
+        }
+        let body_size = ((*sequence).atom.size as usize).saturating_sub(size_of::<LV2_Atom_Sequence_Body>());
+        let ptr = sequence.cast::<u8>().add(size_of::<LV2_Atom_Sequence>());
+        Self {
+            ptr,
+            end: ptr.add(body_size),
+            _marker: PhantomData,
+        }
+    }
+
+    fn empty() -> Self {
+        Self {
+            ptr: std::ptr::null(),
+            end: std::ptr::null(),
+            _marker: PhantomData,
+        }
+    }
+}
+
+impl<'a> Iterator for SequenceIter<'a> {
+    type Item = AtomEvent<'a>;
+
+    fn next(&mut self) -> Option<AtomEvent<'a>> {
+        let header = size_of::<LV2_Atom_Event>();
+        if (self.end as usize).saturating_sub(self.ptr as usize) < header {
+            return None;
+        }
+        // SAFETY: bounds checked against the sequence size; atom events are
+        // 64-bit aligned within the sequence
+        unsafe {
+            let event = &*self.ptr.cast::<LV2_Atom_Event>();
+            let size = event.body.size as usize;
+            let data = self.ptr.add(header);
+            if (self.end as usize).saturating_sub(data as usize) < size {
+                self.ptr = self.end;
+                return None;
+            }
+            self.ptr = self.ptr.add(header + atom_pad_size(event.body.size) as usize);
+            Some(AtomEvent {
+                frames: event.frames,
+                type_: event.body.type_,
+                body: std::slice::from_raw_parts(data, size),
+            })
+        }
+    }
+}
+
+/// Read a `u32` from an atom body at `offset`.
+#[inline]
+pub(crate) fn read_u32(bytes: &[u8], offset: usize) -> Option<u32> {
+    bytes.get(offset..offset + 4).map(|b| u32::from_ne_bytes([b[0], b[1], b[2], b[3]]))
+}
+
+/// Properties of an atom object body: `(object type, iterator over (key, value type, value bytes))`.
+///
+/// Returns `None` if the body is too short to be an object.
+pub fn object_properties(body: &[u8]) -> Option<(u32, PropertyIter<'_>)> {
+    let otype = read_u32(body, 4)?;
+    Some((otype, PropertyIter { bytes: body, offset: 8 }))
+}
+
+/// Iterator over the properties of an atom object.
+pub struct PropertyIter<'a> {
+    bytes: &'a [u8],
+    offset: usize,
+}
+
+impl<'a> Iterator for PropertyIter<'a> {
+    /// `(key URID, value type URID, value bytes)`
+    type Item = (u32, u32, &'a [u8]);
+
+    fn next(&mut self) -> Option<Self::Item> {
+        // key, context, value.size, value.type
+        let key = read_u32(self.bytes, self.offset)?;
+        let size = read_u32(self.bytes, self.offset + 8)?;
+        let type_ = read_u32(self.bytes, self.offset + 12)?;
+        let start = self.offset + 16;
+        let value = self.bytes.get(start..start + size as usize)?;
+        self.offset = start + atom_pad_size(size) as usize;
+        Some((key, type_, value))
+    }
+}
+
+// =============================================================================
+// Writing
+// =============================================================================
+
+/// Appends events to an output sequence in host memory.
+pub struct SequenceWriter<'a> {
+    sequence: *mut LV2_Atom_Sequence,
+    /// Body bytes available for events
+    capacity: usize,
+    /// Body bytes written (events only)
+    used: usize,
+    _marker: PhantomData<&'a mut LV2_Atom_Sequence>,
+}
+
+impl<'a> SequenceWriter<'a> {
+    /// Start writing a sequence into a host output port.
+    ///
+    /// The host passes the buffer capacity in `atom.size`; this resets the
+    /// sequence to empty (frame time stamps), as the port must be
+    /// initialized every `run()` even if nothing is written.
+    ///
+    /// # Safety
+    ///
+    /// `sequence` must point to a host buffer of `atom.size` bytes after the
+    /// atom header, valid for writes for `'a`.
+    pub unsafe fn new(sequence: *mut LV2_Atom_Sequence, sequence_type: u32) -> Self {
+        let capacity = ((*sequence).atom.size as usize).saturating_sub(size_of::<LV2_Atom_Sequence_Body>());
+        (*sequence).atom = LV2_Atom {
+            size: size_of::<LV2_Atom_Sequence_Body>() as u32,
+            type_: sequence_type,
+        };
+        (*sequence).body = LV2_Atom_Sequence_Body { unit: 0, pad: 0 };
+        Self {
+            sequence,
+            capacity,
+            used: 0,
+            _marker: PhantomData,
+        }
+    }
+
+    /// Append an event. Returns `false` (writing nothing) if it doesn't fit.
+    pub fn push(&mut self, frames: i64, type_: u32, body: &[u8]) -> bool {
+        let header = size_of::<LV2_Atom_Event>();
+        let total = header + atom_pad_size(body.len() as u32) as usize;
+        if self.used + total > self.capacity {
+            return false;
+        }
+        // SAFETY: capacity checked above; events start 64-bit aligned
+        unsafe {
+            let at = self.sequence.cast::<u8>().add(size_of::<LV2_Atom_Sequence>() + self.used);
+            at.cast::<LV2_Atom_Event>().write(LV2_Atom_Event {
+                frames,
+                body: LV2_Atom {
+                    size: body.len() as u32,
+                    type_,
+                },
+            });
+            std::ptr::copy_nonoverlapping(body.as_ptr(), at.add(header), body.len());
+            self.used += total;
+            (*self.sequence).atom.size = (size_of::<LV2_Atom_Sequence_Body>() + self.used) as u32;
+        }
+        true
+    }
+}
@@ -0,0 +1,61 @@
+//! LV2-specific plugin configuration.
+//!
+//! This module provides LV2-specific configuration that complements
+//! the shared [`beamer_core::PluginConfig`].
+
+use std::ffi::CStr;
+
+/// Default block length assumed when the host doesn't pass `bufsz:maxBlockLength`.
+pub const DEFAULT_MAX_BLOCK_LENGTH: usize = 4096;
+
+/// Default number of `patch:Set` automation points handled per `run()`.
+pub const DEFAULT_MAX_AUTOMATION_POINTS: usize = 512;
+
+/// LV2-specific plugin configuration.
+///
+/// This struct holds LV2-specific metadata. Use in combination with
+/// [`beamer_core::PluginConfig`] for complete plugin configuration.
+///
+/// # Example
+///
+/// ```ignore
+/// use beamer_core::PluginConfig;
+/// use beamer_lv2::Lv2Config;
+///
+/// pub static CONFIG: PluginConfig = PluginConfig::new("Beamer Gain")
+///     .with_vendor("Beamer Framework");
+///
+/// pub static LV2_CONFIG: Lv2Config = Lv2Config::new(c"https://beamer.rs/plugins/gain");
+///
+/// export_lv2!(CONFIG, LV2_CONFIG, GainPlugin);
+/// ```
+pub struct Lv2Config {
+    /// Plugin URI. Must be unique and stable: hosts store sessions by it.
+    pub uri: &'static CStr,
+
+    /// Number of `patch:Set` automation points handled per `run()`.
+    /// The wrapper splits the block at each point; points beyond this
+    /// are applied at the start of the block.
+    pub max_automation_points: usize,
+}
+
+impl Lv2Config {
+    /// Create a new LV2 configuration with default values.
+    pub const fn new(uri: &'static CStr) -> Self {
+        Self {
+            uri,
+            max_automation_points: DEFAULT_MAX_AUTOMATION_POINTS,
+        }
+    }
+
+    /// Set the number of automation points handled per `run()`.
+    pub const fn with_max_automation_points(mut self, points: usize) -> Self {
+        self.max_automation_points = points;
+        self
+    }
+
+    /// Plugin URI as UTF-8 (for TTL generation).
+    pub fn uri_str(&self) -> &'static str {
+        self.uri.to_str().unwrap_or("")
+    }
+}
@@ -0,0 +1,100 @@
+//! LV2 export macro and entry points.
+
+/// Generate the LV2 entry point for a plugin.
+///
+/// Emits `lv2_descriptor()`, which hosts call to discover the plugin, and
+/// three functions the bundler calls to generate the bundle's TTL files at
+/// build time from the same port layout the binary uses:
+///
+/// - `beamer_lv2_plugin_ttl()` → plugin data file
+/// - `beamer_lv2_manifest_ttl(binary, data_file)` → `manifest.ttl`
+/// - `beamer_lv2_free_ttl(ttl)` → frees a string returned by the above
+///
+/// # Example
+///
+/// ```rust,ignore
+/// use beamer_core::PluginConfig;
+/// use beamer_lv2::{export_lv2, Lv2Config};
+///
+/// // Shared plugin configuration
+/// static CONFIG: PluginConfig = PluginConfig::new("My Plugin")
+///     .with_vendor("My Company");
+///
+/// // LV2-specific configuration
+/// static LV2_CONFIG: Lv2Config = Lv2Config::new(c"https://example.com/plugins/my-plugin");
+///
+/// export_lv2!(CONFIG, LV2_CONFIG, MyPlugin);
+/// ```
+#[macro_export]
+macro_rules! export_lv2 {
+    ($config:expr, $lv2_config:expr, $plugin:ty) => {
+        // Plugin discovery (one plugin per binary: index 0)
+        #[no_mangle]
+        pub extern "C" fn lv2_descriptor(index: u32) -> *const $crate::sys::LV2_Descriptor {
+            static DESCRIPTOR: ::std::sync::OnceLock<$crate::Lv2Descriptor<$plugin>> = ::std::sync::OnceLock::new();
+
+            if index != 0 {
+                return ::std::ptr::null();
+            }
+            DESCRIPTOR
+                .get_or_init(|| $crate::Lv2Descriptor::<$plugin>::new(&$config, &$lv2_config))
+                .as_raw()
+        }
+
+        // TTL generation for the bundler
+        #[no_mangle]
+        pub extern "C" fn beamer_lv2_plugin_ttl() -> *mut ::std::ffi::c_char {
+            $crate::export::into_c_string($crate::ttl::plugin_ttl::<$plugin>(&$config, &$lv2_config))
+        }
+
+        #[no_mangle]
+        pub unsafe extern "C" fn beamer_lv2_manifest_ttl(
+            binary: *const ::std::ffi::c_char,
+            data_file: *const ::std::ffi::c_char,
+        ) -> *mut ::std::ffi::c_char {
+            let (Some(binary), Some(data_file)) = (
+                $crate::export::from_c_str(binary),
+                $crate::export::from_c_str(data_file),
+            ) else {
+                return ::std::ptr::null_mut();
+            };
+            $crate::export::into_c_string($crate::ttl::manifest_ttl(&$lv2_config, binary, data_file))
+        }
+
+        #[no_mangle]
+        pub unsafe extern "C" fn beamer_lv2_free_ttl(ttl: *mut ::std::ffi::c_char) {
+            $crate::export::free_c_string(ttl);
+        }
+    };
+}
+
+use std::ffi::{c_char, CStr, CString};
+
+/// Hand a generated string to C (null if it contains a NUL byte).
+#[doc(hidden)]
+pub fn into_c_string(s: String) -> *mut c_char {
+    CString::new(s).map_or(std::ptr::null_mut(), CString::into_raw)
+}
+
+/// Borrow a C string argument as UTF-8.
+///
+/// # Safety
+/// `s` must be null or a valid NUL-terminated string.
+#[doc(hidden)]
+pub unsafe fn from_c_str<'a>(s: *const c_char) -> Option<&'a str> {
+    if s.is_null() {
+        return None;
+    }
+    CStr::from_ptr(s).to_str().ok()
+}
+
+/// Free a string returned by [`into_c_string()`].
+///
+/// # Safety
+/// `s` must be null or come from `into_c_string()`, and not be freed twice.
+#[doc(hidden)]
+pub unsafe fn free_c_string(s: *mut c_char) {
+    if !s.is_null() {
+        drop(CString::from_raw(s));
+    }
+}
@@ -0,0 +1,723 @@
+//! Minimal in-process LV2 host for testing plugins without a real host.
+//!
+//! [`Lv2Host`] drives an instance through the C descriptor exactly like an
+//! LV2 host would: `urid:map` and `bufsz:maxBlockLength` features,
+//! `connect_port()` on host-owned buffers, atom sequences built in host
+//! memory, and `activate()`/`run()`/`deactivate()`/`cleanup()`. CI on Linux
+//! can test the wrapper end to end without Ardour, Carla or jalv installed.
+//!
+//! ```ignore
+//! let descriptor = Lv2Descriptor::<GainPlugin>::new(&CONFIG, &LV2_CONFIG);
+//! let mut host = Lv2Host::new(&descriptor, 48000.0, 512).unwrap();
+//! host.input(0).fill(1.0);
+//! host.automate(256, GAIN_ID, 0.5);
+//! host.run(512);
+//! assert_eq!(host.output(0)[300], 0.5);
+//! ```
+
+use std::cell::RefCell;
+use std::ffi::{c_char, c_void, CStr, CString};
+use std::marker::PhantomData;
+use std::mem::size_of;
+use std::ptr;
+
+use beamer_core::{ParameterId, ParameterStore, Plugin};
+
+use crate::atom::{SequenceIter, SequenceWriter};
+use crate::instance::{BuildConfig, Lv2Descriptor};
+use crate::ports::{parameter_symbol, PortKind, PortLayout};
+use crate::sys::*;
+use crate::time::TimePosition;
+
+/// Bytes of each atom port buffer.
+const ATOM_BUFFER_SIZE: usize = 64 * 1024;
+
+// =============================================================================
+// URID Map
+// =============================================================================
+
+/// Host-side URI table; URIDs are indices + 1.
+#[derive(Default)]
+struct UridTable {
+    uris: RefCell<Vec<CString>>,
+}
+
+impl UridTable {
+    fn map(&self, uri: &CStr) -> LV2_URID {
+        let mut uris = self.uris.borrow_mut();
+        let index = match uris.iter().position(|u| u.as_c_str() == uri) {
+            Some(index) => index,
+            None => {
+                uris.push(uri.to_owned());
+                uris.len() - 1
+            }
+        };
+        index as LV2_URID + 1
+    }
+}
+
+unsafe extern "C" fn map_uri(handle: *mut c_void, uri: *const c_char) -> LV2_URID {
+    if handle.is_null() || uri.is_null() {
+        return 0;
+    }
+    (*handle.cast::<UridTable>()).map(CStr::from_ptr(uri))
+}
+
+/// 64-bit aligned atom port buffer.
+struct AtomBuffer {
+    words: Vec<u64>,
+}
+
+impl AtomBuffer {
+    fn new() -> Self {
+        Self {
+            words: vec![0; ATOM_BUFFER_SIZE / 8],
+        }
+    }
+
+    fn as_sequence(&mut self) -> *mut LV2_Atom_Sequence {
+        self.words.as_mut_ptr().cast()
+    }
+
+    /// Mark the whole buffer as available (as hosts do for output ports
+    /// and before writing input ports).
+    fn reset_capacity(&mut self) {
+        let sequence = self.as_sequence();
+        // SAFETY: the buffer holds at least an atom header
+        unsafe { (*sequence).atom.size = (ATOM_BUFFER_SIZE - size_of::<LV2_Atom>()) as u32 };
+    }
+}
+
+/// Append an object property (`key`, value atom) to an object body.
+fn push_property(body: &mut Vec<u8>, key: LV2_URID, type_: LV2_URID, value: &[u8]) {
+    body.extend_from_slice(&key.to_ne_bytes());
+    body.extend_from_slice(&0u32.to_ne_bytes());
+    body.extend_from_slice(&(value.len() as u32).to_ne_bytes());
+    body.extend_from_slice(&type_.to_ne_bytes());
+    body.extend_from_slice(value);
+    body.resize(body.len() + (atom_pad_size(value.len() as u32) as usize - value.len()), 0);
+}
+
+// =============================================================================
+// Lv2Host
+// =============================================================================
+
+/// In-process LV2 host for one plugin instance.
+///
+/// Audio ports get `max_block_size` samples each. Events queued with
+/// [`midi()`](Self::midi), [`automate()`](Self::automate) and
+/// [`transport()`](Self::transport) go into the next [`run()`](Self::run)'s
+/// control sequence.
+pub struct Lv2Host<'a> {
+    descriptor: *const LV2_Descriptor,
+    handle: LV2_Handle,
+    ports: PortLayout,
+    plugin_uri: String,
+    // Boxed: the instance keeps pointers to the features
+    urids: Box<UridTable>,
+    _map: Box<LV2_URID_Map>,
+    _max_block_length: Box<i32>,
+    _options: Box<[LV2_Options_Option; 2]>,
+    _features: Box<[LV2_Feature; 2]>,
+    inputs: Vec<Vec<f32>>,
+    outputs: Vec<Vec<f32>>,
+    controls: Vec<f32>,
+    control: AtomBuffer,
+    notify: AtomBuffer,
+    /// Queued control events: (frame, type, body)
+    events: Vec<(i64, LV2_URID, Vec<u8>)>,
+    midi_output: Vec<(i64, Vec<u8>)>,
+    in_place: bool,
+    active: bool,
+    _descriptor: PhantomData<&'a ()>,
+}
+
+impl<'a> Lv2Host<'a> {
+    /// Instantiate and activate a plugin at `sample_rate`, with
+    /// `max_block_size` passed as `bufsz:maxBlockLength`.
+    ///
+    /// Parameter control ports start at their defaults. Returns `None` if
+    /// `instantiate()` fails.
+    #[allow(private_bounds)]
+    pub fn new<P: Plugin + 'static>(
+        descriptor: &'a Lv2Descriptor<P>,
+        sample_rate: f64,
+        max_block_size: usize,
+    ) -> Option<Self>
+    where
+        P::Config: BuildConfig,
+    {
+        let plugin = P::default();
+        let ports = PortLayout::from_plugin(&plugin);
+        let parameters = plugin.parameters();
+        let controls = ports
+            .ports()
+            .iter()
+            .filter_map(|port| match port.kind {
+                PortKind::Parameter { index, id } => {
+                    let default = parameters.info(index).map_or(0.0, |info| info.default_normalized);
+                    Some(parameters.normalized_to_plain(id, default) as f32)
+                }
+                _ => None,
+            })
+            .collect();
+
+        let urids = Box::new(UridTable::default());
+        let mut map = Box::new(LV2_URID_Map {
+            handle: (&*urids as *const UridTable).cast_mut().cast(),
+            map: Some(map_uri),
+        });
+        let max_block_length = Box::new(max_block_size as i32);
+        let options = Box::new([
+            LV2_Options_Option {
+                context: 0,
+                subject: 0,
+                key: urids.map(LV2_BUF_SIZE__maxBlockLength),
+                size: size_of::<i32>() as u32,
+                type_: urids.map(LV2_ATOM__Int),
+                value: (&*max_block_length as *const i32).cast(),
+            },
+            LV2_Options_Option {
+                context: 0,
+                subject: 0,
+                key: 0,
+                size: 0,
+                type_: 0,
+                value: ptr::null(),
+            },
+        ]);
+        let features = Box::new([
+            LV2_Feature {
+                URI: LV2_URID__map.as_ptr(),
+                data: (&mut *map as *mut LV2_URID_Map).cast(),
+            },
+            LV2_Feature {
+                URI: LV2_OPTIONS__options.as_ptr(),
+                data: options.as_ptr().cast_mut().cast(),
+            },
+        ]);
+        let feature_list = [&features[0] as *const LV2_Feature, &features[1], ptr::null()];
+
+        let raw = descriptor.as_raw();
+        // SAFETY: the descriptor's functions are the wrapper's; features
+        // outlive the instance (owned by the host)
+        let handle = unsafe {
+            ((*raw).instantiate?)(raw, sample_rate, c".".as_ptr(), feature_list.as_ptr())
+        };
+        if handle.is_null() {
+            return None;
+        }
+
+        let mut host = Self {
+            descriptor: raw,
+            handle,
+            plugin_uri: descriptor.lv2_config().uri_str().to_string(),
+            urids,
+            _map: map,
+            _max_block_length: max_block_length,
+            _options: options,
+            _features: features,
+            inputs: vec![vec![0.0; max_block_size]; ports.audio_input_count()],
+            outputs: vec![vec![0.0; max_block_size]; ports.audio_output_count()],
+            controls,
+            control: AtomBuffer::new(),
+            notify: AtomBuffer::new(),
+            events: Vec::new(),
+            midi_output: Vec::new(),
+            in_place: false,
+            active: false,
+            ports,
+            _descriptor: PhantomData,
+        };
+        host.connect_ports();
+        host.activate();
+        Some(host)
+    }
+
+    /// Port layout of the plugin.
+    #[inline]
+    pub fn ports(&self) -> &PortLayout {
+        &self.ports
+    }
+
+    /// Map a URI with the host's URID table.
+    pub fn map(&self, uri: &CStr) -> LV2_URID {
+        self.urids.map(uri)
+    }
+
+    /// Input channel buffer (flat over buses, main first).
+    pub fn input(&mut self, channel: usize) -> &mut [f32] {
+        &mut self.inputs[channel]
+    }
+
+    /// Output channel buffer (flat over buses, main first).
+    ///
+    /// In place, main outputs share their input's buffer.
+    pub fn output(&self, channel: usize) -> &[f32] {
+        let main = self.ports.input_channels()[0].min(self.ports.output_channels()[0]);
+        if self.in_place && channel < main {
+            &self.inputs[channel]
+        } else {
+            &self.outputs[channel]
+        }
+    }
+
+    /// Connect main outputs to their input's buffer, as in-place hosts do.
+    pub fn set_in_place(&mut self, in_place: bool) {
+        self.in_place = in_place;
+        self.connect_ports();
+    }
+
+    /// Set a parameter's control port (plain value), read on the next `run()`.
+    pub fn set_control(&mut self, id: ParameterId, plain: f32) {
+        let Some(port) = self.ports.parameter_port(id) else {
+            return;
+        };
+        let index = (port - self.ports.first_parameter_port()) as usize;
+        self.controls[index] = plain;
+    }
+
+    /// Queue a raw MIDI message at `frame`.
+    pub fn midi(&mut self, frame: i64, bytes: &[u8]) {
+        let type_ = self.map(LV2_MIDI__MidiEvent);
+        self.events.push((frame, type_, bytes.to_vec()));
+    }
+
+    /// Queue a `patch:Set` of a parameter (plain value) at `frame`.
+    pub fn automate(&mut self, frame: i64, id: ParameterId, plain: f32) {
+        let property = CString::new(format!("{}#{}", self.plugin_uri, parameter_symbol(id))).unwrap();
+        let mut body = Vec::new();
+        body.extend_from_slice(&0u32.to_ne_bytes());
+        body.extend_from_slice(&self.map(LV2_PATCH__Set).to_ne_bytes());
+        push_property(
+            &mut body,
+            self.map(LV2_PATCH__property),
+            self.map(LV2_ATOM__URID),
+            &self.map(&property).to_ne_bytes(),
+        );
+        push_property(&mut body, self.map(LV2_PATCH__value), self.map(LV2_ATOM__Float), &plain.to_ne_bytes());
+        let type_ = self.map(LV2_ATOM__Object);
+        self.events.push((frame, type_, body));
+    }
+
+    /// Queue a `time:Position` with the fields of `position` that are set.
+    pub fn transport(&mut self, frame: i64, position: &TimePosition) {
+        let long = self.map(LV2_ATOM__Long);
+        let float = self.map(LV2_ATOM__Float);
+        let int = self.map(LV2_ATOM__Int);
+        let mut body = Vec::new();
+        body.extend_from_slice(&0u32.to_ne_bytes());
+        body.extend_from_slice(&self.map(LV2_TIME__Position).to_ne_bytes());
+        if let Some(v) = position.frame {
+            push_property(&mut body, self.map(LV2_TIME__frame), long, &v.to_ne_bytes());
+        }
+        if let Some(v) = position.speed {
+            push_property(&mut body, self.map(LV2_TIME__speed), float, &(v as f32).to_ne_bytes());
+        }
+        if let Some(v) = position.beats_per_minute {
+            push_property(&mut body, self.map(LV2_TIME__beatsPerMinute), float, &(v as f32).to_ne_bytes());
+        }
+        if let Some(v) = position.beats_per_bar {
+            push_property(&mut body, self.map(LV2_TIME__beatsPerBar), float, &(v as f32).to_ne_bytes());
+        }
+        if let Some(v) = position.beat_unit {
+            push_property(&mut body, self.map(LV2_TIME__beatUnit), int, &v.to_ne_bytes());
+        }
+        if let Some(v) = position.bar {
+            push_property(&mut body, self.map(LV2_TIME__bar), long, &v.to_ne_bytes());
+        }
+        if let Some(v) = position.bar_beat {
+            push_property(&mut body, self.map(LV2_TIME__barBeat), float, &(v as f32).to_ne_bytes());
+        }
+        let type_ = self.map(LV2_ATOM__Object);
+        self.events.push((frame, type_, body));
+    }
+
+    /// Run one block of `sample_count` frames with the queued events.
+    pub fn run(&mut self, sample_count: usize) {
+        // Events in time order, as in a real sequence
+        self.events.sort_by_key(|&(frame, _, _)| frame);
+        let sequence_type = self.map(LV2_ATOM__Sequence);
+        self.control.reset_capacity();
+        // SAFETY: the control buffer is host memory of ATOM_BUFFER_SIZE bytes
+        let mut writer = unsafe { SequenceWriter::new(self.control.as_sequence(), sequence_type) };
+        for (frame, type_, body) in self.events.drain(..) {
+            assert!(writer.push(frame, type_, &body), "control sequence full");
+        }
+        self.notify.reset_capacity();
+
+        // SAFETY: all ports are connected to buffers of max_block_size frames
+        unsafe {
+            if let Some(run) = (*self.descriptor).run {
+                run(self.handle, sample_count as u32);
+            }
+        }
+
+        let midi_type = self.map(LV2_MIDI__MidiEvent);
+        self.midi_output.clear();
+        if self.ports.notify_port().is_some() {
+            // SAFETY: the plugin wrote a valid sequence into the notify buffer
+            for event in unsafe { SequenceIter::new(self.notify.as_sequence()) } {
+                if event.type_ == midi_type {
+                    self.midi_output.push((event.frames, event.body.to_vec()));
+                }
+            }
+        }
+    }
+
+    /// MIDI the plugin wrote to the notify port in the last `run()`.
+    pub fn midi_output(&self) -> &[(i64, Vec<u8>)] {
+        &self.midi_output
+    }
+
+    /// Call `activate()` (done by [`new()`](Self::new)).
+    pub fn activate(&mut self) {
+        if !self.active {
+            // SAFETY: valid handle from instantiate()
+            unsafe {
+                if let Some(activate) = (*self.descriptor).activate {
+                    activate(self.handle);
+                }
+            }
+            self.active = true;
+        }
+    }
+
+    /// Call `deactivate()` (done on drop).
+    pub fn deactivate(&mut self) {
+        if self.active {
+            // SAFETY: valid handle from instantiate()
+            unsafe {
+                if let Some(deactivate) = (*self.descriptor).deactivate {
+                    deactivate(self.handle);
+                }
+            }
+            self.active = false;
+        }
+    }
+
+    fn connect_ports(&mut self) {
+        let Some(connect) = (unsafe { (*self.descriptor).connect_port }) else {
+            return;
+        };
+        let input_count = self.inputs.len();
+        let main = self.ports.input_channels()[0].min(self.ports.output_channels()[0]);
+        let first_parameter = self.ports.first_parameter_port();
+        for port in self.ports.ports() {
+            let data: *mut c_void = match port.kind {
+                PortKind::AudioInput { .. } => self.inputs[port.index as usize].as_mut_ptr().cast(),
+                PortKind::AudioOutput { .. } => {
+                    let channel = port.index as usize - input_count;
+                    if self.in_place && channel < main {
+                        self.inputs[channel].as_mut_ptr().cast()
+                    } else {
+                        self.outputs[channel].as_mut_ptr().cast()
+                    }
+                }
+                PortKind::Control => self.control.as_sequence().cast(),
+                PortKind::Notify => self.notify.as_sequence().cast(),
+                PortKind::Parameter { .. } => {
+                    (&mut self.controls[(port.index - first_parameter) as usize] as *mut f32).cast()
+                }
+            };
+            // SAFETY: valid handle; buffers live as long as the host
+            unsafe { connect(self.handle, port.index, data) };
+        }
+    }
+}
+
+impl Drop for Lv2Host<'_> {
+    fn drop(&mut self) {
+        self.deactivate();
+        // SAFETY: valid handle from instantiate(), not used afterwards
+        unsafe {
+            if let Some(cleanup) = (*self.descriptor).cleanup {
+                cleanup(self.handle);
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    use beamer_core::{
+        AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, FloatParameter, GroupInfo, HasParameters, MidiBuffer, MidiEvent,
+        MidiEventKind, ParameterGroups, ParameterInfo, ParameterRef, ParameterValue, Parameters, PluginConfig,
+        ProcessCapabilities, ProcessContext,
+    };
+
+    use crate::config::Lv2Config;
+    use crate::ttl::plugin_ttl;
+
+    const GAIN: ParameterId = 7;
+
+    static CONFIG: PluginConfig = PluginConfig::new("LV2 Test").with_sub_categories("Fx|Dynamics");
+    static LV2_CONFIG: Lv2Config = Lv2Config::new(c"https://example.com/plugins/lv2-test").with_max_automation_points(4);
+
+    /// One linear gain parameter, 0-2, default 1.
+    struct TestParameters {
+        gain: FloatParameter,
+    }
+
+    impl Default for TestParameters {
+        fn default() -> Self {
+            Self {
+                gain: FloatParameter::new("Gain", 1.0, 0.0..=2.0).with_id(GAIN),
+            }
+        }
+    }
+
+    impl ParameterGroups for TestParameters {
+        fn group_count(&self) -> usize {
+            1
+        }
+
+        fn group_info(&self, index: usize) -> Option<GroupInfo> {
+            (index == 0).then(GroupInfo::root)
+        }
+    }
+
+    impl ParameterStore for TestParameters {
+        fn count(&self) -> usize {
+            1
+        }
+        fn info(&self, index: usize) -> Option<&ParameterInfo> {
+            (index == 0).then(|| self.gain.info())
+        }
+        fn get_normalized(&self, _id: ParameterId) -> ParameterValue {
+            self.gain.get_normalized()
+        }
+        fn set_normalized(&self, _id: ParameterId, value: ParameterValue) {
+            self.gain.set_normalized(value);
+        }
+        fn normalized_to_string(&self, _id: ParameterId, normalized: ParameterValue) -> String {
+            self.gain.display_normalized(normalized)
+        }
+        fn string_to_normalized(&self, _id: ParameterId, string: &str) -> Option<ParameterValue> {
+            self.gain.parse(string)
+        }
+        fn normalized_to_plain(&self, _id: ParameterId, normalized: ParameterValue) -> ParameterValue {
+            normalized * 2.0
+        }
+        fn plain_to_normalized(&self, _id: ParameterId, plain: ParameterValue) -> ParameterValue {
+            plain / 2.0
+        }
+    }
+
+    impl Parameters for TestParameters {
+        fn count(&self) -> usize {
+            1
+        }
+        fn iter(&self) -> Box<dyn Iterator<Item = &dyn ParameterRef> + '_> {
+            Box::new(std::iter::once(&self.gain as &dyn ParameterRef))
+        }
+        fn by_id(&self, id: ParameterId) -> Option<&dyn ParameterRef> {
+            (id == GAIN).then_some(&self.gain as &dyn ParameterRef)
+        }
+    }
+
+    /// Mono gain with MIDI echo transposed up an octave.
+    #[derive(Default)]
+    struct TestPlugin {
+        parameters: TestParameters,
+    }
+
+    struct TestProcessor {
+        parameters: TestParameters,
+    }
+
+    impl HasParameters for TestPlugin {
+        type Parameters = TestParameters;
+        fn parameters(&self) -> &TestParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut TestParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl HasParameters for TestProcessor {
+        type Parameters = TestParameters;
+        fn parameters(&self) -> &TestParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut TestParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl Plugin for TestPlugin {
+        type Config = AudioSetup;
+        type Processor = TestProcessor;
+
+        fn prepare(self, _config: AudioSetup) -> TestProcessor {
+            TestProcessor {
+                parameters: self.parameters,
+            }
+        }
+
+        fn input_bus_info(&self, index: usize) -> Option<beamer_core::BusInfo> {
+            (index == 0).then(|| beamer_core::BusInfo::mono("Input"))
+        }
+
+        fn output_bus_info(&self, index: usize) -> Option<beamer_core::BusInfo> {
+            (index == 0).then(|| beamer_core::BusInfo::mono("Output"))
+        }
+
+        fn wants_midi(&self) -> bool {
+            true
+        }
+    }
+
+    impl AudioProcessor for TestProcessor {
+        type Plugin = TestPlugin;
+
+        const CAPABILITIES: ProcessCapabilities =
+            ProcessCapabilities::AUDIO_ONLY.with_midi_input().with_midi_output();
+
+        fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, _context: &ProcessContext) {
+            let gain = self.parameters.gain.get() as f32;
+            for channel in buffer.in_place_channels() {
+                for sample in channel {
+                    *sample *= gain;
+                }
+            }
+        }
+
+        fn process_midi(&mut self, input: &[MidiEvent], output: &mut MidiBuffer) {
+            for event in input {
+                let mut event = event.clone();
+                if let MidiEventKind::NoteOn(note) = &mut event.event {
+                    note.pitch += 12;
+                }
+                output.push(event);
+            }
+        }
+
+        fn supports_in_place(&self) -> bool {
+            true
+        }
+
+        fn unprepare(self) -> TestPlugin {
+            TestPlugin {
+                parameters: self.parameters,
+            }
+        }
+    }
+
+    fn descriptor() -> Lv2Descriptor<TestPlugin> {
+        Lv2Descriptor::new(&CONFIG, &LV2_CONFIG)
+    }
+
+    #[test]
+    fn test_port_layout() {
+        let descriptor = descriptor();
+        let host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        let ports = host.ports();
+        assert_eq!((ports.audio_input_count(), ports.audio_output_count()), (1, 1));
+        assert_eq!(ports.control_port(), 2);
+        assert_eq!(ports.notify_port(), Some(3));
+        assert_eq!(ports.parameter_port(GAIN), Some(4));
+    }
+
+    #[test]
+    fn test_control_port_and_automation_split() {
+        let descriptor = descriptor();
+        let mut host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        host.input(0).fill(1.0);
+        host.run(64);
+        assert!(host.output(0).iter().all(|&s| s == 1.0));
+
+        // Control port: whole block
+        host.set_control(GAIN, 0.5);
+        host.input(0).fill(1.0);
+        host.run(64);
+        assert!(host.output(0).iter().all(|&s| s == 0.5));
+
+        // patch:Set at frame 16 and 40: sample-accurate
+        host.automate(16, GAIN, 2.0);
+        host.automate(40, GAIN, 0.0);
+        host.input(0).fill(1.0);
+        host.run(64);
+        let out = host.output(0);
+        assert!(out[..16].iter().all(|&s| s == 0.5));
+        assert!(out[16..40].iter().all(|&s| s == 2.0));
+        assert!(out[40..].iter().all(|&s| s == 0.0));
+    }
+
+    #[test]
+    fn test_automation_overflow() {
+        let descriptor = descriptor();
+        let mut host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        for (i, frame) in [8, 24, 32, 48].into_iter().enumerate() {
+            host.automate(frame, GAIN, i as f32 * 0.5);
+        }
+        // Beyond max_automation_points (4): applied at the block start
+        host.automate(56, GAIN, 2.0);
+        host.input(0).fill(1.0);
+        host.run(64);
+        let out = host.output(0);
+        assert!(out[..8].iter().all(|&s| s == 2.0));
+        assert!(out[8..24].iter().all(|&s| s == 0.0));
+        assert!(out[24..32].iter().all(|&s| s == 0.5));
+        assert!(out[48..].iter().all(|&s| s == 1.5));
+    }
+
+    #[test]
+    fn test_midi_through_atom_sequences() {
+        let descriptor = descriptor();
+        let mut host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        host.midi(5, &[0x90, 60, 100]);
+        host.automate(10, GAIN, 1.0);
+        host.midi(20, &[0x80, 60, 0]);
+        host.midi(30, &[0xF0, 0x7E, 0xF7]); // SysEx: dropped
+        host.run(64);
+
+        // Offsets survive the split at frame 10
+        assert_eq!(
+            host.midi_output(),
+            &[(5, vec![0x90, 72, 100]), (20, vec![0x80, 60, 0])]
+        );
+
+        // The notify sequence is reset every run
+        host.run(64);
+        assert!(host.midi_output().is_empty());
+    }
+
+    #[test]
+    fn test_in_place_ports() {
+        let descriptor = descriptor();
+        let mut host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        host.set_in_place(true);
+        host.set_control(GAIN, 0.5);
+        host.input(0).fill(1.0);
+        host.run(64);
+        assert!(host.output(0).iter().all(|&s| s == 0.5));
+    }
+
+    #[test]
+    fn test_reactivation() {
+        let descriptor = descriptor();
+        let mut host = Lv2Host::new(&descriptor, 48000.0, 64).unwrap();
+        host.deactivate();
+        host.activate();
+        host.input(0).fill(1.0);
+        host.run(64);
+        assert!(host.output(0).iter().all(|&s| s == 1.0));
+    }
+
+    #[test]
+    fn test_plugin_ttl() {
+        let ttl = plugin_ttl::<TestPlugin>(&CONFIG, &LV2_CONFIG);
+        assert!(ttl.contains("<https://example.com/plugins/lv2-test>\n    a lv2:Plugin, lv2:DynamicsPlugin ;"));
+        assert!(ttl.contains("doap:name \"LV2 Test\""));
+        assert!(ttl.contains("lv2:requiredFeature urid:map"));
+        assert!(ttl.contains("patch:writable <https://example.com/plugins/lv2-test#p7>"));
+        assert!(ttl.contains("lv2:index 4 ;\n        lv2:symbol \"p7\" ;\n        lv2:name \"Gain\" ;"));
+        assert!(ttl.contains("lv2:default 1.0 ;\n        lv2:minimum 0.0 ;\n        lv2:maximum 2.0"));
+        assert!(ttl.contains("atom:supports patch:Message, midi:MidiEvent ;"));
+        assert!(ttl.contains("lv2:symbol \"notify\""));
+    }
+}
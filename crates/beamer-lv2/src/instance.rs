@@ -0,0 +1,1075 @@
+//! Generic LV2 plugin instance wrapping any [`Plugin`] implementation.
+//!
+//! # Lifecycle
+//!
+//! LV2 passes the sample rate to `instantiate()`, so the plugin is prepared
+//! right away and the instance only ever holds the processor:
+//!
+//! ```text
+//! instantiate()   Plugin::default() → prepare(config) → processor
+//! activate()      resume() if hibernated, set_active(true)
+//! run(n)          control ports, control sequence, process_midi(), process()
+//! deactivate()    set_active(false), hibernate() (buffers released)
+//! cleanup()       processor dropped
+//! ```
+//!
+//! # Sample-Accurate Automation
+//!
+//! Control ports are read once per `run()`. `patch:Set` events in the
+//! control sequence carry a frame time, so the block is split at each one:
+//! `process_midi()` and `process()` run per segment with the parameter
+//! already changed, and MIDI offsets and [`MidiCcCurves`] windows rebased to
+//! the segment. Blocks longer than `bufsz:maxBlockLength` are split the same
+//! way, so scratch memory never needs to grow.
+//!
+//! # Real-Time Safety
+//!
+//! Port buffers are used in place: audio ports become `Buffer` and
+//! `AuxiliaryBuffers` slices without copying (only an input that aliases a
+//! different output is copied to preallocated scratch), and MIDI is read
+//! from and written to the atom sequences directly. Everything `run()`
+//! touches is allocated in `instantiate()` or `activate()`.
+
+use std::ffi::{c_char, c_void, CStr, CString};
+use std::marker::PhantomData;
+use std::ptr;
+use std::slice;
+use std::time::Instant;
+
+use beamer_core::{
+    controller, ArenaLayout, ArenaSlice, AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, BusLayout,
+    CcCurveMode, DeadlineMonitor, DspArena, FullAudioSetup, HasParameters, MemoryPolicy, MidiBuffer, MidiCcCurves,
+    MidiCcState, MidiEvent, MidiEventKind, MidiOutputFilter, NoConfig, ParameterId, ParameterStore, Parameters, Plugin, PluginConfig,
+    PrepareScope, ProcessContext, ProcessorConfig, ResidencyReport, Transport,
+};
+use beamer_core::trace::{self, category};
+use log::warn;
+
+use crate::atom::{object_properties, read_u32, SequenceIter, SequenceWriter};
+use crate::config::{Lv2Config, DEFAULT_MAX_BLOCK_LENGTH};
+use crate::midi::{midi_from_bytes, midi_to_bytes};
+use crate::ports::{parameter_symbol, PortKind, PortLayout};
+use crate::sys::*;
+use crate::time::TimePosition;
+
+// =============================================================================
+// Config Building
+// =============================================================================
+
+/// Internal trait for building plugin configs from the `instantiate()` setup.
+///
+/// This trait is `pub(crate)` to satisfy the bound in [`Lv2Descriptor<P>`]
+/// where `P::Config: BuildConfig`. All standard ProcessorConfig types
+/// (NoConfig, AudioSetup, FullAudioSetup) have built-in implementations.
+pub(crate) trait BuildConfig: ProcessorConfig {
+    fn build(sample_rate: f64, max_block_size: usize, bus_layout: &BusLayout) -> Self;
+}
+
+impl BuildConfig for NoConfig {
+    fn build(_sample_rate: f64, _max_block_size: usize, _bus_layout: &BusLayout) -> Self {
+        NoConfig
+    }
+}
+
+impl BuildConfig for AudioSetup {
+    fn build(sample_rate: f64, max_block_size: usize, _bus_layout: &BusLayout) -> Self {
+        AudioSetup {
+            sample_rate,
+            max_buffer_size: max_block_size,
+        }
+    }
+}
+
+impl BuildConfig for FullAudioSetup {
+    fn build(sample_rate: f64, max_block_size: usize, bus_layout: &BusLayout) -> Self {
+        FullAudioSetup {
+            sample_rate,
+            max_buffer_size: max_block_size,
+            layout: bus_layout.clone(),
+        }
+    }
+}
+
+// =============================================================================
+// Host Features
+// =============================================================================
+
+/// Find a host feature's data by URI.
+///
+/// # Safety
+/// `features` must be null or a null-terminated array of valid features.
+unsafe fn find_feature(features: *const *const LV2_Feature, uri: &CStr) -> Option<*mut c_void> {
+    if features.is_null() {
+        return None;
+    }
+    let mut cursor = features;
+    while !(*cursor).is_null() {
+        let feature = &**cursor;
+        if !feature.URI.is_null() && CStr::from_ptr(feature.URI) == uri {
+            return Some(feature.data);
+        }
+        cursor = cursor.add(1);
+    }
+    None
+}
+
+/// URIDs of every URI the wrapper compares against, mapped once in
+/// `instantiate()`.
+struct Urids {
+    atom_sequence: LV2_URID,
+    atom_object: LV2_URID,
+    atom_blank: LV2_URID,
+    atom_float: LV2_URID,
+    atom_double: LV2_URID,
+    atom_int: LV2_URID,
+    atom_long: LV2_URID,
+    atom_urid: LV2_URID,
+    midi_event: LV2_URID,
+    patch_set: LV2_URID,
+    patch_property: LV2_URID,
+    patch_value: LV2_URID,
+    time_position: LV2_URID,
+    time_frame: LV2_URID,
+    time_speed: LV2_URID,
+    time_beats_per_minute: LV2_URID,
+    time_beats_per_bar: LV2_URID,
+    time_beat_unit: LV2_URID,
+    time_bar: LV2_URID,
+    time_bar_beat: LV2_URID,
+    max_block_length: LV2_URID,
+}
+
+impl Urids {
+    fn new(map: &UridMap) -> Self {
+        Self {
+            atom_sequence: map.map(LV2_ATOM__Sequence),
+            atom_object: map.map(LV2_ATOM__Object),
+            atom_blank: map.map(LV2_ATOM__Blank),
+            atom_float: map.map(LV2_ATOM__Float),
+            atom_double: map.map(LV2_ATOM__Double),
+            atom_int: map.map(LV2_ATOM__Int),
+            atom_long: map.map(LV2_ATOM__Long),
+            atom_urid: map.map(LV2_ATOM__URID),
+            midi_event: map.map(LV2_MIDI__MidiEvent),
+            patch_set: map.map(LV2_PATCH__Set),
+            patch_property: map.map(LV2_PATCH__property),
+            patch_value: map.map(LV2_PATCH__value),
+            time_position: map.map(LV2_TIME__Position),
+            time_frame: map.map(LV2_TIME__frame),
+            time_speed: map.map(LV2_TIME__speed),
+            time_beats_per_minute: map.map(LV2_TIME__beatsPerMinute),
+            time_beats_per_bar: map.map(LV2_TIME__beatsPerBar),
+            time_beat_unit: map.map(LV2_TIME__beatUnit),
+            time_bar: map.map(LV2_TIME__bar),
+            time_bar_beat: map.map(LV2_TIME__barBeat),
+            max_block_length: map.map(LV2_BUF_SIZE__maxBlockLength),
+        }
+    }
+
+    /// Numeric value of a scalar atom (`atom:Float`, `Double`, `Int` or `Long`).
+    fn number(&self, type_: LV2_URID, bytes: &[u8]) -> Option<f64> {
+        let array = |n: usize| bytes.get(..n);
+        if type_ == self.atom_float {
+            array(4).map(|b| f32::from_ne_bytes(b.try_into().unwrap()) as f64)
+        } else if type_ == self.atom_double {
+            array(8).map(|b| f64::from_ne_bytes(b.try_into().unwrap()))
+        } else if type_ == self.atom_int {
+            array(4).map(|b| i32::from_ne_bytes(b.try_into().unwrap()) as f64)
+        } else if type_ == self.atom_long {
+            array(8).map(|b| i64::from_ne_bytes(b.try_into().unwrap()) as f64)
+        } else {
+            None
+        }
+    }
+
+    /// Whether an atom type is an object (`atom:Object` or the deprecated `atom:Blank`).
+    #[inline]
+    fn is_object(&self, type_: LV2_URID) -> bool {
+        type_ == self.atom_object || type_ == self.atom_blank
+    }
+}
+
+/// Safe wrapper around the host's `urid:map` feature.
+struct UridMap(*const LV2_URID_Map);
+
+impl UridMap {
+    fn map(&self, uri: &CStr) -> LV2_URID {
+        // SAFETY: the host keeps the feature valid for the instance's lifetime
+        unsafe { (*self.0).map.map_or(0, |map| map((*self.0).handle, uri.as_ptr())) }
+    }
+}
+
+/// `bufsz:maxBlockLength` from the host's `opts:options`, if passed.
+///
+/// # Safety
+/// `options` must be null or an options array terminated by a zero key.
+unsafe fn max_block_length(options: *const LV2_Options_Option, urids: &Urids) -> Option<usize> {
+    if options.is_null() {
+        return None;
+    }
+    let mut cursor = options;
+    while (*cursor).key != 0 {
+        let option = &*cursor;
+        if option.key == urids.max_block_length && !option.value.is_null() {
+            let bytes = slice::from_raw_parts(option.value.cast::<u8>(), option.size as usize);
+            return urids.number(option.type_, bytes).filter(|&n| n > 0.0).map(|n| n as usize);
+        }
+        cursor = cursor.add(1);
+    }
+    None
+}
+
+// =============================================================================
+// Per-Block State
+// =============================================================================
+
+/// A `patch:Set` on a parameter, applied at `frame`.
+#[derive(Debug, Clone, Copy)]
+struct AutomationPoint {
+    frame: u32,
+    id: ParameterId,
+    normalized: f64,
+}
+
+/// A MIDI CC emulation controller change, rendered into the curves.
+#[derive(Debug, Clone, Copy)]
+struct CcPoint {
+    frame: u32,
+    controller: u8,
+    normalized: f64,
+}
+
+/// A parameter control port.
+struct ParameterPort {
+    id: ParameterId,
+    /// Host value (plain units)
+    data: *const f32,
+    /// Last value applied (NaN: apply on the first `run()`)
+    last: f32,
+}
+
+/// Channel pointers for the current chunk and the scratch behind them.
+///
+/// Flat over all buses, main first, in port order.
+struct ChannelStorage {
+    /// Input pointers at the chunk start (null: in-place main channel)
+    inputs: Vec<*const f32>,
+    /// Output pointers at the chunk start
+    outputs: Vec<*mut f32>,
+    /// Copies of input channels that alias an output (one per input channel,
+    /// each `max_block_size` long, in one arena block)
+    alias_scratch: Vec<ArenaSlice<f32>>,
+}
+
+impl ChannelStorage {
+    fn new() -> Self {
+        Self {
+            inputs: Vec::new(),
+            outputs: Vec::new(),
+            alias_scratch: Vec::new(),
+        }
+    }
+
+    fn allocate(ports: &PortLayout, max_block_size: usize) -> Self {
+        let input_count = ports.audio_input_count();
+        let mut arena = DspArena::new(ArenaLayout::new().slices::<f32>(input_count, max_block_size));
+        Self {
+            inputs: vec![ptr::null(); input_count],
+            outputs: vec![ptr::null_mut(); ports.audio_output_count()],
+            alias_scratch: (0..input_count).map(|_| arena.alloc(max_block_size, 0.0)).collect(),
+        }
+    }
+
+    /// Point at `len` samples from `offset` of the host buffers, resolving
+    /// aliasing like the VST3 wrapper: a main input sharing memory with the
+    /// main output at the same index becomes in place (null) when the
+    /// processor supports it, and any other aliased input is copied to scratch.
+    ///
+    /// # Safety
+    /// Host pointers must be non-null and valid for `offset + len` samples;
+    /// `len` must not exceed the scratch length.
+    unsafe fn load(
+        &mut self,
+        host_inputs: &[*const f32],
+        host_outputs: &[*mut f32],
+        main_channels: usize,
+        offset: usize,
+        len: usize,
+        in_place: bool,
+    ) {
+        for (out, &host) in self.outputs.iter_mut().zip(host_outputs) {
+            *out = host.add(offset);
+        }
+        for (ch, (input, &host)) in self.inputs.iter_mut().zip(host_inputs).enumerate() {
+            let host = host.add(offset);
+            let aliases = |out: &*mut f32| ptr::eq(*out, host);
+            if in_place && ch < main_channels && self.outputs.get(ch).is_some_and(aliases) {
+                *input = ptr::null();
+            } else if self.outputs.iter().any(aliases) {
+                let copy = &mut self.alias_scratch[ch];
+                copy[..len].copy_from_slice(slice::from_raw_parts(host, len));
+                *input = copy.as_ptr();
+            } else {
+                *input = host;
+            }
+        }
+    }
+}
+
+// =============================================================================
+// Lv2Instance
+// =============================================================================
+
+/// Runtime state of one LV2 plugin instance.
+///
+/// Created by `instantiate()` through [`Lv2Descriptor`]; hosts only see the
+/// opaque handle. LV2 calls `run()` from one thread at a time and never
+/// concurrently with the other instance callbacks, so the instance uses
+/// plain `&mut self` access.
+pub struct Lv2Instance<P: Plugin> {
+    /// The prepared processor
+    processor: P::Processor,
+    /// Port indices shared with the TTL generator
+    ports: PortLayout,
+    urids: Urids,
+    sample_rate: f64,
+    /// Longest chunk passed to `process()` (`bufsz:maxBlockLength`)
+    max_block_size: usize,
+    /// Pre-faulting/locking applied to memory allocated in `instantiate()`/`activate()`
+    memory_policy: MemoryPolicy,
+    /// Host audio buffers, flat over buses (main first)
+    audio_inputs: Vec<*const f32>,
+    audio_outputs: Vec<*mut f32>,
+    /// Atom control input
+    control: *const LV2_Atom_Sequence,
+    /// Atom notify output (only if the processor declares midi_output)
+    notify: *mut LV2_Atom_Sequence,
+    /// Parameter control ports, in port order
+    parameter_ports: Vec<ParameterPort>,
+    /// `patch:Set` property URID → parameter ID, sorted by URID
+    parameter_urids: Vec<(LV2_URID, ParameterId)>,
+    /// Channel pointers and alias scratch (released while hibernated)
+    channels: ChannelStorage,
+    /// MIDI parsed from the control sequence, absolute frames (released while hibernated)
+    midi_input: Option<Box<MidiBuffer>>,
+    /// `midi_input` events of the current segment, segment-relative
+    midi_segment: Option<Box<MidiBuffer>>,
+    /// `process_midi()` output of the current segment
+    midi_output: Option<Box<MidiBuffer>>,
+    /// Output thinning, if the processor's `MIDI_OUTPUT` opts in (released while hibernated)
+    midi_output_filter: Option<MidiOutputFilter>,
+    /// `patch:Set` points of the current `run()`, in frame order
+    automation: Vec<AutomationPoint>,
+    /// MIDI CC emulation points of the current `run()`, in frame order
+    cc_points: Vec<CcPoint>,
+    /// MIDI CC state (created from the plugin's midi_cc_config())
+    midi_cc_state: Option<MidiCcState>,
+    /// Per-chunk CC curves (if the MIDI CC config enables them, released
+    /// while hibernated)
+    midi_cc_curves: Option<MidiCcCurves>,
+    /// Last host position, advanced every `run()`
+    position: TimePosition,
+    /// Process-time load tracking for ProcessContext::quality
+    deadline: DeadlineMonitor,
+    /// Deactivated with process buffers released
+    hibernated: bool,
+    /// Instance ID tagging this instance's trace spans
+    trace_instance: u32,
+}
+
+// Allow private_bounds: BuildConfig is intentionally private (sealed pattern).
+#[allow(private_bounds)]
+impl<P: Plugin + 'static> Lv2Instance<P>
+where
+    P::Config: BuildConfig,
+{
+    /// Prepare a plugin for the host's sample rate and features.
+    ///
+    /// Returns `None` if the host doesn't provide `urid:map` (a required
+    /// feature in the generated TTL).
+    ///
+    /// # Safety
+    /// `features` must be null or a valid null-terminated feature array.
+    pub unsafe fn new(
+        config: &'static PluginConfig,
+        lv2_config: &'static Lv2Config,
+        sample_rate: f64,
+        features: *const *const LV2_Feature,
+    ) -> Option<Self> {
+        let Some(map) = find_feature(features, LV2_URID__map).filter(|map| !map.is_null()) else {
+            warn!("Host doesn't provide urid:map; cannot instantiate {}", config.name);
+            return None;
+        };
+        let map = UridMap(map.cast::<LV2_URID_Map>());
+        let urids = Urids::new(&map);
+        let max_block_size = find_feature(features, LV2_OPTIONS__options)
+            .and_then(|options| max_block_length(options.cast(), &urids))
+            .unwrap_or(DEFAULT_MAX_BLOCK_LENGTH);
+
+        let plugin = P::default();
+        Self::warn_undeclared_capabilities(&plugin);
+        let ports = PortLayout::from_plugin(&plugin);
+        let bus_layout = BusLayout::from_plugin(&plugin);
+        let midi_cc_state = plugin.midi_cc_config().map(|cfg| MidiCcState::from_config(&cfg));
+
+        let parameter_ports = ports
+            .ports()
+            .iter()
+            .filter_map(|port| match port.kind {
+                PortKind::Parameter { id, .. } => Some(ParameterPort {
+                    id,
+                    data: ptr::null(),
+                    last: f32::NAN,
+                }),
+                _ => None,
+            })
+            .collect::<Vec<_>>();
+        let mut parameter_urids: Vec<(LV2_URID, ParameterId)> = parameter_ports
+            .iter()
+            .filter_map(|port| {
+                let uri = CString::new(format!("{}#{}", lv2_config.uri_str(), parameter_symbol(port.id))).ok()?;
+                Some((map.map(&uri), port.id))
+            })
+            .collect();
+        parameter_urids.sort_unstable_by_key(|&(urid, _)| urid);
+
+        // Prepare the processor, collecting the arenas it allocates
+        let mut residency = PrepareScope::begin(config.memory_policy);
+        let mut processor = plugin.prepare(P::Config::build(sample_rate, max_block_size, &bus_layout));
+        processor.parameters_mut().set_sample_rate(sample_rate);
+
+        let mut instance = Self {
+            processor,
+            audio_inputs: vec![ptr::null(); ports.audio_input_count()],
+            audio_outputs: vec![ptr::null_mut(); ports.audio_output_count()],
+            ports,
+            urids,
+            sample_rate,
+            max_block_size,
+            memory_policy: config.memory_policy,
+            control: ptr::null(),
+            notify: ptr::null_mut(),
+            parameter_ports,
+            parameter_urids,
+            channels: ChannelStorage::new(),
+            midi_input: None,
+            midi_segment: None,
+            midi_output: None,
+            midi_output_filter: None,
+            automation: Vec::with_capacity(lv2_config.max_automation_points),
+            cc_points: Vec::with_capacity(beamer_core::midi::MAX_MIDI_EVENTS),
+            midi_cc_state,
+            midi_cc_curves: None,
+            position: TimePosition::default(),
+            deadline: DeadlineMonitor::new(config.deadline),
+            hibernated: true,
+            trace_instance: trace::next_instance_id(),
+        };
+        instance.allocate_process_buffers(&mut residency);
+        instance.log_residency(residency.finish());
+        Some(instance)
+    }
+
+    /// Allocate the buffers `run()` uses: channel storage, the MIDI buffers,
+    /// the MIDI output filter and the MIDI CC curves. Clears the hibernated flag.
+    fn allocate_process_buffers(&mut self, residency: &mut PrepareScope) {
+        let capabilities = P::Processor::CAPABILITIES;
+        self.channels = ChannelStorage::allocate(&self.ports, self.max_block_size);
+
+        for midi in [&mut self.midi_input, &mut self.midi_segment, &mut self.midi_output] {
+            let midi = midi.get_or_insert_with(|| Box::new(MidiBuffer::new()));
+            if capabilities.processes_midi() {
+                residency.prefault(&mut **midi);
+            }
+        }
+
+        self.midi_cc_curves = match self.midi_cc_state.as_ref() {
+            Some(state) if capabilities.midi_cc && state.curve_mode() != CcCurveMode::Off => {
+                Some(MidiCcCurves::new(state, self.max_block_size))
+            }
+            _ => None,
+        };
+
+        self.midi_output_filter = (capabilities.midi_output && !P::Processor::MIDI_OUTPUT.is_pass_through())
+            .then(|| MidiOutputFilter::new(P::Processor::MIDI_OUTPUT, self.sample_rate));
+
+        self.hibernated = false;
+    }
+
+    /// Free the buffers allocated by `allocate_process_buffers()` while the
+    /// instance is deactivated.
+    fn release_process_buffers(&mut self) {
+        self.channels = ChannelStorage::new();
+        self.midi_input = None;
+        self.midi_segment = None;
+        self.midi_output = None;
+        self.midi_cc_curves = None;
+        self.midi_output_filter = None;
+        self.hibernated = true;
+    }
+
+    /// Warn when the plugin uses a feature its processor's
+    /// `CAPABILITIES` leave out; the wrapper would silently skip it.
+    fn warn_undeclared_capabilities(plugin: &P) {
+        let capabilities = P::Processor::CAPABILITIES;
+        if plugin.wants_midi() && !capabilities.midi_input {
+            warn!("Plugin wants MIDI but its processor doesn't declare midi_input; host MIDI is ignored");
+        }
+        if plugin.midi_cc_config().is_some() && !capabilities.midi_cc {
+            warn!("Plugin has a MIDI CC config but its processor doesn't declare midi_cc; CC state won't be updated");
+        }
+        if (plugin.input_bus_count() > 1 || plugin.output_bus_count() > 1) && !capabilities.aux_buses {
+            warn!("Plugin has aux buses but its processor doesn't declare aux_buses; they get no ports");
+        }
+    }
+
+    /// Log the outcome of the memory policy.
+    fn log_residency(&self, report: ResidencyReport) {
+        if !self.memory_policy.is_enabled() {
+            return;
+        }
+        if report.lock_failures > 0 {
+            warn!("Memory policy {:?}: {}", self.memory_policy, report);
+        } else {
+            log::info!("Memory policy {:?}: {}", self.memory_policy, report);
+        }
+    }
+
+    /// The prepared processor.
+    #[inline]
+    pub fn processor(&self) -> &P::Processor {
+        &self.processor
+    }
+
+    /// Port layout of the instance.
+    #[inline]
+    pub fn ports(&self) -> &PortLayout {
+        &self.ports
+    }
+
+    /// Maximum block length passed to `process()`.
+    #[inline]
+    pub fn max_block_size(&self) -> usize {
+        self.max_block_size
+    }
+
+    // =========================================================================
+    // LV2 Callbacks
+    // =========================================================================
+
+    /// `connect_port()`: remember a host buffer. Unknown ports are ignored.
+    pub fn connect_port(&mut self, port: u32, data: *mut c_void) {
+        let Some(info) = self.ports.port(port) else {
+            return;
+        };
+        match info.kind {
+            PortKind::AudioInput { .. } => {
+                self.audio_inputs[port as usize] = data.cast();
+            }
+            PortKind::AudioOutput { .. } => {
+                self.audio_outputs[port as usize - self.audio_inputs.len()] = data.cast();
+            }
+            PortKind::Control => self.control = data.cast(),
+            PortKind::Notify => self.notify = data.cast(),
+            PortKind::Parameter { .. } => {
+                let index = (port - self.ports.first_parameter_port()) as usize;
+                self.parameter_ports[index].data = data.cast();
+            }
+        }
+    }
+
+    /// `activate()`: restore what deactivation released, then `set_active(true)`.
+    pub fn activate(&mut self) {
+        if self.hibernated {
+            let mut residency = PrepareScope::begin(self.memory_policy);
+            self.processor.resume();
+            self.allocate_process_buffers(&mut residency);
+            self.log_residency(residency.finish());
+        }
+        self.deadline.reset();
+        self.processor.set_active(true);
+    }
+
+    /// `deactivate()`: `set_active(false)`, then release large allocations
+    /// until the next `activate()`.
+    pub fn deactivate(&mut self) {
+        self.processor.set_active(false);
+        if !self.hibernated {
+            self.processor.hibernate();
+            self.release_process_buffers();
+        }
+    }
+
+    /// `run()`: process `sample_count` frames.
+    ///
+    /// # Safety
+    /// All ports must be connected to buffers valid for `sample_count`
+    /// frames (atom ports: for their declared capacity).
+    pub unsafe fn run(&mut self, sample_count: usize) {
+        let capabilities = P::Processor::CAPABILITIES;
+
+        // The notify sequence must be (re)initialized on every run
+        let mut notify = (capabilities.midi_output && !self.notify.is_null())
+            .then(|| SequenceWriter::new(self.notify, self.urids.atom_sequence));
+
+        if sample_count == 0 {
+            return;
+        }
+        // Buffers are released while hibernated. Hosts shouldn't run an
+        // inactive plugin, but if one does it gets silence
+        if self.hibernated {
+            for &output in self.audio_outputs.iter().filter(|p| !p.is_null()) {
+                std::slice::from_raw_parts_mut(output, sample_count).fill(0.0);
+            }
+            return;
+        }
+        if self.audio_inputs.iter().any(|p| p.is_null()) || self.audio_outputs.iter().any(|p| p.is_null()) {
+            return;
+        }
+
+        // Whole-call time against the block's real-time budget
+        let started = Instant::now();
+        let _instance = trace::instance_scope(self.trace_instance);
+        let _block = trace::span_in(category::WRAPPER, "process");
+
+        // 1. Control ports (values the host set since the last run)
+        let span = trace::span_in(category::WRAPPER, "parameters");
+        let parameters = self.processor.parameters();
+        for port in self.parameter_ports.iter_mut().filter(|port| !port.data.is_null()) {
+            let value = *port.data;
+            if value != port.last {
+                port.last = value;
+                parameters.set_normalized(port.id, parameters.plain_to_normalized(port.id, value as f64));
+            }
+        }
+        drop(span);
+
+        // 2. Control sequence: MIDI, patch:Set automation, time:Position
+        let span = trace::span_in(category::MIDI, "midi events");
+        self.read_control_sequence(sample_count);
+        drop(span);
+
+        // 3. Chunks of at most max_block_size, split at automation points
+        let in_place = self.processor.supports_in_place();
+        let main_inputs = self.ports.input_channels()[0];
+        let mut next_point = 0;
+        let mut midi_cursor = 0;
+        let mut chunk_start = 0;
+
+        while chunk_start < sample_count {
+            let chunk_end = (chunk_start + self.max_block_size).min(sample_count);
+            self.channels.load(
+                &self.audio_inputs,
+                &self.audio_outputs,
+                main_inputs,
+                chunk_start,
+                chunk_end - chunk_start,
+                in_place,
+            );
+            if capabilities.midi_cc {
+                self.render_curves(chunk_start, chunk_end);
+            }
+
+            let mut start = chunk_start;
+            while start < chunk_end {
+                while let Some(point) = self.automation.get(next_point).filter(|p| p.frame as usize <= start) {
+                    self.processor.parameters().set_normalized(point.id, point.normalized);
+                    next_point += 1;
+                }
+                let end = self
+                    .automation
+                    .get(next_point)
+                    .map_or(chunk_end, |p| (p.frame as usize).min(chunk_end));
+                self.process_segment(chunk_start, start, end, &mut midi_cursor, notify.as_mut());
+                start = end;
+            }
+            chunk_start = chunk_end;
+        }
+
+        // 4. Transport and quality level for the next run
+        self.position.advance(sample_count, self.sample_rate);
+        self.deadline.record(started.elapsed(), sample_count, self.sample_rate);
+    }
+
+    // =========================================================================
+    // Run Stages
+    // =========================================================================
+
+    /// Parse the control sequence into the MIDI input, automation and CC
+    /// point lists, and apply `time:Position` objects.
+    ///
+    /// Frames are clamped to the block. `patch:Set` points beyond the
+    /// automation capacity are applied right away (at the block start).
+    unsafe fn read_control_sequence(&mut self, sample_count: usize) {
+        let capabilities = P::Processor::CAPABILITIES;
+        let Self {
+            processor,
+            urids,
+            control,
+            parameter_urids,
+            midi_input,
+            automation,
+            cc_points,
+            midi_cc_state,
+            midi_cc_curves,
+            position,
+            ..
+        } = self;
+        let Some(midi_input) = midi_input.as_deref_mut() else {
+            return;
+        };
+        midi_input.clear();
+        automation.clear();
+        cc_points.clear();
+        let last_frame = sample_count.saturating_sub(1) as i64;
+
+        for event in SequenceIter::new(*control) {
+            let frame = event.frames.clamp(0, last_frame) as u32;
+
+            if event.type_ == urids.midi_event {
+                if !capabilities.processes_midi() {
+                    continue;
+                }
+                let Some(midi) = midi_from_bytes(event.body, frame) else {
+                    continue;
+                };
+                let cc = emulated_controller(&midi).filter(|_| capabilities.midi_cc).and_then(|(controller, normalized)| {
+                    let state = midi_cc_state.as_ref().filter(|state| state.has_controller(controller))?;
+                    state.set_normalized(MidiCcState::parameter_id(controller), normalized);
+                    Some(CcPoint {
+                        frame,
+                        controller,
+                        normalized,
+                    })
+                });
+                if let Some(point) = cc {
+                    if midi_cc_curves.is_some() && cc_points.len() < cc_points.capacity() {
+                        cc_points.push(point);
+                    }
+                }
+                if capabilities.midi_input || cc.is_some() {
+                    midi_input.push(midi);
+                }
+            } else if urids.is_object(event.type_) {
+                let Some((otype, properties)) = object_properties(event.body) else {
+                    continue;
+                };
+                if otype == urids.patch_set {
+                    let mut property = None;
+                    let mut value = None;
+                    for (key, type_, bytes) in properties {
+                        if key == urids.patch_property && type_ == urids.atom_urid {
+                            property = read_u32(bytes, 0);
+                        } else if key == urids.patch_value {
+                            value = urids.number(type_, bytes);
+                        }
+                    }
+                    let (Some(property), Some(plain)) = (property, value) else {
+                        continue;
+                    };
+                    let Ok(found) = parameter_urids.binary_search_by_key(&property, |&(urid, _)| urid) else {
+                        continue;
+                    };
+                    let id = parameter_urids[found].1;
+                    let parameters = processor.parameters();
+                    let normalized = parameters.plain_to_normalized(id, plain);
+                    if automation.len() < automation.capacity() {
+                        automation.push(AutomationPoint { frame, id, normalized });
+                    } else {
+                        parameters.set_normalized(id, normalized);
+                    }
+                } else if otype == urids.time_position && capabilities.transport {
+                    for (key, type_, bytes) in properties {
+                        let Some(value) = urids.number(type_, bytes) else {
+                            continue;
+                        };
+                        if key == urids.time_frame {
+                            position.frame = Some(value as i64);
+                        } else if key == urids.time_speed {
+                            position.speed = Some(value);
+                        } else if key == urids.time_beats_per_minute {
+                            position.beats_per_minute = Some(value);
+                        } else if key == urids.time_beats_per_bar {
+                            position.beats_per_bar = Some(value);
+                        } else if key == urids.time_beat_unit {
+                            position.beat_unit = Some(value as i32);
+                        } else if key == urids.time_bar {
+                            position.bar = Some(value as i64);
+                        } else if key == urids.time_bar_beat {
+                            position.bar_beat = Some(value);
+                        }
+                    }
+                }
+            }
+        }
+
+        if midi_input.has_overflowed() {
+            warn!(
+                "MIDI input buffer overflow: {} events max, some events were dropped",
+                beamer_core::midi::MAX_MIDI_EVENTS
+            );
+        }
+    }
+
+    /// Render the CC curves for one chunk from this run's CC points.
+    fn render_curves(&mut self, chunk_start: usize, chunk_end: usize) {
+        let Some(curves) = self.midi_cc_curves.as_mut() else {
+            return;
+        };
+        curves.begin_block(chunk_end - chunk_start);
+        for point in self
+            .cc_points
+            .iter()
+            .filter(|p| (chunk_start..chunk_end).contains(&(p.frame as usize)))
+        {
+            curves.push_point(point.controller, (point.frame as usize - chunk_start) as u32, point.normalized);
+        }
+        curves.end_block();
+    }
+
+    /// Run `process_midi()` and `process()` for frames `start..end` of the
+    /// block, inside the chunk starting at `chunk_start`.
+    unsafe fn process_segment(
+        &mut self,
+        chunk_start: usize,
+        start: usize,
+        end: usize,
+        midi_cursor: &mut usize,
+        notify: Option<&mut SequenceWriter<'_>>,
+    ) {
+        let capabilities = P::Processor::CAPABILITIES;
+        let len = end - start;
+
+        // MIDI: this segment's events, rebased; output written to notify
+        if capabilities.processes_midi() {
+            if let (Some(input), Some(segment), Some(output)) = (
+                self.midi_input.as_deref(),
+                self.midi_segment.as_deref_mut(),
+                self.midi_output.as_deref_mut(),
+            ) {
+                segment.clear();
+                output.clear();
+                let events = input.as_slice();
+                while let Some(event) = events.get(*midi_cursor).filter(|e| (e.sample_offset as usize) < end) {
+                    let mut event = event.clone();
+                    event.sample_offset -= start as u32;
+                    segment.push(event);
+                    *midi_cursor += 1;
+                }
+                let span = trace::span_in(category::MIDI, "process_midi");
+                self.processor.process_midi(segment.as_slice(), output);
+                drop(span);
+                if let Some(filter) = &mut self.midi_output_filter {
+                    filter.filter(output, len);
+                }
+
+                if let Some(notify) = notify {
+                    let mut scratch = [0; 3];
+                    for event in output.iter() {
+                        if let Some(bytes) = midi_to_bytes(event, &mut scratch) {
+                            let frame = (start + event.sample_offset as usize).min(end - 1);
+                            if !notify.push(frame as i64, self.urids.midi_event, bytes) {
+                                break;
+                            }
+                        }
+                    }
+                }
+                if output.has_overflowed() {
+                    warn!(
+                        "MIDI output buffer overflow: {} events reached capacity, some events were dropped",
+                        output.len()
+                    );
+                }
+            }
+        }
+
+        // Context for the segment
+        let transport = if capabilities.transport {
+            self.position.transport(start, self.sample_rate)
+        } else {
+            Transport::default()
+        };
+        let context = match self.midi_cc_state.as_ref() {
+            Some(state) => ProcessContext::with_midi_cc(self.sample_rate, len, transport, state),
+            None => ProcessContext::new(self.sample_rate, len, transport),
+        };
+        if let Some(curves) = self.midi_cc_curves.as_mut() {
+            curves.set_window(start - chunk_start, len);
+        }
+        let context = context
+            .with_quality(self.deadline.level())
+            .with_midi_cc_curves(self.midi_cc_curves.as_ref());
+
+        // Audio: port buffers as slices, no copies
+        let offset = start - chunk_start;
+        let input_channels = self.ports.input_channels();
+        let output_channels = self.ports.output_channels();
+        let (main_in, aux_in) = self.channels.inputs.split_at(input_channels[0]);
+        let (main_out, aux_out) = self.channels.outputs.split_at(output_channels[0]);
+
+        let main_in_iter = main_in
+            .iter()
+            .map(|&p| (!p.is_null()).then(|| slice::from_raw_parts(p.add(offset), len)));
+        let main_out_iter = main_out.iter().map(|&p| slice::from_raw_parts_mut(p.add(offset), len));
+        let aux_in_iter = bus_slices(aux_in, &input_channels[1..])
+            .map(|bus| bus.iter().map(|&p| slice::from_raw_parts(p.add(offset), len)));
+        let aux_out_iter = bus_slices(aux_out, &output_channels[1..])
+            .map(|bus| bus.iter().map(|&p| slice::from_raw_parts_mut(p.add(offset), len)));
+
+        let mut buffer = Buffer::new_in_place(main_in_iter, main_out_iter, len);
+        let mut aux = AuxiliaryBuffers::new(aux_in_iter, aux_out_iter, len);
+        let _span = trace::span_in(category::WRAPPER, "audio");
+        self.processor.process(&mut buffer, &mut aux, &context);
+    }
+}
+
+/// Split flat channel pointers into per-bus slices.
+fn bus_slices<'a, T>(channels: &'a [T], counts: &'a [usize]) -> impl Iterator<Item = &'a [T]> + 'a {
+    counts.iter().scan(0, move |start, &count| {
+        let bus = channels.get(*start..*start + count).unwrap_or(&[]);
+        *start += count;
+        Some(bus)
+    })
+}
+
+/// The MIDI CC emulation controller and normalized value an event carries:
+/// a CC, channel pressure (aftertouch) or pitch bend.
+fn emulated_controller(event: &MidiEvent) -> Option<(u8, f64)> {
+    match &event.event {
+        MidiEventKind::ControlChange(cc) => Some((cc.controller, cc.value as f64)),
+        MidiEventKind::ChannelPressure(pressure) => Some((controller::AFTERTOUCH, pressure.pressure as f64)),
+        MidiEventKind::PitchBend(bend) => Some((controller::PITCH_BEND, (bend.value as f64 + 1.0) * 0.5)),
+        _ => None,
+    }
+}
+
+// =============================================================================
+// Lv2Descriptor
+// =============================================================================
+
+/// `LV2_Descriptor` for a plugin type, plus the configs `instantiate()` needs.
+///
+/// `#[repr(C)]` with the raw descriptor first: the host hands the descriptor
+/// pointer back to `instantiate()`, which casts it to reach the configs.
+/// Created once by [`export_lv2!`](crate::export_lv2).
+#[repr(C)]
+pub struct Lv2Descriptor<P> {
+    raw: LV2_Descriptor,
+    config: &'static PluginConfig,
+    lv2_config: &'static Lv2Config,
+    _marker: PhantomData<fn() -> P>,
+}
+
+// Safety: the descriptor is immutable after creation; its pointers are
+// 'static (the URI) or functions.
+unsafe impl<P> Send for Lv2Descriptor<P> {}
+unsafe impl<P> Sync for Lv2Descriptor<P> {}
+
+#[allow(private_bounds)]
+impl<P: Plugin + 'static> Lv2Descriptor<P>
+where
+    P::Config: BuildConfig,
+{
+    /// Create the descriptor for `P`.
+    pub fn new(config: &'static PluginConfig, lv2_config: &'static Lv2Config) -> Self {
+        Self {
+            raw: LV2_Descriptor {
+                URI: lv2_config.uri.as_ptr(),
+                instantiate: Some(instantiate::<P>),
+                connect_port: Some(connect_port::<P>),
+                activate: Some(activate::<P>),
+                run: Some(run::<P>),
+                deactivate: Some(deactivate::<P>),
+                cleanup: Some(cleanup::<P>),
+                extension_data: Some(extension_data),
+            },
+            config,
+            lv2_config,
+            _marker: PhantomData,
+        }
+    }
+
+    /// The C descriptor handed to the host.
+    #[inline]
+    pub fn as_raw(&self) -> *const LV2_Descriptor {
+        &self.raw
+    }
+
+    /// Shared plugin configuration.
+    #[inline]
+    pub fn config(&self) -> &'static PluginConfig {
+        self.config
+    }
+
+    /// LV2-specific configuration.
+    #[inline]
+    pub fn lv2_config(&self) -> &'static Lv2Config {
+        self.lv2_config
+    }
+}
+
+unsafe extern "C" fn instantiate<P: Plugin + 'static>(
+    descriptor: *const LV2_Descriptor,
+    sample_rate: f64,
+    _bundle_path: *const c_char,
+    features: *const *const LV2_Feature,
+) -> LV2_Handle
+where
+    P::Config: BuildConfig,
+{
+    if descriptor.is_null() {
+        return ptr::null_mut();
+    }
+    // SAFETY: every descriptor with this function is an Lv2Descriptor<P>
+    let descriptor = &*descriptor.cast::<Lv2Descriptor<P>>();
+    match Lv2Instance::<P>::new(descriptor.config, descriptor.lv2_config, sample_rate, features) {
+        Some(instance) => Box::into_raw(Box::new(instance)).cast(),
+        None => ptr::null_mut(),
+    }
+}
+
+unsafe extern "C" fn connect_port<P: Plugin + 'static>(instance: LV2_Handle, port: u32, data: *mut c_void)
+where
+    P::Config: BuildConfig,
+{
+    if let Some(instance) = instance.cast::<Lv2Instance<P>>().as_mut() {
+        instance.connect_port(port, data);
+    }
+}
+
+unsafe extern "C" fn activate<P: Plugin + 'static>(instance: LV2_Handle)
+where
+    P::Config: BuildConfig,
+{
+    if let Some(instance) = instance.cast::<Lv2Instance<P>>().as_mut() {
+        instance.activate();
+    }
+}
+
+unsafe extern "C" fn run<P: Plugin + 'static>(instance: LV2_Handle, sample_count: u32)
+where
+    P::Config: BuildConfig,
+{
+    if let Some(instance) = instance.cast::<Lv2Instance<P>>().as_mut() {
+        instance.run(sample_count as usize);
+    }
+}
+
+unsafe extern "C" fn deactivate<P: Plugin + 'static>(instance: LV2_Handle)
+where
+    P::Config: BuildConfig,
+{
+    if let Some(instance) = instance.cast::<Lv2Instance<P>>().as_mut() {
+        instance.deactivate();
+    }
+}
+
+unsafe extern "C" fn cleanup<P: Plugin + 'static>(instance: LV2_Handle) {
+    if !instance.is_null() {
+        drop(Box::from_raw(instance.cast::<Lv2Instance<P>>()));
+    }
+}
+
+unsafe extern "C" fn extension_data(_uri: *const c_char) -> *const c_void {
+    ptr::null()
+}
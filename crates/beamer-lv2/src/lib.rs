@@ -0,0 +1,71 @@
+//! # beamer-lv2
+//!
+//! LV2 implementation layer for the Beamer framework.
+//!
+//! This crate wraps `beamer-core` traits into the LV2 C API so the same
+//! plugin can be loaded by Linux hosts (Ardour, Carla, Qtractor, REAPER):
+//!
+//! - Descriptor and entry point ([`Lv2Descriptor`], [`export_lv2!`])
+//! - Generic instance wrapper ([`Lv2Instance`])
+//! - Bundle TTL generation from the same port layout ([`ttl`])
+//! - In-process test host ([`Lv2Host`])
+//!
+//! ## Architecture
+//!
+//! ```text
+//! User Plugin (implements beamer_core::Plugin)
+//!        ↓
+//! Lv2Instance<P> (generic LV2 wrapper)
+//!        ↓
+//! LV2_Descriptor (instantiate, connect_port, run, ...)
+//! ```
+//!
+//! ## Ports
+//!
+//! One audio port per channel (main bus first, auxiliary buses flagged as
+//! side-chain), an atom control input, an atom notify output when the
+//! processor emits MIDI, and one control port per parameter. Parameters can
+//! also be set with `patch:Set` messages on the control input; those are
+//! applied at their frame, splitting the block like VST3 sample-accurate
+//! automation.
+//!
+//! ## Usage
+//!
+//! ```rust,ignore
+//! use beamer_core::PluginConfig;
+//! use beamer_lv2::{export_lv2, Lv2Config};
+//!
+//! static CONFIG: PluginConfig = PluginConfig::new("My Plugin")
+//!     .with_vendor("My Company");
+//!
+//! static LV2_CONFIG: Lv2Config = Lv2Config::new(c"https://example.com/plugins/my-plugin");
+//!
+//! export_lv2!(CONFIG, LV2_CONFIG, MyPlugin);
+//! ```
+//!
+//! The LV2 ABI is declared in [`sys`]; no LV2 SDK is needed to build.
+
+#![allow(non_upper_case_globals)]
+#![allow(non_camel_case_types)]
+#![allow(non_snake_case)]
+
+pub mod atom;
+pub mod config;
+pub mod export;
+pub mod host;
+pub mod instance;
+pub mod midi;
+pub mod ports;
+pub mod sys;
+pub mod time;
+pub mod ttl;
+
+// Re-exports
+pub use config::Lv2Config;
+pub use host::Lv2Host;
+pub use instance::{Lv2Descriptor, Lv2Instance};
+pub use ports::PortLayout;
+pub use time::TimePosition;
+
+// Re-export shared PluginConfig from beamer-core
+pub use beamer_core::PluginConfig;
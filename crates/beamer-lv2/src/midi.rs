@@ -0,0 +1,128 @@
+//! Conversion between raw MIDI bytes (`midi:MidiEvent` atoms) and `MidiEvent`.
+
+use beamer_core::{MidiEvent, MidiEventKind, NoteId};
+
+/// Convert a raw MIDI message to a [`MidiEvent`].
+///
+/// Handles channel voice messages. Raw MIDI has no note IDs, so the pitch
+/// doubles as the ID (note-offs then match their note-on). SysEx and
+/// system messages return `None`: a `MidiEvent` SysEx boxes its payload,
+/// and the wrapper keeps `run()` free of per-event allocation.
+pub fn midi_from_bytes(bytes: &[u8], sample_offset: u32) -> Option<MidiEvent> {
+    let status = *bytes.first()?;
+    let channel = status & 0x0F;
+    let data1 = || bytes.get(1).map(|&b| b & 0x7F);
+    let data2 = || bytes.get(2).map(|&b| b & 0x7F);
+    let unit = |v: u8| v as f32 / 127.0;
+
+    let event = match status & 0xF0 {
+        0x80 => {
+            let pitch = data1()?;
+            MidiEvent::note_off(sample_offset, channel, pitch, unit(data2()?), pitch as NoteId, 0.0)
+        }
+        0x90 => {
+            let pitch = data1()?;
+            match data2()? {
+                // Velocity 0 is a note-off by convention
+                0 => MidiEvent::note_off(sample_offset, channel, pitch, 0.0, pitch as NoteId, 0.0),
+                velocity => MidiEvent::note_on(sample_offset, channel, pitch, unit(velocity), pitch as NoteId, 0.0, 0),
+            }
+        }
+        0xA0 => {
+            let pitch = data1()?;
+            MidiEvent::poly_pressure(sample_offset, channel, pitch, unit(data2()?), pitch as NoteId)
+        }
+        0xB0 => MidiEvent::control_change(sample_offset, channel, data1()?, unit(data2()?)),
+        0xC0 => MidiEvent::program_change(sample_offset, channel, data1()?),
+        0xD0 => MidiEvent::channel_pressure(sample_offset, channel, unit(data1()?)),
+        0xE0 => {
+            let raw = data1()? as u16 | (data2()? as u16) << 7;
+            let value = ((raw as f32 - 8192.0) / 8192.0).clamp(-1.0, 1.0);
+            MidiEvent::pitch_bend(sample_offset, channel, value)
+        }
+        _ => return None,
+    };
+    Some(event)
+}
+
+/// Encode a [`MidiEvent`] as raw MIDI.
+///
+/// Channel voice messages are written to `scratch`; SysEx is returned from
+/// the event itself. Events without a MIDI 1.0 equivalent (note
+/// expression, chord/scale info) return `None`.
+pub fn midi_to_bytes<'a>(event: &'a MidiEvent, scratch: &'a mut [u8; 3]) -> Option<&'a [u8]> {
+    let to_7bit = |v: f32| (v.clamp(0.0, 1.0) * 127.0).round() as u8;
+    let len = match &event.event {
+        MidiEventKind::NoteOn(note) => {
+            // A rounded-down velocity must not turn into a note-off
+            *scratch = [0x90 | (note.channel & 0x0F), note.pitch & 0x7F, to_7bit(note.velocity).max(1)];
+            3
+        }
+        MidiEventKind::NoteOff(note) => {
+            *scratch = [0x80 | (note.channel & 0x0F), note.pitch & 0x7F, to_7bit(note.velocity)];
+            3
+        }
+        MidiEventKind::PolyPressure(pressure) => {
+            *scratch = [0xA0 | (pressure.channel & 0x0F), pressure.pitch & 0x7F, to_7bit(pressure.pressure)];
+            3
+        }
+        MidiEventKind::ControlChange(cc) => {
+            *scratch = [0xB0 | (cc.channel & 0x0F), cc.controller & 0x7F, to_7bit(cc.value)];
+            3
+        }
+        MidiEventKind::ProgramChange(program) => {
+            *scratch = [0xC0 | (program.channel & 0x0F), program.program & 0x7F, 0];
+            2
+        }
+        MidiEventKind::ChannelPressure(pressure) => {
+            *scratch = [0xD0 | (pressure.channel & 0x0F), to_7bit(pressure.pressure), 0];
+            2
+        }
+        MidiEventKind::PitchBend(bend) => {
+            let raw = ((bend.value.clamp(-1.0, 1.0) + 1.0) * 8192.0).round().min(16383.0) as u16;
+            *scratch = [0xE0 | (bend.channel & 0x0F), (raw & 0x7F) as u8, (raw >> 7) as u8];
+            3
+        }
+        MidiEventKind::SysEx(sysex) => return Some(sysex.as_slice()),
+        _ => return None,
+    };
+    Some(&scratch[..len])
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_round_trip() {
+        let events = [
+            MidiEvent::note_on(3, 1, 60, 100.0 / 127.0, 60, 0.0, 0),
+            MidiEvent::note_off(4, 1, 60, 0.0, 60, 0.0),
+            MidiEvent::control_change(5, 0, 1, 64.0 / 127.0),
+            MidiEvent::pitch_bend(6, 2, 0.5),
+            MidiEvent::program_change(7, 3, 12),
+            MidiEvent::channel_pressure(8, 4, 1.0),
+        ];
+        for event in events {
+            let mut scratch = [0; 3];
+            let bytes = midi_to_bytes(&event, &mut scratch).unwrap().to_vec();
+            assert_eq!(midi_from_bytes(&bytes, event.sample_offset), Some(event));
+        }
+    }
+
+    #[test]
+    fn test_pitch_bend_range() {
+        let center = midi_from_bytes(&[0xE0, 0x00, 0x40], 0).unwrap();
+        assert_eq!(center, MidiEvent::pitch_bend(0, 0, 0.0));
+        let min = midi_from_bytes(&[0xE0, 0x00, 0x00], 0).unwrap();
+        assert_eq!(min, MidiEvent::pitch_bend(0, 0, -1.0));
+    }
+
+    #[test]
+    fn test_zero_velocity_and_unsupported() {
+        let off = midi_from_bytes(&[0x90, 64, 0], 0).unwrap();
+        assert!(matches!(off.event, MidiEventKind::NoteOff(_)));
+        assert!(midi_from_bytes(&[0xF0, 0x7E, 0xF7], 0).is_none());
+        assert!(midi_from_bytes(&[0x90, 64], 0).is_none());
+    }
+}
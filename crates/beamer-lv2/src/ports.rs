@@ -0,0 +1,248 @@
+//! LV2 port layout derived from a plugin's buses and parameters.
+//!
+//! LV2 ports are flat and numbered. [`PortLayout`] assigns the indices once
+//! so the runtime wrapper and the TTL generator always agree:
+//!
+//! ```text
+//! audio inputs   main bus channels, then each aux bus's channels
+//! audio outputs  main bus channels, then each aux bus's channels
+//! control        atom input: MIDI, patch:Set automation, time:Position
+//! notify         atom output: MIDI (only if the processor declares midi_output)
+//! parameters     one control input per parameter, plain values
+//! ```
+
+use beamer_core::{AudioProcessor, BusLayout, ParameterId, ParameterStore, Plugin, MAX_AUX_BUSES, MAX_CHANNELS};
+
+// =============================================================================
+// Port Descriptions
+// =============================================================================
+
+/// What a port carries.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PortKind {
+    /// Audio input channel (`bus` 0 = main).
+    AudioInput {
+        /// Bus index.
+        bus: usize,
+        /// Channel within the bus.
+        channel: usize,
+    },
+    /// Audio output channel (`bus` 0 = main).
+    AudioOutput {
+        /// Bus index.
+        bus: usize,
+        /// Channel within the bus.
+        channel: usize,
+    },
+    /// Atom sequence input (MIDI, automation, transport).
+    Control,
+    /// Atom sequence output (MIDI).
+    Notify,
+    /// Control input for a parameter, in plain units.
+    Parameter {
+        /// Parameter ID.
+        id: ParameterId,
+        /// Index in the plugin's parameter list.
+        index: usize,
+    },
+}
+
+/// One LV2 port.
+#[derive(Debug, Clone, PartialEq)]
+pub struct PortInfo {
+    /// Port index.
+    pub index: u32,
+    /// `lv2:symbol` (stable identifier hosts save sessions by).
+    pub symbol: String,
+    /// `lv2:name`.
+    pub name: String,
+    /// What the port carries.
+    pub kind: PortKind,
+}
+
+// =============================================================================
+// PortLayout
+// =============================================================================
+
+/// Port indices for a plugin.
+#[derive(Debug, Clone, PartialEq)]
+pub struct PortLayout {
+    ports: Vec<PortInfo>,
+    /// Channel count per input bus (main first)
+    input_channels: Vec<usize>,
+    /// Channel count per output bus (main first)
+    output_channels: Vec<usize>,
+    /// Index of the atom control input
+    control: u32,
+    /// Index of the atom notify output
+    notify: Option<u32>,
+}
+
+impl PortLayout {
+    /// Build the layout for a plugin.
+    ///
+    /// Aux buses get ports only if the processor declares `aux_buses`, and
+    /// the notify port only if it declares `midi_output`, as the VST3 wrapper
+    /// skips those stages otherwise.
+    pub fn from_plugin<P: Plugin>(plugin: &P) -> Self {
+        let capabilities = P::Processor::CAPABILITIES;
+        let layout = BusLayout::from_plugin(plugin);
+        let bus_limit = if capabilities.aux_buses { MAX_AUX_BUSES + 1 } else { 1 };
+
+        // A plugin without a bus (an instrument's input) gets no ports for it
+        let main_input = if plugin.input_bus_count() > 0 { layout.main_input_channels } else { 0 };
+        let main_output = if plugin.output_bus_count() > 0 { layout.main_output_channels } else { 0 };
+
+        let input_channels: Vec<usize> = std::iter::once(main_input as usize)
+            .chain((1..plugin.input_bus_count().min(bus_limit)).map(|i| {
+                plugin.input_bus_info(i).map_or(0, |b| b.channel_count as usize)
+            }))
+            .map(|channels| channels.min(MAX_CHANNELS))
+            .collect();
+        let output_channels: Vec<usize> = std::iter::once(main_output as usize)
+            .chain((1..plugin.output_bus_count().min(bus_limit)).map(|i| {
+                plugin.output_bus_info(i).map_or(0, |b| b.channel_count as usize)
+            }))
+            .map(|channels| channels.min(MAX_CHANNELS))
+            .collect();
+
+        let mut ports = Vec::new();
+        let mut push = |symbol: String, name: String, kind: PortKind| {
+            let index = ports.len() as u32;
+            ports.push(PortInfo { index, symbol, name, kind });
+            index
+        };
+
+        for (bus, &channels) in input_channels.iter().enumerate() {
+            let bus_name = plugin.input_bus_info(bus).map_or("Input", |b| b.name);
+            for channel in 0..channels {
+                push(
+                    audio_symbol("in", bus, channel),
+                    format!("{} {}", bus_name, channel + 1),
+                    PortKind::AudioInput { bus, channel },
+                );
+            }
+        }
+        for (bus, &channels) in output_channels.iter().enumerate() {
+            let bus_name = plugin.output_bus_info(bus).map_or("Output", |b| b.name);
+            for channel in 0..channels {
+                push(
+                    audio_symbol("out", bus, channel),
+                    format!("{} {}", bus_name, channel + 1),
+                    PortKind::AudioOutput { bus, channel },
+                );
+            }
+        }
+
+        let control = push("control".into(), "Control".into(), PortKind::Control);
+        let notify = capabilities
+            .midi_output
+            .then(|| push("notify".into(), "Notify".into(), PortKind::Notify));
+
+        let parameters = plugin.parameters();
+        for index in 0..parameters.count() {
+            if let Some(info) = parameters.info(index) {
+                push(parameter_symbol(info.id), info.name.to_string(), PortKind::Parameter { id: info.id, index });
+            }
+        }
+
+        Self {
+            ports,
+            input_channels,
+            output_channels,
+            control,
+            notify,
+        }
+    }
+
+    /// All ports in index order.
+    #[inline]
+    pub fn ports(&self) -> &[PortInfo] {
+        &self.ports
+    }
+
+    /// Port by index.
+    #[inline]
+    pub fn port(&self, index: u32) -> Option<&PortInfo> {
+        self.ports.get(index as usize)
+    }
+
+    /// Number of ports.
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.ports.len()
+    }
+
+    /// Whether there are no ports (never true: the control port always exists).
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.ports.is_empty()
+    }
+
+    /// Channel count per input bus (main first).
+    #[inline]
+    pub fn input_channels(&self) -> &[usize] {
+        &self.input_channels
+    }
+
+    /// Channel count per output bus (main first).
+    #[inline]
+    pub fn output_channels(&self) -> &[usize] {
+        &self.output_channels
+    }
+
+    /// Total audio input ports.
+    #[inline]
+    pub fn audio_input_count(&self) -> usize {
+        self.input_channels.iter().sum()
+    }
+
+    /// Total audio output ports.
+    #[inline]
+    pub fn audio_output_count(&self) -> usize {
+        self.output_channels.iter().sum()
+    }
+
+    /// Index of the atom control input.
+    #[inline]
+    pub fn control_port(&self) -> u32 {
+        self.control
+    }
+
+    /// Index of the atom notify output, if the processor emits MIDI.
+    #[inline]
+    pub fn notify_port(&self) -> Option<u32> {
+        self.notify
+    }
+
+    /// Index of the first parameter port.
+    #[inline]
+    pub fn first_parameter_port(&self) -> u32 {
+        self.notify.unwrap_or(self.control) + 1
+    }
+
+    /// Port index of a parameter.
+    pub fn parameter_port(&self, id: ParameterId) -> Option<u32> {
+        self.ports
+            .iter()
+            .find(|p| matches!(p.kind, PortKind::Parameter { id: port_id, .. } if port_id == id))
+            .map(|p| p.index)
+    }
+}
+
+/// `lv2:symbol` of an audio port: `in_1`, `out_2`, `in_aux1_1`, ...
+fn audio_symbol(direction: &str, bus: usize, channel: usize) -> String {
+    if bus == 0 {
+        format!("{}_{}", direction, channel + 1)
+    } else {
+        format!("{}_aux{}_{}", direction, bus, channel + 1)
+    }
+}
+
+/// `lv2:symbol` of a parameter port.
+///
+/// Derived from the parameter ID (the hash of its string ID), not its
+/// display name, so renaming a parameter doesn't break saved sessions.
+pub fn parameter_symbol(id: ParameterId) -> String {
+    format!("p{}", id)
+}
@@ -0,0 +1,209 @@
+//! Minimal LV2 C ABI.
+//!
+//! Only the parts of the LV2 headers the wrapper uses: the plugin descriptor,
+//! host features (URID map, options), atoms, and the URIs of the vocabularies
+//! involved. Layouts match `lv2/core/lv2.h`, `lv2/urid/urid.h`,
+//! `lv2/atom/atom.h` and `lv2/options/options.h`.
+
+use std::ffi::{c_char, c_void, CStr};
+
+// =============================================================================
+// Core
+// =============================================================================
+
+/// Opaque plugin instance handle.
+pub type LV2_Handle = *mut c_void;
+
+/// Host feature passed to `instantiate()`.
+#[repr(C)]
+pub struct LV2_Feature {
+    /// Feature URI.
+    pub URI: *const c_char,
+    /// Feature-specific data.
+    pub data: *mut c_void,
+}
+
+/// Plugin descriptor returned from `lv2_descriptor()`.
+#[repr(C)]
+pub struct LV2_Descriptor {
+    /// Plugin URI.
+    pub URI: *const c_char,
+    /// Create an instance.
+    pub instantiate: Option<
+        unsafe extern "C" fn(
+            descriptor: *const LV2_Descriptor,
+            sample_rate: f64,
+            bundle_path: *const c_char,
+            features: *const *const LV2_Feature,
+        ) -> LV2_Handle,
+    >,
+    /// Connect a port to host memory.
+    pub connect_port: Option<unsafe extern "C" fn(instance: LV2_Handle, port: u32, data: *mut c_void)>,
+    /// Prepare for `run()`.
+    pub activate: Option<unsafe extern "C" fn(instance: LV2_Handle)>,
+    /// Process a block.
+    pub run: Option<unsafe extern "C" fn(instance: LV2_Handle, sample_count: u32)>,
+    /// Counterpart of `activate()`.
+    pub deactivate: Option<unsafe extern "C" fn(instance: LV2_Handle)>,
+    /// Destroy an instance.
+    pub cleanup: Option<unsafe extern "C" fn(instance: LV2_Handle)>,
+    /// Extension interfaces (none are provided).
+    pub extension_data: Option<unsafe extern "C" fn(uri: *const c_char) -> *const c_void>,
+}
+
+// =============================================================================
+// URID
+// =============================================================================
+
+/// Integer ID of a mapped URI.
+pub type LV2_URID = u32;
+
+/// Host URI → URID mapping feature (`urid:map`).
+#[repr(C)]
+pub struct LV2_URID_Map {
+    /// Host data passed to `map`.
+    pub handle: *mut c_void,
+    /// Map a URI to its ID (0 on failure).
+    pub map: Option<unsafe extern "C" fn(handle: *mut c_void, uri: *const c_char) -> LV2_URID>,
+}
+
+// =============================================================================
+// Atom
+// =============================================================================
+
+/// Atom header.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct LV2_Atom {
+    /// Body size in bytes (header excluded).
+    pub size: u32,
+    /// Body type URID.
+    pub type_: u32,
+}
+
+/// Sequence body header.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct LV2_Atom_Sequence_Body {
+    /// Time stamp unit URID (0 = frames).
+    pub unit: u32,
+    /// Padding.
+    pub pad: u32,
+}
+
+/// Atom sequence (events follow the header).
+#[repr(C)]
+pub struct LV2_Atom_Sequence {
+    /// Atom header.
+    pub atom: LV2_Atom,
+    /// Sequence header.
+    pub body: LV2_Atom_Sequence_Body,
+}
+
+/// Sequence event header (the body atom's data follows).
+#[repr(C)]
+pub struct LV2_Atom_Event {
+    /// Time stamp in audio frames.
+    pub frames: i64,
+    /// Event body header.
+    pub body: LV2_Atom,
+}
+
+/// Object body header (properties follow).
+#[repr(C)]
+pub struct LV2_Atom_Object_Body {
+    /// Object ID URID (0 = blank).
+    pub id: u32,
+    /// Object type URID.
+    pub otype: u32,
+}
+
+/// Object property header (the value atom's data follows).
+#[repr(C)]
+pub struct LV2_Atom_Property_Body {
+    /// Property key URID.
+    pub key: u32,
+    /// Context URID (unused, 0).
+    pub context: u32,
+    /// Value header.
+    pub value: LV2_Atom,
+}
+
+/// Round an atom size up to the 64-bit alignment of atom containers.
+#[inline]
+pub const fn atom_pad_size(size: u32) -> u32 {
+    (size + 7) & !7
+}
+
+// =============================================================================
+// Options
+// =============================================================================
+
+/// Host option (`opts:options` feature is a null-terminated array of these).
+#[repr(C)]
+pub struct LV2_Options_Option {
+    /// Option context (instance, resource, blank or port).
+    pub context: u32,
+    /// Subject URID or port index.
+    pub subject: u32,
+    /// Option key URID.
+    pub key: LV2_URID,
+    /// Value size in bytes.
+    pub size: u32,
+    /// Value type URID.
+    pub type_: LV2_URID,
+    /// Value data.
+    pub value: *const c_void,
+}
+
+// =============================================================================
+// URIs
+// =============================================================================
+
+/// `urid:map` feature.
+pub const LV2_URID__map: &CStr = c"http://lv2plug.in/ns/ext/urid#map";
+/// `opts:options` feature.
+pub const LV2_OPTIONS__options: &CStr = c"http://lv2plug.in/ns/ext/options#options";
+/// `bufsz:maxBlockLength` option.
+pub const LV2_BUF_SIZE__maxBlockLength: &CStr = c"http://lv2plug.in/ns/ext/buf-size#maxBlockLength";
+
+/// `atom:Sequence`.
+pub const LV2_ATOM__Sequence: &CStr = c"http://lv2plug.in/ns/ext/atom#Sequence";
+/// `atom:Object`.
+pub const LV2_ATOM__Object: &CStr = c"http://lv2plug.in/ns/ext/atom#Object";
+/// `atom:Blank` (deprecated object type some hosts still send).
+pub const LV2_ATOM__Blank: &CStr = c"http://lv2plug.in/ns/ext/atom#Blank";
+/// `atom:Float`.
+pub const LV2_ATOM__Float: &CStr = c"http://lv2plug.in/ns/ext/atom#Float";
+/// `atom:Double`.
+pub const LV2_ATOM__Double: &CStr = c"http://lv2plug.in/ns/ext/atom#Double";
+/// `atom:Int`.
+pub const LV2_ATOM__Int: &CStr = c"http://lv2plug.in/ns/ext/atom#Int";
+/// `atom:Long`.
+pub const LV2_ATOM__Long: &CStr = c"http://lv2plug.in/ns/ext/atom#Long";
+/// `atom:URID`.
+pub const LV2_ATOM__URID: &CStr = c"http://lv2plug.in/ns/ext/atom#URID";
+/// `midi:MidiEvent`.
+pub const LV2_MIDI__MidiEvent: &CStr = c"http://lv2plug.in/ns/ext/midi#MidiEvent";
+/// `patch:Set`.
+pub const LV2_PATCH__Set: &CStr = c"http://lv2plug.in/ns/ext/patch#Set";
+/// `patch:property`.
+pub const LV2_PATCH__property: &CStr = c"http://lv2plug.in/ns/ext/patch#property";
+/// `patch:value`.
+pub const LV2_PATCH__value: &CStr = c"http://lv2plug.in/ns/ext/patch#value";
+/// `time:Position`.
+pub const LV2_TIME__Position: &CStr = c"http://lv2plug.in/ns/ext/time#Position";
+/// `time:frame`.
+pub const LV2_TIME__frame: &CStr = c"http://lv2plug.in/ns/ext/time#frame";
+/// `time:speed`.
+pub const LV2_TIME__speed: &CStr = c"http://lv2plug.in/ns/ext/time#speed";
+/// `time:beatsPerMinute`.
+pub const LV2_TIME__beatsPerMinute: &CStr = c"http://lv2plug.in/ns/ext/time#beatsPerMinute";
+/// `time:beatsPerBar`.
+pub const LV2_TIME__beatsPerBar: &CStr = c"http://lv2plug.in/ns/ext/time#beatsPerBar";
+/// `time:beatUnit`.
+pub const LV2_TIME__beatUnit: &CStr = c"http://lv2plug.in/ns/ext/time#beatUnit";
+/// `time:bar`.
+pub const LV2_TIME__bar: &CStr = c"http://lv2plug.in/ns/ext/time#bar";
+/// `time:barBeat`.
+pub const LV2_TIME__barBeat: &CStr = c"http://lv2plug.in/ns/ext/time#barBeat";
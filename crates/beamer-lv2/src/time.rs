@@ -0,0 +1,133 @@
+//! Host transport from `time:Position` objects.
+//!
+//! LV2 hosts send a position object only when the transport changes (start,
+//! stop, locate, tempo change), not every `run()`. [`TimePosition`] keeps the
+//! last one and advances it by the processed frames in between, so every
+//! block gets a complete [`Transport`].
+
+use beamer_core::Transport;
+
+/// Last known host position, in the units of the `time:` vocabulary.
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct TimePosition {
+    /// `time:frame`: timeline position in frames.
+    pub frame: Option<i64>,
+    /// `time:speed`: 1.0 while playing, 0.0 while stopped.
+    pub speed: Option<f64>,
+    /// `time:beatsPerMinute`.
+    pub beats_per_minute: Option<f64>,
+    /// `time:beatsPerBar`.
+    pub beats_per_bar: Option<f64>,
+    /// `time:beatUnit` (4 = quarter note).
+    pub beat_unit: Option<i32>,
+    /// `time:bar`: bar index from the start of the timeline.
+    pub bar: Option<i64>,
+    /// `time:barBeat`: beats since the start of `bar`.
+    pub bar_beat: Option<f64>,
+}
+
+impl TimePosition {
+    /// Transport for the frame `offset` frames after the current position.
+    ///
+    /// Musical positions are converted to quarter notes, as in [`Transport`].
+    pub fn transport(&self, offset: usize, sample_rate: f64) -> Transport {
+        let speed = self.speed.unwrap_or(0.0);
+        let elapsed_frames = offset as f64 * speed;
+        let elapsed_beats = self.beats_in(elapsed_frames, sample_rate);
+        let quarters_per_beat = self.beat_unit.filter(|&u| u > 0).map_or(1.0, |u| 4.0 / u as f64);
+
+        // Beats from the start of the timeline, in the host's beat unit
+        let timeline_beats = match (self.bar, self.bar_beat, self.beats_per_bar) {
+            (Some(bar), Some(bar_beat), Some(per_bar)) => Some(bar as f64 * per_bar + bar_beat + elapsed_beats),
+            _ => None,
+        };
+
+        Transport {
+            tempo: self.beats_per_minute,
+            time_sig_numerator: self.beats_per_bar.map(|b| b.round() as i32),
+            time_sig_denominator: self.beat_unit,
+            project_time_samples: self.frame.map(|f| f + elapsed_frames as i64),
+            project_time_beats: timeline_beats.map(|b| b * quarters_per_beat),
+            bar_position_beats: timeline_beats
+                .zip(self.beats_per_bar.filter(|&b| b > 0.0))
+                .map(|(b, per_bar)| (b / per_bar).floor() * per_bar * quarters_per_beat),
+            is_playing: speed != 0.0,
+            ..Transport::default()
+        }
+    }
+
+    /// Advance the position by `frames` processed at the current speed.
+    pub fn advance(&mut self, frames: usize, sample_rate: f64) {
+        let elapsed_frames = frames as f64 * self.speed.unwrap_or(0.0);
+        if elapsed_frames == 0.0 {
+            return;
+        }
+        if let Some(frame) = &mut self.frame {
+            *frame += elapsed_frames as i64;
+        }
+        let elapsed_beats = self.beats_in(elapsed_frames, sample_rate);
+        if let (Some(bar), Some(bar_beat)) = (&mut self.bar, &mut self.bar_beat) {
+            *bar_beat += elapsed_beats;
+            if let Some(per_bar) = self.beats_per_bar.filter(|&b| b > 0.0) {
+                let bars = (*bar_beat / per_bar).floor();
+                *bar += bars as i64;
+                *bar_beat -= bars * per_bar;
+            }
+        }
+    }
+
+    /// Host beats spanned by `frames`.
+    #[inline]
+    fn beats_in(&self, frames: f64, sample_rate: f64) -> f64 {
+        match self.beats_per_minute {
+            Some(bpm) if sample_rate > 0.0 => frames * bpm / (60.0 * sample_rate),
+            _ => 0.0,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn playing() -> TimePosition {
+        TimePosition {
+            frame: Some(0),
+            speed: Some(1.0),
+            beats_per_minute: Some(120.0),
+            beats_per_bar: Some(6.0),
+            beat_unit: Some(8),
+            bar: Some(1),
+            bar_beat: Some(5.0),
+        }
+    }
+
+    #[test]
+    fn test_transport_in_quarter_notes() {
+        let transport = playing().transport(0, 48000.0);
+        assert!(transport.is_playing);
+        assert_eq!(transport.time_signature(), Some((6, 8)));
+        // Bar 1 beat 5 in eighths = 11 eighths = 5.5 quarters
+        assert_eq!(transport.project_time_beats, Some(5.5));
+        assert_eq!(transport.bar_position_beats, Some(3.0));
+
+        // 120 eighths per minute: 24000 frames = one eighth later
+        let later = playing().transport(24000, 48000.0);
+        assert_eq!(later.project_time_samples, Some(24000));
+        assert_eq!(later.project_time_beats, Some(6.0));
+        assert_eq!(later.bar_position_beats, Some(6.0));
+    }
+
+    #[test]
+    fn test_advance_wraps_bars() {
+        let mut position = playing();
+        position.advance(24000, 48000.0);
+        assert_eq!((position.bar, position.bar_beat, position.frame), (Some(2), Some(0.0), Some(24000)));
+
+        // Stopped transport doesn't move
+        position.speed = Some(0.0);
+        position.advance(24000, 48000.0);
+        assert_eq!(position.frame, Some(24000));
+        assert!(!position.transport(0, 48000.0).is_playing);
+    }
+}
@@ -0,0 +1,279 @@
+//! Turtle (TTL) generation for LV2 bundles.
+//!
+//! An LV2 bundle is a directory with `manifest.ttl` (plugin URI → binary and
+//! data file) and the plugin's data file (name, class, features, ports).
+//! Both are generated from the same [`PortLayout`] the runtime wrapper uses,
+//! so port indices can never drift from the binary. The bundler (`cargo xtask
+//! bundle --lv2`) loads the built library and calls the functions exported
+//! by [`export_lv2!`](crate::export_lv2) to write them.
+
+use std::fmt::Write;
+
+use beamer_core::{AudioProcessor, ParameterInfo, ParameterStore, Plugin, PluginConfig};
+
+use crate::config::Lv2Config;
+use crate::ports::{parameter_symbol, PortKind, PortLayout};
+
+/// Prefixes used by the plugin data file.
+const PREFIXES: &str = "\
+@prefix atom: <http://lv2plug.in/ns/ext/atom#> .
+@prefix bufsz: <http://lv2plug.in/ns/ext/buf-size#> .
+@prefix doap: <http://usefulinc.com/ns/doap#> .
+@prefix foaf: <http://xmlns.com/foaf/0.1/> .
+@prefix lv2: <http://lv2plug.in/ns/lv2core#> .
+@prefix midi: <http://lv2plug.in/ns/ext/midi#> .
+@prefix opts: <http://lv2plug.in/ns/ext/options#> .
+@prefix patch: <http://lv2plug.in/ns/ext/patch#> .
+@prefix pprops: <http://lv2plug.in/ns/ext/port-props#> .
+@prefix rdf: <http://www.w3.org/1999/02/22-rdf-syntax-ns#> .
+@prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .
+@prefix time: <http://lv2plug.in/ns/ext/time#> .
+@prefix urid: <http://lv2plug.in/ns/ext/urid#> .
+";
+
+/// Generate `manifest.ttl`.
+///
+/// `binary` is the library file name and `data_file` the plugin data file
+/// name, both relative to the bundle directory.
+pub fn manifest_ttl(lv2_config: &Lv2Config, binary: &str, data_file: &str) -> String {
+    format!(
+        "@prefix lv2: <http://lv2plug.in/ns/lv2core#> .\n\
+         @prefix rdfs: <http://www.w3.org/2000/01/rdf-schema#> .\n\
+         \n\
+         <{}>\n    a lv2:Plugin ;\n    lv2:binary <{}> ;\n    rdfs:seeAlso <{}> .\n",
+        lv2_config.uri_str(),
+        binary,
+        data_file
+    )
+}
+
+/// Generate the plugin data file for `P`.
+pub fn plugin_ttl<P: Plugin>(config: &PluginConfig, lv2_config: &Lv2Config) -> String {
+    let plugin = P::default();
+    let parameters = plugin.parameters();
+    let layout = PortLayout::from_plugin(&plugin);
+    let capabilities = P::Processor::CAPABILITIES;
+    let uri = lv2_config.uri_str();
+
+    let mut ttl = String::from(PREFIXES);
+
+    // Parameters addressable by patch:Set (sample-accurate automation)
+    let parameter_infos: Vec<&ParameterInfo> = (0..parameters.count()).filter_map(|i| parameters.info(i)).collect();
+    for info in &parameter_infos {
+        let (default, minimum, maximum) = plain_range(parameters, info);
+        let _ = write!(
+            ttl,
+            "\n<{}#{}>\n    a lv2:Parameter ;\n    rdfs:label \"{}\" ;\n    rdfs:range atom:Float ;\n    \
+             lv2:default {:?} ;\n    lv2:minimum {:?} ;\n    lv2:maximum {:?} .\n",
+            uri,
+            parameter_symbol(info.id),
+            escape(info.name),
+            default,
+            minimum,
+            maximum
+        );
+    }
+
+    // Plugin
+    let _ = write!(ttl, "\n<{}>\n    a lv2:Plugin", uri);
+    for class in plugin_classes(config) {
+        let _ = write!(ttl, ", lv2:{}", class);
+    }
+    let _ = write!(ttl, " ;\n    doap:name \"{}\" ;\n", escape(config.name));
+    let _ = writeln!(ttl, "    doap:release [ doap:revision \"{}\" ] ;", escape(config.version));
+    let _ = write!(ttl, "    doap:maintainer [\n        foaf:name \"{}\"", escape(config.vendor));
+    if !config.url.is_empty() {
+        let _ = write!(ttl, " ;\n        foaf:homepage <{}>", config.url);
+    }
+    if !config.email.is_empty() {
+        let _ = write!(ttl, " ;\n        foaf:mbox <mailto:{}>", config.email);
+    }
+    ttl.push_str("\n    ] ;\n");
+    ttl.push_str("    lv2:requiredFeature urid:map ;\n");
+    ttl.push_str("    lv2:optionalFeature lv2:hardRTCapable, opts:options, bufsz:boundedBlockLength ;\n");
+    ttl.push_str("    opts:supportedOption bufsz:maxBlockLength ;\n");
+    if !parameter_infos.is_empty() {
+        ttl.push_str("    patch:writable ");
+        for (i, info) in parameter_infos.iter().enumerate() {
+            let separator = if i == 0 { "" } else { ",\n        " };
+            let _ = write!(ttl, "{}<{}#{}>", separator, uri, parameter_symbol(info.id));
+        }
+        ttl.push_str(" ;\n");
+    }
+
+    // Ports
+    ttl.push_str("    lv2:port ");
+    for (i, port) in layout.ports().iter().enumerate() {
+        if i > 0 {
+            ttl.push_str(", ");
+        }
+        let _ = write!(
+            ttl,
+            "[\n        lv2:index {} ;\n        lv2:symbol \"{}\" ;\n        lv2:name \"{}\" ;\n",
+            port.index,
+            port.symbol,
+            escape(&port.name)
+        );
+        match port.kind {
+            PortKind::AudioInput { bus, .. } => {
+                ttl.push_str("        a lv2:AudioPort, lv2:InputPort");
+                if bus > 0 {
+                    ttl.push_str(" ;\n        lv2:portProperty lv2:isSideChain");
+                }
+            }
+            PortKind::AudioOutput { bus, .. } => {
+                ttl.push_str("        a lv2:AudioPort, lv2:OutputPort");
+                if bus > 0 {
+                    ttl.push_str(" ;\n        lv2:portProperty lv2:isSideChain");
+                }
+            }
+            PortKind::Control => {
+                ttl.push_str("        a atom:AtomPort, lv2:InputPort ;\n        atom:bufferType atom:Sequence ;\n");
+                ttl.push_str("        atom:supports patch:Message");
+                if capabilities.processes_midi() {
+                    ttl.push_str(", midi:MidiEvent");
+                }
+                if capabilities.transport {
+                    ttl.push_str(", time:Position");
+                }
+                ttl.push_str(" ;\n        lv2:designation lv2:control");
+            }
+            PortKind::Notify => {
+                ttl.push_str("        a atom:AtomPort, lv2:OutputPort ;\n        atom:bufferType atom:Sequence ;\n");
+                ttl.push_str("        atom:supports midi:MidiEvent");
+            }
+            PortKind::Parameter { index, .. } => {
+                if let Some(info) = parameters.info(index) {
+                    write_control_port(&mut ttl, parameters, info);
+                }
+            }
+        }
+        ttl.push_str(" ;\n    ]");
+    }
+    ttl.push_str(" .\n");
+    ttl
+}
+
+/// Properties of a parameter control port (after index, symbol and name).
+fn write_control_port<S: ParameterStore + ?Sized>(ttl: &mut String, parameters: &S, info: &ParameterInfo) {
+    let (default, minimum, maximum) = plain_range(parameters, info);
+    let _ = write!(
+        ttl,
+        "        a lv2:ControlPort, lv2:InputPort ;\n        \
+         lv2:default {:?} ;\n        lv2:minimum {:?} ;\n        lv2:maximum {:?}",
+        default, minimum, maximum
+    );
+    if !info.units.is_empty() {
+        let _ = write!(ttl, " ;\n        rdfs:comment \"{}\"", escape(info.units));
+    }
+    if info.step_count == 1 {
+        ttl.push_str(" ;\n        lv2:portProperty lv2:toggled");
+    } else if info.step_count > 1 {
+        ttl.push_str(" ;\n        lv2:portProperty lv2:integer");
+        if info.flags.is_list {
+            ttl.push_str(", lv2:enumeration");
+            for step in 0..=info.step_count {
+                let normalized = step as f64 / info.step_count as f64;
+                let _ = write!(
+                    ttl,
+                    " ;\n        lv2:scalePoint [ rdfs:label \"{}\" ; rdf:value {:?} ]",
+                    escape(&parameters.normalized_to_string(info.id, normalized)),
+                    parameters.normalized_to_plain(info.id, normalized)
+                );
+            }
+        }
+    }
+    if info.flags.is_hidden {
+        ttl.push_str(" ;\n        lv2:portProperty pprops:notOnGUI");
+    }
+    if !info.flags.can_automate {
+        ttl.push_str(" ;\n        lv2:portProperty pprops:notAutomatic");
+    }
+}
+
+/// `(default, minimum, maximum)` of a parameter in plain units.
+fn plain_range<S: ParameterStore + ?Sized>(parameters: &S, info: &ParameterInfo) -> (f64, f64, f64) {
+    let a = parameters.normalized_to_plain(info.id, 0.0);
+    let b = parameters.normalized_to_plain(info.id, 1.0);
+    (
+        parameters.normalized_to_plain(info.id, info.default_normalized),
+        a.min(b),
+        a.max(b),
+    )
+}
+
+/// LV2 plugin classes for the category and sub-categories.
+fn plugin_classes(config: &PluginConfig) -> Vec<&'static str> {
+    let mut classes = Vec::new();
+    let mapped = config
+        .category
+        .split('|')
+        .chain(config.sub_categories.split('|'))
+        .filter_map(|category| match category.trim() {
+            "Instrument" | "Synth" | "Sampler" => Some("InstrumentPlugin"),
+            "Delay" => Some("DelayPlugin"),
+            "Reverb" => Some("ReverbPlugin"),
+            "Dynamics" => Some("DynamicsPlugin"),
+            "Compressor" => Some("CompressorPlugin"),
+            "Limiter" => Some("LimiterPlugin"),
+            "Gate" => Some("GatePlugin"),
+            "Expander" => Some("ExpanderPlugin"),
+            "EQ" => Some("EQPlugin"),
+            "Filter" => Some("FilterPlugin"),
+            "Distortion" => Some("DistortionPlugin"),
+            "Modulation" => Some("ModulatorPlugin"),
+            "Chorus" => Some("ChorusPlugin"),
+            "Flanger" => Some("FlangerPlugin"),
+            "Phaser" => Some("PhaserPlugin"),
+            "Pitch Shift" => Some("PitchPlugin"),
+            "Spatial" | "Surround" => Some("SpatialPlugin"),
+            "Analyzer" => Some("AnalyserPlugin"),
+            "Generator" => Some("GeneratorPlugin"),
+            "Tools" => Some("UtilityPlugin"),
+            _ => None,
+        });
+    for class in mapped {
+        if !classes.contains(&class) {
+            classes.push(class);
+        }
+    }
+    classes
+}
+
+/// Escape a string literal for Turtle.
+fn escape(s: &str) -> String {
+    let mut escaped = String::with_capacity(s.len());
+    for c in s.chars() {
+        match c {
+            '"' => escaped.push_str("\\\""),
+            '\\' => escaped.push_str("\\\\"),
+            '\n' => escaped.push_str("\\n"),
+            '\r' => escaped.push_str("\\r"),
+            c => escaped.push(c),
+        }
+    }
+    escaped
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_manifest() {
+        let config = Lv2Config::new(c"https://example.com/plugins/test");
+        let manifest = manifest_ttl(&config, "libtest.so", "test.ttl");
+        assert!(manifest.contains("<https://example.com/plugins/test>\n    a lv2:Plugin ;"));
+        assert!(manifest.contains("lv2:binary <libtest.so> ;"));
+        assert!(manifest.contains("rdfs:seeAlso <test.ttl> ."));
+    }
+
+    #[test]
+    fn test_classes_and_escape() {
+        let config = PluginConfig::new("Test").with_category("Fx").with_sub_categories("Fx|Dynamics|Compressor");
+        assert_eq!(plugin_classes(&config), ["DynamicsPlugin", "CompressorPlugin"]);
+        let config = PluginConfig::new("Test").with_category("Instrument").with_sub_categories("Instrument|Synth");
+        assert_eq!(plugin_classes(&config), ["InstrumentPlugin"]);
+        assert_eq!(escape("a \"b\"\\"), "a \\\"b\\\"\\\\");
+    }
+}
@@ -6,6 +6,7 @@
 use proc_macro2::TokenStream;
 use quote::quote;
 
+use beamer_utils::fnv1a_32;
 use crate::ir::{
     FieldIR, ParameterDefault, ParameterFieldIR, ParameterKind, ParametersIR, SmoothingStyle,
 };
@@ -13,6 +14,7 @@ use crate::ir::{
 /// Generate all code for the derive macro.
 pub fn generate(ir: &ParametersIR) -> TokenStream {
     let const_ids = generate_const_ids(ir);
+    let array_tables = generate_array_tables(ir);
     let unit_consts = generate_group_consts(ir);
     let collision_check = generate_collision_check(ir);
     let units_impl = generate_groups_impl(ir);
@@ -23,6 +25,7 @@ pub fn generate(ir: &ParametersIR) -> TokenStream {
 
     quote! {
         #const_ids
+        #array_tables
         #unit_consts
         #collision_check
         #units_impl
@@ -59,6 +62,44 @@ fn generate_const_ids(ir: &ParametersIR) -> TokenStream {
     }
 }
 
+/// Generate the static per-element tables for `#[nested]` array fields.
+///
+/// Each array gets three `N`-entry tables (DAW group names, state path keys
+/// and ID salts) that the generated methods index in loops, so the expansion
+/// grows with the number of fields rather than the number of elements.
+fn generate_array_tables(ir: &ParametersIR) -> TokenStream {
+    let struct_name = &ir.struct_name;
+    let (impl_generics, ty_generics, where_clause) = ir.generics.split_for_impl();
+
+    let tables: Vec<TokenStream> = ir
+        .nested_array_fields()
+        .map(|nested| {
+            let len = nested.group_count();
+            let names: Vec<String> = (0..len).map(|i| nested.element_group_name(i)).collect();
+            let keys: Vec<String> = (0..len).map(|i| nested.element_key(i)).collect();
+            let salts: Vec<u32> = keys.iter().map(|key| fnv1a_32(key)).collect();
+            let names_const = nested.table_const("GROUP_NAMES");
+            let keys_const = nested.table_const("PATH_KEYS");
+            let salts_const = nested.table_const("ID_SALTS");
+            quote! {
+                const #names_const: [&'static str; #len] = [#(#names),*];
+                const #keys_const: [&'static str; #len] = [#(#keys),*];
+                const #salts_const: [u32; #len] = [#(#salts),*];
+            }
+        })
+        .collect();
+
+    if tables.is_empty() {
+        quote! {}
+    } else {
+        quote! {
+            impl #impl_generics #struct_name #ty_generics #where_clause {
+                #(#tables)*
+            }
+        }
+    }
+}
+
 /// Generate group ID constants for each nested field and flat group.
 fn generate_group_consts(ir: &ParametersIR) -> TokenStream {
     let struct_name = &ir.struct_name;
@@ -82,19 +123,22 @@ fn generate_group_consts(ir: &ParametersIR) -> TokenStream {
         })
         .collect();
 
-    // Nested groups get IDs after flat groups
-    let flat_group_count = flat_groups.len() as i32;
+    // Nested groups get IDs after flat groups (assigned during parsing)
     let nested_consts: Vec<TokenStream> = ir
         .nested_fields()
-        .enumerate()
-        .map(|(idx, nested)| {
+        .map(|nested| {
             let const_name = syn::Ident::new(
                 &format!("GROUP_{}", nested.field_name.to_string().to_uppercase()),
                 nested.span,
             );
-            let group_id = flat_group_count + (idx as i32) + 1;
+            let group_id = nested.group_id;
+            let doc = if nested.array_len.is_some() {
+                quote! { #[doc = "Group ID of the first element of the nested parameter group array."] }
+            } else {
+                quote! { #[doc = "Group ID for the nested parameter group."] }
+            };
             quote! {
-                /// Group ID for the nested parameter group.
+                #doc
                 pub const #const_name: ::beamer::core::parameter_groups::GroupId = #group_id;
             }
         })
@@ -260,6 +304,10 @@ fn generate_set_group_ids(ir: &ParametersIR) -> TokenStream {
             use ::beamer::core::parameter_types::Parameters;
             // Nested groups start after flat groups
             self.assign_group_ids(#flat_group_count + 1, 0);
+            // Give array elements their unique parameter IDs, then check
+            // them: salted IDs can't be checked at compile time
+            self.salt_ids(0);
+            ::beamer::core::parameter_types::assert_unique_ids(self, stringify!(#struct_name));
         }
     } else {
         quote! {}
@@ -346,9 +394,11 @@ fn generate_parameters_impl(ir: &ParametersIR) -> TokenStream {
     let save_state_impl = generate_save_state(ir);
     let load_state_impl = generate_load_state(ir);
     let set_all_group_ids_impl = generate_set_all_group_ids(ir);
+    let salt_ids_impl = generate_salt_ids(ir);
     let nested_discovery_impl = generate_nested_discovery(ir);
     let set_sample_rate_impl = generate_set_sample_rate(ir);
     let reset_smoothing_impl = generate_reset_smoothing(ir);
+    let for_each_smoothed_impl = generate_for_each_smoothed(ir);
 
     quote! {
         impl #impl_generics ::beamer::core::parameter_types::Parameters for #struct_name #ty_generics #where_clause {
@@ -370,6 +420,8 @@ fn generate_parameters_impl(ir: &ParametersIR) -> TokenStream {
 
             #set_all_group_ids_impl
 
+            #salt_ids_impl
+
             #nested_discovery_impl
 
             #save_state_impl
@@ -379,6 +431,8 @@ fn generate_parameters_impl(ir: &ParametersIR) -> TokenStream {
             #set_sample_rate_impl
 
             #reset_smoothing_impl
+
+            #for_each_smoothed_impl
         }
     }
 }
@@ -408,41 +462,98 @@ fn generate_set_all_group_ids(ir: &ParametersIR) -> TokenStream {
     }
 }
 
-/// Generate the nested group discovery methods for the Parameters trait.
-fn generate_nested_discovery(ir: &ParametersIR) -> TokenStream {
-    if !ir.has_nested() {
-        // No nested fields = use default implementations (return 0/None)
+/// Generate the `salt_ids()` method for the Parameters trait.
+///
+/// Direct parameters get their declared ID XOR the salt. Single nested
+/// structs inherit the salt; array elements add their own from the table.
+fn generate_salt_ids(ir: &ParametersIR) -> TokenStream {
+    if !ir.has_nested() && ir.parameter_count() == 0 {
         return quote! {};
     }
 
-    let nested_count = ir.nested_fields().count();
+    let struct_name = &ir.struct_name;
 
-    // Generate match arms for nested_group()
-    let group_match_arms: Vec<TokenStream> = ir
-        .nested_fields()
-        .enumerate()
-        .map(|(idx, nested)| {
-            let field = &nested.field_name;
-            let name = &nested.group_name;
+    let parameter_ids: Vec<TokenStream> = ir
+        .parameter_fields()
+        .map(|parameter| {
+            let field = &parameter.field_name;
+            let const_name = parameter.const_name();
             quote! {
-                #idx => Some((#name, &self.#field as &dyn ::beamer::core::parameter_types::Parameters)),
+                self.#field.set_id(#struct_name::#const_name ^ salt);
             }
         })
         .collect();
 
-    // Generate match arms for nested_group_mut()
-    let group_mut_match_arms: Vec<TokenStream> = ir
+    let nested_ids: Vec<TokenStream> = ir
         .nested_fields()
-        .enumerate()
-        .map(|(idx, nested)| {
+        .map(|nested| {
             let field = &nested.field_name;
-            let name = &nested.group_name;
-            quote! {
-                #idx => Some((#name, &mut self.#field as &mut dyn ::beamer::core::parameter_types::Parameters)),
+            if nested.array_len.is_some() {
+                let salts_const = nested.table_const("ID_SALTS");
+                quote! {
+                    for (element, element_salt) in self.#field.iter_mut().zip(Self::#salts_const) {
+                        ::beamer::core::parameter_types::Parameters::salt_ids(element, salt ^ element_salt);
+                    }
+                }
+            } else {
+                quote! {
+                    ::beamer::core::parameter_types::Parameters::salt_ids(&mut self.#field, salt);
+                }
             }
         })
         .collect();
 
+    quote! {
+        fn salt_ids(&mut self, salt: ::beamer::core::types::ParameterId) {
+            #(#parameter_ids)*
+            #(#nested_ids)*
+        }
+    }
+}
+
+/// Generate the nested group discovery methods for the Parameters trait.
+fn generate_nested_discovery(ir: &ParametersIR) -> TokenStream {
+    if !ir.has_nested() {
+        // No nested fields = use default implementations (return 0/None)
+        return quote! {};
+    }
+
+    let nested_count = ir.nested_group_count();
+
+    // Generate match arms for nested_group() and nested_group_mut(). An array
+    // field covers a range of indices and looks up its element in the tables.
+    let mut group_match_arms = Vec::new();
+    let mut group_mut_match_arms = Vec::new();
+    let mut start = 0usize;
+    for nested in ir.nested_fields() {
+        let field = &nested.field_name;
+        if nested.array_len.is_some() {
+            let end = start + nested.group_count() - 1;
+            let names_const = nested.table_const("GROUP_NAMES");
+            group_match_arms.push(quote! {
+                #start..=#end => Some((
+                    Self::#names_const[index - #start],
+                    &self.#field[index - #start] as &dyn ::beamer::core::parameter_types::Parameters,
+                )),
+            });
+            group_mut_match_arms.push(quote! {
+                #start..=#end => Some((
+                    Self::#names_const[index - #start],
+                    &mut self.#field[index - #start] as &mut dyn ::beamer::core::parameter_types::Parameters,
+                )),
+            });
+        } else {
+            let name = &nested.group_name;
+            group_match_arms.push(quote! {
+                #start => Some((#name, &self.#field as &dyn ::beamer::core::parameter_types::Parameters)),
+            });
+            group_mut_match_arms.push(quote! {
+                #start => Some((#name, &mut self.#field as &mut dyn ::beamer::core::parameter_types::Parameters)),
+            });
+        }
+        start += nested.group_count();
+    }
+
     quote! {
         fn nested_count(&self) -> usize {
             #nested_count
@@ -474,7 +585,13 @@ fn generate_count(ir: &ParametersIR) -> TokenStream {
             .map(|nested| {
                 let field = &nested.field_name;
                 // Use fully qualified syntax to disambiguate between Parameters::count and Parameters::count
-                quote! { ::beamer::core::parameter_types::Parameters::count(&self.#field) }
+                if nested.array_len.is_some() {
+                    quote! {
+                        self.#field.iter().map(|element| ::beamer::core::parameter_types::Parameters::count(element)).sum::<usize>()
+                    }
+                } else {
+                    quote! { ::beamer::core::parameter_types::Parameters::count(&self.#field) }
+                }
             })
             .collect();
 
@@ -496,35 +613,34 @@ fn generate_iter(ir: &ParametersIR) -> TokenStream {
         })
         .collect();
 
-    let nested_chains: Vec<TokenStream> = ir
+    let nested_iters: Vec<TokenStream> = ir
         .nested_fields()
         .map(|nested| {
             let field = &nested.field_name;
-            quote! { .chain(self.#field.iter()) }
+            if nested.array_len.is_some() {
+                quote! {
+                    self.#field.iter().flat_map(|element| ::beamer::core::parameter_types::Parameters::iter(element))
+                }
+            } else {
+                quote! { self.#field.iter() }
+            }
         })
         .collect();
 
-    if parameter_iters.is_empty() && nested_chains.is_empty() {
+    if parameter_iters.is_empty() && nested_iters.is_empty() {
         quote! { Box::new(::std::iter::empty()) }
     } else if parameter_iters.is_empty() {
         // Only nested fields
-        let first_nested = &ir.nested_fields().next().unwrap().field_name;
-        let rest_nested: Vec<TokenStream> = ir
-            .nested_fields()
-            .skip(1)
-            .map(|n| {
-                let field = &n.field_name;
-                quote! { .chain(self.#field.iter()) }
-            })
-            .collect();
+        let first_nested = &nested_iters[0];
+        let rest_nested = &nested_iters[1..];
         quote! {
-            Box::new(self.#first_nested.iter() #(#rest_nested)*)
+            Box::new(#first_nested #(.chain(#rest_nested))*)
         }
     } else {
         quote! {
             Box::new(
                 [#(#parameter_iters),*].into_iter()
-                    #(#nested_chains)*
+                    #(.chain(#nested_iters))*
             )
         }
     }
@@ -549,9 +665,21 @@ fn generate_by_id(ir: &ParametersIR) -> TokenStream {
         .nested_fields()
         .map(|nested| {
             let field = &nested.field_name;
-            quote! {
-                if let Some(parameter) = self.#field.by_id(id) {
-                    return Some(parameter);
+            if nested.array_len.is_some() {
+                // Undo each element's salt to get back to the declared ID
+                let salts_const = nested.table_const("ID_SALTS");
+                quote! {
+                    for (element, salt) in self.#field.iter().zip(Self::#salts_const) {
+                        if let Some(parameter) = ::beamer::core::parameter_types::Parameters::by_id(element, id ^ salt) {
+                            return Some(parameter);
+                        }
+                    }
+                }
+            } else {
+                quote! {
+                    if let Some(parameter) = self.#field.by_id(id) {
+                        return Some(parameter);
+                    }
                 }
             }
         })
@@ -604,6 +732,20 @@ fn generate_save_state(ir: &ParametersIR) -> TokenStream {
         .nested_fields()
         .map(|nested| {
             let field = &nested.field_name;
+            if nested.array_len.is_some() {
+                // Array elements use their path keys ("band0", "band1", ...)
+                let keys_const = nested.table_const("PATH_KEYS");
+                return quote! {
+                    for (element, key) in self.#field.iter().zip(Self::#keys_const) {
+                        let nested_prefix = if prefix.is_empty() {
+                            key.to_string()
+                        } else {
+                            format!("{}/{}", prefix, key)
+                        };
+                        ::beamer::core::parameter_types::Parameters::save_state_prefixed(element, data, &nested_prefix);
+                    }
+                };
+            }
             let group_name = &nested.group_name;
             quote! {
                 // Build nested prefix: prefix + "/" + group_name (or just group_name)
@@ -658,6 +800,7 @@ fn generate_load_state(ir: &ParametersIR) -> TokenStream {
     // Generate nested group routing - match group name and delegate rest of path
     let nested_routes: Vec<TokenStream> = ir
         .nested_fields()
+        .filter(|nested| nested.array_len.is_none())
         .map(|nested| {
             let field = &nested.field_name;
             let group_name = &nested.group_name;
@@ -671,13 +814,35 @@ fn generate_load_state(ir: &ParametersIR) -> TokenStream {
         })
         .collect();
 
-    let nested_routing = if nested_routes.is_empty() {
+    // Array elements: parse the index after the key prefix and check it
+    // against the key table instead of matching every element's key
+    let array_routes: Vec<TokenStream> = ir
+        .nested_array_fields()
+        .map(|nested| {
+            let field = &nested.field_name;
+            let key_base = nested.element_key_base();
+            let keys_const = nested.table_const("PATH_KEYS");
+            quote! {
+                if let Some(index) = group.strip_prefix(#key_base).and_then(|i| i.parse::<usize>().ok()) {
+                    if Self::#keys_const.get(index) == Some(&group) {
+                        ::beamer::core::parameter_types::Parameters::load_state_path(&mut self.#field[index], rest, value);
+                        return true;
+                    }
+                }
+            }
+        })
+        .collect();
+
+    let nested_routing = if nested_routes.is_empty() && array_routes.is_empty() {
         quote! { false }
     } else {
         quote! {
             match group {
                 #(#nested_routes)*
-                _ => false
+                _ => {
+                    #(#array_routes)*
+                    false
+                }
             }
         }
     };
@@ -862,6 +1027,17 @@ fn generate_info(ir: &ParametersIR) -> TokenStream {
             .map(|nested| {
                 let field = &nested.field_name;
                 // Use fully qualified syntax to disambiguate
+                if nested.array_len.is_some() {
+                    return quote! {
+                        for element in &self.#field {
+                            let nested_count = ::beamer::core::parameter_types::Parameters::count(element);
+                            if adjusted_index < nested_count {
+                                return ::beamer::core::parameter_store::ParameterStore::info(element, adjusted_index);
+                            }
+                            adjusted_index -= nested_count;
+                        }
+                    };
+                }
                 quote! {
                     let nested_count = ::beamer::core::parameter_types::Parameters::count(&self.#field);
                     if adjusted_index < nested_count {
@@ -914,7 +1090,15 @@ fn generate_set_sample_rate(ir: &ParametersIR) -> TokenStream {
         .nested_fields()
         .map(|nested| {
             let field = &nested.field_name;
-            quote! { self.#field.set_sample_rate(sample_rate); }
+            if nested.array_len.is_some() {
+                quote! {
+                    for element in &mut self.#field {
+                        ::beamer::core::parameter_types::Parameters::set_sample_rate(element, sample_rate);
+                    }
+                }
+            } else {
+                quote! { self.#field.set_sample_rate(sample_rate); }
+            }
         })
         .collect();
 
@@ -947,7 +1131,15 @@ fn generate_reset_smoothing(ir: &ParametersIR) -> TokenStream {
         .nested_fields()
         .map(|nested| {
             let field = &nested.field_name;
-            quote! { self.#field.reset_smoothing(); }
+            if nested.array_len.is_some() {
+                quote! {
+                    for element in &mut self.#field {
+                        ::beamer::core::parameter_types::Parameters::reset_smoothing(element);
+                    }
+                }
+            } else {
+                quote! { self.#field.reset_smoothing(); }
+            }
         })
         .collect();
 
@@ -964,6 +1156,47 @@ fn generate_reset_smoothing(ir: &ParametersIR) -> TokenStream {
     }
 }
 
+/// Generate the `for_each_smoothed()` method for the Parameters trait.
+fn generate_for_each_smoothed(ir: &ParametersIR) -> TokenStream {
+    // Generate calls for direct parameter fields
+    let parameter_calls: Vec<TokenStream> = ir
+        .parameter_fields()
+        .map(|parameter| {
+            let field = &parameter.field_name;
+            quote! { self.#field.for_each_smoothed(f); }
+        })
+        .collect();
+
+    // Generate calls for nested fields
+    let nested_calls: Vec<TokenStream> = ir
+        .nested_fields()
+        .map(|nested| {
+            let field = &nested.field_name;
+            if nested.array_len.is_some() {
+                quote! {
+                    for element in &self.#field {
+                        ::beamer::core::parameter_types::Parameters::for_each_smoothed(element, f);
+                    }
+                }
+            } else {
+                quote! { ::beamer::core::parameter_types::Parameters::for_each_smoothed(&self.#field, f); }
+            }
+        })
+        .collect();
+
+    if parameter_calls.is_empty() && nested_calls.is_empty() {
+        // No parameters = use default no-op
+        quote! {}
+    } else {
+        quote! {
+            fn for_each_smoothed(&self, f: &mut dyn FnMut(&::beamer::core::parameter_types::FloatParameter)) {
+                #(#parameter_calls)*
+                #(#nested_calls)*
+            }
+        }
+    }
+}
+
 // =============================================================================
 // Default Implementation Generation
 // =============================================================================
@@ -990,7 +1223,12 @@ fn generate_default_impl(ir: &ParametersIR) -> TokenStream {
             FieldIR::Parameter(p) => generate_parameter_initializer(p, struct_name),
             FieldIR::Nested(n) => {
                 let field = &n.field_name;
-                quote! { #field: Default::default() }
+                if n.array_len.is_some() {
+                    // `[T; N]: Default` only exists up to N = 32
+                    quote! { #field: ::std::array::from_fn(|_| Default::default()) }
+                } else {
+                    quote! { #field: Default::default() }
+                }
             }
         })
         .collect();
@@ -224,10 +224,41 @@ pub struct NestedFieldIR {
     pub group_id: i32,
     /// Parent group ID (0 for top-level, parent's group_id for nested-within-nested)
     pub parent_group_id: i32,
+    /// Element count for array fields (`[Band; 32]`), `None` for a single struct
+    pub array_len: Option<usize>,
     /// Span for error reporting
     pub span: Span,
 }
 
+impl NestedFieldIR {
+    /// Number of groups this field contributes (1 for a single struct).
+    pub fn group_count(&self) -> usize {
+        self.array_len.unwrap_or(1)
+    }
+
+    /// Path key prefix for array elements: the group name in lowercase with
+    /// spaces replaced by underscores (e.g., "Band" -> "band").
+    pub fn element_key_base(&self) -> String {
+        self.group_name.to_lowercase().replace(' ', "_")
+    }
+
+    /// Display name of array element `index` (1-based for the DAW, e.g., "Band 1").
+    pub fn element_group_name(&self, index: usize) -> String {
+        format!("{} {}", self.group_name, index + 1)
+    }
+
+    /// State path key of array element `index` (0-based like the array, e.g., "band0").
+    pub fn element_key(&self, index: usize) -> String {
+        format!("{}{}", self.element_key_base(), index)
+    }
+
+    /// Name of a generated per-element table constant (e.g., `BANDS_ID_SALTS`).
+    pub fn table_const(&self, table: &str) -> syn::Ident {
+        let name = self.field_name.to_string().to_uppercase();
+        syn::Ident::new(&format!("{}_{}", name, table), self.span)
+    }
+}
+
 /// The type of a parameter field.
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub enum ParameterType {
@@ -264,6 +295,16 @@ impl ParametersIR {
         self.nested_fields().next().is_some()
     }
 
+    /// Iterate over nested array fields.
+    pub fn nested_array_fields(&self) -> impl Iterator<Item = &NestedFieldIR> {
+        self.nested_fields().filter(|n| n.array_len.is_some())
+    }
+
+    /// Total number of direct nested groups, counting each array element.
+    pub fn nested_group_count(&self) -> usize {
+        self.nested_fields().map(NestedFieldIR::group_count).sum()
+    }
+
     /// Check if all parameter fields have complete declarative attributes.
     ///
     /// When true, the macro can generate a `Default` implementation.
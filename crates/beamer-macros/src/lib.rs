@@ -85,6 +85,8 @@ mod validate;
 ///
 /// ## Nested Groups
 /// - `#[nested(group = "...")]` - For fields containing nested parameter structs
+/// - `#[nested(group = "Band")]` on `[BandParameters; 32]` - One group per element
+///   ("Band 1", ...), state paths `band0/...`, IDs salted per element
 ///
 /// # Example
 ///
@@ -339,6 +339,9 @@ fn parse_smoothing_spec(meta: &syn::meta::ParseNestedMeta) -> syn::Result<Smooth
 }
 
 /// Parse a field with `#[nested(group = "...")]` attribute.
+///
+/// The field is either a single parameter struct or an array of them
+/// (`[Band; 32]`), which becomes one group per element.
 fn parse_nested_field(field: &Field, attr: &syn::Attribute) -> syn::Result<NestedFieldIR> {
     let field_name = field
         .ident
@@ -368,16 +371,51 @@ fn parse_nested_field(field: &Field, attr: &syn::Attribute) -> syn::Result<Neste
         )
     })?;
 
+    let array_len = parse_array_len(&field.ty)?;
+    if array_len.is_some() && group_name.contains('/') {
+        return Err(syn::Error::new_spanned(
+            attr,
+            format!(
+                "group name '{}' of array field `{}` cannot contain '/' (reserved for nested group path routing)",
+                group_name, field_name
+            ),
+        ));
+    }
+
     Ok(NestedFieldIR {
         field_name,
         field_type: field.ty.clone(),
         group_name,
         group_id: 0,         // Assigned later by assign_group_ids()
         parent_group_id: 0,  // Assigned later by assign_group_ids()
+        array_len,
         span: attr.path().segments[0].ident.span(),
     })
 }
 
+/// Get the length of an array-of-groups field (`[Band; 32]`).
+///
+/// Returns `None` for a single nested struct. The length must be an integer
+/// literal so the macro can emit the per-element tables.
+fn parse_array_len(ty: &syn::Type) -> syn::Result<Option<usize>> {
+    let syn::Type::Array(array) = ty else {
+        return Ok(None);
+    };
+    let len = match &array.len {
+        syn::Expr::Lit(syn::ExprLit { lit: syn::Lit::Int(int), .. }) => int.base10_parse::<usize>()?,
+        other => {
+            return Err(syn::Error::new_spanned(
+                other,
+                "#[nested] array length must be an integer literal",
+            ))
+        }
+    };
+    if len == 0 {
+        return Err(syn::Error::new_spanned(&array.len, "#[nested] array must have at least one element"));
+    }
+    Ok(Some(len))
+}
+
 /// Assign sequential group IDs to nested fields.
 ///
 /// Group 0 is reserved for root. Flat groups (via `group = "..."`) get IDs 1, 2, 3, ...
@@ -393,7 +431,7 @@ fn assign_group_ids(fields: &mut [FieldIR]) {
         if let FieldIR::Nested(nested) = field {
             nested.group_id = next_group_id;
             nested.parent_group_id = 0; // All top-level for now (recursive nesting is future work)
-            next_group_id += 1;
+            next_group_id += nested.group_count() as i32;
         }
     }
 }
@@ -0,0 +1,94 @@
+//! Allocation tracking for real-time safety checks.
+//!
+//! [`CountingAllocator`] wraps the system allocator and counts allocations
+//! made by the current thread while tracking is enabled. Install it in a test
+//! binary with [`install_counting_allocator!`](crate::install_counting_allocator):
+//!
+//! ```ignore
+//! beamer_test::install_counting_allocator!();
+//! ```
+//!
+//! Tracking is per thread, so tests running in parallel don't see each
+//! other's allocations.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::cell::Cell;
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// Set on the first allocation routed through [`CountingAllocator`].
+static INSTALLED: AtomicBool = AtomicBool::new(false);
+
+thread_local! {
+    static TRACKING: Cell<bool> = const { Cell::new(false) };
+    static COUNT: Cell<usize> = const { Cell::new(0) };
+}
+
+/// Global allocator that counts allocations on threads with tracking enabled.
+pub struct CountingAllocator;
+
+impl CountingAllocator {
+    #[inline]
+    fn record() {
+        INSTALLED.store(true, Ordering::Relaxed);
+        // `try_with` avoids panicking during thread-local teardown
+        let _ = TRACKING.try_with(|tracking| {
+            if tracking.get() {
+                let _ = COUNT.try_with(|count| count.set(count.get() + 1));
+            }
+        });
+    }
+}
+
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        Self::record();
+        System.alloc(layout)
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        Self::record();
+        System.alloc_zeroed(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        Self::record();
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+/// Install [`CountingAllocator`] as the global allocator of this binary.
+///
+/// Use once per test binary (e.g. at the top of a `#[cfg(test)]` module).
+#[macro_export]
+macro_rules! install_counting_allocator {
+    () => {
+        #[global_allocator]
+        static BEAMER_TEST_ALLOCATOR: $crate::CountingAllocator = $crate::CountingAllocator;
+    };
+}
+
+/// Whether [`CountingAllocator`] is the global allocator of this binary.
+pub fn allocation_tracking_installed() -> bool {
+    if !INSTALLED.load(Ordering::Relaxed) {
+        // Force one allocation through the global allocator to find out
+        drop(std::hint::black_box(Box::new(0u8)));
+    }
+    INSTALLED.load(Ordering::Relaxed)
+}
+
+/// Run `f` and count the allocations it makes on the current thread.
+///
+/// Returns `None` if [`CountingAllocator`] is not installed.
+pub fn count_allocations<R>(f: impl FnOnce() -> R) -> (R, Option<usize>) {
+    let installed = allocation_tracking_installed();
+    COUNT.with(|count| count.set(0));
+    TRACKING.with(|tracking| tracking.set(true));
+    let result = f();
+    TRACKING.with(|tracking| tracking.set(false));
+    let count = COUNT.with(Cell::get);
+    (result, installed.then_some(count))
+}
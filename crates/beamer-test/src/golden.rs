@@ -0,0 +1,245 @@
+//! Golden-file comparison.
+//!
+//! Golden files store rendered main outputs in a small binary format:
+//!
+//! ```text
+//! "BEAMERG1"            8-byte magic
+//! channels: u32 LE
+//! frames:   u32 LE
+//! samples:  f32 LE      channel-major (all of channel 0, then channel 1, ...)
+//! ```
+//!
+//! Relative paths resolve against the current directory, which `cargo test`
+//! sets to the package root. Reference files are only written when
+//! `BEAMER_BLESS=1` is set: run once that way to create a new file or to
+//! accept an intended change. Without it, a missing file fails the check, so
+//! a deleted or renamed reference can't pass silently.
+
+use std::fmt;
+use std::fs;
+use std::io;
+use std::path::Path;
+
+use crate::host::Rendered;
+
+const MAGIC: &[u8; 8] = b"BEAMERG1";
+
+/// Environment variable that makes [`assert_golden()`] rewrite reference files.
+pub const BLESS_ENV: &str = "BEAMER_BLESS";
+
+/// Error reading or comparing a golden file.
+#[derive(Debug)]
+pub enum GoldenError {
+    /// File could not be read or written.
+    Io(io::Error),
+    /// File doesn't exist and `BEAMER_BLESS` isn't set.
+    Missing,
+    /// File is not a valid golden file.
+    Format(String),
+    /// Channel or frame count differs.
+    Shape {
+        expected: (usize, usize),
+        actual: (usize, usize),
+    },
+    /// A sample differs by more than the tolerance.
+    Mismatch {
+        channel: usize,
+        frame: usize,
+        expected: f32,
+        actual: f32,
+    },
+}
+
+impl fmt::Display for GoldenError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            Self::Io(e) => write!(f, "golden file I/O error: {}", e),
+            Self::Missing => write!(f, "missing golden file, rerun with {}=1", BLESS_ENV),
+            Self::Format(msg) => write!(f, "invalid golden file: {}", msg),
+            Self::Shape { expected, actual } => write!(
+                f,
+                "shape mismatch: expected {} channels x {} frames, got {} x {}",
+                expected.0, expected.1, actual.0, actual.1
+            ),
+            Self::Mismatch {
+                channel,
+                frame,
+                expected,
+                actual,
+            } => write!(
+                f,
+                "sample mismatch at channel {} frame {}: expected {}, got {} (diff {})",
+                channel,
+                frame,
+                expected,
+                actual,
+                (expected - actual).abs()
+            ),
+        }
+    }
+}
+
+impl std::error::Error for GoldenError {}
+
+impl From<io::Error> for GoldenError {
+    fn from(e: io::Error) -> Self {
+        Self::Io(e)
+    }
+}
+
+/// Serialize channels into the golden file format.
+pub fn encode(channels: &[Vec<f32>]) -> Vec<u8> {
+    let frames = channels.first().map_or(0, Vec::len);
+    let mut bytes = Vec::with_capacity(16 + channels.len() * frames * 4);
+    bytes.extend_from_slice(MAGIC);
+    bytes.extend_from_slice(&(channels.len() as u32).to_le_bytes());
+    bytes.extend_from_slice(&(frames as u32).to_le_bytes());
+    for channel in channels {
+        for sample in channel {
+            bytes.extend_from_slice(&sample.to_le_bytes());
+        }
+    }
+    bytes
+}
+
+/// Parse the golden file format back into channels.
+pub fn decode(bytes: &[u8]) -> Result<Vec<Vec<f32>>, GoldenError> {
+    if bytes.len() < 16 || &bytes[..8] != MAGIC {
+        return Err(GoldenError::Format("missing BEAMERG1 header".into()));
+    }
+    let read_u32 = |at: usize| u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap()) as usize;
+    let (channels, frames) = (read_u32(8), read_u32(12));
+    let data = &bytes[16..];
+    if data.len() != channels * frames * 4 {
+        return Err(GoldenError::Format(format!(
+            "expected {} bytes of sample data, found {}",
+            channels * frames * 4,
+            data.len()
+        )));
+    }
+    let stride = frames * 4;
+    Ok((0..channels)
+        .map(|ch| {
+            data[ch * stride..(ch + 1) * stride]
+                .chunks_exact(4)
+                .map(|b| f32::from_le_bytes(b.try_into().unwrap()))
+                .collect()
+        })
+        .collect())
+}
+
+/// Compare channels against a reference within an absolute tolerance.
+pub fn compare(expected: &[Vec<f32>], actual: &[Vec<f32>], tolerance: f32) -> Result<(), GoldenError> {
+    let frames = |c: &[Vec<f32>]| c.first().map_or(0, Vec::len);
+    if expected.len() != actual.len() || frames(expected) != frames(actual) {
+        return Err(GoldenError::Shape {
+            expected: (expected.len(), frames(expected)),
+            actual: (actual.len(), frames(actual)),
+        });
+    }
+    for (channel, (exp, act)) in expected.iter().zip(actual).enumerate() {
+        for (frame, (&e, &a)) in exp.iter().zip(act).enumerate() {
+            let within = (e - a).abs() <= tolerance; // false for NaN
+            if !within {
+                return Err(GoldenError::Mismatch {
+                    channel,
+                    frame,
+                    expected: e,
+                    actual: a,
+                });
+            }
+        }
+    }
+    Ok(())
+}
+
+/// Check rendered main outputs against a golden file.
+///
+/// Returns `Ok(())` after writing the file if `BEAMER_BLESS` is set, and
+/// [`GoldenError::Missing`] if it isn't and the file doesn't exist.
+pub fn check_golden(path: impl AsRef<Path>, rendered: &Rendered, tolerance: f32) -> Result<(), GoldenError> {
+    let path = path.as_ref();
+    let bless = std::env::var_os(BLESS_ENV).is_some_and(|v| v != "0");
+    if !bless && !path.exists() {
+        return Err(GoldenError::Missing);
+    }
+    if bless {
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        fs::write(path, encode(&rendered.outputs))?;
+        return Ok(());
+    }
+    let expected = decode(&fs::read(path)?)?;
+    compare(&expected, &rendered.outputs, tolerance)
+}
+
+/// Assert that rendered main outputs match a golden file within `tolerance`.
+///
+/// See the [module docs](self) for the file format and blessing.
+#[track_caller]
+pub fn assert_golden(path: impl AsRef<Path>, rendered: &Rendered, tolerance: f32) {
+    let path = path.as_ref();
+    match check_golden(path, rendered, tolerance) {
+        Ok(()) => {}
+        Err(e @ GoldenError::Missing) => panic!("golden check failed for {}: {}", path.display(), e),
+        Err(e) => panic!(
+            "golden check failed for {}: {}\n(rerun with {}=1 to accept the new output)",
+            path.display(),
+            e,
+            BLESS_ENV
+        ),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_encode_decode_roundtrip() {
+        let channels = vec![vec![0.0, 0.5, -1.0], vec![0.25, f32::MIN_POSITIVE, 1.0]];
+        assert_eq!(decode(&encode(&channels)).unwrap(), channels);
+        assert!(matches!(decode(b"not a golden file"), Err(GoldenError::Format(_))));
+    }
+
+    #[test]
+    fn test_missing_file_fails_without_bless() {
+        if std::env::var_os(BLESS_ENV).is_some_and(|v| v != "0") {
+            return;
+        }
+        let rendered = Rendered {
+            sample_rate: 48_000.0,
+            block_size: 1,
+            outputs: vec![vec![0.5]],
+            aux_outputs: Vec::new(),
+            midi: Vec::new(),
+            block_times: Vec::new(),
+            allocations: None,
+            perf: Vec::new(),
+        };
+        let path = std::env::temp_dir().join(format!("beamer-golden-missing-{}.bin", std::process::id()));
+        let result = check_golden(&path, &rendered, 0.0);
+        assert!(matches!(result, Err(GoldenError::Missing)));
+        assert!(!path.exists());
+        assert_eq!(result.unwrap_err().to_string(), "missing golden file, rerun with BEAMER_BLESS=1");
+    }
+
+    #[test]
+    fn test_compare_tolerance() {
+        let expected = vec![vec![0.0, 0.5]];
+        assert!(compare(&expected, &[vec![1e-6, 0.5]], 1e-5).is_ok());
+        assert!(matches!(
+            compare(&expected, &[vec![0.0, 0.6]], 1e-5),
+            Err(GoldenError::Mismatch { frame: 1, .. })
+        ));
+        assert!(matches!(
+            compare(&expected, &[vec![0.0, f32::NAN]], 1.0),
+            Err(GoldenError::Mismatch { .. })
+        ));
+        assert!(matches!(
+            compare(&expected, &[vec![0.0]], 1e-5),
+            Err(GoldenError::Shape { .. })
+        ));
+    }
+}
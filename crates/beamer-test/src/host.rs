@@ -0,0 +1,697 @@
+//! Offline host that prepares a plugin and renders scripts.
+
+use std::io;
+use std::time::{Duration, Instant};
+
+use beamer_core::trace::{self, category};
+use beamer_core::{
+    AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, BusLayout, CcCurveMode, FullAudioSetup,
+    HasParameters, MemoryPolicy, MidiBuffer, MidiCcCurves, MidiCcState, MidiEvent, MidiOutputFilter, NoConfig, ParameterId, ParameterStore, Parameters, Plugin,
+    PrepareScope, ProcessContext, ProcessorConfig, QualityLevel, MAX_AUX_BUSES, MAX_CHANNELS,
+};
+
+use crate::alloc::count_allocations;
+use crate::perf::{PerfCounters, PerfCounts, PerfReport};
+use crate::script::Script;
+
+// =============================================================================
+// Config Building
+// =============================================================================
+
+mod sealed {
+    pub trait Sealed {}
+    impl Sealed for beamer_core::NoConfig {}
+    impl Sealed for beamer_core::AudioSetup {}
+    impl Sealed for beamer_core::FullAudioSetup {}
+}
+
+/// Builds a plugin's config the same way the VST3 wrapper does.
+///
+/// Sealed: implemented for [`NoConfig`], [`AudioSetup`] and [`FullAudioSetup`].
+pub trait HarnessConfig: ProcessorConfig + sealed::Sealed {
+    /// Build the config for a sample rate, maximum block size and bus layout.
+    fn build(sample_rate: f64, max_buffer_size: usize, layout: &BusLayout) -> Self;
+}
+
+impl HarnessConfig for NoConfig {
+    fn build(_sample_rate: f64, _max_buffer_size: usize, _layout: &BusLayout) -> Self {
+        NoConfig
+    }
+}
+
+impl HarnessConfig for AudioSetup {
+    fn build(sample_rate: f64, max_buffer_size: usize, _layout: &BusLayout) -> Self {
+        AudioSetup {
+            sample_rate,
+            max_buffer_size,
+        }
+    }
+}
+
+impl HarnessConfig for FullAudioSetup {
+    fn build(sample_rate: f64, max_buffer_size: usize, layout: &BusLayout) -> Self {
+        FullAudioSetup {
+            sample_rate,
+            max_buffer_size,
+            layout: layout.clone(),
+        }
+    }
+}
+
+// =============================================================================
+// TestHost
+// =============================================================================
+
+/// Offline host for a single plugin instance.
+///
+/// Mirrors the VST3 wrapper's call sequence: `prepare()`, parameter sample
+/// rate, `set_active(true)`, then per block: parameter changes,
+/// `process_midi()`, `process()`. Stages left out of the processor's
+/// [`CAPABILITIES`](AudioProcessor::CAPABILITIES) are skipped the same way,
+/// so a processor that under-declares fails its tests.
+///
+/// All buffers are allocated up front, so the only allocations observed
+/// during a block are the plugin's own.
+///
+/// With [`trace`] enabled, each block records the same stages as the
+/// wrapper (`process`, `process_midi`, `audio`) tagged with
+/// [`trace_instance()`](Self::trace_instance).
+pub struct TestHost<P: Plugin> {
+    processor: P::Processor,
+    sample_rate: f64,
+    block_size: usize,
+    layout: BusLayout,
+    midi_cc_state: Option<MidiCcState>,
+    midi_cc_curves: Option<MidiCcCurves>,
+    quality: QualityLevel,
+    inputs: Vec<Vec<f32>>,
+    outputs: Vec<Vec<f32>>,
+    aux_inputs: Vec<Vec<Vec<f32>>>,
+    aux_outputs: Vec<Vec<Vec<f32>>>,
+    // Boxed: MidiBuffer is large (fixed MAX_MIDI_EVENTS storage)
+    midi_input: Box<MidiBuffer>,
+    midi_output: Box<MidiBuffer>,
+    /// Present when the processor opts into output thinning, as in the wrappers
+    midi_output_filter: Option<MidiOutputFilter>,
+    trace_instance: u32,
+    perf_counters: Option<PerfCounters>,
+}
+
+impl<P: Plugin> TestHost<P>
+where
+    P::Config: HarnessConfig,
+{
+    /// Prepare `P::default()` for the given sample rate and block size.
+    pub fn new(sample_rate: f64, block_size: usize) -> Self {
+        Self::with_plugin(P::default(), sample_rate, block_size)
+    }
+
+    /// Prepare an already configured plugin instance.
+    pub fn with_plugin(plugin: P, sample_rate: f64, block_size: usize) -> Self {
+        assert!(block_size > 0, "block size must be non-zero");
+
+        let layout = BusLayout::from_plugin(&plugin);
+        // Without the aux stage the processor gets no aux buses, as in the wrapper
+        let aux_bus_limit = if P::Processor::CAPABILITIES.aux_buses { MAX_AUX_BUSES + 1 } else { 1 };
+        let aux_input_channels: Vec<usize> = (1..plugin.input_bus_count().min(aux_bus_limit))
+            .map(|i| plugin.input_bus_info(i).map_or(0, |b| b.channel_count as usize))
+            .collect();
+        let aux_output_channels: Vec<usize> = (1..plugin.output_bus_count().min(aux_bus_limit))
+            .map(|i| plugin.output_bus_info(i).map_or(0, |b| b.channel_count as usize))
+            .collect();
+        let midi_cc_state = plugin.midi_cc_config().map(|cfg| MidiCcState::from_config(&cfg));
+        let midi_cc_curves = midi_cc_state
+            .as_ref()
+            .filter(|state| P::Processor::CAPABILITIES.midi_cc && state.curve_mode() != CcCurveMode::Off)
+            .map(|state| MidiCcCurves::new(state, block_size));
+        let midi_output_filter = (P::Processor::CAPABILITIES.midi_output && !P::Processor::MIDI_OUTPUT.is_pass_through())
+            .then(|| MidiOutputFilter::new(P::Processor::MIDI_OUTPUT, sample_rate));
+
+        // Prepare the way the format wrappers do (this also builds the shared lookup tables)
+        let scope = PrepareScope::begin(MemoryPolicy::Default);
+        let config = P::Config::build(sample_rate, block_size, &layout);
+        let mut processor = plugin.prepare(config);
+        scope.finish();
+        processor.parameters_mut().set_sample_rate(sample_rate);
+        processor.set_active(true);
+
+        let channels = |count: usize| vec![vec![0.0; block_size]; count.min(MAX_CHANNELS)];
+
+        Self {
+            processor,
+            sample_rate,
+            block_size,
+            inputs: channels(layout.main_input_channels as usize),
+            outputs: channels(layout.main_output_channels as usize),
+            aux_inputs: aux_input_channels.into_iter().map(channels).collect(),
+            aux_outputs: aux_output_channels.into_iter().map(channels).collect(),
+            layout,
+            midi_cc_state,
+            midi_cc_curves,
+            quality: QualityLevel::Full,
+            midi_input: Box::new(MidiBuffer::new()),
+            midi_output: Box::new(MidiBuffer::new()),
+            midi_output_filter,
+            trace_instance: trace::next_instance_id(),
+            perf_counters: None,
+        }
+    }
+}
+
+impl<P: Plugin> TestHost<P> {
+    /// The prepared processor.
+    #[inline]
+    pub fn processor(&self) -> &P::Processor {
+        &self.processor
+    }
+
+    /// Mutable access to the prepared processor.
+    #[inline]
+    pub fn processor_mut(&mut self) -> &mut P::Processor {
+        &mut self.processor
+    }
+
+    /// Instance ID this host's spans are tagged with.
+    #[inline]
+    pub fn trace_instance(&self) -> u32 {
+        self.trace_instance
+    }
+
+    /// Bus layout the plugin was prepared with.
+    #[inline]
+    pub fn layout(&self) -> &BusLayout {
+        &self.layout
+    }
+
+    /// Sample rate in Hz.
+    #[inline]
+    pub fn sample_rate(&self) -> f64 {
+        self.sample_rate
+    }
+
+    /// Samples per `process()` call.
+    #[inline]
+    pub fn block_size(&self) -> usize {
+        self.block_size
+    }
+
+    /// Set a parameter (or MIDI CC parameter) to a normalized value.
+    pub fn set_parameter(&mut self, id: ParameterId, normalized: f64) {
+        if MidiCcState::is_midi_cc_parameter(id) {
+            if let Some(state) = &self.midi_cc_state {
+                state.set_normalized(id, normalized);
+            }
+        } else {
+            self.processor.parameters().set_normalized(id, normalized);
+        }
+    }
+
+    /// Quality level passed in every block's `ProcessContext`.
+    ///
+    /// The test host doesn't measure load (renders must stay
+    /// deterministic); set the level to exercise degraded paths.
+    pub fn set_quality(&mut self, quality: QualityLevel) {
+        self.quality = quality;
+    }
+
+    /// Count hardware events around every block (see [`perf`](crate::perf)).
+    ///
+    /// Counters belong to the calling thread, so render on the same thread.
+    /// Fails if the platform or kernel settings don't allow counting.
+    pub fn enable_perf_counters(&mut self) -> io::Result<()> {
+        self.perf_counters = Some(PerfCounters::open()?);
+        Ok(())
+    }
+
+    /// Deactivate and reactivate the processor, as the VST3 wrapper does:
+    /// `set_active(false)`, `hibernate()`, `resume()`, `set_active(true)`.
+    pub fn reactivate(&mut self) {
+        self.processor.set_active(false);
+        self.processor.hibernate();
+        self.processor.resume();
+        if let (Some(curves), Some(state)) = (&mut self.midi_cc_curves, &self.midi_cc_state) {
+            curves.reset(state);
+        }
+        if let Some(filter) = &mut self.midi_output_filter {
+            filter.reset();
+        }
+        self.processor.set_active(true);
+    }
+
+    /// Render a script from the processor's current state.
+    ///
+    /// The last block is shorter if the script length isn't a multiple of
+    /// the block size. Repeated calls continue from where the previous
+    /// render stopped (no reset in between).
+    ///
+    /// Processors that return `true` from
+    /// [`supports_in_place()`](AudioProcessor::supports_in_place) get their
+    /// paired main channels in place, as from an in-place host.
+    pub fn render(&mut self, script: &Script) -> Rendered {
+        let len = script.len();
+        let sample_rate = self.sample_rate;
+        let in_place = self.processor.supports_in_place();
+        let capabilities = P::Processor::CAPABILITIES;
+
+        // Render all input signals up front so signal generation stays
+        // outside the measured region.
+        let main_in: Vec<Vec<f32>> = (0..self.inputs.len())
+            .map(|ch| script.input_signal(ch).render(len, sample_rate))
+            .collect();
+        let sidechain_in: Vec<Option<Vec<f32>>> = (0..self.aux_inputs.first().map_or(0, Vec::len))
+            .map(|ch| script.sidechain_signal(ch).map(|s| s.render(len, sample_rate)))
+            .collect();
+
+        let mut rendered = Rendered {
+            sample_rate,
+            block_size: self.block_size,
+            outputs: vec![Vec::with_capacity(len); self.outputs.len()],
+            aux_outputs: self
+                .aux_outputs
+                .iter()
+                .map(|bus| vec![Vec::with_capacity(len); bus.len()])
+                .collect(),
+            midi: Vec::new(),
+            block_times: Vec::with_capacity(len.div_ceil(self.block_size)),
+            allocations: Some(0),
+            perf: Vec::with_capacity(if self.perf_counters.is_some() { len.div_ceil(self.block_size) } else { 0 }),
+        };
+
+        let mut automation = script.automation.iter().peekable();
+        let mut midi = script.midi.iter().peekable();
+        let mut pos = 0;
+
+        while pos < len {
+            let n = self.block_size.min(len - pos);
+            let end = pos + n;
+
+            // Parameter changes land at the start of the block; MIDI CC
+            // curves get them at their exact offset
+            if let Some(curves) = &mut self.midi_cc_curves {
+                curves.begin_block(n);
+            }
+            while let Some(change) = automation.next_if(|a| a.at < end) {
+                if let (Some(curves), Some(controller)) =
+                    (&mut self.midi_cc_curves, MidiCcState::parameter_id_to_controller(change.id))
+                {
+                    curves.push_point(controller, change.at.saturating_sub(pos) as u32, change.normalized);
+                }
+                self.set_parameter(change.id, change.normalized);
+            }
+            if let Some(curves) = &mut self.midi_cc_curves {
+                curves.end_block();
+            }
+
+            // MIDI input with block-relative offsets
+            self.midi_input.clear();
+            self.midi_output.clear();
+            while let Some(event) = midi.next_if(|e| (e.sample_offset as usize) < end) {
+                if capabilities.midi_input {
+                    let mut event = event.clone();
+                    event.sample_offset = event.sample_offset.saturating_sub(pos as u32);
+                    self.midi_input.push(event);
+                }
+            }
+
+            for (buf, signal) in self.inputs.iter_mut().zip(&main_in) {
+                buf[..n].copy_from_slice(&signal[pos..end]);
+            }
+            if let Some(bus) = self.aux_inputs.first_mut() {
+                for (buf, signal) in bus.iter_mut().zip(&sidechain_in) {
+                    match signal {
+                        Some(signal) => buf[..n].copy_from_slice(&signal[pos..end]),
+                        None => buf[..n].fill(0.0),
+                    }
+                }
+            }
+            for buf in self.outputs.iter_mut().chain(self.aux_outputs.iter_mut().flatten()) {
+                buf[..n].fill(0.0);
+            }
+            // Like an in-place host: paired main channels share one buffer
+            let num_in_place = if in_place { self.inputs.len().min(self.outputs.len()) } else { 0 };
+            for (out, input) in self.outputs.iter_mut().zip(&self.inputs).take(num_in_place) {
+                out[..n].copy_from_slice(&input[..n]);
+            }
+
+            let mut transport = if capabilities.transport { script.transport } else { Default::default() };
+            if let Some(start) = transport.project_time_samples {
+                transport.project_time_samples = Some(start + pos as i64);
+            }
+
+            let ((elapsed, counts), allocations) = {
+                let context = match &self.midi_cc_state {
+                    Some(state) => ProcessContext::with_midi_cc(sample_rate, n, transport, state),
+                    None => ProcessContext::new(sample_rate, n, transport),
+                }
+                .with_quality(self.quality)
+                .with_midi_cc_curves(self.midi_cc_curves.as_ref());
+                let mut buffer = Buffer::new_in_place(
+                    self.inputs.iter().enumerate().map(|(ch, c)| (ch >= num_in_place).then(|| &c[..n])),
+                    self.outputs.iter_mut().map(|c| &mut c[..n]),
+                    n,
+                );
+                let mut aux = AuxiliaryBuffers::new(
+                    self.aux_inputs.iter().map(|bus| bus.iter().map(|c| &c[..n])),
+                    self.aux_outputs.iter_mut().map(|bus| bus.iter_mut().map(|c| &mut c[..n])),
+                    n,
+                );
+                let processor = &mut self.processor;
+                let midi_input = &self.midi_input;
+                let midi_output = &mut self.midi_output;
+                let midi_output_filter = self.midi_output_filter.as_mut();
+                let trace_instance = self.trace_instance;
+                let counters = self.perf_counters.as_ref();
+
+                count_allocations(|| {
+                    let before = counters.map(PerfCounters::read);
+                    let start = Instant::now();
+                    let _instance = trace::instance_scope(trace_instance);
+                    let _block = trace::span_in(category::WRAPPER, "process");
+                    if capabilities.processes_midi() {
+                        let _midi = trace::span_in(category::MIDI, "process_midi");
+                        processor.process_midi(midi_input.as_slice(), midi_output);
+                        if let Some(filter) = midi_output_filter {
+                            filter.filter(midi_output, n);
+                        }
+                    }
+                    let _audio = trace::span_in(category::WRAPPER, "audio");
+                    processor.process(&mut buffer, &mut aux, &context);
+                    let elapsed = start.elapsed();
+                    (elapsed, counters.zip(before).map(|(c, before)| c.read() - before))
+                })
+            };
+
+            rendered.block_times.push(elapsed);
+            rendered.perf.extend(counts);
+            rendered.allocations = rendered.allocations.zip(allocations).map(|(a, b)| a + b);
+            for (out, buf) in rendered.outputs.iter_mut().zip(&self.outputs) {
+                out.extend_from_slice(&buf[..n]);
+            }
+            for (out_bus, bus) in rendered.aux_outputs.iter_mut().zip(&self.aux_outputs) {
+                for (out, buf) in out_bus.iter_mut().zip(bus) {
+                    out.extend_from_slice(&buf[..n]);
+                }
+            }
+            for event in self.midi_output.iter().filter(|_| capabilities.midi_output) {
+                let mut event = event.clone();
+                event.sample_offset += pos as u32;
+                rendered.midi.push(event);
+            }
+
+            pos = end;
+        }
+
+        rendered
+    }
+}
+
+// =============================================================================
+// Rendered
+// =============================================================================
+
+/// Result of [`TestHost::render()`].
+#[derive(Debug, Clone)]
+pub struct Rendered {
+    /// Sample rate the script was rendered at.
+    pub sample_rate: f64,
+    /// Samples per `process()` call (the last block may be shorter).
+    pub block_size: usize,
+    /// Main output channels.
+    pub outputs: Vec<Vec<f32>>,
+    /// Auxiliary output buses, each a list of channels.
+    pub aux_outputs: Vec<Vec<Vec<f32>>>,
+    /// MIDI output with absolute sample offsets.
+    pub midi: Vec<MidiEvent>,
+    /// Wall-clock time of `process_midi()` + `process()` per block.
+    pub block_times: Vec<Duration>,
+    /// Heap allocations during all blocks, or `None` without
+    /// [`install_counting_allocator!`](crate::install_counting_allocator).
+    pub allocations: Option<usize>,
+    /// Hardware event counts of `process_midi()` + `process()` per block,
+    /// empty unless [`TestHost::enable_perf_counters()`] succeeded.
+    pub perf: Vec<PerfCounts>,
+}
+
+impl Rendered {
+    /// Main output channel.
+    #[inline]
+    pub fn channel(&self, index: usize) -> &[f32] {
+        &self.outputs[index]
+    }
+
+    /// Number of rendered samples per channel.
+    #[inline]
+    pub fn len(&self) -> usize {
+        self.outputs.first().map_or(0, Vec::len)
+    }
+
+    /// Whether no samples were rendered.
+    #[inline]
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Peak absolute value across all main output channels.
+    pub fn peak(&self) -> f32 {
+        self.outputs
+            .iter()
+            .flatten()
+            .fold(0.0f32, |peak, s| peak.max(s.abs()))
+    }
+
+    /// Hardware event counts of all blocks per sample and per voice.
+    ///
+    /// `voices` is the number of voices the script kept sounding (1 for
+    /// effects). `None` without counters.
+    pub fn perf_report(&self, voices: usize) -> Option<PerfReport> {
+        if self.perf.is_empty() {
+            return None;
+        }
+        let mut total = PerfCounts::default();
+        for &counts in &self.perf {
+            total += counts;
+        }
+        Some(PerfReport {
+            total,
+            samples: self.len(),
+            voices,
+        })
+    }
+
+    /// Highest per-block load: processing time divided by the block's real-time duration.
+    pub fn max_load(&self) -> f64 {
+        let mut remaining = self.len();
+        self.block_times
+            .iter()
+            .map(|t| {
+                let n = self.block_size.min(remaining);
+                remaining -= n;
+                t.as_secs_f64() / (n as f64 / self.sample_rate)
+            })
+            .fold(0.0, f64::max)
+    }
+
+    /// Assert that every block finished within `fraction` of its real-time duration.
+    ///
+    /// `0.5` means each block must take at most half the time it represents.
+    /// Unoptimized timings say little about real-time safety; plugin tests
+    /// usually want [`assert_cpu_budget_release()`](Self::assert_cpu_budget_release).
+    #[track_caller]
+    pub fn assert_cpu_budget(&self, fraction: f64) {
+        let load = self.max_load();
+        assert!(
+            load <= fraction,
+            "CPU budget exceeded: worst block used {:.1}% of real time (budget {:.1}%)",
+            load * 100.0,
+            fraction * 100.0
+        );
+    }
+
+    /// [`assert_cpu_budget()`](Self::assert_cpu_budget) in optimized builds;
+    /// does nothing with debug assertions on.
+    ///
+    /// Lets a regular test carry its budget: `cargo test` stays independent
+    /// of machine speed, and `cargo test --release` enforces the budget.
+    #[track_caller]
+    pub fn assert_cpu_budget_release(&self, fraction: f64) {
+        if !cfg!(debug_assertions) {
+            self.assert_cpu_budget(fraction);
+        }
+    }
+
+    /// Assert that no block allocated on the heap.
+    ///
+    /// Panics if [`install_counting_allocator!`](crate::install_counting_allocator)
+    /// was not used in this test binary, since the check would silently pass.
+    #[track_caller]
+    pub fn assert_no_allocations(&self) {
+        match self.allocations {
+            Some(0) => {}
+            Some(count) => panic!("{count} heap allocation(s) during process()"),
+            None => panic!(
+                "allocation tracking unavailable: add `beamer_test::install_counting_allocator!();` to the test binary"
+            ),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer_core::{AudioSetup, NoParameters};
+
+    use crate::{Script, Signal};
+
+    /// Halves the input, echoes MIDI, optionally allocates in `process()`.
+    #[derive(Default)]
+    struct HalfPlugin {
+        parameters: NoParameters,
+        allocate: bool,
+    }
+
+    struct HalfProcessor {
+        parameters: NoParameters,
+        allocate: bool,
+        sample_rate: f64,
+    }
+
+    impl HasParameters for HalfPlugin {
+        type Parameters = NoParameters;
+        fn parameters(&self) -> &NoParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut NoParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl HasParameters for HalfProcessor {
+        type Parameters = NoParameters;
+        fn parameters(&self) -> &NoParameters {
+            &self.parameters
+        }
+        fn parameters_mut(&mut self) -> &mut NoParameters {
+            &mut self.parameters
+        }
+    }
+
+    impl Plugin for HalfPlugin {
+        type Config = AudioSetup;
+        type Processor = HalfProcessor;
+        fn prepare(self, config: AudioSetup) -> HalfProcessor {
+            HalfProcessor {
+                parameters: self.parameters,
+                allocate: self.allocate,
+                sample_rate: config.sample_rate,
+            }
+        }
+    }
+
+    impl AudioProcessor for HalfProcessor {
+        type Plugin = HalfPlugin;
+
+        fn process(&mut self, buffer: &mut Buffer, _aux: &mut AuxiliaryBuffers, _context: &ProcessContext) {
+            if self.allocate {
+                std::hint::black_box(vec![0u8; 16]);
+            }
+            for (input, output) in buffer.zip_channels() {
+                for (i, o) in input.iter().zip(output.iter_mut()) {
+                    *o = i * 0.5;
+                }
+            }
+        }
+
+        fn process_midi(&mut self, input: &[MidiEvent], output: &mut MidiBuffer) {
+            for event in input {
+                output.push(event.clone());
+            }
+        }
+
+        fn unprepare(self) -> HalfPlugin {
+            HalfPlugin {
+                parameters: self.parameters,
+                allocate: self.allocate,
+            }
+        }
+    }
+
+    #[test]
+    fn test_render_blocks_and_midi() {
+        let script = Script::new(1000)
+            .input_all(Signal::Dc(1.0))
+            .note(300, 0, 60, 1.0, 400);
+        let mut host = TestHost::<HalfPlugin>::new(48_000.0, 256);
+        assert_eq!(host.processor().sample_rate, 48_000.0);
+
+        let rendered = host.render(&script);
+        assert_eq!(rendered.outputs.len(), 2);
+        assert_eq!(rendered.len(), 1000);
+        assert_eq!(rendered.block_times.len(), 4);
+        assert!(rendered.channel(1).iter().all(|&s| s == 0.5));
+
+        // Offsets are restored to absolute positions
+        let offsets: Vec<u32> = rendered.midi.iter().map(|e| e.sample_offset).collect();
+        assert_eq!(offsets, vec![300, 700]);
+    }
+
+    #[test]
+    fn test_allocation_tracking() {
+        let script = Script::new(512);
+        let rendered = TestHost::<HalfPlugin>::new(44_100.0, 128).render(&script);
+        rendered.assert_no_allocations();
+
+        let plugin = HalfPlugin {
+            allocate: true,
+            ..Default::default()
+        };
+        let rendered = TestHost::with_plugin(plugin, 44_100.0, 128).render(&script);
+        assert_eq!(rendered.allocations, Some(4));
+    }
+
+    #[test]
+    fn test_cpu_budget() {
+        let rendered = TestHost::<HalfPlugin>::new(48_000.0, 512).render(&Script::new(4096));
+        assert!(rendered.max_load() > 0.0);
+        // Bounds that hold regardless of machine load
+        rendered.assert_cpu_budget(f64::INFINITY);
+        let exceeded = std::panic::catch_unwind(|| rendered.assert_cpu_budget(0.0));
+        assert!(exceeded.is_err());
+    }
+
+    #[test]
+    fn test_perf_counters_per_block() {
+        let mut host = TestHost::<HalfPlugin>::new(48_000.0, 256);
+        let rendered = host.render(&Script::new(512));
+        assert!(rendered.perf.is_empty());
+        assert!(rendered.perf_report(1).is_none());
+
+        // Counters are unavailable in many containers and CI runners
+        if host.enable_perf_counters().is_err() {
+            return;
+        }
+        let rendered = host.render(&Script::new(1000));
+        assert_eq!(rendered.perf.len(), 4);
+        rendered.assert_no_allocations();
+        let report = rendered.perf_report(2).unwrap();
+        assert_eq!((report.samples, report.voices), (1000, 2));
+    }
+
+    #[test]
+    fn test_trace_spans() {
+        trace::enable(beamer_core::TraceConfig::new());
+        let mut host = TestHost::<HalfPlugin>::new(48_000.0, 256);
+        let rendered = host.render(&Script::new(1000).note(0, 0, 60, 1.0, 100));
+        // Tracing must not add allocations to the block
+        rendered.assert_no_allocations();
+
+        let snapshot = trace::drain();
+        let spans: Vec<_> = snapshot
+            .spans
+            .iter()
+            .filter(|s| s.instance == host.trace_instance())
+            .collect();
+        let count = |name: &str| spans.iter().filter(|s| s.name == name).count();
+        assert_eq!((count("process"), count("process_midi"), count("audio")), (4, 4, 4));
+        assert!(spans.iter().all(|s| s.thread == spans[0].thread));
+    }
+}
@@ -0,0 +1,68 @@
+//! # beamer-test
+//!
+//! Offline test harness for Beamer plugins.
+//!
+//! Drives any [`Plugin`](beamer_core::Plugin) through `prepare()` and
+//! `process()` without a host, with scripted inputs, and checks the result:
+//!
+//! - [`Script`] - test signals, sidechain input, parameter automation and MIDI
+//! - [`TestHost`] - prepares the plugin and renders a script block by block
+//! - [`Rendered`] - output audio, output MIDI, per-block timings and allocation counts
+//! - [`assert_golden()`] - compare output against a stored reference within a tolerance
+//! - [`install_counting_allocator!`] - enable allocation tracking in a test binary
+//! - [`perf`] - hardware performance counters per block (Linux `perf_event_open`)
+//!
+//! ## Example
+//!
+//! ```ignore
+//! use beamer_test::{parameter_id, Script, Signal, TestHost};
+//!
+//! beamer_test::install_counting_allocator!();
+//!
+//! #[test]
+//! fn gain_ramp() {
+//!     let script = Script::new(48_000)
+//!         .input_all(Signal::sine(440.0, 0.5))
+//!         .automate(24_000, parameter_id("gain"), 0.25);
+//!
+//!     let rendered = TestHost::<GainPlugin>::new(48_000.0, 256).render(&script);
+//!
+//!     rendered.assert_no_allocations();
+//!     // Enforced by `cargo test --release`, skipped in debug builds
+//!     rendered.assert_cpu_budget_release(0.5);
+//!     beamer_test::assert_golden("golden/gain_ramp.bin", &rendered, 1e-5);
+//! }
+//! ```
+
+pub mod alloc;
+pub mod golden;
+pub mod host;
+pub mod perf;
+pub mod script;
+pub mod signal;
+
+pub use alloc::{allocation_tracking_installed, count_allocations, CountingAllocator};
+pub use golden::{assert_golden, GoldenError};
+pub use host::{HarnessConfig, Rendered, TestHost};
+pub use perf::{PerfCounters, PerfCounts, PerfEvent, PerfReport};
+pub use script::{Automation, Script};
+pub use signal::Signal;
+
+/// Get the parameter ID generated by `#[derive(Parameters)]` for a string ID.
+///
+/// Matches the hash the derive macro uses, so tests can refer to parameters
+/// by the `id = "..."` attribute value.
+#[inline]
+pub const fn parameter_id(string_id: &str) -> beamer_core::ParameterId {
+    beamer_utils::fnv1a_32(string_id)
+}
+
+/// Get the parameter ID of `string_id` inside an element of a `#[nested]`
+/// array, e.g. `element_parameter_id("band3", "freq")` for `bands[3].freq`.
+#[inline]
+pub const fn element_parameter_id(element_key: &str, string_id: &str) -> beamer_core::ParameterId {
+    beamer_utils::fnv1a_32(string_id) ^ beamer_utils::fnv1a_32(element_key)
+}
+
+#[cfg(test)]
+install_counting_allocator!();
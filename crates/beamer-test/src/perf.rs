@@ -0,0 +1,446 @@
+//! Hardware performance counters (Linux `perf_event_open`).
+//!
+//! Wall-clock block times say a loop got slower; counters say why. A
+//! [`PerfCounters`] set counts CPU cycles, retired instructions, L1 data and
+//! last-level cache read misses, and branch misses for the calling thread,
+//! in user space only. [`TestHost`](crate::TestHost) reads them around every
+//! block when enabled with
+//! [`enable_perf_counters()`](crate::TestHost::enable_perf_counters), and
+//! [`Rendered::perf_report()`](crate::Rendered::perf_report) normalizes them
+//! per sample and per voice.
+//!
+//! ```ignore
+//! let mut host = TestHost::<SynthPlugin>::new(48_000.0, 256);
+//! host.enable_perf_counters()?;
+//! let rendered = host.render(&chord_script(16));
+//! println!("{}", rendered.perf_report(16).unwrap());
+//! ```
+//!
+//! # Availability
+//!
+//! Counters need Linux and `kernel.perf_event_paranoid` ≤ 2 (the default on
+//! most distributions). Events the CPU or hypervisor doesn't expose are left
+//! out and report `None`; [`PerfCounters::open()`] only fails if none can be
+//! opened. When the kernel multiplexes more events than the PMU has
+//! registers, counts are scaled by the fraction of time each event ran.
+//!
+//! Counters are per thread: read them on the thread that opened them.
+
+use std::fmt;
+use std::io;
+use std::ops::{AddAssign, Sub};
+use std::thread::{self, ThreadId};
+
+/// A hardware event counted by [`PerfCounters`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum PerfEvent {
+    /// CPU cycles.
+    Cycles,
+    /// Retired instructions.
+    Instructions,
+    /// L1 data cache read misses.
+    L1dMisses,
+    /// Last-level cache read misses.
+    LlcMisses,
+    /// Mispredicted branches.
+    BranchMisses,
+}
+
+impl PerfEvent {
+    /// Number of events.
+    pub const COUNT: usize = 5;
+
+    /// All events, in report order.
+    pub const ALL: [PerfEvent; Self::COUNT] = [
+        PerfEvent::Cycles,
+        PerfEvent::Instructions,
+        PerfEvent::L1dMisses,
+        PerfEvent::LlcMisses,
+        PerfEvent::BranchMisses,
+    ];
+
+    /// Short name, as printed by `perf stat`.
+    pub const fn name(self) -> &'static str {
+        match self {
+            PerfEvent::Cycles => "cycles",
+            PerfEvent::Instructions => "instructions",
+            PerfEvent::L1dMisses => "L1-dcache-load-misses",
+            PerfEvent::LlcMisses => "LLC-load-misses",
+            PerfEvent::BranchMisses => "branch-misses",
+        }
+    }
+}
+
+// =============================================================================
+// PerfCounts
+// =============================================================================
+
+/// Event counts over some interval (`None` for events that aren't available).
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PerfCounts {
+    values: [Option<u64>; PerfEvent::COUNT],
+}
+
+impl PerfCounts {
+    /// Count of one event.
+    #[inline]
+    pub fn get(&self, event: PerfEvent) -> Option<u64> {
+        self.values[event as usize]
+    }
+
+    /// Instructions per cycle.
+    pub fn ipc(&self) -> Option<f64> {
+        let cycles = self.get(PerfEvent::Cycles).filter(|&c| c > 0)?;
+        Some(self.get(PerfEvent::Instructions)? as f64 / cycles as f64)
+    }
+}
+
+impl AddAssign for PerfCounts {
+    fn add_assign(&mut self, other: Self) {
+        for (value, other) in self.values.iter_mut().zip(other.values) {
+            *value = match (*value, other) {
+                (Some(a), Some(b)) => Some(a + b),
+                (a, b) => a.or(b),
+            };
+        }
+    }
+}
+
+impl Sub for PerfCounts {
+    type Output = PerfCounts;
+
+    /// Counts between two readings (`self` taken after `earlier`).
+    fn sub(self, earlier: Self) -> PerfCounts {
+        let mut values = self.values;
+        for (value, earlier) in values.iter_mut().zip(earlier.values) {
+            *value = value.zip(earlier).map(|(a, b)| a.saturating_sub(b));
+        }
+        PerfCounts { values }
+    }
+}
+
+// =============================================================================
+// PerfReport
+// =============================================================================
+
+/// Counts of a render, normalized per sample and per voice.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct PerfReport {
+    /// Counts summed over all blocks.
+    pub total: PerfCounts,
+    /// Rendered samples (per channel).
+    pub samples: usize,
+    /// Voices the caller declared active (1 for effects).
+    pub voices: usize,
+}
+
+impl PerfReport {
+    /// Average count of `event` per sample.
+    pub fn per_sample(&self, event: PerfEvent) -> Option<f64> {
+        Some(self.total.get(event)? as f64 / self.samples.max(1) as f64)
+    }
+
+    /// Average count of `event` per sample and voice.
+    pub fn per_voice_sample(&self, event: PerfEvent) -> Option<f64> {
+        Some(self.per_sample(event)? / self.voices.max(1) as f64)
+    }
+}
+
+impl fmt::Display for PerfReport {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        writeln!(
+            f,
+            "{:<24} {:>14} {:>12} {:>14}",
+            "event", "total", "/sample", "/voice/sample"
+        )?;
+        for event in PerfEvent::ALL {
+            match self.total.get(event) {
+                Some(total) => writeln!(
+                    f,
+                    "{:<24} {:>14} {:>12.3} {:>14.3}",
+                    event.name(),
+                    total,
+                    self.per_sample(event).unwrap_or_default(),
+                    self.per_voice_sample(event).unwrap_or_default()
+                )?,
+                None => writeln!(f, "{:<24} {:>14}", event.name(), "n/a")?,
+            }
+        }
+        match self.total.ipc() {
+            Some(ipc) => write!(f, "IPC {ipc:.2} ({} samples, {} voices)", self.samples, self.voices),
+            None => write!(f, "({} samples, {} voices)", self.samples, self.voices),
+        }
+    }
+}
+
+// =============================================================================
+// PerfCounters
+// =============================================================================
+
+/// Open hardware counters for the calling thread.
+///
+/// Counting starts at [`open()`](Self::open); [`read()`](Self::read) takes a
+/// cumulative snapshot and [`measure()`](Self::measure) the counts of a
+/// closure. Reading does not allocate.
+pub struct PerfCounters {
+    counters: [Option<sys::Counter>; PerfEvent::COUNT],
+    thread: ThreadId,
+}
+
+impl PerfCounters {
+    /// Open every available event for the calling thread.
+    ///
+    /// Fails with the first open error (e.g. permission denied, or
+    /// unsupported outside Linux) if no event could be opened.
+    pub fn open() -> io::Result<Self> {
+        let mut first_error = None;
+        let counters = PerfEvent::ALL.map(|event| match sys::Counter::open(event) {
+            Ok(counter) => Some(counter),
+            Err(error) => {
+                first_error.get_or_insert(error);
+                None
+            }
+        });
+        if counters.iter().all(Option::is_none) {
+            return Err(first_error.unwrap_or_else(|| io::ErrorKind::Unsupported.into()));
+        }
+        Ok(Self {
+            counters,
+            thread: thread::current().id(),
+        })
+    }
+
+    /// Whether `event` is being counted.
+    #[inline]
+    pub fn is_available(&self, event: PerfEvent) -> bool {
+        self.counters[event as usize].is_some()
+    }
+
+    /// Cumulative counts since [`open()`](Self::open).
+    ///
+    /// # Panics
+    /// If called from a thread other than the one that opened the counters.
+    pub fn read(&self) -> PerfCounts {
+        assert_eq!(
+            thread::current().id(),
+            self.thread,
+            "PerfCounters read from a different thread than the one that opened them"
+        );
+        let mut counts = PerfCounts::default();
+        for (value, counter) in counts.values.iter_mut().zip(&self.counters) {
+            *value = counter.as_ref().and_then(sys::Counter::read);
+        }
+        counts
+    }
+
+    /// Run `f` and return its result with the counts it took.
+    pub fn measure<R>(&self, f: impl FnOnce() -> R) -> (R, PerfCounts) {
+        let before = self.read();
+        let result = f();
+        (result, self.read() - before)
+    }
+}
+
+impl fmt::Debug for PerfCounters {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let available: Vec<_> = PerfEvent::ALL
+            .into_iter()
+            .filter(|&event| self.is_available(event))
+            .map(PerfEvent::name)
+            .collect();
+        f.debug_struct("PerfCounters").field("available", &available).finish()
+    }
+}
+
+#[cfg(target_os = "linux")]
+mod sys {
+    use std::ffi::{c_int, c_long, c_ulong};
+    use std::fs::File;
+    use std::io::{self, Read};
+    use std::os::fd::FromRawFd;
+
+    use super::PerfEvent;
+
+    #[cfg(target_arch = "x86_64")]
+    const SYS_PERF_EVENT_OPEN: c_long = 298;
+    #[cfg(target_arch = "x86")]
+    const SYS_PERF_EVENT_OPEN: c_long = 336;
+    #[cfg(target_arch = "arm")]
+    const SYS_PERF_EVENT_OPEN: c_long = 364;
+    #[cfg(any(target_arch = "aarch64", target_arch = "riscv64", target_arch = "loongarch64"))]
+    const SYS_PERF_EVENT_OPEN: c_long = 241;
+
+    const PERF_TYPE_HARDWARE: u32 = 0;
+    const PERF_TYPE_HW_CACHE: u32 = 3;
+    const PERF_COUNT_HW_CPU_CYCLES: u64 = 0;
+    const PERF_COUNT_HW_INSTRUCTIONS: u64 = 1;
+    const PERF_COUNT_HW_BRANCH_MISSES: u64 = 5;
+    const PERF_COUNT_HW_CACHE_L1D: u64 = 0;
+    const PERF_COUNT_HW_CACHE_LL: u64 = 2;
+    const PERF_COUNT_HW_CACHE_OP_READ: u64 = 0;
+    const PERF_COUNT_HW_CACHE_RESULT_MISS: u64 = 1;
+    const PERF_FORMAT_TOTAL_TIME_ENABLED: u64 = 1 << 0;
+    const PERF_FORMAT_TOTAL_TIME_RUNNING: u64 = 1 << 1;
+    const ATTR_FLAG_EXCLUDE_KERNEL: u64 = 1 << 5;
+    const ATTR_FLAG_EXCLUDE_HV: u64 = 1 << 6;
+    const PERF_FLAG_FD_CLOEXEC: c_ulong = 1 << 3;
+    const ENOENT: i32 = 2;
+
+    /// `struct perf_event_attr`, first published layout (`PERF_ATTR_SIZE_VER0`).
+    #[repr(C)]
+    #[derive(Default)]
+    struct PerfEventAttr {
+        kind: u32,
+        size: u32,
+        config: u64,
+        sample_period: u64,
+        sample_type: u64,
+        read_format: u64,
+        flags: u64,
+        wakeup_events: u32,
+        bp_type: u32,
+        config1: u64,
+    }
+
+    extern "C" {
+        fn syscall(number: c_long, ...) -> c_long;
+    }
+
+    /// One open counter (closed when the file drops).
+    pub(super) struct Counter {
+        file: File,
+    }
+
+    impl Counter {
+        pub(super) fn open(event: PerfEvent) -> io::Result<Self> {
+            let cache = |cache: u64| {
+                cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+            };
+            let (kind, config) = match event {
+                PerfEvent::Cycles => (PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES),
+                PerfEvent::Instructions => (PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS),
+                PerfEvent::L1dMisses => (PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_L1D)),
+                PerfEvent::LlcMisses => (PERF_TYPE_HW_CACHE, cache(PERF_COUNT_HW_CACHE_LL)),
+                PerfEvent::BranchMisses => (PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES),
+            };
+            let attr = PerfEventAttr {
+                kind,
+                size: std::mem::size_of::<PerfEventAttr>() as u32,
+                config,
+                read_format: PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING,
+                flags: ATTR_FLAG_EXCLUDE_KERNEL | ATTR_FLAG_EXCLUDE_HV,
+                ..Default::default()
+            };
+
+            // Calling thread (pid 0) on any CPU (-1), no group (-1)
+            // SAFETY: attr is a valid perf_event_attr of the declared size
+            let fd = unsafe {
+                syscall(
+                    SYS_PERF_EVENT_OPEN,
+                    &attr as *const PerfEventAttr,
+                    0 as c_int,
+                    -1 as c_int,
+                    -1 as c_int,
+                    PERF_FLAG_FD_CLOEXEC,
+                )
+            };
+            if fd < 0 {
+                let error = io::Error::last_os_error();
+                // ENOENT: no PMU for this event (common in virtual machines)
+                if error.raw_os_error() == Some(ENOENT) {
+                    return Err(io::Error::new(
+                        io::ErrorKind::Unsupported,
+                        format!("{} not supported by this CPU or hypervisor", event.name()),
+                    ));
+                }
+                return Err(error);
+            }
+            // SAFETY: the kernel returned a new file descriptor we own
+            let file = unsafe { File::from_raw_fd(fd as c_int) };
+            Ok(Self { file })
+        }
+
+        /// Current count, scaled for multiplexing (`None` if never scheduled).
+        pub(super) fn read(&self) -> Option<u64> {
+            let mut bytes = [0u8; 24];
+            (&self.file).read_exact(&mut bytes).ok()?;
+            let word = |i: usize| u64::from_ne_bytes(bytes[i * 8..i * 8 + 8].try_into().unwrap());
+            let (value, enabled, running) = (word(0), word(1), word(2));
+            if running == 0 {
+                return None;
+            }
+            if running == enabled {
+                return Some(value);
+            }
+            Some((value as u128 * enabled as u128 / running as u128) as u64)
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+mod sys {
+    use std::io;
+
+    use super::PerfEvent;
+
+    pub(super) enum Counter {}
+
+    impl Counter {
+        pub(super) fn open(_event: PerfEvent) -> io::Result<Self> {
+            Err(io::Error::new(
+                io::ErrorKind::Unsupported,
+                "hardware counters require Linux perf_event_open",
+            ))
+        }
+
+        pub(super) fn read(&self) -> Option<u64> {
+            match *self {}
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn counts(values: [Option<u64>; PerfEvent::COUNT]) -> PerfCounts {
+        PerfCounts { values }
+    }
+
+    #[test]
+    fn test_counts_arithmetic() {
+        let before = counts([Some(100), Some(50), None, Some(7), Some(1)]);
+        let after = counts([Some(400), Some(650), None, Some(9), Some(1)]);
+        let delta = after - before;
+        assert_eq!(delta, counts([Some(300), Some(600), None, Some(2), Some(0)]));
+        assert_eq!(delta.ipc(), Some(2.0));
+
+        let mut total = PerfCounts::default();
+        total += delta;
+        total += delta;
+        assert_eq!(total.get(PerfEvent::Instructions), Some(1200));
+        assert_eq!(total.get(PerfEvent::L1dMisses), None);
+
+        let report = PerfReport {
+            total,
+            samples: 100,
+            voices: 4,
+        };
+        assert_eq!(report.per_sample(PerfEvent::Cycles), Some(6.0));
+        assert_eq!(report.per_voice_sample(PerfEvent::Cycles), Some(1.5));
+        assert!(report.to_string().contains("n/a"));
+    }
+
+    #[test]
+    fn test_measure_counts_work() {
+        // Counters are unavailable in many containers and CI runners
+        let Ok(counters) = PerfCounters::open() else {
+            return;
+        };
+        let (sum, counts) = counters.measure(|| (0..100_000u64).map(std::hint::black_box).sum::<u64>());
+        assert_eq!(sum, 4_999_950_000);
+        if let Some(instructions) = counts.get(PerfEvent::Instructions) {
+            assert!(instructions >= 100_000);
+        }
+    }
+}
@@ -0,0 +1,123 @@
+//! Scripted test input: signals, automation, MIDI and transport.
+
+use beamer_core::{MidiChannel, MidiEvent, MidiNote, ParameterId, Transport};
+
+use crate::signal::Signal;
+
+/// A parameter change at an absolute sample position.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct Automation {
+    /// Absolute sample position.
+    pub at: usize,
+    /// Parameter ID.
+    pub id: ParameterId,
+    /// New normalized value (0.0 to 1.0).
+    pub normalized: f64,
+}
+
+/// Everything a [`TestHost`](crate::TestHost) feeds the plugin during a render.
+///
+/// Built with chained methods. Positions are absolute sample indices from the
+/// start of the render.
+///
+/// # Timing
+///
+/// Automation behaves like the VST3 wrapper: a change lands at the start of
+/// the block containing it. MIDI events keep their exact sample offsets.
+#[derive(Debug, Clone)]
+pub struct Script {
+    pub(crate) len: usize,
+    pub(crate) inputs: Vec<(usize, Signal)>,
+    pub(crate) default_input: Signal,
+    pub(crate) sidechain: Vec<(usize, Signal)>,
+    pub(crate) automation: Vec<Automation>,
+    pub(crate) midi: Vec<MidiEvent>,
+    pub(crate) transport: Transport,
+}
+
+impl Script {
+    /// Create a script rendering `len` samples of silence.
+    pub fn new(len: usize) -> Self {
+        Self {
+            len,
+            inputs: Vec::new(),
+            default_input: Signal::Silence,
+            sidechain: Vec::new(),
+            automation: Vec::new(),
+            midi: Vec::new(),
+            transport: Transport::default(),
+        }
+    }
+
+    /// Total number of samples to render.
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Whether the script renders nothing.
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Feed a signal into one main input channel.
+    pub fn input(mut self, channel: usize, signal: Signal) -> Self {
+        self.inputs.push((channel, signal));
+        self
+    }
+
+    /// Feed a signal into every main input channel without an explicit signal.
+    pub fn input_all(mut self, signal: Signal) -> Self {
+        self.default_input = signal;
+        self
+    }
+
+    /// Feed a signal into one channel of the sidechain (aux input bus 0).
+    pub fn sidechain(mut self, channel: usize, signal: Signal) -> Self {
+        self.sidechain.push((channel, signal));
+        self
+    }
+
+    /// Set a parameter to a normalized value at a sample position.
+    pub fn automate(mut self, at: usize, id: ParameterId, normalized: f64) -> Self {
+        self.automation.push(Automation { at, id, normalized });
+        self.automation.sort_by_key(|a| a.at);
+        self
+    }
+
+    /// Send a MIDI event. Its `sample_offset` is an absolute sample position.
+    pub fn midi(mut self, event: MidiEvent) -> Self {
+        self.midi.push(event);
+        self.midi.sort_by_key(|e| e.sample_offset);
+        self
+    }
+
+    /// Play a note: note-on at `at`, note-off `length` samples later.
+    pub fn note(self, at: usize, channel: MidiChannel, pitch: MidiNote, velocity: f32, length: usize) -> Self {
+        self.midi(MidiEvent::note_on(at as u32, channel, pitch, velocity, -1, 0.0, 0))
+            .midi(MidiEvent::note_off((at + length) as u32, channel, pitch, 0.0, -1, 0.0))
+    }
+
+    /// Set the transport state. `project_time_samples` advances per block if set.
+    pub fn transport(mut self, transport: Transport) -> Self {
+        self.transport = transport;
+        self
+    }
+
+    /// Signal for a main input channel.
+    pub(crate) fn input_signal(&self, channel: usize) -> &Signal {
+        self.inputs
+            .iter()
+            .rev()
+            .find(|(ch, _)| *ch == channel)
+            .map_or(&self.default_input, |(_, signal)| signal)
+    }
+
+    /// Signal for a sidechain channel.
+    pub(crate) fn sidechain_signal(&self, channel: usize) -> Option<&Signal> {
+        self.sidechain
+            .iter()
+            .rev()
+            .find(|(ch, _)| *ch == channel)
+            .map(|(_, signal)| signal)
+    }
+}
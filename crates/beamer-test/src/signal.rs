@@ -0,0 +1,89 @@
+//! Deterministic test signals.
+
+/// A deterministic input signal.
+///
+/// All generators are pure functions of the sample index and sample rate,
+/// so renders are reproducible across runs and machines.
+#[derive(Debug, Clone, PartialEq)]
+pub enum Signal {
+    /// Digital silence.
+    Silence,
+    /// Constant value.
+    Dc(f32),
+    /// Sine wave with frequency in Hz and peak amplitude.
+    Sine { frequency: f64, amplitude: f32 },
+    /// Single sample of the given amplitude at the given sample index.
+    Impulse { at: usize, amplitude: f32 },
+    /// Uniform white noise in `[-amplitude, amplitude]` from a fixed seed.
+    Noise { seed: u32, amplitude: f32 },
+    /// Linear sweep from `from` to `to` over the script length.
+    Ramp { from: f32, to: f32 },
+    /// Explicit samples; silence after the end.
+    Samples(Vec<f32>),
+}
+
+impl Signal {
+    /// Sine wave.
+    pub const fn sine(frequency: f64, amplitude: f32) -> Self {
+        Self::Sine { frequency, amplitude }
+    }
+
+    /// Unit impulse at sample 0.
+    pub const fn impulse() -> Self {
+        Self::Impulse { at: 0, amplitude: 1.0 }
+    }
+
+    /// White noise with a fixed seed.
+    pub const fn noise(seed: u32, amplitude: f32) -> Self {
+        Self::Noise { seed, amplitude }
+    }
+
+    /// Render `len` samples at `sample_rate`.
+    pub fn render(&self, len: usize, sample_rate: f64) -> Vec<f32> {
+        match self {
+            Self::Silence => vec![0.0; len],
+            Self::Dc(value) => vec![*value; len],
+            Self::Sine { frequency, amplitude } => (0..len)
+                .map(|i| {
+                    let phase = std::f64::consts::TAU * frequency * i as f64 / sample_rate;
+                    phase.sin() as f32 * amplitude
+                })
+                .collect(),
+            Self::Impulse { at, amplitude } => {
+                let mut out = vec![0.0; len];
+                if let Some(sample) = out.get_mut(*at) {
+                    *sample = *amplitude;
+                }
+                out
+            }
+            Self::Noise { seed, amplitude } => {
+                // xorshift32: tiny, deterministic, good enough for test input
+                let mut state = (*seed).max(1);
+                (0..len)
+                    .map(|_| {
+                        state ^= state << 13;
+                        state ^= state >> 17;
+                        state ^= state << 5;
+                        (state as f32 / u32::MAX as f32 * 2.0 - 1.0) * amplitude
+                    })
+                    .collect()
+            }
+            Self::Ramp { from, to } => {
+                let step = if len > 1 { (to - from) / (len - 1) as f32 } else { 0.0 };
+                (0..len).map(|i| from + step * i as f32).collect()
+            }
+            Self::Samples(samples) => {
+                let mut out = vec![0.0; len];
+                let n = samples.len().min(len);
+                out[..n].copy_from_slice(&samples[..n]);
+                out
+            }
+        }
+    }
+}
+
+impl Default for Signal {
+    fn default() -> Self {
+        Self::Silence
+    }
+}
@@ -0,0 +1,583 @@
+//! Type-erased control-plane paths shared by every `Vst3Processor<P>`.
+//!
+//! The COM interface impls on [`Vst3Processor<P>`](crate::Vst3Processor) have
+//! to exist per plugin type, but most of them are cold: hosts call
+//! `getParameterInfo`, `getUnitInfo`, MIDI mapping, note expression and
+//! keyswitch queries when loading a plugin or opening a menu, never per block.
+//! Their bodies live here as non-generic functions over trait objects
+//! ([`ParameterStore`], [`ParameterGroups`] and [`PluginControl`]), so they are
+//! compiled once per binary instead of once per plugin, and the generic impls
+//! shrink to one-line shims.
+//!
+//! `process()` and the parameter hot path (`getParamNormalized`,
+//! `setParamNormalized`) stay generic, so the audio path keeps static
+//! dispatch.
+//!
+//! Functions are `#[inline(never)]` so release builds with LTO keep the single
+//! shared copy instead of inlining it back into every plugin's shims.
+
+use std::slice;
+
+use vst3::Steinberg::Vst::*;
+use vst3::Steinberg::*;
+
+use beamer_core::parameter_groups::ParameterGroups;
+use beamer_core::{
+    KeyswitchInfo as CoreKeyswitchInfo, Midi1Assignment, Midi2Assignment, MidiCcState,
+    NoteExpressionTypeInfo as CoreNoteExpressionTypeInfo, ParameterStore, PhysicalUIMap, Plugin,
+};
+
+use crate::util::{copy_wstring, len_wstring};
+
+// =============================================================================
+// PluginControl
+// =============================================================================
+
+/// Object-safe view of the [`Plugin`] methods used by controller interfaces.
+///
+/// `Plugin` itself has associated types and can't be a trait object; this
+/// trait exposes just the control-plane queries, implemented for every plugin.
+pub(crate) trait PluginControl {
+    fn midi_cc_to_parameter(&self, bus_index: i32, channel: i16, cc: u8) -> Option<u32>;
+    fn midi1_assignments(&self) -> &[Midi1Assignment];
+    fn midi2_assignments(&self) -> &[Midi2Assignment];
+    fn note_expression_count(&self, bus_index: i32, channel: i16) -> usize;
+    fn note_expression_info(&self, bus_index: i32, channel: i16, index: usize) -> Option<CoreNoteExpressionTypeInfo>;
+    fn note_expression_value_to_string(&self, bus_index: i32, channel: i16, type_id: u32, value: f64) -> String;
+    fn note_expression_string_to_value(&self, bus_index: i32, channel: i16, type_id: u32, string: &str) -> Option<f64>;
+    fn keyswitch_count(&self, bus_index: i32, channel: i16) -> usize;
+    fn keyswitch_info(&self, bus_index: i32, channel: i16, index: usize) -> Option<CoreKeyswitchInfo>;
+    fn physical_ui_mappings(&self, bus_index: i32, channel: i16) -> &[PhysicalUIMap];
+}
+
+impl<P: Plugin> PluginControl for P {
+    fn midi_cc_to_parameter(&self, bus_index: i32, channel: i16, cc: u8) -> Option<u32> {
+        Plugin::midi_cc_to_parameter(self, bus_index, channel, cc)
+    }
+
+    fn midi1_assignments(&self) -> &[Midi1Assignment] {
+        Plugin::midi1_assignments(self)
+    }
+
+    fn midi2_assignments(&self) -> &[Midi2Assignment] {
+        Plugin::midi2_assignments(self)
+    }
+
+    fn note_expression_count(&self, bus_index: i32, channel: i16) -> usize {
+        Plugin::note_expression_count(self, bus_index, channel)
+    }
+
+    fn note_expression_info(&self, bus_index: i32, channel: i16, index: usize) -> Option<CoreNoteExpressionTypeInfo> {
+        Plugin::note_expression_info(self, bus_index, channel, index)
+    }
+
+    fn note_expression_value_to_string(&self, bus_index: i32, channel: i16, type_id: u32, value: f64) -> String {
+        Plugin::note_expression_value_to_string(self, bus_index, channel, type_id, value)
+    }
+
+    fn note_expression_string_to_value(&self, bus_index: i32, channel: i16, type_id: u32, string: &str) -> Option<f64> {
+        Plugin::note_expression_string_to_value(self, bus_index, channel, type_id, string)
+    }
+
+    fn keyswitch_count(&self, bus_index: i32, channel: i16) -> usize {
+        Plugin::keyswitch_count(self, bus_index, channel)
+    }
+
+    fn keyswitch_info(&self, bus_index: i32, channel: i16, index: usize) -> Option<CoreKeyswitchInfo> {
+        Plugin::keyswitch_info(self, bus_index, channel, index)
+    }
+
+    fn physical_ui_mappings(&self, bus_index: i32, channel: i16) -> &[PhysicalUIMap] {
+        Plugin::physical_ui_mappings(self, bus_index, channel)
+    }
+}
+
+// =============================================================================
+// IEditController (parameter metadata and display)
+// =============================================================================
+
+/// User parameters plus enabled MIDI CC emulation parameters.
+#[inline(never)]
+pub(crate) fn parameter_count(parameters: &dyn ParameterStore, midi_cc_state: Option<&MidiCcState>) -> i32 {
+    let user_parameters = parameters.count();
+    // MIDI CC state is framework-owned, always available
+    let cc_parameters = midi_cc_state.map(|s| s.enabled_count()).unwrap_or(0);
+    (user_parameters + cc_parameters) as i32
+}
+
+/// Fill `ParameterInfo`: user parameters first, then hidden MIDI CC parameters.
+///
+/// # Safety
+/// `info` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn parameter_info(
+    parameters: &dyn ParameterStore,
+    midi_cc_state: Option<&MidiCcState>,
+    parameter_index: i32,
+    info: *mut ParameterInfo,
+) -> tresult {
+    if info.is_null() || parameter_index < 0 {
+        return kInvalidArgument;
+    }
+
+    let user_parameter_count = parameters.count();
+
+    // User-defined parameters first
+    if (parameter_index as usize) < user_parameter_count {
+        if let Some(parameter_info) = parameters.info(parameter_index as usize) {
+            let info = &mut *info;
+            info.id = parameter_info.id;
+            copy_wstring(parameter_info.name, &mut info.title);
+            copy_wstring(parameter_info.short_name, &mut info.shortTitle);
+            copy_wstring(parameter_info.units, &mut info.units);
+            info.stepCount = parameter_info.step_count;
+            info.defaultNormalizedValue = parameter_info.default_normalized;
+            info.unitId = parameter_info.group_id;
+            info.flags = {
+                let mut flags = 0;
+                if parameter_info.flags.can_automate {
+                    flags |= ParameterInfo_::ParameterFlags_::kCanAutomate;
+                }
+                if parameter_info.flags.is_bypass {
+                    flags |= ParameterInfo_::ParameterFlags_::kIsBypass;
+                }
+                // List parameters (enums) - display as dropdown with text labels
+                if parameter_info.flags.is_list {
+                    flags |= ParameterInfo_::ParameterFlags_::kIsList;
+                }
+                // Hidden parameters (MIDI CC emulation)
+                if parameter_info.flags.is_hidden {
+                    flags |= ParameterInfo_::ParameterFlags_::kIsHidden;
+                }
+                flags
+            };
+            return kResultOk;
+        }
+        return kInvalidArgument;
+    }
+
+    // Hidden MIDI CC parameters (framework-owned state)
+    if let Some(cc_state) = midi_cc_state {
+        let cc_index = (parameter_index as usize) - user_parameter_count;
+        if let Some(parameter_info) = cc_state.info(cc_index) {
+            let info = &mut *info;
+            info.id = parameter_info.id;
+            copy_wstring(parameter_info.name, &mut info.title);
+            copy_wstring(parameter_info.short_name, &mut info.shortTitle);
+            copy_wstring(parameter_info.units, &mut info.units);
+            info.stepCount = parameter_info.step_count;
+            info.defaultNormalizedValue = parameter_info.default_normalized;
+            info.unitId = parameter_info.group_id;
+            // Hidden + automatable
+            info.flags = ParameterInfo_::ParameterFlags_::kCanAutomate
+                | ParameterInfo_::ParameterFlags_::kIsHidden;
+            return kResultOk;
+        }
+    }
+
+    kInvalidArgument
+}
+
+/// Format a normalized value for display.
+///
+/// # Safety
+/// `string` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn param_string_by_value(
+    parameters: &dyn ParameterStore,
+    id: u32,
+    value_normalized: f64,
+    string: *mut String128,
+) -> tresult {
+    if string.is_null() {
+        return kInvalidArgument;
+    }
+
+    let display = parameters.normalized_to_string(id, value_normalized);
+    copy_wstring(&display, &mut *string);
+    kResultOk
+}
+
+/// Parse a display string to a normalized value.
+///
+/// # Safety
+/// `string` must be null or NUL-terminated; `value_normalized` null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn param_value_by_string(
+    parameters: &dyn ParameterStore,
+    id: u32,
+    string: *mut TChar,
+    value_normalized: *mut f64,
+) -> tresult {
+    if string.is_null() || value_normalized.is_null() {
+        return kInvalidArgument;
+    }
+
+    let len = len_wstring(string as *const TChar);
+    if let Ok(s) = String::from_utf16(slice::from_raw_parts(string as *const u16, len)) {
+        if let Some(value) = parameters.string_to_normalized(id, &s) {
+            *value_normalized = value;
+            return kResultOk;
+        }
+    }
+    kInvalidArgument
+}
+
+// =============================================================================
+// IUnitInfo
+// =============================================================================
+
+/// Fill `UnitInfo` from a parameter group.
+///
+/// # Safety
+/// `info` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn unit_info(groups: &dyn ParameterGroups, unit_index: i32, info: *mut UnitInfo) -> tresult {
+    if info.is_null() || unit_index < 0 {
+        return kInvalidArgument;
+    }
+
+    if let Some(group_info) = groups.group_info(unit_index as usize) {
+        let info = &mut *info;
+        info.id = group_info.id;
+        info.parentUnitId = group_info.parent_id;
+        info.programListId = kNoProgramListId;
+        copy_wstring(group_info.name, &mut info.name);
+        kResultOk
+    } else {
+        kInvalidArgument
+    }
+}
+
+// =============================================================================
+// IMidiMapping / IMidiMapping2
+// =============================================================================
+
+/// Resolve a MIDI controller to a parameter: plugin mappings first (only
+/// available unprepared), then framework-owned MIDI CC emulation.
+///
+/// # Safety
+/// `id` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn midi_controller_assignment(
+    plugin: Option<&dyn PluginControl>,
+    midi_cc_state: Option<&MidiCcState>,
+    bus_index: i32,
+    channel: i16,
+    midi_controller_number: i16,
+    id: *mut u32,
+) -> tresult {
+    if id.is_null() {
+        return kInvalidArgument;
+    }
+
+    let controller = midi_controller_number as u8;
+
+    // 1. First check plugin's custom mappings (only available in unprepared state)
+    if let Some(plugin) = plugin {
+        if let Some(parameter_id) = plugin.midi_cc_to_parameter(bus_index, channel, controller) {
+            *id = parameter_id;
+            return kResultOk;
+        }
+    }
+
+    // 2. Check framework-owned MIDI CC state (omni channel - ignore channel parameter)
+    if let Some(cc_state) = midi_cc_state {
+        if cc_state.has_controller(controller) {
+            *id = MidiCcState::parameter_id(controller);
+            return kResultOk;
+        }
+    }
+
+    kResultFalse
+}
+
+/// Number of MIDI 1.0 controller assignments (input direction only).
+#[inline(never)]
+pub(crate) fn midi1_assignment_count(plugin: Option<&dyn PluginControl>, direction: BusDirections) -> u32 {
+    if direction != BusDirections_::kInput {
+        return 0;
+    }
+    plugin.map(|p| p.midi1_assignments().len() as u32).unwrap_or(0)
+}
+
+/// Fill the host's MIDI 1.0 assignment list.
+///
+/// # Safety
+/// `list` must be null or point to a list with `count` writable entries.
+#[inline(never)]
+pub(crate) unsafe fn midi1_assignments(
+    plugin: Option<&dyn PluginControl>,
+    direction: BusDirections,
+    list: *const Midi1ControllerParamIDAssignmentList,
+) -> tresult {
+    if list.is_null() || direction != BusDirections_::kInput {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kResultFalse;
+    };
+    let assignments = plugin.midi1_assignments();
+    let list_ref = &*list;
+
+    if (list_ref.count as usize) < assignments.len() {
+        return kResultFalse;
+    }
+
+    if assignments.is_empty() {
+        return kResultOk;
+    }
+
+    let map = slice::from_raw_parts_mut(list_ref.map, assignments.len());
+    for (i, a) in assignments.iter().enumerate() {
+        map[i] = Midi1ControllerParamIDAssignment {
+            pId: a.assignment.parameter_id,
+            busIndex: a.assignment.bus_index,
+            channel: a.assignment.channel,
+            controller: a.controller as i16,
+        };
+    }
+
+    kResultOk
+}
+
+/// Number of MIDI 2.0 controller assignments (input direction only).
+#[inline(never)]
+pub(crate) fn midi2_assignment_count(plugin: Option<&dyn PluginControl>, direction: BusDirections) -> u32 {
+    if direction != BusDirections_::kInput {
+        return 0;
+    }
+    plugin.map(|p| p.midi2_assignments().len() as u32).unwrap_or(0)
+}
+
+/// Fill the host's MIDI 2.0 assignment list.
+///
+/// # Safety
+/// `list` must be null or point to a list with `count` writable entries.
+#[inline(never)]
+pub(crate) unsafe fn midi2_assignments(
+    plugin: Option<&dyn PluginControl>,
+    direction: BusDirections,
+    list: *const Midi2ControllerParamIDAssignmentList,
+) -> tresult {
+    if list.is_null() || direction != BusDirections_::kInput {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kResultFalse;
+    };
+    let assignments = plugin.midi2_assignments();
+    let list_ref = &*list;
+
+    if (list_ref.count as usize) < assignments.len() {
+        return kResultFalse;
+    }
+
+    if assignments.is_empty() {
+        return kResultOk;
+    }
+
+    let map = slice::from_raw_parts_mut(list_ref.map, assignments.len());
+    for (i, a) in assignments.iter().enumerate() {
+        map[i] = Midi2ControllerParamIDAssignment {
+            pId: a.assignment.parameter_id,
+            busIndex: a.assignment.bus_index,
+            channel: a.assignment.channel,
+            controller: Midi2Controller {
+                bank: a.controller.bank,
+                registered: if a.controller.registered { 1 } else { 0 },
+                index: a.controller.index,
+                reserved: 0,
+            },
+        };
+    }
+
+    kResultOk
+}
+
+// =============================================================================
+// INoteExpressionController
+// =============================================================================
+
+/// Number of note expression types.
+#[inline(never)]
+pub(crate) fn note_expression_count(plugin: Option<&dyn PluginControl>, bus_index: i32, channel: i16) -> i32 {
+    plugin
+        .map(|p| p.note_expression_count(bus_index, channel) as i32)
+        .unwrap_or(0)
+}
+
+/// Fill `NoteExpressionTypeInfo`.
+///
+/// # Safety
+/// `info` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn note_expression_info(
+    plugin: Option<&dyn PluginControl>,
+    bus_index: i32,
+    channel: i16,
+    note_expression_index: i32,
+    info: *mut NoteExpressionTypeInfo,
+) -> tresult {
+    if info.is_null() || note_expression_index < 0 {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kInvalidArgument;
+    };
+    if let Some(expr_info) = plugin.note_expression_info(bus_index, channel, note_expression_index as usize) {
+        let vst_info = &mut *info;
+        vst_info.typeId = expr_info.type_id;
+        copy_wstring(expr_info.title_str(), &mut vst_info.title);
+        copy_wstring(expr_info.short_title_str(), &mut vst_info.shortTitle);
+        copy_wstring(expr_info.units_str(), &mut vst_info.units);
+        vst_info.unitId = expr_info.unit_id;
+        vst_info.valueDesc.minimum = expr_info.value_desc.minimum;
+        vst_info.valueDesc.maximum = expr_info.value_desc.maximum;
+        vst_info.valueDesc.defaultValue = expr_info.value_desc.default_value;
+        vst_info.valueDesc.stepCount = expr_info.value_desc.step_count;
+        vst_info.associatedParameterId = expr_info.associated_parameter_id as u32;
+        vst_info.flags = expr_info.flags.0;
+        kResultOk
+    } else {
+        kInvalidArgument
+    }
+}
+
+/// Format a note expression value for display.
+///
+/// # Safety
+/// `string` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn note_expression_string_by_value(
+    plugin: Option<&dyn PluginControl>,
+    bus_index: i32,
+    channel: i16,
+    id: NoteExpressionTypeID,
+    value_normalized: NoteExpressionValue,
+    string: *mut String128,
+) -> tresult {
+    if string.is_null() {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kInvalidArgument;
+    };
+    let display = plugin.note_expression_value_to_string(bus_index, channel, id, value_normalized);
+    copy_wstring(&display, &mut *string);
+    kResultOk
+}
+
+/// Parse a note expression display string.
+///
+/// # Safety
+/// `string` must be null or NUL-terminated; `value_normalized` null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn note_expression_value_by_string(
+    plugin: Option<&dyn PluginControl>,
+    bus_index: i32,
+    channel: i16,
+    id: NoteExpressionTypeID,
+    string: *const TChar,
+    value_normalized: *mut NoteExpressionValue,
+) -> tresult {
+    if string.is_null() || value_normalized.is_null() {
+        return kInvalidArgument;
+    }
+
+    let len = len_wstring(string);
+    if let Ok(s) = String::from_utf16(slice::from_raw_parts(string, len)) {
+        if let Some(plugin) = plugin {
+            if let Some(value) = plugin.note_expression_string_to_value(bus_index, channel, id, &s) {
+                *value_normalized = value;
+                return kResultOk;
+            }
+        }
+    }
+    kResultFalse
+}
+
+// =============================================================================
+// IKeyswitchController / INoteExpressionPhysicalUIMapping
+// =============================================================================
+
+/// Number of keyswitches.
+#[inline(never)]
+pub(crate) fn keyswitch_count(plugin: Option<&dyn PluginControl>, bus_index: i32, channel: i16) -> i32 {
+    plugin
+        .map(|p| p.keyswitch_count(bus_index, channel) as i32)
+        .unwrap_or(0)
+}
+
+/// Fill `KeyswitchInfo`.
+///
+/// # Safety
+/// `info` must be null or valid for writes.
+#[inline(never)]
+pub(crate) unsafe fn keyswitch_info(
+    plugin: Option<&dyn PluginControl>,
+    bus_index: i32,
+    channel: i16,
+    keyswitch_index: i32,
+    info: *mut KeyswitchInfo,
+) -> tresult {
+    if info.is_null() || keyswitch_index < 0 {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kInvalidArgument;
+    };
+    if let Some(ks_info) = plugin.keyswitch_info(bus_index, channel, keyswitch_index as usize) {
+        let vst_info = &mut *info;
+        vst_info.typeId = ks_info.type_id;
+        copy_wstring(ks_info.title_str(), &mut vst_info.title);
+        copy_wstring(ks_info.short_title_str(), &mut vst_info.shortTitle);
+        vst_info.keyswitchMin = ks_info.keyswitch_min;
+        vst_info.keyswitchMax = ks_info.keyswitch_max;
+        vst_info.keyRemapped = ks_info.key_remapped;
+        vst_info.unitId = ks_info.unit_id;
+        vst_info.flags = ks_info.flags;
+        kResultOk
+    } else {
+        kInvalidArgument
+    }
+}
+
+/// Fill the host's physical UI mapping list, up to its count.
+///
+/// # Safety
+/// `list` must be null or valid, with `map` null or holding `count` entries.
+#[inline(never)]
+pub(crate) unsafe fn physical_ui_mapping(
+    plugin: Option<&dyn PluginControl>,
+    bus_index: i32,
+    channel: i16,
+    list: *mut PhysicalUIMapList,
+) -> tresult {
+    if list.is_null() {
+        return kInvalidArgument;
+    }
+
+    let Some(plugin) = plugin else {
+        return kInvalidArgument;
+    };
+    let mappings = plugin.physical_ui_mappings(bus_index, channel);
+    let list_ref = &mut *list;
+
+    // Fill in the mappings up to the provided count
+    let fill_count = (list_ref.count as usize).min(mappings.len());
+    if fill_count > 0 && !list_ref.map.is_null() {
+        let map_slice = slice::from_raw_parts_mut(list_ref.map, fill_count);
+        for (i, mapping) in mappings.iter().take(fill_count).enumerate() {
+            map_slice[i].physicalUITypeID = mapping.physical_ui_type_id;
+            map_slice[i].noteExpressionTypeID = mapping.note_expression_type_id;
+        }
+    }
+
+    kResultOk
+}
@@ -1,6 +1,6 @@
 //! VST3 export macros and entry points.
 
-/// Generate VST3 entry points for a plugin.
+/// Generate VST3 entry points for one or more plugins.
 ///
 /// This macro generates the platform-specific entry points and the
 /// `GetPluginFactory` function required by the VST3 host.
@@ -25,9 +25,26 @@
 ///
 /// export_vst3!(CONFIG, VST3_CONFIG, Vst3Processor<MyPlugin>);
 /// ```
+///
+/// # Plugin Suites
+///
+/// A bracketed list exports several plugins from one binary. The host sees
+/// every class in the factory; the framework code, the wrapper code shared
+/// between plugins and all `static` data (lookup tables,
+/// [`SharedService`](beamer_core::SharedService)s) are loaded once instead
+/// of once per plugin. Each plugin needs its own component UID.
+///
+/// ```rust,ignore
+/// export_vst3!([
+///     (EQ_CONFIG, EQ_VST3_CONFIG, Vst3Processor<Equalizer>),
+///     (COMP_CONFIG, COMP_VST3_CONFIG, Vst3Processor<Compressor>),
+///     (GATE_CONFIG, GATE_VST3_CONFIG, Vst3Processor<Gate>),
+/// ]);
+/// ```
 #[macro_export]
 macro_rules! export_vst3 {
-    ($config:expr, $vst3_config:expr, $component:ty) => {
+    // Matched first: a class list must not be parsed as an `expr`
+    ([$(($config:expr, $vst3_config:expr, $component:ty)),+ $(,)?]) => {
         // Platform-specific entry points
 
         #[cfg(target_os = "windows")]
@@ -71,9 +88,11 @@ macro_rules! export_vst3 {
         #[no_mangle]
         extern "system" fn GetPluginFactory() -> *mut std::ffi::c_void {
             use vst3::ComWrapper;
-            use $crate::Factory;
+            use $crate::factory::{ClassEntry, Factory};
+
+            static CLASSES: &[ClassEntry] = &[$(ClassEntry::new::<$component>(&$config, &$vst3_config)),+];
 
-            let factory = Factory::<$component>::new(&$config, &$vst3_config);
+            let factory = Factory::new(CLASSES);
             let wrapper = ComWrapper::new(factory);
 
             wrapper
@@ -82,4 +101,7 @@ macro_rules! export_vst3 {
                 .into_raw() as *mut std::ffi::c_void
         }
     };
+    ($config:expr, $vst3_config:expr, $component:ty) => {
+        $crate::export_vst3!([($config, $vst3_config, $component)]);
+    };
 }
@@ -1,9 +1,11 @@
 //! VST3 Plugin Factory implementation.
 //!
-//! Generic factory with inline component creation.
+//! One factory lists every plugin class exported by the module. Each class is
+//! a [`ClassEntry`]: its configs plus a creation function monomorphized for
+//! its component type, so the factory itself is not generic and a module
+//! exporting many plugins shares one copy of the framework code and statics.
 
 use std::ffi::c_void;
-use std::marker::PhantomData;
 
 use beamer_core::PluginConfig;
 use vst3::com_scrape_types::MakeHeader;
@@ -12,91 +14,177 @@ use vst3::{Class, ComWrapper, Steinberg::*};
 use crate::util::{copy_cstring, copy_wstring};
 use crate::wrapper::Vst3Config;
 
-/// VST3 Plugin Factory.
+/// Trait implemented by component types that can be constructed from plugin configs.
+pub trait ComponentFactory: Class {
+    fn create(config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self;
+}
+
+/// Creates a component and queries the requested interface.
+type CreateFn =
+    unsafe fn(&'static PluginConfig, &'static Vst3Config, *const TUID, *mut *mut c_void) -> tresult;
+
+/// One plugin class exported by the module.
 ///
-/// Generic over the component type C. Creates combined component instances
-/// (IComponent + IEditController in one object).
-pub struct Factory<C> {
+/// Built in a `static` by [`export_vst3!`](crate::export_vst3).
+pub struct ClassEntry {
     config: &'static PluginConfig,
     vst3_config: &'static Vst3Config,
-    _marker: PhantomData<C>,
+    create: CreateFn,
 }
 
-impl<C> Factory<C> {
-    /// Create a new factory with the given configuration.
-    pub const fn new(config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self {
+impl ClassEntry {
+    /// Register component type `C` with its configuration.
+    pub const fn new<C>(config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self
+    where
+        C: ComponentFactory + 'static,
+        C::Interfaces: MakeHeader<C, ComWrapper<C>>,
+    {
         Self {
             config,
             vst3_config,
-            _marker: PhantomData,
+            create: create_instance::<C>,
         }
     }
-}
 
-/// Trait implemented by component types that can be constructed from plugin configs.
-pub trait ComponentFactory: Class {
-    fn create(config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self;
+    /// Shared plugin configuration of this class.
+    pub fn config(&self) -> &'static PluginConfig {
+        self.config
+    }
+
+    /// VST3 configuration of this class.
+    pub fn vst3_config(&self) -> &'static Vst3Config {
+        self.vst3_config
+    }
+
+    /// Returns true if `cid` is this class's component or controller UID.
+    fn matches(&self, cid: &TUID) -> bool {
+        *cid == self.vst3_config.component_uid || self.vst3_config.controller_uid.as_ref() == Some(cid)
+    }
 }
 
-impl<C> Class for Factory<C>
+unsafe fn create_instance<C>(
+    config: &'static PluginConfig,
+    vst3_config: &'static Vst3Config,
+    iid: *const TUID,
+    obj: *mut *mut c_void,
+) -> tresult
 where
     C: ComponentFactory + 'static,
     C::Interfaces: MakeHeader<C, ComWrapper<C>>,
 {
+    let component = ComWrapper::new(C::create(config, vst3_config));
+    let unknown = component.as_com_ref::<FUnknown>().unwrap();
+    let ptr = unknown.as_ptr();
+    ((*(*ptr).vtbl).queryInterface)(ptr, iid, obj)
+}
+
+/// VST3 Plugin Factory.
+///
+/// Lists the classes of every exported plugin: one audio module class per
+/// plugin, followed by its controller class when the plugin registers one.
+/// Creates combined component instances (IComponent + IEditController in one
+/// object). Factory info (vendor, URL, email) comes from the first class.
+pub struct Factory {
+    classes: &'static [ClassEntry],
+}
+
+/// Kind of a factory class index.
+#[derive(Clone, Copy)]
+enum ClassKind {
+    Component,
+    Controller,
+}
+
+impl Factory {
+    /// Create a factory for the given classes.
+    pub fn new(classes: &'static [ClassEntry]) -> Self {
+        for (i, a) in classes.iter().enumerate() {
+            for b in &classes[i + 1..] {
+                if a.matches(&b.vst3_config.component_uid)
+                    || b.vst3_config.controller_uid.is_some_and(|uid| a.matches(&uid))
+                {
+                    log::warn!(
+                        "Plugins '{}' and '{}' share a class UID; the host will only see one of them",
+                        a.config.name,
+                        b.config.name
+                    );
+                }
+            }
+        }
+        Self { classes }
+    }
+
+    /// Class entry and kind for a factory class index.
+    fn class(&self, index: i32) -> Option<(&ClassEntry, ClassKind)> {
+        let mut index = usize::try_from(index).ok()?;
+        for entry in self.classes {
+            if index == 0 {
+                return Some((entry, ClassKind::Component));
+            }
+            if entry.vst3_config.has_controller() {
+                if index == 1 {
+                    return Some((entry, ClassKind::Controller));
+                }
+                index -= 2;
+            } else {
+                index -= 1;
+            }
+        }
+        None
+    }
+}
+
+impl Class for Factory {
     type Interfaces = (IPluginFactory3,);
 }
 
-impl<C> IPluginFactoryTrait for Factory<C>
-where
-    C: ComponentFactory + 'static,
-    C::Interfaces: MakeHeader<C, ComWrapper<C>>,
-{
+impl IPluginFactoryTrait for Factory {
     unsafe fn getFactoryInfo(&self, info: *mut PFactoryInfo) -> tresult {
         if info.is_null() {
             return kInvalidArgument;
         }
+        let Some(first) = self.classes.first() else {
+            return kNotInitialized;
+        };
 
         let info = &mut *info;
-        copy_cstring(self.config.vendor, &mut info.vendor);
-        copy_cstring(self.config.url, &mut info.url);
-        copy_cstring(self.config.email, &mut info.email);
+        copy_cstring(first.config.vendor, &mut info.vendor);
+        copy_cstring(first.config.url, &mut info.url);
+        copy_cstring(first.config.email, &mut info.email);
         info.flags = PFactoryInfo_::FactoryFlags_::kUnicode as int32;
 
         kResultOk
     }
 
     unsafe fn countClasses(&self) -> i32 {
-        if self.vst3_config.has_controller() {
-            2
-        } else {
-            1
-        }
+        self.classes
+            .iter()
+            .map(|entry| if entry.vst3_config.has_controller() { 2 } else { 1 })
+            .sum()
     }
 
     unsafe fn getClassInfo(&self, index: i32, info: *mut PClassInfo) -> tresult {
         if info.is_null() {
             return kInvalidArgument;
         }
+        let Some((entry, kind)) = self.class(index) else {
+            return kInvalidArgument;
+        };
 
-        match index {
-            0 => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.component_uid;
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        let info = &mut *info;
+        info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        copy_cstring(entry.config.name, &mut info.name);
+        match kind {
+            ClassKind::Component => {
+                info.cid = entry.vst3_config.component_uid;
                 copy_cstring("Audio Module Class", &mut info.category);
-                copy_cstring(self.config.name, &mut info.name);
-                kResultOk
             }
-            1 if self.vst3_config.has_controller() => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.controller_uid.unwrap();
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+            ClassKind::Controller => {
+                info.cid = entry.vst3_config.controller_uid.unwrap();
                 copy_cstring("Component Controller Class", &mut info.category);
-                copy_cstring(self.config.name, &mut info.name);
-                kResultOk
             }
-            _ => kInvalidArgument,
         }
+        kResultOk
     }
 
     unsafe fn createInstance(
@@ -111,106 +199,79 @@ where
 
         let requested_cid = &*(cid as *const TUID);
 
-        // Check if request matches component or controller UID
-        if *requested_cid != self.vst3_config.component_uid {
-            if let Some(controller_uid) = self.vst3_config.controller_uid {
-                if *requested_cid != controller_uid {
-                    return kInvalidArgument;
-                }
-            } else {
-                return kInvalidArgument;
-            }
-        }
+        // Find the class whose component or controller UID matches
+        let Some(entry) = self.classes.iter().find(|entry| entry.matches(requested_cid)) else {
+            return kInvalidArgument;
+        };
 
         // Create component and query requested interface
-        let component = ComWrapper::new(C::create(self.config, self.vst3_config));
-        let unknown = component.as_com_ref::<FUnknown>().unwrap();
-        let ptr = unknown.as_ptr();
-        ((*(*ptr).vtbl).queryInterface)(ptr, iid as *const TUID, obj)
+        (entry.create)(entry.config, entry.vst3_config, iid as *const TUID, obj)
     }
 }
 
-impl<C> IPluginFactory2Trait for Factory<C>
-where
-    C: ComponentFactory + 'static,
-    C::Interfaces: MakeHeader<C, ComWrapper<C>>,
-{
+impl IPluginFactory2Trait for Factory {
     unsafe fn getClassInfo2(&self, index: i32, info: *mut PClassInfo2) -> tresult {
         if info.is_null() {
             return kInvalidArgument;
         }
+        let Some((entry, kind)) = self.class(index) else {
+            return kInvalidArgument;
+        };
 
-        match index {
-            0 => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.component_uid;
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        let info = &mut *info;
+        info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        copy_cstring(entry.config.name, &mut info.name);
+        copy_cstring(entry.config.vendor, &mut info.vendor);
+        copy_cstring(entry.config.version, &mut info.version);
+        copy_cstring("VST 3.8.0", &mut info.sdkVersion);
+        match kind {
+            ClassKind::Component => {
+                info.cid = entry.vst3_config.component_uid;
                 copy_cstring("Audio Module Class", &mut info.category);
-                copy_cstring(self.config.name, &mut info.name);
                 info.classFlags = 0;
-                copy_cstring(self.config.sub_categories, &mut info.subCategories);
-                copy_cstring(self.config.vendor, &mut info.vendor);
-                copy_cstring(self.config.version, &mut info.version);
-                copy_cstring("VST 3.8.0", &mut info.sdkVersion);
-                kResultOk
+                copy_cstring(entry.config.sub_categories, &mut info.subCategories);
             }
-            1 if self.vst3_config.has_controller() => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.controller_uid.unwrap();
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+            ClassKind::Controller => {
+                info.cid = entry.vst3_config.controller_uid.unwrap();
                 copy_cstring("Component Controller Class", &mut info.category);
-                copy_cstring(self.config.name, &mut info.name);
                 info.classFlags = 1; // kComponentControllerClass
                 copy_cstring("", &mut info.subCategories);
-                copy_cstring(self.config.vendor, &mut info.vendor);
-                copy_cstring(self.config.version, &mut info.version);
-                copy_cstring("VST 3.8.0", &mut info.sdkVersion);
-                kResultOk
             }
-            _ => kInvalidArgument,
         }
+        kResultOk
     }
 }
 
-impl<C> IPluginFactory3Trait for Factory<C>
-where
-    C: ComponentFactory + 'static,
-    C::Interfaces: MakeHeader<C, ComWrapper<C>>,
-{
+impl IPluginFactory3Trait for Factory {
     unsafe fn getClassInfoUnicode(&self, index: i32, info: *mut PClassInfoW) -> tresult {
         if info.is_null() {
             return kInvalidArgument;
         }
+        let Some((entry, kind)) = self.class(index) else {
+            return kInvalidArgument;
+        };
 
-        match index {
-            0 => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.component_uid;
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        let info = &mut *info;
+        info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+        copy_wstring(entry.config.name, &mut info.name);
+        copy_wstring(entry.config.vendor, &mut info.vendor);
+        copy_wstring(entry.config.version, &mut info.version);
+        copy_wstring("VST 3.8.0", &mut info.sdkVersion);
+        match kind {
+            ClassKind::Component => {
+                info.cid = entry.vst3_config.component_uid;
                 copy_cstring("Audio Module Class", &mut info.category);
-                copy_wstring(self.config.name, &mut info.name);
                 info.classFlags = 0;
-                copy_cstring(self.config.sub_categories, &mut info.subCategories);
-                copy_wstring(self.config.vendor, &mut info.vendor);
-                copy_wstring(self.config.version, &mut info.version);
-                copy_wstring("VST 3.8.0", &mut info.sdkVersion);
-                kResultOk
+                copy_cstring(entry.config.sub_categories, &mut info.subCategories);
             }
-            1 if self.vst3_config.has_controller() => {
-                let info = &mut *info;
-                info.cid = self.vst3_config.controller_uid.unwrap();
-                info.cardinality = PClassInfo_::ClassCardinality_::kManyInstances as int32;
+            ClassKind::Controller => {
+                info.cid = entry.vst3_config.controller_uid.unwrap();
                 copy_cstring("Component Controller Class", &mut info.category);
-                copy_wstring(self.config.name, &mut info.name);
                 info.classFlags = 1; // kComponentControllerClass
                 copy_cstring("", &mut info.subCategories);
-                copy_wstring(self.config.vendor, &mut info.vendor);
-                copy_wstring(self.config.version, &mut info.version);
-                copy_wstring("VST 3.8.0", &mut info.sdkVersion);
-                kResultOk
             }
-            _ => kInvalidArgument,
         }
+        kResultOk
     }
 
     unsafe fn setHostContext(&self, _context: *mut FUnknown) -> tresult {
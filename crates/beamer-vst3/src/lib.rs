@@ -51,6 +51,7 @@
 #![allow(non_camel_case_types)]
 #![allow(non_snake_case)]
 
+mod control;
 pub mod export;
 pub mod factory;
 pub mod processor;
@@ -58,7 +59,7 @@ pub mod util;
 pub mod wrapper;
 
 // Re-exports
-pub use factory::Factory;
+pub use factory::{ClassEntry, Factory};
 pub use processor::Vst3Processor;
 pub use wrapper::Vst3Config;
 
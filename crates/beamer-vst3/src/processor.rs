@@ -21,24 +21,27 @@ use std::cell::UnsafeCell;
 use std::ffi::{c_char, c_void};
 use std::marker::PhantomData;
 use std::slice;
+use std::time::Instant;
 
 use log::warn;
 use vst3::{Class, ComRef, Steinberg::Vst::*, Steinberg::*};
 
 use beamer_core::{
-    AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer, BusInfo as CoreBusInfo, BusLayout,
-    BusType as CoreBusType, ChordInfo, FrameRate as CoreFrameRate, FullAudioSetup, HasParameters,
-    MidiBuffer, MidiCcState, MidiEvent, MidiEventKind, NoConfig, NoteExpressionInt,
+    ArenaLayout, ArenaSlice, AudioProcessor, AudioSetup, AuxiliaryBuffers, Buffer,
+    BusInfo as CoreBusInfo, BusLayout, BusType as CoreBusType, ChordInfo, DeadlineMonitor, DspArena,
+    FrameRate as CoreFrameRate, FullAudioSetup, HasParameters, MemoryPolicy, CcCurveMode, MidiBuffer, MidiCcCurves, MidiCcState, MidiEvent, MidiEventKind, MidiOutputFilter, NoConfig, NoteExpressionInt,
     NoteExpressionText, NoteExpressionValue as CoreNoteExpressionValue, ParameterStore, Plugin,
-    ProcessContext as CoreProcessContext, ProcessorConfig, ScaleInfo, SysEx, Transport, MAX_BUSES,
+    PrepareScope, ProcessContext as CoreProcessContext, ProcessorConfig, ResidencyReport, ScaleInfo, SysEx, Transport, MAX_BUSES,
     MAX_CHANNELS, MAX_CHORD_NAME_SIZE, MAX_EXPRESSION_TEXT_SIZE, MAX_SCALE_NAME_SIZE,
     MAX_SYSEX_SIZE,
 };
 
+use beamer_core::trace::{self, category};
 use beamer_core::PluginConfig;
 
+use crate::control::{self, PluginControl};
 use crate::factory::ComponentFactory;
-use crate::util::{copy_wstring, len_wstring};
+use crate::util::copy_wstring;
 use crate::wrapper::Vst3Config;
 
 // VST3 event type constants
@@ -273,16 +276,18 @@ unsafe fn extract_transport(context_ptr: *const ProcessContext) -> Transport {
 /// Conversion buffers for f64→f32 processing when plugin doesn't support native f64.
 ///
 /// Pre-allocated in `setupProcessing()` to avoid heap allocations on the audio thread.
+/// All channels live in one [`DspArena`] block, so the conversion pass walks
+/// contiguous memory and the whole set is freed at once.
 struct ConversionBuffers {
-    /// Input conversion buffers: f64 → f32
-    /// Outer Vec: per bus, Inner Vec: per channel
-    main_input_f32: Vec<Vec<f32>>,
+    /// Input conversion buffers: f64 → f32 (per channel)
+    main_input_f32: Vec<ArenaSlice<f32>>,
     /// Output conversion buffers: f32 → f64
-    main_output_f32: Vec<Vec<f32>>,
+    main_output_f32: Vec<ArenaSlice<f32>>,
     /// Auxiliary input conversion buffers
-    aux_input_f32: Vec<Vec<Vec<f32>>>,
+    /// Outer Vec: per bus, Inner Vec: per channel
+    aux_input_f32: Vec<Vec<ArenaSlice<f32>>>,
     /// Auxiliary output conversion buffers
-    aux_output_f32: Vec<Vec<Vec<f32>>>,
+    aux_output_f32: Vec<Vec<ArenaSlice<f32>>>,
 }
 
 impl ConversionBuffers {
@@ -298,47 +303,81 @@ impl ConversionBuffers {
     /// Pre-allocate buffers based on cached bus configuration and max block size.
     ///
     /// This is used during setupProcessing() when we don't have a plugin reference
-    /// anymore (it was consumed by prepare()).
-    fn allocate_from_config(bus_config: &CachedBusConfig, max_block_size: usize) -> Self {
+    /// anymore (it was consumed by prepare()). Aux buses are skipped unless
+    /// `include_aux` is set.
+    fn allocate_from_config(bus_config: &CachedBusConfig, max_block_size: usize, include_aux: bool) -> Self {
         // Main bus (bus 0) channels
         let main_in_channels = bus_config.input_bus_info(0).map(|b| b.channel_count as usize).unwrap_or(0);
         let main_out_channels = bus_config.output_bus_info(0).map(|b| b.channel_count as usize).unwrap_or(0);
 
-        let main_input_f32: Vec<Vec<f32>> = (0..main_in_channels)
-            .map(|_| vec![0.0f32; max_block_size])
+        // Auxiliary buses (bus 1+)
+        let (aux_in_count, aux_out_count) = if include_aux {
+            (bus_config.input_bus_count, bus_config.output_bus_count)
+        } else {
+            (1, 1)
+        };
+        let aux_in_channels: Vec<usize> = (1..aux_in_count)
+            .filter_map(|bus_idx| bus_config.input_bus_info(bus_idx))
+            .map(|info| info.channel_count as usize)
             .collect();
-
-        let main_output_f32: Vec<Vec<f32>> = (0..main_out_channels)
-            .map(|_| vec![0.0f32; max_block_size])
+        let aux_out_channels: Vec<usize> = (1..aux_out_count)
+            .filter_map(|bus_idx| bus_config.output_bus_info(bus_idx))
+            .map(|info| info.channel_count as usize)
             .collect();
 
-        // Auxiliary buses (bus 1+)
-        let mut aux_input_f32 = Vec::new();
-        for bus_idx in 1..bus_config.input_bus_count {
-            if let Some(info) = bus_config.input_bus_info(bus_idx) {
-                let channels: Vec<Vec<f32>> = (0..info.channel_count)
-                    .map(|_| vec![0.0f32; max_block_size])
-                    .collect();
-                aux_input_f32.push(channels);
-            }
-        }
+        let total_channels = main_in_channels
+            + main_out_channels
+            + aux_in_channels.iter().sum::<usize>()
+            + aux_out_channels.iter().sum::<usize>();
+        let mut arena = DspArena::new(ArenaLayout::new().slices::<f32>(total_channels, max_block_size));
+        let mut channels = |count: usize| -> Vec<ArenaSlice<f32>> {
+            (0..count).map(|_| arena.alloc(max_block_size, 0.0f32)).collect()
+        };
 
-        let mut aux_output_f32 = Vec::new();
-        for bus_idx in 1..bus_config.output_bus_count {
-            if let Some(info) = bus_config.output_bus_info(bus_idx) {
-                let channels: Vec<Vec<f32>> = (0..info.channel_count)
-                    .map(|_| vec![0.0f32; max_block_size])
-                    .collect();
-                aux_output_f32.push(channels);
-            }
+        Self {
+            main_input_f32: channels(main_in_channels),
+            main_output_f32: channels(main_out_channels),
+            aux_input_f32: aux_in_channels.iter().map(|&n| channels(n)).collect(),
+            aux_output_f32: aux_out_channels.iter().map(|&n| channels(n)).collect(),
         }
+    }
+}
 
-        Self {
-            main_input_f32,
-            main_output_f32,
-            aux_input_f32,
-            aux_output_f32,
+// =============================================================================
+// Output Silencing
+// =============================================================================
+
+/// Write silence to every output channel and flag it as silent.
+///
+/// Used when a block can't be processed, so the host never plays whatever
+/// its output buffers held before.
+///
+/// # Safety
+///
+/// Output bus and channel pointers must be valid for `num_samples` writes.
+unsafe fn silence_outputs(process_data: &ProcessData, num_samples: usize, double_precision: bool) {
+    if process_data.numOutputs <= 0 || process_data.outputs.is_null() {
+        return;
+    }
+    let buses = slice::from_raw_parts_mut(process_data.outputs, process_data.numOutputs as usize);
+    for bus in buses {
+        let num_channels = bus.numChannels.max(0) as usize;
+        if double_precision {
+            if !bus.__field0.channelBuffers64.is_null() {
+                for &ptr in slice::from_raw_parts(bus.__field0.channelBuffers64, num_channels) {
+                    if !ptr.is_null() {
+                        slice::from_raw_parts_mut(ptr, num_samples).fill(0.0);
+                    }
+                }
+            }
+        } else if !bus.__field0.channelBuffers32.is_null() {
+            for &ptr in slice::from_raw_parts(bus.__field0.channelBuffers32, num_channels) {
+                if !ptr.is_null() {
+                    slice::from_raw_parts_mut(ptr, num_samples).fill(0.0);
+                }
+            }
         }
+        bus.silenceFlags = if num_channels >= 64 { u64::MAX } else { (1u64 << num_channels) - 1 };
     }
 }
 
@@ -433,6 +472,9 @@ struct ProcessBufferStorage<S: Sample> {
     aux_inputs: Vec<Vec<*const S>>,
     /// Auxiliary bus output channel pointers (per-bus Vec)
     aux_outputs: Vec<Vec<*mut S>>,
+    /// Copies of input channels that alias an output (one per input channel
+    /// across all buses, each `max_block_size` long, in one arena block)
+    alias_scratch: Vec<ArenaSlice<S>>,
 }
 
 // Safety: ProcessBufferStorage is Send because:
@@ -455,6 +497,7 @@ impl<S: Sample> ProcessBufferStorage<S> {
             main_outputs: Vec::new(),
             aux_inputs: Vec::new(),
             aux_outputs: Vec::new(),
+            alias_scratch: Vec::new(),
         }
     }
 
@@ -462,7 +505,8 @@ impl<S: Sample> ProcessBufferStorage<S> {
     ///
     /// Reserves Vec capacity for the exact channel counts declared by the plugin.
     /// This ensures that subsequent push() calls in process() never allocate.
-    fn allocate_from_config(bus_config: &CachedBusConfig) -> Self {
+    /// Aux buses are skipped unless `include_aux` is set.
+    fn allocate_from_config(bus_config: &CachedBusConfig, max_block_size: usize, include_aux: bool) -> Self {
         // Get main bus channel counts
         let main_in_channels = bus_config
             .input_bus_info(0)
@@ -478,11 +522,16 @@ impl<S: Sample> ProcessBufferStorage<S> {
         let main_outputs = Vec::with_capacity(main_out_channels);
 
         // Pre-allocate auxiliary bus storage
-        let aux_input_bus_count = bus_config.input_bus_count.saturating_sub(1);
-        let aux_output_bus_count = bus_config.output_bus_count.saturating_sub(1);
+        let (input_bus_count, output_bus_count) = if include_aux {
+            (bus_config.input_bus_count, bus_config.output_bus_count)
+        } else {
+            (1, 1)
+        };
+        let aux_input_bus_count = input_bus_count.saturating_sub(1);
+        let aux_output_bus_count = output_bus_count.saturating_sub(1);
 
         let mut aux_inputs = Vec::with_capacity(aux_input_bus_count);
-        for bus_idx in 1..bus_config.input_bus_count {
+        for bus_idx in 1..input_bus_count {
             if let Some(info) = bus_config.input_bus_info(bus_idx) {
                 aux_inputs.push(Vec::with_capacity(info.channel_count as usize));
             } else {
@@ -491,7 +540,7 @@ impl<S: Sample> ProcessBufferStorage<S> {
         }
 
         let mut aux_outputs = Vec::with_capacity(aux_output_bus_count);
-        for bus_idx in 1..bus_config.output_bus_count {
+        for bus_idx in 1..output_bus_count {
             if let Some(info) = bus_config.output_bus_info(bus_idx) {
                 aux_outputs.push(Vec::with_capacity(info.channel_count as usize));
             } else {
@@ -499,11 +548,19 @@ impl<S: Sample> ProcessBufferStorage<S> {
             }
         }
 
+        let total_input_channels = main_inputs.capacity()
+            + aux_inputs.iter().map(Vec::capacity).sum::<usize>();
+        let mut arena = DspArena::new(ArenaLayout::new().slices::<S>(total_input_channels, max_block_size));
+        let alias_scratch = (0..total_input_channels)
+            .map(|_| arena.alloc(max_block_size, S::ZERO))
+            .collect();
+
         Self {
             main_inputs,
             main_outputs,
             aux_inputs,
             aux_outputs,
+            alias_scratch,
         }
     }
 
@@ -521,6 +578,75 @@ impl<S: Sample> ProcessBufferStorage<S> {
             bus.clear();
         }
     }
+
+    /// Resolve input channels that share memory with an output channel.
+    ///
+    /// Hosts often process in place, passing the same pointer for an input
+    /// and an output. Building `&[S]` and `&mut [S]` over the same memory
+    /// would be undefined behavior, so after collecting pointers:
+    ///
+    /// - A main input that aliases the main output at the same index becomes
+    ///   null (an in-place channel) when `in_place` is set.
+    /// - Any other aliased input is copied to scratch memory and redirected,
+    ///   so the processor reads a stable copy while writing outputs.
+    ///
+    /// Never allocates. If scratch is too short (a block longer than the
+    /// prepared maximum), the pointer is left as is.
+    ///
+    /// # Safety
+    ///
+    /// Returns false if an aliased input couldn't be copied (no scratch slot
+    /// or a block longer than the scratch); the buffers must not be built then.
+    ///
+    /// All collected pointers must be valid for `num_samples` reads.
+    #[must_use]
+    unsafe fn resolve_aliasing(&mut self, num_samples: usize, in_place: bool) -> bool {
+        let Self {
+            main_inputs,
+            main_outputs,
+            aux_inputs,
+            aux_outputs,
+            alias_scratch,
+        } = self;
+
+        let is_output = |ptr: *const S| {
+            main_outputs.iter().chain(aux_outputs.iter().flatten()).any(|&out| out as *const S == ptr)
+        };
+        let mut scratch = alias_scratch.iter_mut();
+
+        for (ch, input) in main_inputs.iter_mut().enumerate() {
+            let slot = scratch.next();
+            if in_place && main_outputs.get(ch).is_some_and(|&out| out as *const S == *input) {
+                *input = std::ptr::null();
+            } else if is_output(*input) && !redirect_to_scratch(input, slot, num_samples) {
+                return false;
+            }
+        }
+        for input in aux_inputs.iter_mut().flatten() {
+            let slot = scratch.next();
+            if is_output(*input) && !redirect_to_scratch(input, slot, num_samples) {
+                return false;
+            }
+        }
+        true
+    }
+}
+
+/// Copy an aliased input channel into its scratch slot and point at the copy.
+///
+/// Returns false, leaving the pointer aliased, if there is no slot long
+/// enough.
+#[inline]
+#[must_use]
+unsafe fn redirect_to_scratch<S: Sample>(input: &mut *const S, slot: Option<&mut ArenaSlice<S>>, num_samples: usize) -> bool {
+    match slot.filter(|copy| copy.len() >= num_samples) {
+        Some(copy) => {
+            copy[..num_samples].copy_from_slice(slice::from_raw_parts(*input, num_samples));
+            *input = copy.as_ptr();
+            true
+        }
+        None => false,
+    }
 }
 
 // =============================================================================
@@ -693,16 +819,28 @@ pub struct Vst3Processor<P: Plugin> {
     state: UnsafeCell<PluginState<P>>,
     /// VST3-specific configuration reference
     vst3_config: &'static Vst3Config,
+    /// Pre-faulting/locking applied to memory allocated in prepare()
+    memory_policy: MemoryPolicy,
     /// Current sample rate
     sample_rate: UnsafeCell<f64>,
     /// Maximum block size
     max_block_size: UnsafeCell<usize>,
     /// Current symbolic sample size (kSample32 or kSample64)
     symbolic_sample_size: UnsafeCell<i32>,
-    /// MIDI input buffer (reused each process call to avoid stack overflow)
-    midi_input: UnsafeCell<MidiBuffer>,
-    /// MIDI output buffer (reused each process call)
-    midi_output: UnsafeCell<MidiBuffer>,
+    /// MIDI input buffer (reused each process call to avoid stack overflow,
+    /// released while hibernated)
+    midi_input: UnsafeCell<Option<Box<MidiBuffer>>>,
+    /// MIDI output buffer (reused each process call, released while hibernated)
+    midi_output: UnsafeCell<Option<Box<MidiBuffer>>>,
+    /// Output thinning (if the processor's MIDI_OUTPUT opts in, released
+    /// while hibernated)
+    midi_output_filter: UnsafeCell<Option<MidiOutputFilter>>,
+    /// Deactivated with process buffers released (see setActive)
+    hibernated: UnsafeCell<bool>,
+    /// Process-time load tracking for ProcessContext::quality
+    deadline: UnsafeCell<DeadlineMonitor>,
+    /// Instance ID tagging this instance's trace spans
+    trace_instance: u32,
     /// SysEx output buffer pool (for VST3 DataEvent pointer stability)
     sysex_output_pool: UnsafeCell<SysExOutputPool>,
     /// Conversion buffers for f64→f32 processing
@@ -714,6 +852,9 @@ pub struct Vst3Processor<P: Plugin> {
     /// MIDI CC state (created from Plugin's midi_cc_config())
     /// Framework owns this - plugin authors don't touch it
     midi_cc_state: Option<MidiCcState>,
+    /// Per-block CC curves (if the MIDI CC config enables them, released
+    /// while hibernated)
+    midi_cc_curves: UnsafeCell<Option<MidiCcCurves>>,
     /// Marker for the plugin type
     _marker: PhantomData<P>,
 }
@@ -741,7 +882,7 @@ where
     ///
     /// The wrapper starts in the Unprepared state with a default plugin instance.
     /// The processor will be created when `setupProcessing()` is called.
-    pub fn new(_config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self {
+    pub fn new(config: &'static PluginConfig, vst3_config: &'static Vst3Config) -> Self {
         let plugin = P::default();
 
         // Create MidiCcState from plugin's config (framework-managed)
@@ -753,11 +894,16 @@ where
                 pending_state: None,
             }),
             vst3_config,
+            memory_policy: config.memory_policy,
             sample_rate: UnsafeCell::new(44100.0),
             max_block_size: UnsafeCell::new(1024),
             symbolic_sample_size: UnsafeCell::new(SymbolicSampleSizes_::kSample32 as i32),
-            midi_input: UnsafeCell::new(MidiBuffer::new()),
-            midi_output: UnsafeCell::new(MidiBuffer::new()),
+            midi_input: UnsafeCell::new(Some(Box::new(MidiBuffer::new()))),
+            midi_output: UnsafeCell::new(Some(Box::new(MidiBuffer::new()))),
+            midi_output_filter: UnsafeCell::new(None),
+            hibernated: UnsafeCell::new(false),
+            deadline: UnsafeCell::new(DeadlineMonitor::new(config.deadline)),
+            trace_instance: trace::next_instance_id(),
             sysex_output_pool: UnsafeCell::new(SysExOutputPool::with_capacity(
                 vst3_config.sysex_slots,
                 vst3_config.sysex_buffer_size,
@@ -766,10 +912,109 @@ where
             buffer_storage_f32: UnsafeCell::new(ProcessBufferStorage::new()),
             buffer_storage_f64: UnsafeCell::new(ProcessBufferStorage::new()),
             midi_cc_state,
+            midi_cc_curves: UnsafeCell::new(None),
             _marker: PhantomData,
         }
     }
 
+    /// Allocate the buffers `process()` uses for the current setup: channel
+    /// pointer storage, f64→f32 conversion buffers (if needed), the MIDI
+    /// buffers, the MIDI output filter and the MIDI CC curves. Clears the
+    /// hibernated flag.
+    ///
+    /// # Safety
+    /// Setup thread only, never concurrently with `process()`.
+    unsafe fn allocate_process_buffers(
+        &self,
+        bus_config: &CachedBusConfig,
+        supports_double_precision: bool,
+        residency: &mut PrepareScope,
+    ) {
+        let capabilities = P::Processor::CAPABILITIES;
+        let native_f64 = capabilities.double_precision && supports_double_precision;
+        let max_block_size = *self.max_block_size.get();
+        *self.buffer_storage_f32.get() =
+            ProcessBufferStorage::allocate_from_config(bus_config, max_block_size, capabilities.aux_buses);
+        *self.buffer_storage_f64.get() = if native_f64 {
+            ProcessBufferStorage::allocate_from_config(bus_config, max_block_size, capabilities.aux_buses)
+        } else {
+            ProcessBufferStorage::new()
+        };
+
+        // Pre-allocate conversion buffers for f64→f32 processing
+        if *self.symbolic_sample_size.get() == SymbolicSampleSizes_::kSample64 as i32 && !native_f64 {
+            *self.conversion_buffers.get() =
+                ConversionBuffers::allocate_from_config(bus_config, max_block_size, capabilities.aux_buses);
+        }
+
+        // Fault in (and optionally lock) everything process() will touch.
+        // The MIDI buffers double as the "not hibernated" marker, so they
+        // exist even when the processor doesn't use MIDI.
+        for midi in [&self.midi_input, &self.midi_output] {
+            let midi = (*midi.get()).get_or_insert_with(|| Box::new(MidiBuffer::new()));
+            if capabilities.processes_midi() {
+                residency.prefault(&mut **midi);
+            }
+        }
+
+        // Creating the curves writes every lane, so they're faulted in already
+        *self.midi_cc_curves.get() = match self.midi_cc_state.as_ref() {
+            Some(state) if capabilities.midi_cc && state.curve_mode() != CcCurveMode::Off => {
+                Some(MidiCcCurves::new(state, max_block_size))
+            }
+            _ => None,
+        };
+
+        // A fresh filter per activation: nothing sent yet
+        *self.midi_output_filter.get() = (capabilities.midi_output && !P::Processor::MIDI_OUTPUT.is_pass_through())
+            .then(|| MidiOutputFilter::new(P::Processor::MIDI_OUTPUT, *self.sample_rate.get()));
+
+        *self.hibernated.get() = false;
+    }
+
+    /// Free the buffers allocated by `allocate_process_buffers()` while the
+    /// processor is deactivated.
+    ///
+    /// # Safety
+    /// Setup thread only, never concurrently with `process()`.
+    unsafe fn release_process_buffers(&self) {
+        *self.buffer_storage_f32.get() = ProcessBufferStorage::new();
+        *self.buffer_storage_f64.get() = ProcessBufferStorage::new();
+        *self.conversion_buffers.get() = ConversionBuffers::new();
+        *self.midi_input.get() = None;
+        *self.midi_output.get() = None;
+        *self.midi_cc_curves.get() = None;
+        *self.midi_output_filter.get() = None;
+        *self.hibernated.get() = true;
+    }
+
+    /// Warn when the plugin uses a feature its processor's
+    /// `CAPABILITIES` leave out; the wrapper would silently skip it.
+    fn warn_undeclared_capabilities(plugin: &P) {
+        let capabilities = P::Processor::CAPABILITIES;
+        if plugin.wants_midi() && !capabilities.midi_input {
+            warn!("Plugin wants MIDI but its processor doesn't declare midi_input; host MIDI is ignored");
+        }
+        if plugin.midi_cc_config().is_some() && !capabilities.midi_cc {
+            warn!("Plugin has a MIDI CC config but its processor doesn't declare midi_cc; CC parameters won't become MIDI events");
+        }
+        if (plugin.input_bus_count() > 1 || plugin.output_bus_count() > 1) && !capabilities.aux_buses {
+            warn!("Plugin has aux buses but its processor doesn't declare aux_buses; they are left empty");
+        }
+    }
+
+    /// Log the outcome of the memory policy after prepare().
+    fn log_residency(&self, report: ResidencyReport) {
+        if !self.memory_policy.is_enabled() {
+            return;
+        }
+        if report.lock_failures > 0 {
+            warn!("Memory policy {:?}: {}", self.memory_policy, report);
+        } else {
+            log::info!("Memory policy {:?}: {}", self.memory_policy, report);
+        }
+    }
+
     /// Get a reference to the prepared processor.
     ///
     /// # Safety
@@ -919,6 +1164,12 @@ where
         }
     }
 
+    /// Type-erased plugin for control-plane queries (only available in unprepared state).
+    #[inline]
+    unsafe fn plugin_control(&self) -> Option<&dyn PluginControl> {
+        self.try_plugin().map(|plugin| plugin as &dyn PluginControl)
+    }
+
     // =========================================================================
     // Parameter Access (works in both states)
     // =========================================================================
@@ -1007,6 +1258,184 @@ where
         }
     }
 
+    // =========================================================================
+    // MIDI Processing Stage
+    // =========================================================================
+
+    /// Gather MIDI input, run `process_midi()` and send its output to the host.
+    ///
+    /// Each part is gated on a field of `P::Processor::CAPABILITIES`, a
+    /// constant, so parts the processor doesn't declare compile away.
+    /// Returns false when the MIDI buffers are missing (hibernated).
+    #[inline]
+    unsafe fn process_midi_stage(&self, process_data: &ProcessData) -> bool {
+        let capabilities = P::Processor::CAPABILITIES;
+
+        // Reuse pre-allocated buffers to avoid stack overflow
+        let Some(midi_input) = (*self.midi_input.get()).as_deref_mut() else {
+            return false;
+        };
+        midi_input.clear();
+
+        if capabilities.midi_input {
+            if let Some(event_list) = ComRef::from_raw(process_data.inputEvents) {
+                let event_count = event_list.getEventCount();
+
+                for i in 0..event_count {
+                    let mut event: Event = std::mem::zeroed();
+                    if event_list.getEvent(i, &mut event) == kResultOk {
+                        if let Some(midi_event) = convert_vst3_to_midi(&event) {
+                            midi_input.push(midi_event);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Convert MIDI CC parameter changes to MIDI events (and curves, if enabled)
+        // This handles the VST3 IMidiMapping flow where DAWs send CC/pitch bend
+        // as parameter changes instead of raw MIDI events.
+        // Uses framework-owned MidiCcState.
+        if capabilities.midi_cc {
+            let mut curves = (*self.midi_cc_curves.get()).as_mut();
+            if let Some(curves) = curves.as_mut() {
+                curves.begin_block(process_data.numSamples.max(0) as usize);
+            }
+
+            if let (Some(parameter_changes), Some(cc_state)) = (
+                ComRef::from_raw(process_data.inputParameterChanges),
+                self.midi_cc_state.as_ref(),
+            ) {
+                let parameter_count = parameter_changes.getParameterCount();
+
+                for i in 0..parameter_count {
+                    if let Some(queue) = ComRef::from_raw(parameter_changes.getParameterData(i)) {
+                        let parameter_id = queue.getParameterId();
+
+                        // Check if this is a MIDI CC parameter
+                        if let Some(controller) = MidiCcState::parameter_id_to_controller(parameter_id) {
+                            if cc_state.has_controller(controller) {
+                                let point_count = queue.getPointCount();
+
+                                // Process all points for sample-accurate timing
+                                for j in 0..point_count {
+                                    let mut sample_offset: i32 = 0;
+                                    let mut value: f64 = 0.0;
+
+                                    if queue.getPoint(j, &mut sample_offset, &mut value) == kResultOk {
+                                        let sample_offset = sample_offset.max(0) as u32;
+                                        if let Some(curves) = curves.as_mut() {
+                                            curves.push_point(controller, sample_offset, value);
+                                        }
+                                        let midi_event = convert_cc_parameter_to_midi(
+                                            controller,
+                                            value as f32,
+                                            sample_offset,
+                                        );
+                                        midi_input.push(midi_event);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            if let Some(curves) = curves {
+                curves.end_block();
+            }
+        }
+
+        // Check for MIDI input buffer overflow (once per block)
+        if midi_input.has_overflowed() {
+            warn!(
+                "MIDI input buffer overflow: {} events max, some events were dropped",
+                beamer_core::midi::MAX_MIDI_EVENTS
+            );
+        }
+
+        let Some(midi_output) = (*self.midi_output.get()).as_deref_mut() else {
+            return false;
+        };
+        midi_output.clear();
+
+        if !capabilities.midi_output {
+            // Output is discarded; the buffer only receives process_midi()'s writes
+            let _span = trace::span_in(category::MIDI, "process_midi");
+            self.processor_mut().process_midi(midi_input.as_slice(), midi_output);
+            return true;
+        }
+
+        let sysex_pool = &mut *self.sysex_output_pool.get();
+
+        // Clear pool FIRST so next_slot is reset to 0 before draining fallback
+        sysex_pool.clear();
+
+        // With heap fallback enabled, emit any overflow messages from previous block first.
+        // These allocate slots starting from 0; new plugin output will append after them.
+        #[cfg(feature = "sysex-heap-fallback")]
+        if sysex_pool.has_fallback() {
+            if let Some(event_list) = ComRef::from_raw(process_data.outputEvents) {
+                for sysex_data in sysex_pool.take_fallback() {
+                    // Allocate from pool (succeeds since we just cleared it)
+                    if let Some((ptr, len)) = sysex_pool.allocate(&sysex_data) {
+                        let mut event: Event = std::mem::zeroed();
+                        event.busIndex = 0;
+                        event.sampleOffset = 0; // Delayed message, emit at start of block
+                        event.ppqPosition = 0.0;
+                        event.flags = 0;
+                        event.r#type = K_DATA_EVENT;
+                        event.__field0.data.r#type = DATA_TYPE_MIDI_SYSEX;
+                        event.__field0.data.size = len as u32;
+                        event.__field0.data.bytes = ptr;
+                        let _ = event_list.addEvent(&mut event);
+                    }
+                }
+            }
+            // Log that we recovered from overflow
+            warn!(
+                "SysEx fallback: emitted delayed messages from previous block overflow"
+            );
+        }
+        // NOTE: Don't clear again - fallback events occupy slots 0..N, new events append after
+
+        // Process MIDI events (process_midi is on AudioProcessor)
+        let span = trace::span_in(category::MIDI, "process_midi");
+        self.processor_mut().process_midi(midi_input.as_slice(), midi_output);
+        drop(span);
+
+        if let Some(filter) = (*self.midi_output_filter.get()).as_mut() {
+            filter.filter(midi_output, process_data.numSamples.max(0) as usize);
+        }
+
+        // Write output MIDI events
+        if let Some(event_list) = ComRef::from_raw(process_data.outputEvents) {
+            for midi_event in midi_output.iter() {
+                if let Some(mut vst3_event) = convert_midi_to_vst3(midi_event, sysex_pool) {
+                    let _ = event_list.addEvent(&mut vst3_event);
+                }
+            }
+        }
+
+        // Check for MIDI buffer overflow (once per block)
+        if midi_output.has_overflowed() {
+            warn!(
+                "MIDI output buffer overflow: {} events reached capacity, some events were dropped",
+                midi_output.len()
+            );
+        }
+
+        // Check for SysEx pool overflow (once per block)
+        if sysex_pool.has_overflowed() {
+            warn!(
+                "SysEx output pool overflow: {} slots exhausted, some SysEx messages were dropped",
+                sysex_pool.capacity()
+            );
+        }
+
+        true
+    }
+
     // =========================================================================
     // Audio Processing Helpers
     // =========================================================================
@@ -1076,7 +1505,7 @@ where
         }
 
         // Collect auxiliary input channel pointers (bounded by pre-allocated capacity)
-        if process_data.numInputs > 1 && !process_data.inputs.is_null() {
+        if P::Processor::CAPABILITIES.aux_buses && process_data.numInputs > 1 && !process_data.inputs.is_null() {
             let input_buses =
                 slice::from_raw_parts(process_data.inputs, process_data.numInputs as usize);
             for (aux_idx, bus) in input_buses[1..].iter().enumerate() {
@@ -1097,7 +1526,7 @@ where
         }
 
         // Collect auxiliary output channel pointers (bounded by pre-allocated capacity)
-        if process_data.numOutputs > 1 && !process_data.outputs.is_null() {
+        if P::Processor::CAPABILITIES.aux_buses && process_data.numOutputs > 1 && !process_data.outputs.is_null() {
             let output_buses =
                 slice::from_raw_parts(process_data.outputs, process_data.numOutputs as usize);
             for (aux_idx, bus) in output_buses[1..].iter().enumerate() {
@@ -1117,11 +1546,19 @@ where
             }
         }
 
-        // Create slices from pointers (safe: ProcessData lifetime covers this scope)
+        // Split aliased input/output channels into in-place or scratch copies
+        if !storage.resolve_aliasing(num_samples, processor.supports_in_place()) {
+            // Never build a buffer over aliased input/output memory
+            silence_outputs(process_data, num_samples, false);
+            return;
+        }
+
+        // Create slices from pointers (safe: ProcessData lifetime covers this scope).
+        // Null main inputs mark in-place channels.
         let main_in_iter = storage
             .main_inputs
             .iter()
-            .map(|&ptr| slice::from_raw_parts(ptr, num_samples));
+            .map(|&ptr| (!ptr.is_null()).then(|| slice::from_raw_parts(ptr, num_samples)));
         let main_out_iter = storage
             .main_outputs
             .iter()
@@ -1137,7 +1574,7 @@ where
         });
 
         // Construct buffers and process
-        let mut buffer = Buffer::new(main_in_iter, main_out_iter, num_samples);
+        let mut buffer = Buffer::new_in_place(main_in_iter, main_out_iter, num_samples);
         let mut aux = AuxiliaryBuffers::new(aux_in_iter, aux_out_iter, num_samples);
 
         processor.process(&mut buffer, &mut aux, context);
@@ -1192,7 +1629,7 @@ where
         }
 
         // Collect auxiliary input channel pointers (bounded by pre-allocated capacity)
-        if process_data.numInputs > 1 && !process_data.inputs.is_null() {
+        if P::Processor::CAPABILITIES.aux_buses && process_data.numInputs > 1 && !process_data.inputs.is_null() {
             let input_buses =
                 slice::from_raw_parts(process_data.inputs, process_data.numInputs as usize);
             for (aux_idx, bus) in input_buses[1..].iter().enumerate() {
@@ -1213,7 +1650,7 @@ where
         }
 
         // Collect auxiliary output channel pointers (bounded by pre-allocated capacity)
-        if process_data.numOutputs > 1 && !process_data.outputs.is_null() {
+        if P::Processor::CAPABILITIES.aux_buses && process_data.numOutputs > 1 && !process_data.outputs.is_null() {
             let output_buses =
                 slice::from_raw_parts(process_data.outputs, process_data.numOutputs as usize);
             for (aux_idx, bus) in output_buses[1..].iter().enumerate() {
@@ -1233,11 +1670,19 @@ where
             }
         }
 
-        // Create slices from pointers (safe: ProcessData lifetime covers this scope)
+        // Split aliased input/output channels into in-place or scratch copies
+        if !storage.resolve_aliasing(num_samples, processor.supports_in_place()) {
+            // Never build a buffer over aliased input/output memory
+            silence_outputs(process_data, num_samples, true);
+            return;
+        }
+
+        // Create slices from pointers (safe: ProcessData lifetime covers this scope).
+        // Null main inputs mark in-place channels.
         let main_in_iter = storage
             .main_inputs
             .iter()
-            .map(|&ptr| slice::from_raw_parts(ptr, num_samples));
+            .map(|&ptr| (!ptr.is_null()).then(|| slice::from_raw_parts(ptr, num_samples)));
         let main_out_iter = storage
             .main_outputs
             .iter()
@@ -1253,7 +1698,7 @@ where
         });
 
         // Construct buffers and process
-        let mut buffer: Buffer<f64> = Buffer::new(main_in_iter, main_out_iter, num_samples);
+        let mut buffer: Buffer<f64> = Buffer::new_in_place(main_in_iter, main_out_iter, num_samples);
         let mut aux: AuxiliaryBuffers<f64> =
             AuxiliaryBuffers::new(aux_in_iter, aux_out_iter, num_samples);
 
@@ -1556,8 +2001,30 @@ where
 
     unsafe fn setActive(&self, state: TBool) -> tresult {
         // set_active is only meaningful when prepared (processor exists)
-        if let PluginState::Prepared { processor, .. } = &mut *self.state.get() {
-            processor.set_active(state != 0);
+        if let PluginState::Prepared { processor, bus_config } = &mut *self.state.get() {
+            if state != 0 {
+                // Restore what deactivation released, before the first process()
+                if *self.hibernated.get() {
+                    let mut residency = PrepareScope::begin(self.memory_policy);
+                    processor.resume();
+                    self.allocate_process_buffers(
+                        bus_config,
+                        processor.supports_double_precision(),
+                        &mut residency,
+                    );
+                    self.log_residency(residency.finish());
+                }
+                (*self.deadline.get()).reset();
+                processor.set_active(true);
+            } else {
+                processor.set_active(false);
+                // Deactivated tracks can stay that way for a long time:
+                // release large allocations until reactivation
+                if !*self.hibernated.get() {
+                    processor.hibernate();
+                    self.release_process_buffers();
+                }
+            }
         }
         // When unprepared, silently succeed (host may call this before setupProcessing)
         kResultOk
@@ -1800,11 +2267,14 @@ where
                 // Build the processor config
                 let config = P::Config::build(setup, plugin, &bus_layout);
 
+                Self::warn_undeclared_capabilities(plugin);
+
                 // Take ownership of the plugin and any pending state
                 let plugin = std::mem::take(plugin);
                 let pending = pending_state.take();
 
-                // Prepare the processor
+                // Prepare the processor, collecting the arenas it allocates
+                let mut residency = PrepareScope::begin(self.memory_policy);
                 let mut processor = plugin.prepare(config);
 
                 // Apply any pending state that was set before preparation
@@ -1816,18 +2286,12 @@ where
                 }
 
                 // Pre-allocate buffer storage based on bus config
-                *self.buffer_storage_f32.get() =
-                    ProcessBufferStorage::allocate_from_config(&bus_config);
-                *self.buffer_storage_f64.get() =
-                    ProcessBufferStorage::allocate_from_config(&bus_config);
-
-                // Pre-allocate conversion buffers for f64→f32 processing
-                if setup.symbolicSampleSize == SymbolicSampleSizes_::kSample64 as i32
-                    && !processor.supports_double_precision()
-                {
-                    *self.conversion_buffers.get() =
-                        ConversionBuffers::allocate_from_config(&bus_config, setup.maxSamplesPerBlock as usize);
-                }
+                self.allocate_process_buffers(
+                    &bus_config,
+                    processor.supports_double_precision(),
+                    &mut residency,
+                );
+                self.log_residency(residency.finish());
 
                 // Update state to Prepared
                 *state = PluginState::Prepared {
@@ -1865,15 +2329,17 @@ where
 
                     // Build new config and re-prepare
                     let config = P::Config::build(setup, &plugin, &bus_layout);
+                    let mut residency = PrepareScope::begin(self.memory_policy);
                     let new_processor = plugin.prepare(config);
 
-                    // Pre-allocate conversion buffers if needed
-                    if setup.symbolicSampleSize == SymbolicSampleSizes_::kSample64 as i32
-                        && !new_processor.supports_double_precision()
-                    {
-                        *self.conversion_buffers.get() =
-                            ConversionBuffers::allocate_from_config(bus_config, setup.maxSamplesPerBlock as usize);
-                    }
+                    // Re-allocate buffers for the new setup (this also ends
+                    // hibernation: the new processor holds fresh state)
+                    self.allocate_process_buffers(
+                        bus_config,
+                        new_processor.supports_double_precision(),
+                        &mut residency,
+                    );
+                    self.log_residency(residency.finish());
 
                     *processor = new_processor;
                 }
@@ -1900,8 +2366,34 @@ where
             return kResultOk;
         }
 
+        // Scratch and conversion buffers hold `maxSamplesPerBlock` frames, so
+        // longer blocks (a host bug) are rejected rather than overrun
+        if num_samples > *self.max_block_size.get() {
+            let double_precision = *self.symbolic_sample_size.get() == SymbolicSampleSizes_::kSample64 as i32;
+            silence_outputs(process_data, num_samples, double_precision);
+            return kResultFalse;
+        }
+
+        // Buffers are released while hibernated. Hosts shouldn't process an
+        // inactive plugin, but if one does it gets silence (and no output
+        // events) rather than whatever its buffers held
+        if *self.hibernated.get() {
+            let double_precision = *self.symbolic_sample_size.get() == SymbolicSampleSizes_::kSample64 as i32;
+            silence_outputs(process_data, num_samples, double_precision);
+            return kResultOk;
+        }
+
+        // Stages the processor doesn't declare are removed at compile time
+        let capabilities = P::Processor::CAPABILITIES;
+
+        // Whole-call time against the block's real-time budget
+        let started = Instant::now();
+        let _instance = trace::instance_scope(self.trace_instance);
+        let _block = trace::span_in(category::WRAPPER, "process");
+
         // 1. Handle incoming parameter changes from host
         if let Some(parameter_changes) = ComRef::from_raw(process_data.inputParameterChanges) {
+            let _span = trace::span_in(category::WRAPPER, "parameters");
             let parameters = self.parameters();
             let parameter_count = parameter_changes.getParameterCount();
 
@@ -1924,150 +2416,39 @@ where
             }
         }
 
-        // 2. Handle MIDI events (reuse pre-allocated buffer to avoid stack overflow)
-        let midi_input = &mut *self.midi_input.get();
-        midi_input.clear();
-
-        if let Some(event_list) = ComRef::from_raw(process_data.inputEvents) {
-            let event_count = event_list.getEventCount();
-
-            for i in 0..event_count {
-                let mut event: Event = std::mem::zeroed();
-                if event_list.getEvent(i, &mut event) == kResultOk {
-                    if let Some(midi_event) = convert_vst3_to_midi(&event) {
-                        midi_input.push(midi_event);
-                    }
-                }
-            }
-        }
-
-        // 2.5. Convert MIDI CC parameter changes to MIDI events
-        // This handles the VST3 IMidiMapping flow where DAWs send CC/pitch bend
-        // as parameter changes instead of raw MIDI events.
-        // Uses framework-owned MidiCcState.
-        if let Some(parameter_changes) = ComRef::from_raw(process_data.inputParameterChanges) {
-            if let Some(cc_state) = self.midi_cc_state.as_ref() {
-                let parameter_count = parameter_changes.getParameterCount();
-
-                for i in 0..parameter_count {
-                    if let Some(queue) = ComRef::from_raw(parameter_changes.getParameterData(i)) {
-                        let parameter_id = queue.getParameterId();
-
-                        // Check if this is a MIDI CC parameter
-                        if let Some(controller) = MidiCcState::parameter_id_to_controller(parameter_id) {
-                            if cc_state.has_controller(controller) {
-                                let point_count = queue.getPointCount();
-
-                                // Process all points for sample-accurate timing
-                                for j in 0..point_count {
-                                    let mut sample_offset: i32 = 0;
-                                    let mut value: f64 = 0.0;
-
-                                    if queue.getPoint(j, &mut sample_offset, &mut value) == kResultOk {
-                                        let midi_event = convert_cc_parameter_to_midi(
-                                            controller,
-                                            value as f32,
-                                            sample_offset as u32,
-                                        );
-                                        midi_input.push(midi_event);
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // Check for MIDI input buffer overflow (once per block)
-        if midi_input.has_overflowed() {
-            warn!(
-                "MIDI input buffer overflow: {} events max, some events were dropped",
-                beamer_core::midi::MAX_MIDI_EVENTS
-            );
-        }
-
-        // Clear and prepare MIDI output buffer and SysEx pool
-        let midi_output = &mut *self.midi_output.get();
-        midi_output.clear();
-        let sysex_pool = &mut *self.sysex_output_pool.get();
-
-        // Clear pool FIRST so next_slot is reset to 0 before draining fallback
-        sysex_pool.clear();
-
-        // With heap fallback enabled, emit any overflow messages from previous block first.
-        // These allocate slots starting from 0; new plugin output will append after them.
-        #[cfg(feature = "sysex-heap-fallback")]
-        if sysex_pool.has_fallback() {
-            if let Some(event_list) = ComRef::from_raw(process_data.outputEvents) {
-                for sysex_data in sysex_pool.take_fallback() {
-                    // Allocate from pool (succeeds since we just cleared it)
-                    if let Some((ptr, len)) = sysex_pool.allocate(&sysex_data) {
-                        let mut event: Event = std::mem::zeroed();
-                        event.busIndex = 0;
-                        event.sampleOffset = 0; // Delayed message, emit at start of block
-                        event.ppqPosition = 0.0;
-                        event.flags = 0;
-                        event.r#type = K_DATA_EVENT;
-                        event.__field0.data.r#type = DATA_TYPE_MIDI_SYSEX;
-                        event.__field0.data.size = len as u32;
-                        event.__field0.data.bytes = ptr;
-                        let _ = event_list.addEvent(&mut event);
-                    }
-                }
-            }
-            // Log that we recovered from overflow
-            warn!(
-                "SysEx fallback: emitted delayed messages from previous block overflow"
-            );
-        }
-        // NOTE: Don't clear again - fallback events occupy slots 0..N, new events append after
-
-        // Process MIDI events (process_midi is on AudioProcessor)
-        let processor = self.processor_mut();
-        processor.process_midi(midi_input.as_slice(), midi_output);
-
-        // Write output MIDI events
-        if let Some(event_list) = ComRef::from_raw(process_data.outputEvents) {
-            for midi_event in midi_output.iter() {
-                if let Some(mut vst3_event) = convert_midi_to_vst3(midi_event, sysex_pool) {
-                    let _ = event_list.addEvent(&mut vst3_event);
-                }
+        // 2. MIDI input, CC conversion, process_midi() and MIDI output
+        if capabilities.processes_midi() {
+            let _span = trace::span_in(category::MIDI, "midi events");
+            if !self.process_midi_stage(process_data) {
+                return kResultFalse;
             }
         }
 
-        // Check for MIDI buffer overflow (once per block)
-        if midi_output.has_overflowed() {
-            warn!(
-                "MIDI output buffer overflow: {} events reached capacity, some events were dropped",
-                midi_output.len()
-            );
-        }
-
-        // Check for SysEx pool overflow (once per block)
-        if sysex_pool.has_overflowed() {
-            warn!(
-                "SysEx output pool overflow: {} slots exhausted, some SysEx messages were dropped",
-                sysex_pool.capacity()
-            );
-        }
-
         // 3. Extract transport info from VST3 ProcessContext
-        let transport = extract_transport(process_data.processContext);
+        let transport = if capabilities.transport {
+            extract_transport(process_data.processContext)
+        } else {
+            Transport::default()
+        };
         let sample_rate = *self.sample_rate.get();
         let context = if let Some(cc_state) = self.midi_cc_state.as_ref() {
             CoreProcessContext::with_midi_cc(sample_rate, num_samples, transport, cc_state)
         } else {
             CoreProcessContext::new(sample_rate, num_samples, transport)
         };
+        let deadline = &mut *self.deadline.get();
+        let context = context
+            .with_quality(deadline.level())
+            .with_midi_cc_curves((*self.midi_cc_curves.get()).as_ref());
 
         // 4. Process audio based on sample size
         let symbolic_sample_size = *self.symbolic_sample_size.get();
         let processor = self.processor_mut();
+        let span = trace::span_in(category::WRAPPER, "audio");
 
         if symbolic_sample_size == SymbolicSampleSizes_::kSample64 as i32 {
             // 64-bit processing path
-            if processor.supports_double_precision() {
+            if capabilities.double_precision && processor.supports_double_precision() {
                 // Native f64: extract f64 buffers and call process_f64()
                 self.process_audio_f64_native(process_data, num_samples, processor, &context);
             } else {
@@ -2078,6 +2459,10 @@ where
             // 32-bit processing path (default)
             self.process_audio_f32(process_data, num_samples, processor, &context);
         }
+        drop(span);
+
+        // Quality level for the next block
+        deadline.record(started.elapsed(), num_samples, sample_rate);
 
         kResultOk
     }
@@ -2147,78 +2532,11 @@ where
     }
 
     unsafe fn getParameterCount(&self) -> i32 {
-        let user_parameters = self.parameters().count();
-        // MIDI CC state is framework-owned, always available
-        let cc_parameters = self
-            .midi_cc_state
-            .as_ref()
-            .map(|s| s.enabled_count())
-            .unwrap_or(0);
-        (user_parameters + cc_parameters) as i32
+        control::parameter_count(self.parameters(), self.midi_cc_state.as_ref())
     }
 
     unsafe fn getParameterInfo(&self, parameter_index: i32, info: *mut ParameterInfo) -> tresult {
-        if info.is_null() {
-            return kInvalidArgument;
-        }
-
-        let parameters = self.parameters();
-        let user_parameter_count = parameters.count();
-
-        // User-defined parameters first
-        if (parameter_index as usize) < user_parameter_count {
-            if let Some(parameter_info) = parameters.info(parameter_index as usize) {
-                let info = &mut *info;
-                info.id = parameter_info.id;
-                copy_wstring(parameter_info.name, &mut info.title);
-                copy_wstring(parameter_info.short_name, &mut info.shortTitle);
-                copy_wstring(parameter_info.units, &mut info.units);
-                info.stepCount = parameter_info.step_count;
-                info.defaultNormalizedValue = parameter_info.default_normalized;
-                info.unitId = parameter_info.group_id;
-                info.flags = {
-                    let mut flags = 0;
-                    if parameter_info.flags.can_automate {
-                        flags |= ParameterInfo_::ParameterFlags_::kCanAutomate;
-                    }
-                    if parameter_info.flags.is_bypass {
-                        flags |= ParameterInfo_::ParameterFlags_::kIsBypass;
-                    }
-                    // List parameters (enums) - display as dropdown with text labels
-                    if parameter_info.flags.is_list {
-                        flags |= ParameterInfo_::ParameterFlags_::kIsList;
-                    }
-                    // Hidden parameters (MIDI CC emulation)
-                    if parameter_info.flags.is_hidden {
-                        flags |= ParameterInfo_::ParameterFlags_::kIsHidden;
-                    }
-                    flags
-                };
-                return kResultOk;
-            }
-            return kInvalidArgument;
-        }
-
-        // Hidden MIDI CC parameters (framework-owned state)
-        if let Some(cc_state) = self.midi_cc_state.as_ref() {
-            let cc_index = (parameter_index as usize) - user_parameter_count;
-            if let Some(parameter_info) = cc_state.info(cc_index) {
-                let info = &mut *info;
-                info.id = parameter_info.id;
-                copy_wstring(parameter_info.name, &mut info.title);
-                copy_wstring(parameter_info.short_name, &mut info.shortTitle);
-                copy_wstring(parameter_info.units, &mut info.units);
-                info.stepCount = parameter_info.step_count;
-                info.defaultNormalizedValue = parameter_info.default_normalized;
-                info.unitId = parameter_info.group_id;
-                // Hidden + automatable
-                info.flags = ParameterInfo_::ParameterFlags_::kCanAutomate
-                    | ParameterInfo_::ParameterFlags_::kIsHidden;
-                return kResultOk;
-            }
-        }
-
-        kInvalidArgument
+        control::parameter_info(self.parameters(), self.midi_cc_state.as_ref(), parameter_index, info)
     }
 
     unsafe fn getParamStringByValue(
@@ -2227,14 +2545,7 @@ where
         value_normalized: f64,
         string: *mut String128,
     ) -> tresult {
-        if string.is_null() {
-            return kInvalidArgument;
-        }
-
-        let parameters = self.parameters();
-        let display = parameters.normalized_to_string(id, value_normalized);
-        copy_wstring(&display, &mut *string);
-        kResultOk
+        control::param_string_by_value(self.parameters(), id, value_normalized, string)
     }
 
     unsafe fn getParamValueByString(
@@ -2243,19 +2554,7 @@ where
         string: *mut TChar,
         value_normalized: *mut f64,
     ) -> tresult {
-        if string.is_null() || value_normalized.is_null() {
-            return kInvalidArgument;
-        }
-
-        let len = len_wstring(string as *const TChar);
-        if let Ok(s) = String::from_utf16(slice::from_raw_parts(string as *const u16, len)) {
-            let parameters = self.parameters();
-            if let Some(value) = parameters.string_to_normalized(id, &s) {
-                *value_normalized = value;
-                return kResultOk;
-            }
-        }
-        kInvalidArgument
+        control::param_value_by_string(self.parameters(), id, string, value_normalized)
     }
 
     unsafe fn normalizedParamToPlain(&self, id: u32, value_normalized: f64) -> f64 {
@@ -2326,23 +2625,7 @@ where
     }
 
     unsafe fn getUnitInfo(&self, unit_index: i32, info: *mut UnitInfo) -> tresult {
-        if info.is_null() || unit_index < 0 {
-            return kInvalidArgument;
-        }
-
-        use beamer_core::parameter_groups::ParameterGroups;
-        let parameters = self.parameters();
-
-        if let Some(group_info) = parameters.group_info(unit_index as usize) {
-            let info = &mut *info;
-            info.id = group_info.id;
-            info.parentUnitId = group_info.parent_id;
-            info.programListId = kNoProgramListId;
-            copy_wstring(group_info.name, &mut info.name);
-            kResultOk
-        } else {
-            kInvalidArgument
-        }
+        control::unit_info(self.parameters(), unit_index, info)
     }
 
     unsafe fn getProgramListCount(&self) -> i32 {
@@ -2429,29 +2712,14 @@ where
         midi_controller_number: i16,
         id: *mut u32,
     ) -> tresult {
-        if id.is_null() {
-            return kInvalidArgument;
-        }
-
-        let controller = midi_controller_number as u8;
-
-        // 1. First check plugin's custom mappings (only available in unprepared state)
-        if let Some(plugin) = self.try_plugin() {
-            if let Some(parameter_id) = plugin.midi_cc_to_parameter(bus_index, channel, controller) {
-                *id = parameter_id;
-                return kResultOk;
-            }
-        }
-
-        // 2. Check framework-owned MIDI CC state (omni channel - ignore channel parameter)
-        if let Some(cc_state) = self.midi_cc_state.as_ref() {
-            if cc_state.has_controller(controller) {
-                *id = MidiCcState::parameter_id(controller);
-                return kResultOk;
-            }
-        }
-
-        kResultFalse
+        control::midi_controller_assignment(
+            self.plugin_control(),
+            self.midi_cc_state.as_ref(),
+            bus_index,
+            channel,
+            midi_controller_number,
+            id,
+        )
     }
 }
 
@@ -2488,14 +2756,7 @@ where
     P::Config: BuildConfig,
 {
     unsafe fn getNumMidi1ControllerAssignments(&self, direction: BusDirections) -> u32 {
-        // Only support input direction
-        if direction != BusDirections_::kInput {
-            return 0;
-        }
-        // midi1_assignments is on Plugin, only available in unprepared state
-        self.try_plugin()
-            .map(|p| p.midi1_assignments().len() as u32)
-            .unwrap_or(0)
+        control::midi1_assignment_count(self.plugin_control(), direction)
     }
 
     unsafe fn getMidi1ControllerAssignments(
@@ -2503,47 +2764,11 @@ where
         direction: BusDirections,
         list: *const Midi1ControllerParamIDAssignmentList,
     ) -> tresult {
-        if list.is_null() || direction != BusDirections_::kInput {
-            return kInvalidArgument;
-        }
-
-        // midi1_assignments is on Plugin, only available in unprepared state
-        let Some(plugin) = self.try_plugin() else {
-            return kResultFalse;
-        };
-        let assignments = plugin.midi1_assignments();
-        let list_ref = &*list;
-
-        if (list_ref.count as usize) < assignments.len() {
-            return kResultFalse;
-        }
-
-        if assignments.is_empty() {
-            return kResultOk;
-        }
-
-        let map = slice::from_raw_parts_mut(list_ref.map, assignments.len());
-        for (i, a) in assignments.iter().enumerate() {
-            map[i] = Midi1ControllerParamIDAssignment {
-                pId: a.assignment.parameter_id,
-                busIndex: a.assignment.bus_index,
-                channel: a.assignment.channel,
-                controller: a.controller as i16,
-            };
-        }
-
-        kResultOk
+        control::midi1_assignments(self.plugin_control(), direction, list)
     }
 
     unsafe fn getNumMidi2ControllerAssignments(&self, direction: BusDirections) -> u32 {
-        // Only support input direction
-        if direction != BusDirections_::kInput {
-            return 0;
-        }
-        // midi2_assignments is on Plugin, only available in unprepared state
-        self.try_plugin()
-            .map(|p| p.midi2_assignments().len() as u32)
-            .unwrap_or(0)
+        control::midi2_assignment_count(self.plugin_control(), direction)
     }
 
     unsafe fn getMidi2ControllerAssignments(
@@ -2551,41 +2776,7 @@ where
         direction: BusDirections,
         list: *const Midi2ControllerParamIDAssignmentList,
     ) -> tresult {
-        if list.is_null() || direction != BusDirections_::kInput {
-            return kInvalidArgument;
-        }
-
-        // midi2_assignments is on Plugin, only available in unprepared state
-        let Some(plugin) = self.try_plugin() else {
-            return kResultFalse;
-        };
-        let assignments = plugin.midi2_assignments();
-        let list_ref = &*list;
-
-        if (list_ref.count as usize) < assignments.len() {
-            return kResultFalse;
-        }
-
-        if assignments.is_empty() {
-            return kResultOk;
-        }
-
-        let map = slice::from_raw_parts_mut(list_ref.map, assignments.len());
-        for (i, a) in assignments.iter().enumerate() {
-            map[i] = Midi2ControllerParamIDAssignment {
-                pId: a.assignment.parameter_id,
-                busIndex: a.assignment.bus_index,
-                channel: a.assignment.channel,
-                controller: Midi2Controller {
-                    bank: a.controller.bank,
-                    registered: if a.controller.registered { 1 } else { 0 },
-                    index: a.controller.index,
-                    reserved: 0,
-                },
-            };
-        }
-
-        kResultOk
+        control::midi2_assignments(self.plugin_control(), direction, list)
     }
 }
 
@@ -2640,9 +2831,7 @@ where
     P::Config: BuildConfig,
 {
     unsafe fn getNoteExpressionCount(&self, bus_index: i32, channel: i16) -> i32 {
-        self.try_plugin()
-            .map(|p| p.note_expression_count(bus_index, channel) as i32)
-            .unwrap_or(0)
+        control::note_expression_count(self.plugin_control(), bus_index, channel)
     }
 
     unsafe fn getNoteExpressionInfo(
@@ -2652,32 +2841,7 @@ where
         note_expression_index: i32,
         info: *mut NoteExpressionTypeInfo,
     ) -> tresult {
-        if info.is_null() {
-            return kInvalidArgument;
-        }
-
-        let Some(plugin) = self.try_plugin() else {
-            return kInvalidArgument;
-        };
-        if let Some(expr_info) =
-            plugin.note_expression_info(bus_index, channel, note_expression_index as usize)
-        {
-            let vst_info = &mut *info;
-            vst_info.typeId = expr_info.type_id;
-            copy_wstring(expr_info.title_str(), &mut vst_info.title);
-            copy_wstring(expr_info.short_title_str(), &mut vst_info.shortTitle);
-            copy_wstring(expr_info.units_str(), &mut vst_info.units);
-            vst_info.unitId = expr_info.unit_id;
-            vst_info.valueDesc.minimum = expr_info.value_desc.minimum;
-            vst_info.valueDesc.maximum = expr_info.value_desc.maximum;
-            vst_info.valueDesc.defaultValue = expr_info.value_desc.default_value;
-            vst_info.valueDesc.stepCount = expr_info.value_desc.step_count;
-            vst_info.associatedParameterId = expr_info.associated_parameter_id as u32;
-            vst_info.flags = expr_info.flags.0;
-            kResultOk
-        } else {
-            kInvalidArgument
-        }
+        control::note_expression_info(self.plugin_control(), bus_index, channel, note_expression_index, info)
     }
 
     unsafe fn getNoteExpressionStringByValue(
@@ -2688,16 +2852,7 @@ where
         value_normalized: NoteExpressionValue,
         string: *mut String128,
     ) -> tresult {
-        if string.is_null() {
-            return kInvalidArgument;
-        }
-
-        let Some(plugin) = self.try_plugin() else {
-            return kInvalidArgument;
-        };
-        let display = plugin.note_expression_value_to_string(bus_index, channel, id, value_normalized);
-        copy_wstring(&display, &mut *string);
-        kResultOk
+        control::note_expression_string_by_value(self.plugin_control(), bus_index, channel, id, value_normalized, string)
     }
 
     unsafe fn getNoteExpressionValueByString(
@@ -2708,20 +2863,7 @@ where
         string: *const TChar,
         value_normalized: *mut NoteExpressionValue,
     ) -> tresult {
-        if string.is_null() || value_normalized.is_null() {
-            return kInvalidArgument;
-        }
-
-        let len = len_wstring(string);
-        if let Ok(s) = String::from_utf16(slice::from_raw_parts(string, len)) {
-            if let Some(plugin) = self.try_plugin() {
-                if let Some(value) = plugin.note_expression_string_to_value(bus_index, channel, id, &s) {
-                    *value_normalized = value;
-                    return kResultOk;
-                }
-            }
-        }
-        kResultFalse
+        control::note_expression_value_by_string(self.plugin_control(), bus_index, channel, id, string, value_normalized)
     }
 }
 
@@ -2734,9 +2876,7 @@ where
     P::Config: BuildConfig,
 {
     unsafe fn getKeyswitchCount(&self, bus_index: i32, channel: i16) -> i32 {
-        self.try_plugin()
-            .map(|p| p.keyswitch_count(bus_index, channel) as i32)
-            .unwrap_or(0)
+        control::keyswitch_count(self.plugin_control(), bus_index, channel)
     }
 
     unsafe fn getKeyswitchInfo(
@@ -2746,29 +2886,7 @@ where
         keyswitch_index: i32,
         info: *mut KeyswitchInfo,
     ) -> tresult {
-        if info.is_null() {
-            return kInvalidArgument;
-        }
-
-        let Some(plugin) = self.try_plugin() else {
-            return kInvalidArgument;
-        };
-        if let Some(ks_info) =
-            plugin.keyswitch_info(bus_index, channel, keyswitch_index as usize)
-        {
-            let vst_info = &mut *info;
-            vst_info.typeId = ks_info.type_id;
-            copy_wstring(ks_info.title_str(), &mut vst_info.title);
-            copy_wstring(ks_info.short_title_str(), &mut vst_info.shortTitle);
-            vst_info.keyswitchMin = ks_info.keyswitch_min;
-            vst_info.keyswitchMax = ks_info.keyswitch_max;
-            vst_info.keyRemapped = ks_info.key_remapped;
-            vst_info.unitId = ks_info.unit_id;
-            vst_info.flags = ks_info.flags;
-            kResultOk
-        } else {
-            kInvalidArgument
-        }
+        control::keyswitch_info(self.plugin_control(), bus_index, channel, keyswitch_index, info)
     }
 }
 
@@ -2786,27 +2904,7 @@ where
         channel: i16,
         list: *mut PhysicalUIMapList,
     ) -> tresult {
-        if list.is_null() {
-            return kInvalidArgument;
-        }
-
-        let Some(plugin) = self.try_plugin() else {
-            return kInvalidArgument;
-        };
-        let mappings = plugin.physical_ui_mappings(bus_index, channel);
-        let list_ref = &mut *list;
-
-        // Fill in the mappings up to the provided count
-        let fill_count = (list_ref.count as usize).min(mappings.len());
-        if fill_count > 0 && !list_ref.map.is_null() {
-            let map_slice = slice::from_raw_parts_mut(list_ref.map, fill_count);
-            for (i, mapping) in mappings.iter().take(fill_count).enumerate() {
-                map_slice[i].physicalUITypeID = mapping.physical_ui_type_id;
-                map_slice[i].noteExpressionTypeID = mapping.note_expression_type_id;
-            }
-        }
-
-        kResultOk
+        control::physical_ui_mapping(self.plugin_control(), bus_index, channel, list)
     }
 }
 
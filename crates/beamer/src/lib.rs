@@ -45,6 +45,8 @@
 // Re-export sub-crates
 pub use beamer_core as core;
 pub use beamer_vst3 as vst3_impl;
+#[cfg(feature = "lv2")]
+pub use beamer_lv2 as lv2_impl;
 
 // Re-export derive macros when feature is enabled
 #[cfg(feature = "derive")]
@@ -64,7 +66,21 @@ pub mod prelude {
     // Core traits and types
     pub use beamer_core::{
         // Buffer types
-        AuxiliaryBuffers, AuxInput, AuxOutput, Buffer,
+        AuxiliaryBuffers, AuxInput, AuxOutput, Buffer, ChannelPair,
+        // Frame-major processing of wide buses
+        BiquadCoefficients, FrameTiles, TileBiquad,
+        // Parallel per-bus rendering
+        BusJob, BusRenderPool,
+        // Process-wide services shared across instances and classes
+        SharedService,
+        // Timeline tracing (spans via `trace::span()`)
+        trace, TraceConfig,
+        // Contiguous DSP state memory
+        ArenaLayout, ArenaSlice, DspArena,
+        // Memory residency (pre-faulting, locking)
+        MemoryPolicy, ResidencyReport,
+        // Inter-thread audio transport
+        AudioFifo, AudioFifoConsumer, AudioFifoProducer, FifoLayout,
         // Bypass handling
         BypassAction, BypassHandler, BypassState, CrossfadeCurve,
         // Sample trait for generic f32/f64 processing
@@ -73,18 +89,25 @@ pub mod prelude {
         AudioProcessor, EditorDelegate, HasParameters, Plugin,
         // Processor configuration types
         ProcessorConfig, NoConfig, AudioSetup, FullAudioSetup, BusLayout,
+        // Compile-time wrapper stage selection
+        ProcessCapabilities,
         // Bus configuration
         BusInfo, BusType,
         // Editor types
         EditorConstraints, NoEditor,
+        // Editor UI sync
+        UiDiff, UiSync, UiSyncConfig, UiSyncEmitter, UiSyncWriter,
         // Parameter metadata
         NoParameters, ParameterFlags, ParameterInfo,
         // Parameter types
         BoolParameter, EnumParameter, EnumParameterValue, FloatParameter, IntParameter, Formatter, ParameterRef, Parameters,
         // MIDI CC configuration (framework manages runtime state)
-        MidiCcConfig,
+        CcCurveMode, MidiCcConfig, MidiCcCurves,
         // Parameter smoothing
-        Smoother, SmoothingStyle,
+        Smoother, SmootherBank, SmoothingStyle,
+        // Lookup tables
+        fast_db_to_gain, fast_exp, fast_gain_to_db, fast_sin_phase, fast_tanh, init_shared_tables,
+        LookupTable,
         // Parameter group system
         GroupId, GroupInfo, ParameterGroups, ROOT_GROUP_ID,
         // Range mapping
@@ -96,6 +119,10 @@ pub mod prelude {
         // MIDI types
         ChannelPressure, ControlChange, MidiBuffer, MidiChannel, MidiEvent, MidiEventKind,
         MidiNote, NoteId, NoteOff, NoteOn, PitchBend, PolyPressure, ProgramChange,
+        // MIDI output thinning
+        MidiOutputConfig,
+        // Deadline-aware quality levels
+        DeadlineConfig, QualityLevel,
         // Process context and transport
         FrameRate, ProcessContext, Transport,
     };
@@ -106,6 +133,10 @@ pub mod prelude {
     // VST3 implementation
     pub use beamer_vst3::{export_vst3, Vst3Config, Vst3Processor};
 
+    // LV2 implementation (when feature enabled)
+    #[cfg(feature = "lv2")]
+    pub use beamer_lv2::{export_lv2, Lv2Config};
+
     // Derive macros for parameters (when feature enabled)
     #[cfg(feature = "derive")]
     pub use beamer_macros::Parameters as DeriveParameters;
@@ -197,12 +197,15 @@ fn update_envelope(current: f64, input_level: f64, attack_coeff: f64, release_co
 }
 
 /// Convert linear amplitude to dB with floor.
+///
+/// Uses the shared lookup table (~4e-5 dB error), which is plenty for a
+/// detector running once per sample.
 #[inline]
 fn linear_to_db(linear: f64) -> f64 {
     if linear <= 0.0 {
         -96.0 // Floor
     } else {
-        20.0 * linear.log10()
+        fast_gain_to_db(linear as f32) as f64
     }
 }
 
@@ -252,6 +255,9 @@ impl Plugin for CompressorPlugin {
         // Calculate bypass ramp samples based on sample rate
         let ramp_samples = (config.sample_rate * BYPASS_RAMP_MS * 0.001) as u32;
 
+        // Build the dB lookup tables here, not on the first audio block
+        init_shared_tables();
+
         CompressorProcessor {
             parameters: self.parameters,
             bypass_handler: BypassHandler::new(ramp_samples, CrossfadeCurve::EqualPower),
@@ -469,6 +475,11 @@ fn process_compression_inner<S: Sample>(
 impl AudioProcessor for CompressorProcessor {
     type Plugin = CompressorPlugin;
 
+    // Sidechain and native f64; no MIDI or transport
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY
+        .with_aux_buses()
+        .with_double_precision();
+
     fn unprepare(self) -> CompressorPlugin {
         // Return just the parameters; DSP state is discarded
         // It'll be reallocated on next prepare()
@@ -565,3 +576,67 @@ impl AudioProcessor for CompressorProcessor {
 // =============================================================================
 
 export_vst3!(CONFIG, Vst3Processor<CompressorPlugin>);
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer_test::{parameter_id, Script, Signal, TestHost};
+
+    beamer_test::install_counting_allocator!();
+
+    #[test]
+    fn test_gain_reduction() {
+        // Threshold -24 dB (normalized 0.6 over -60..0 dB), default 4:1 ratio
+        let script = Script::new(24_000)
+            .input_all(Signal::sine(1_000.0, 0.9))
+            .automate(0, parameter_id("threshold"), 0.6);
+        let rendered = TestHost::<CompressorPlugin>::new(48_000.0, 256).render(&script);
+
+        let tail = &rendered.channel(0)[18_000..];
+        let peak = tail.iter().fold(0.0f32, |p, s| p.max(s.abs()));
+        assert!(peak < 0.5, "steady-state peak {peak} not reduced");
+
+        rendered.assert_no_allocations();
+        rendered.assert_cpu_budget_release(0.5);
+        beamer_test::assert_golden("golden/gain_reduction.bin", &rendered, 1e-4);
+    }
+
+    #[test]
+    fn test_external_sidechain() {
+        // Quiet main input keyed by a loud sidechain
+        let script = Script::new(48_000)
+            .input_all(Signal::sine(220.0, 0.1))
+            .sidechain(0, Signal::sine(1_000.0, 1.0))
+            .sidechain(1, Signal::sine(1_000.0, 1.0))
+            .automate(0, parameter_id("threshold"), 0.6)
+            .automate(0, parameter_id("sidechain"), 1.0);
+        let rendered = TestHost::<CompressorPlugin>::new(48_000.0, 256).render(&script);
+
+        let tail = &rendered.channel(0)[36_000..];
+        let peak = tail.iter().fold(0.0f32, |p, s| p.max(s.abs()));
+        assert!(peak < 0.09, "sidechain did not key gain reduction (peak {peak})");
+        rendered.assert_no_allocations();
+    }
+
+    /// Hardware counters of the compression loop while gain reduction is active.
+    ///
+    /// Run with `cargo test --release -p compressor -- --ignored --nocapture perf`.
+    #[test]
+    #[ignore = "prints hardware counters; needs Linux perf_event_open"]
+    fn perf_compression_loop() {
+        let script = Script::new(96_000)
+            .input_all(Signal::sine(1_000.0, 0.9))
+            .automate(0, parameter_id("threshold"), 0.6);
+        let mut host = TestHost::<CompressorPlugin>::new(48_000.0, 256);
+        if let Err(error) = host.enable_perf_counters() {
+            eprintln!("hardware counters unavailable: {error}");
+            return;
+        }
+        let rendered = host.render(&script);
+        println!("{}", rendered.perf_report(1).unwrap());
+    }
+}
@@ -123,26 +123,39 @@ const MAX_DELAY_SECONDS: f64 = 2.5;
 /// ```
 ///
 /// Uses f64 internally for maximum precision, converts to/from
-/// the processing sample type as needed.
+/// the processing sample type as needed. The buffer lives in the
+/// processor's [`DspArena`], next to the other channel's line.
+/// The default line is empty (released while hibernated).
+#[derive(Default)]
 struct DelayLine {
-    buffer: Vec<f64>,
+    buffer: ArenaSlice<f64>,
     write_pos: usize,
     max_samples: usize,
 }
 
 impl DelayLine {
-    /// Create and allocate a delay line for the given sample rate.
-    ///
-    /// Buffer size is calculated as: `MAX_DELAY_SECONDS * sample_rate`
-    fn new(sample_rate: f64) -> Self {
-        let max_samples = (MAX_DELAY_SECONDS * sample_rate) as usize;
+    /// Buffer size for a sample rate: `MAX_DELAY_SECONDS * sample_rate`.
+    fn max_samples(sample_rate: f64) -> usize {
+        (MAX_DELAY_SECONDS * sample_rate) as usize
+    }
+
+    /// Allocate a delay line of `max_samples` from the arena.
+    fn new(arena: &mut DspArena, max_samples: usize) -> Self {
         Self {
-            buffer: vec![0.0; max_samples],
+            buffer: arena.alloc(max_samples, 0.0),
             write_pos: 0,
             max_samples,
         }
     }
 
+    /// Allocate the left/right lines for a sample rate in one contiguous,
+    /// cache-line-aligned block.
+    fn stereo(sample_rate: f64) -> (Self, Self) {
+        let max_samples = Self::max_samples(sample_rate);
+        let mut arena = DspArena::new(ArenaLayout::new().slices::<f64>(2, max_samples));
+        (Self::new(&mut arena, max_samples), Self::new(&mut arena, max_samples))
+    }
+
     /// Read from the delay line at the given delay in samples.
     ///
     /// Calculates read position using modular arithmetic:
@@ -201,10 +214,12 @@ impl Plugin for DelayPlugin {
         // Set sample rate on parameters for smoothing calculations
         self.parameters.set_sample_rate(config.sample_rate);
 
+        let (delay_l, delay_r) = DelayLine::stereo(config.sample_rate);
+
         DelayProcessor {
             parameters: self.parameters,
-            delay_l: DelayLine::new(config.sample_rate),
-            delay_r: DelayLine::new(config.sample_rate),
+            delay_l,
+            delay_r,
             sample_rate: config.sample_rate,
         }
     }
@@ -372,6 +387,11 @@ impl DelayProcessor {
 impl AudioProcessor for DelayProcessor {
     type Plugin = DelayPlugin;
 
+    // Tempo sync needs the transport; no MIDI or aux buses
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY
+        .with_double_precision()
+        .with_transport();
+
     fn unprepare(self) -> DelayPlugin {
         // Return just the parameters; delay buffers are discarded
         // They'll be reallocated with correct size on next prepare()
@@ -411,10 +431,21 @@ impl AudioProcessor for DelayProcessor {
         }
     }
 
+    fn hibernate(&mut self) {
+        // Up to MAX_DELAY_SECONDS of f64 per channel; nothing worth keeping
+        // since activation clears the lines anyway
+        self.delay_l = DelayLine::default();
+        self.delay_r = DelayLine::default();
+    }
+
+    fn resume(&mut self) {
+        (self.delay_l, self.delay_r) = DelayLine::stereo(self.sample_rate);
+    }
+
     fn tail_samples(&self) -> u32 {
         // Return the maximum delay buffer size as tail length
         // This ensures the host knows the plugin has audio tail
-        self.delay_l.max_samples as u32
+        DelayLine::max_samples(self.sample_rate) as u32
     }
 
     fn save_state(&self) -> PluginResult<Vec<u8>> {
@@ -431,3 +462,75 @@ impl AudioProcessor for DelayProcessor {
 // =============================================================================
 
 export_vst3!(CONFIG, Vst3Processor<DelayPlugin>);
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer_test::{Script, Signal, TestHost};
+
+    beamer_test::install_counting_allocator!();
+
+    #[test]
+    fn test_impulse_echo() {
+        // Default: 250 ms free-running delay, 50% mix
+        let script = Script::new(14_400).input_all(Signal::impulse());
+        let rendered = TestHost::<DelayPlugin>::new(48_000.0, 512).render(&script);
+        let left = rendered.channel(0);
+
+        // The first echo lands at 250 ms (12,000 samples), silence before it
+        let echo = left
+            .iter()
+            .enumerate()
+            .skip(1)
+            .max_by(|a, b| a.1.abs().total_cmp(&b.1.abs()))
+            .map(|(i, _)| i)
+            .unwrap();
+        assert!((11_990..=12_010).contains(&echo), "first echo at {echo}");
+        assert!(left[1..11_000].iter().all(|s| s.abs() < 1e-6));
+
+        rendered.assert_no_allocations();
+        rendered.assert_cpu_budget_release(0.5);
+        beamer_test::assert_golden("golden/impulse_echo.bin", &rendered, 1e-5);
+    }
+
+    #[test]
+    fn test_reactivate_restores_delay_lines() {
+        let script = Script::new(14_400).input_all(Signal::impulse());
+        let mut host = TestHost::<DelayPlugin>::new(48_000.0, 512);
+        host.render(&script);
+
+        // Hibernation frees the lines; reactivation starts from silence
+        host.reactivate();
+        let rendered = host.render(&script);
+        let fresh = TestHost::<DelayPlugin>::new(48_000.0, 512).render(&script);
+
+        assert_eq!(rendered.channel(0), fresh.channel(0));
+        rendered.assert_no_allocations();
+    }
+
+    #[test]
+    fn test_smoother_bank_follows_parameters() {
+        let mut parameters = DelayParameters::default();
+        parameters.set_sample_rate(48_000.0);
+        let mut bank = SmootherBank::from_parameters(&parameters);
+        bank.set_sample_rate(48_000.0);
+
+        // Feedback and mix are smoothed; the rest are not
+        assert_eq!(bank.len(), 2);
+        let feedback = bank.slot(parameters.feedback.id()).unwrap();
+        let mix = bank.slot(parameters.mix.id()).unwrap();
+
+        parameters.feedback.set(0.9);
+        parameters.mix.set(0.1);
+        bank.update_targets(&parameters);
+        for _ in 0..1_000 {
+            bank.tick();
+            assert_eq!(bank.value(feedback), parameters.feedback.tick_smoothed());
+            assert_eq!(bank.value(mix), parameters.mix.tick_smoothed());
+        }
+    }
+}
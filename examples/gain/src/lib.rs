@@ -204,10 +204,10 @@ impl GainProcessor {
         let duck_amount = (sidechain_level * S::from_f32(4.0)).min(S::ONE);
         let effective_gain = gain * (S::ONE - duck_amount * S::from_f32(0.8));
 
-        // Process using zip_channels() iterator for cleaner code
-        for (input, output) in buffer.zip_channels() {
-            for (i, o) in input.iter().zip(output.iter_mut()) {
-                *o = *i * effective_gain;
+        // Process in place: channels the host aliased need no input copy
+        for channel in buffer.in_place_channels() {
+            for sample in channel.iter_mut() {
+                *sample = *sample * effective_gain;
             }
         }
     }
@@ -216,6 +216,12 @@ impl GainProcessor {
 impl AudioProcessor for GainProcessor {
     type Plugin = GainPlugin;
 
+    // Sidechain, native f64 and transport; the MIDI stages compile away
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY
+        .with_aux_buses()
+        .with_double_precision()
+        .with_transport();
+
     fn unprepare(self) -> GainPlugin {
         GainPlugin {
             parameters: self.parameters,
@@ -232,6 +238,10 @@ impl AudioProcessor for GainProcessor {
         self.process_generic(buffer, aux, context);
     }
 
+    fn supports_in_place(&self) -> bool {
+        true // process_generic() only uses in_place_channels()
+    }
+
     // =========================================================================
     // 64-bit Processing Support
     // =========================================================================
@@ -271,3 +281,46 @@ impl AudioProcessor for GainProcessor {
 
 // Export VST3 entry points using the generic wrapper
 export_vst3!(CONFIG, Vst3Processor<GainPlugin>);
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer_test::{parameter_id, Script, Signal, TestHost};
+
+    beamer_test::install_counting_allocator!();
+
+    #[test]
+    fn test_gain_automation() {
+        // 0 dB for the first half, -60 dB (normalized 0.0) for the second
+        let script = Script::new(9_600)
+            .input_all(Signal::sine(440.0, 0.5))
+            .automate(4_800, parameter_id("gain"), 0.0);
+        let rendered = TestHost::<GainPlugin>::new(48_000.0, 256).render(&script);
+
+        let first = rendered.channel(0)[..4_608].iter().fold(0.0f32, |p, s| p.max(s.abs()));
+        let second = rendered.channel(0)[4_864..].iter().fold(0.0f32, |p, s| p.max(s.abs()));
+        assert!((first - 0.5).abs() < 1e-3);
+        assert!(second < 0.5e-3 + 1e-6);
+
+        rendered.assert_no_allocations();
+        rendered.assert_cpu_budget_release(0.5);
+        beamer_test::assert_golden("golden/gain_automation.bin", &rendered, 1e-5);
+    }
+
+    #[test]
+    fn test_sidechain_ducking() {
+        let script = Script::new(4_800)
+            .input_all(Signal::Dc(1.0))
+            .sidechain(0, Signal::Dc(0.5))
+            .sidechain(1, Signal::Dc(0.5));
+        let rendered = TestHost::<GainPlugin>::new(48_000.0, 480).render(&script);
+
+        // Sidechain RMS 0.5 -> full ducking (80% reduction)
+        assert!((rendered.peak() - 0.2).abs() < 1e-4);
+        rendered.assert_no_allocations();
+    }
+}
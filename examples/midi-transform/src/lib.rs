@@ -404,6 +404,15 @@ impl MidiTransformProcessor {
 impl AudioProcessor for MidiTransformProcessor {
     type Plugin = MidiTransformPlugin;
 
+    // MIDI in and out only
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY
+        .with_midi_input()
+        .with_midi_output();
+
+    // Scaled or remapped CCs often repeat a value (e.g. clamped at 1.0);
+    // send only changes the host can store at 7-bit resolution
+    const MIDI_OUTPUT: MidiOutputConfig = MidiOutputConfig::COALESCED.with_cc_resolution(128);
+
     fn unprepare(self) -> MidiTransformPlugin {
         MidiTransformPlugin {
             parameters: self.parameters,
@@ -508,3 +517,122 @@ impl AudioProcessor for MidiTransformProcessor {
 // =============================================================================
 
 export_vst3!(CONFIG, Vst3Processor<MidiTransformPlugin>);
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer::core::parameter_groups::ParameterGroups;
+    use beamer::core::parameter_store::ParameterStore;
+    use beamer_test::{element_parameter_id, parameter_id, Script, TestHost};
+
+    beamer_test::install_counting_allocator!();
+
+    fn pitches(events: &[MidiEvent]) -> Vec<(u32, u8)> {
+        events
+            .iter()
+            .filter_map(|e| match &e.event {
+                MidiEventKind::NoteOn(on) => Some((e.sample_offset, on.pitch)),
+                _ => None,
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_notes_pass_through() {
+        let script = Script::new(2_048).note(100, 0, 60, 0.8, 1_000);
+        let rendered = TestHost::<MidiTransformPlugin>::new(48_000.0, 256).render(&script);
+
+        assert_eq!(rendered.midi.len(), 2);
+        assert_eq!(pitches(&rendered.midi), vec![(100, 60)]);
+        rendered.assert_no_allocations();
+        rendered.assert_cpu_budget_release(0.5);
+    }
+
+    #[test]
+    fn test_octave_up_is_sample_accurate() {
+        // Mode index 2 of 6 (Octave Up) -> normalized 0.4
+        let script = Script::new(2_048)
+            .automate(0, parameter_id("note_mode"), 0.4)
+            .note(300, 0, 60, 0.8, 100)
+            .note(1_500, 0, 64, 0.8, 100);
+        let rendered = TestHost::<MidiTransformPlugin>::new(48_000.0, 256).render(&script);
+
+        assert_eq!(pitches(&rendered.midi), vec![(300, 72), (1_500, 76)]);
+        rendered.assert_no_allocations();
+    }
+
+    #[test]
+    fn test_clamped_cc_repeats_are_coalesced() {
+        // Scale (index 2 of 5) at 2x: the upper half of a CC sweep clamps to 1.0
+        let mut script = Script::new(1_024)
+            .automate(0, parameter_id("cc_mode"), 0.5)
+            .automate(0, parameter_id("cc_scale"), 1.0);
+        for i in 0..128 {
+            script = script.midi(MidiEvent::control_change(i * 8, 0, 1, i as f32 / 127.0));
+        }
+        let rendered = TestHost::<MidiTransformPlugin>::new(48_000.0, 256).render(&script);
+
+        let values: Vec<f32> = rendered
+            .midi
+            .iter()
+            .filter_map(|e| match &e.event {
+                MidiEventKind::ControlChange(cc) => Some(cc.value),
+                _ => None,
+            })
+            .collect();
+        assert_eq!(values.len(), 65);
+        assert_eq!(values[63..], [126.0 / 127.0, 1.0]);
+        rendered.assert_no_allocations();
+    }
+
+    #[derive(Parameters)]
+    struct BandParameters {
+        #[parameter(id = "freq", name = "Frequency", default = 1000.0, range = 20.0..=20000.0, kind = "hz")]
+        freq: FloatParameter,
+
+        #[parameter(id = "gain", name = "Gain", default = 0.0, range = -24.0..=24.0, kind = "db")]
+        gain: FloatParameter,
+    }
+
+    #[derive(Parameters)]
+    struct BankParameters {
+        #[parameter(id = "output", name = "Output", default = 0.0, range = -60.0..=12.0, kind = "db")]
+        output: FloatParameter,
+
+        #[nested(group = "Band")]
+        bands: [BandParameters; 32],
+    }
+
+    #[test]
+    fn test_nested_array_groups() {
+        let parameters = BankParameters::default();
+        assert_eq!(Parameters::count(&parameters), 65);
+        assert_eq!(parameters.group_count(), 33);
+        assert_eq!(parameters.group_info(4).unwrap().name, "Band 4");
+
+        // Every element gets its own IDs, reachable through by_id()
+        let ids: std::collections::HashSet<_> = Parameters::iter(&parameters).map(|p| p.id()).collect();
+        assert_eq!(ids.len(), 65);
+        let id = element_parameter_id("band3", "freq");
+        assert_eq!(parameters.bands[3].freq.id(), id);
+        assert_eq!(parameters.by_id(parameter_id("output")).unwrap().name(), "Output");
+        assert!(parameters.by_id(parameter_id("freq")).is_none());
+        assert_eq!(ParameterStore::info(&parameters, 7).unwrap().id, id);
+        assert_eq!(parameters.bands[3].freq.info().group_id, 4);
+
+        // State paths use the element keys
+        parameters.set_normalized(id, 0.25);
+        let state = parameters.save_state();
+        let mut restored = BankParameters::default();
+        restored.load_state(&state).unwrap();
+        assert_eq!(restored.bands[3].freq.get_normalized(), 0.25);
+        assert!(restored.load_state_path("band31/gain", 1.0));
+        assert!(!restored.load_state_path("band32/gain", 1.0));
+        assert!(!restored.load_state_path("band03/gain", 1.0));
+        assert_eq!(restored.bands[31].gain.get_normalized(), 1.0);
+    }
+}
@@ -404,6 +404,9 @@ impl Plugin for SynthPlugin {
         // Set sample rate on parameters for smoothing calculations
         self.parameters.set_sample_rate(config.sample_rate);
 
+        // Build the vibrato sine table here, not on the first audio block
+        init_shared_tables();
+
         SynthProcessor {
             parameters: self.parameters,
             // No midi_cc_parameters to move! Framework manages it.
@@ -423,7 +426,9 @@ impl Plugin for SynthPlugin {
         // mod wheel, breath, volume, pan, expression, and sustain.
         // This solves the VST3 MIDI input problem where most DAWs don't send
         // raw MIDI CC events - instead they use IMidiMapping (hidden parameters).
-        Some(MidiCcConfig::SYNTH_FULL)
+        // Linear curves give pitch bend and mod wheel per-sample values
+        // without zipper steps between host points.
+        Some(MidiCcConfig::SYNTH_FULL.with_curves(CcCurveMode::Linear))
     }
 
     // =========================================================================
@@ -540,12 +545,18 @@ impl SynthProcessor {
         &mut self,
         buffer: &mut Buffer<S>,
         _aux: &mut AuxiliaryBuffers<S>,
-        _context: &ProcessContext,
+        context: &ProcessContext,
     ) {
         let num_samples = buffer.num_samples();
         let waveform = self.parameters.waveform.get();
         let gain = S::from_f64(self.parameters.gain.as_linear());
 
+        // Mapped pitch bend and mod wheel arrive as sample-accurate curves;
+        // raw MIDI events still apply when the host provides no curves
+        let curves = context.midi_cc_curves();
+        let bend_curve = curves.and_then(|c| c.pitch_bend());
+        let mod_curve = curves.and_then(|c| c.mod_wheel());
+
         let mut event_idx = 0;
 
         for sample_idx in 0..num_samples {
@@ -595,6 +606,13 @@ impl SynthProcessor {
                 }
             }
 
+            if let Some(bend) = bend_curve {
+                self.pitch_bend = bend[sample_idx] as f64;
+            }
+            if let Some(mod_wheel) = mod_curve {
+                self.mod_wheel = mod_wheel[sample_idx] as f64;
+            }
+
             // Update vibrato LFO
             let vibrato_phase_inc = VIBRATO_RATE_HZ / self.sample_rate;
             self.vibrato_phase += vibrato_phase_inc;
@@ -602,8 +620,9 @@ impl SynthProcessor {
                 self.vibrato_phase -= 1.0;
             }
 
-            // Calculate base vibrato LFO (sine wave, no scaling yet)
-            let vibrato_lfo = (self.vibrato_phase * 2.0 * PI).sin();
+            // Calculate base vibrato LFO (sine wave, no scaling yet).
+            // Shared lookup table: an LFO doesn't need libm precision.
+            let vibrato_lfo = fast_sin_phase(self.vibrato_phase as f32) as f64;
 
             // =================================================================
             // Filter Modulation
@@ -677,6 +696,12 @@ impl SynthProcessor {
 impl AudioProcessor for SynthProcessor {
     type Plugin = SynthPlugin;
 
+    // Notes and mapped controllers in, no MIDI out
+    const CAPABILITIES: ProcessCapabilities = ProcessCapabilities::AUDIO_ONLY
+        .with_midi_input()
+        .with_midi_cc()
+        .with_double_precision();
+
     fn unprepare(self) -> SynthPlugin {
         // Return parameters; voices and DSP state are discarded
         // They'll be reallocated on next prepare()
@@ -736,3 +761,84 @@ impl AudioProcessor for SynthProcessor {
 // =============================================================================
 
 export_vst3!(CONFIG, Vst3Processor<SynthPlugin>);
+
+// =============================================================================
+// Tests
+// =============================================================================
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use beamer::core::{controller, MidiCcState};
+    use beamer_test::{Script, TestHost};
+
+    beamer_test::install_counting_allocator!();
+
+    #[test]
+    fn test_note_renders_and_releases() {
+        let script = Script::new(24_000).note(1_000, 0, 69, 1.0, 6_000);
+        let rendered = TestHost::<SynthPlugin>::new(48_000.0, 256).render(&script);
+        let left = rendered.channel(0);
+
+        // Silent before the note-on, sounding while held, silent once the
+        // exponential release (30 ms time constant) has decayed
+        assert!(left[..1_000].iter().all(|&s| s == 0.0));
+        assert!(left[2_000..7_000].iter().any(|s| s.abs() > 0.01));
+        assert!(left[21_000..].iter().all(|s| s.abs() < 1e-4));
+
+        rendered.assert_no_allocations();
+        rendered.assert_cpu_budget_release(0.5);
+        beamer_test::assert_golden("golden/note_a4.bin", &rendered, 1e-4);
+    }
+
+    #[test]
+    fn test_chord_stays_allocation_free() {
+        let script = (0..8).fold(Script::new(9_600), |script, i| {
+            script.note(i * 37, 0, 48 + i as u8 * 3, 0.7, 4_800)
+        });
+        let rendered = TestHost::<SynthPlugin>::new(44_100.0, 64).render(&script);
+
+        assert!(rendered.peak() > 0.0);
+        rendered.assert_no_allocations();
+    }
+
+    #[test]
+    fn test_mapped_pitch_bend_follows_curve() {
+        let zero_crossings = |samples: &[f32]| samples.windows(2).filter(|w| (w[0] < 0.0) != (w[1] < 0.0)).count();
+        let note = Script::new(24_000).note(0, 0, 69, 1.0, 24_000);
+        // Full bend up, reached mid-block (linear ramp from center)
+        let bent = note
+            .clone()
+            .automate(1_000, MidiCcState::parameter_id(controller::PITCH_BEND), 1.0);
+
+        let plain = TestHost::<SynthPlugin>::new(48_000.0, 256).render(&note);
+        let rendered = TestHost::<SynthPlugin>::new(48_000.0, 256).render(&bent);
+
+        // +2 semitones: roughly 12% more cycles once the bend has landed
+        let window = 4_000..24_000;
+        let plain_count = zero_crossings(&plain.channel(0)[window.clone()]);
+        let bent_count = zero_crossings(&rendered.channel(0)[window]);
+        assert!(bent_count as f64 > plain_count as f64 * 1.08, "{bent_count} vs {plain_count}");
+        rendered.assert_no_allocations();
+    }
+
+    /// Hardware counters of the voice loop at 1 and NUM_VOICES voices.
+    ///
+    /// Run with `cargo test --release -p synth -- --ignored --nocapture perf`.
+    #[test]
+    #[ignore = "prints hardware counters; needs Linux perf_event_open"]
+    fn perf_voice_loop() {
+        for voices in [1, NUM_VOICES] {
+            let script = (0..voices).fold(Script::new(96_000), |script, i| {
+                script.note(0, 0, 48 + i as u8 * 3, 0.7, 96_000)
+            });
+            let mut host = TestHost::<SynthPlugin>::new(48_000.0, 256);
+            if let Err(error) = host.enable_perf_counters() {
+                eprintln!("hardware counters unavailable: {error}");
+                return;
+            }
+            let rendered = host.render(&script);
+            println!("{voices} voice(s)\n{}\n", rendered.perf_report(voices).unwrap());
+        }
+    }
+}
@@ -1,6 +1,6 @@
 //! Build tooling for Beamer plugins.
 //!
-//! Usage: cargo xtask bundle <package> [--release] [--install]
+//! Usage: cargo xtask bundle <package> [--release] [--install] [--lv2]
 
 use std::fs;
 use std::path::PathBuf;
@@ -17,25 +17,27 @@ fn main() {
     let package = &args[2];
     let release = args.iter().any(|a| a == "--release");
     let install = args.iter().any(|a| a == "--install");
+    let lv2 = args.iter().any(|a| a == "--lv2");
 
-    if let Err(e) = bundle(package, release, install) {
+    if let Err(e) = bundle(package, release, install, lv2) {
         eprintln!("Error: {}", e);
         std::process::exit(1);
     }
 }
 
 fn print_usage() {
-    eprintln!("Usage: cargo xtask bundle <package> [--release] [--install]");
+    eprintln!("Usage: cargo xtask bundle <package> [--release] [--install] [--lv2]");
     eprintln!();
     eprintln!("Commands:");
-    eprintln!("  bundle    Build and bundle a plugin as VST3");
+    eprintln!("  bundle    Build and bundle a plugin as VST3 (or LV2 with --lv2)");
     eprintln!();
     eprintln!("Options:");
     eprintln!("  --release    Build in release mode");
-    eprintln!("  --install    Install to ~/Library/Audio/Plug-Ins/VST3/");
+    eprintln!("  --install    Install to ~/Library/Audio/Plug-Ins/VST3/ (LV2: ~/.lv2/)");
+    eprintln!("  --lv2        Bundle as LV2 (plugin must use export_lv2!)");
 }
 
-fn bundle(package: &str, release: bool, install: bool) -> Result<(), String> {
+fn bundle(package: &str, release: bool, install: bool, lv2: bool) -> Result<(), String> {
     println!("Bundling {} (release: {})...", package, release);
 
     // Get workspace root
@@ -65,6 +67,10 @@ fn bundle(package: &str, release: bool, install: bool) -> Result<(), String> {
     // Convert package name to library name (replace hyphens with underscores)
     let lib_name = package.replace('-', "_");
 
+    if lv2 {
+        return bundle_lv2(package, &lib_name, &target_dir, install);
+    }
+
     // Find the dylib
     let dylib_name = format!("lib{}.dylib", lib_name);
     let dylib_path = target_dir.join(&dylib_name);
@@ -118,6 +124,147 @@ fn bundle(package: &str, release: bool, install: bool) -> Result<(), String> {
     Ok(())
 }
 
+fn bundle_lv2(package: &str, lib_name: &str, target_dir: &PathBuf, install: bool) -> Result<(), String> {
+    let dylib_name = if cfg!(target_os = "macos") {
+        format!("lib{}.dylib", lib_name)
+    } else {
+        format!("lib{}.so", lib_name)
+    };
+    let dylib_path = target_dir.join(&dylib_name);
+
+    if !dylib_path.exists() {
+        return Err(format!("Built library not found: {}", dylib_path.display()));
+    }
+
+    // Create bundle name ("gain" -> "BeamerGain.lv2")
+    let name = to_bundle_name(package).trim_end_matches(".vst3").to_string();
+    let bundle_name = format!("{}.lv2", name);
+    let bundle_dir = target_dir.join(&bundle_name);
+    let data_file = format!("{}.ttl", name);
+
+    println!("Creating bundle at {}...", bundle_dir.display());
+
+    // Clean up existing bundle
+    if bundle_dir.exists() {
+        fs::remove_dir_all(&bundle_dir).map_err(|e| format!("Failed to remove old bundle: {}", e))?;
+    }
+    fs::create_dir_all(&bundle_dir).map_err(|e| format!("Failed to create bundle dir: {}", e))?;
+
+    // Copy library
+    fs::copy(&dylib_path, bundle_dir.join(&dylib_name))
+        .map_err(|e| format!("Failed to copy library: {}", e))?;
+
+    // Generate TTL from the built library, so ports match the binary
+    let (manifest, plugin) = lv2_ttl::generate(&dylib_path, &dylib_name, &data_file)?;
+    fs::write(bundle_dir.join("manifest.ttl"), manifest)
+        .map_err(|e| format!("Failed to write manifest.ttl: {}", e))?;
+    fs::write(bundle_dir.join(&data_file), plugin)
+        .map_err(|e| format!("Failed to write {}: {}", data_file, e))?;
+
+    println!("Bundle created: {}", bundle_dir.display());
+
+    if install {
+        install_lv2(&bundle_dir, &bundle_name)?;
+    }
+
+    Ok(())
+}
+
+fn install_lv2(bundle_dir: &PathBuf, bundle_name: &str) -> Result<(), String> {
+    let home = std::env::var("HOME").map_err(|_| "HOME not set")?;
+    let lv2_dir = if cfg!(target_os = "macos") {
+        PathBuf::from(home).join("Library").join("Audio").join("Plug-Ins").join("LV2")
+    } else {
+        PathBuf::from(home).join(".lv2")
+    };
+
+    fs::create_dir_all(&lv2_dir).map_err(|e| format!("Failed to create LV2 dir: {}", e))?;
+
+    let dest = lv2_dir.join(bundle_name);
+
+    // Remove existing installation
+    if dest.exists() {
+        fs::remove_dir_all(&dest).map_err(|e| format!("Failed to remove old installation: {}", e))?;
+    }
+
+    copy_dir_all(bundle_dir, &dest)?;
+
+    println!("Installed to: {}", dest.display());
+    Ok(())
+}
+
+/// TTL generation through the functions `export_lv2!` exports.
+#[cfg(unix)]
+mod lv2_ttl {
+    use std::ffi::{c_char, c_int, c_void, CStr, CString};
+    use std::path::Path;
+
+    const RTLD_NOW: c_int = 2;
+
+    extern "C" {
+        fn dlopen(filename: *const c_char, flag: c_int) -> *mut c_void;
+        fn dlsym(handle: *mut c_void, symbol: *const c_char) -> *mut c_void;
+        fn dlclose(handle: *mut c_void) -> c_int;
+    }
+
+    type PluginTtl = unsafe extern "C" fn() -> *mut c_char;
+    type ManifestTtl = unsafe extern "C" fn(*const c_char, *const c_char) -> *mut c_char;
+    type FreeTtl = unsafe extern "C" fn(*mut c_char);
+
+    /// Returns `(manifest.ttl, plugin data file)`.
+    pub fn generate(library: &Path, binary: &str, data_file: &str) -> Result<(String, String), String> {
+        let path = CString::new(library.to_string_lossy().as_bytes()).map_err(|e| e.to_string())?;
+        let binary = CString::new(binary).map_err(|e| e.to_string())?;
+        let data_file = CString::new(data_file).map_err(|e| e.to_string())?;
+
+        // SAFETY: symbols have the signatures export_lv2! declares; strings
+        // are copied before being handed back to the library to free
+        unsafe {
+            let handle = dlopen(path.as_ptr(), RTLD_NOW);
+            if handle.is_null() {
+                return Err(format!("Failed to load {}", library.display()));
+            }
+            let symbol = |name: &CStr| {
+                let ptr = dlsym(handle, name.as_ptr());
+                (!ptr.is_null()).then_some(ptr)
+            };
+            let result = match (
+                symbol(c"beamer_lv2_plugin_ttl"),
+                symbol(c"beamer_lv2_manifest_ttl"),
+                symbol(c"beamer_lv2_free_ttl"),
+            ) {
+                (Some(plugin), Some(manifest), Some(free)) => {
+                    let plugin: PluginTtl = std::mem::transmute(plugin);
+                    let manifest: ManifestTtl = std::mem::transmute(manifest);
+                    let free: FreeTtl = std::mem::transmute(free);
+                    let take = |ttl: *mut c_char| {
+                        if ttl.is_null() {
+                            return Err("TTL generation failed".to_string());
+                        }
+                        let s = CStr::from_ptr(ttl).to_string_lossy().into_owned();
+                        free(ttl);
+                        Ok(s)
+                    };
+                    take(manifest(binary.as_ptr(), data_file.as_ptr()))
+                        .and_then(|manifest| Ok((manifest, take(plugin())?)))
+                }
+                _ => Err("Library has no LV2 export (missing export_lv2!)".to_string()),
+            };
+            dlclose(handle);
+            result
+        }
+    }
+}
+
+#[cfg(not(unix))]
+mod lv2_ttl {
+    use std::path::Path;
+
+    pub fn generate(_library: &Path, _binary: &str, _data_file: &str) -> Result<(String, String), String> {
+        Err("LV2 bundling is only supported on Linux and macOS".to_string())
+    }
+}
+
 fn get_workspace_root() -> Result<PathBuf, String> {
     let output = Command::new("cargo")
         .args(["locate-project", "--workspace", "--message-format=plain"])